@@ -406,7 +406,7 @@ struct sbix
       }
       else
       {
-	objidxs.push (c->serializer->pop_pack ());
+	objidxs.push (c->serializer->pop_pack (false));
 	new_strikes.push (o);
       }
     }
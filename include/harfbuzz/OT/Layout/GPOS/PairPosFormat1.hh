@@ -126,7 +126,7 @@ struct PairPosFormat1_3
     TRACE_SUBSET (this);
 
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto *out = c->serializer->start_embed (*this);
     if (unlikely (!c->serializer->extend_min (out))) return_trace (false);
@@ -312,7 +312,7 @@ struct PairPosFormat2_4
     }
 
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto it =
     + hb_iter (this+coverage)
@@ -169,7 +169,7 @@ struct PairSet
     out->len = 0;
 
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     unsigned len1 = valueFormats[0].get_len ();
     unsigned len2 = valueFormats[1].get_len ();
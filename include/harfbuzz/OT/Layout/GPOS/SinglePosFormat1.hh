@@ -141,7 +141,7 @@ struct SinglePosFormat1
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     hb_set_t intersection;
     (this+coverage).intersect_set (glyphset, intersection);
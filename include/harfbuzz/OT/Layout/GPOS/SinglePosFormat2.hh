@@ -147,7 +147,7 @@ struct SinglePosFormat2
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     unsigned sub_length = valueFormat.get_len ();
     auto values_array = values.as_array (valueCount * sub_length);
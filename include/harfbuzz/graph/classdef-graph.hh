@@ -83,30 +83,24 @@ struct ClassDef : public OT::ClassDef
                               unsigned dest_obj,
                               unsigned max_size)
   {
-    char* buffer = (char*) hb_calloc (1, max_size);
+    char* buffer = c.graph.alloc_buffer (max_size);
+    if (!buffer) return false;
     hb_serialize_context_t serializer (buffer, max_size);
     OT::ClassDef_serialize (&serializer, glyph_and_class);
     serializer.end_serialize ();
     if (serializer.in_error ())
     {
-      hb_free (buffer);
+      c.graph.free_buffer (buffer);
       return false;
     }
 
-    hb_bytes_t class_def_copy = serializer.copy_bytes ();
+    hb_bytes_t class_def_copy = c.graph.copy_bytes (serializer);
+    c.graph.free_buffer (buffer);
     if (!class_def_copy.arrayZ) return false;
-    // Give ownership to the context, it will cleanup the buffer.
-    if (!c.add_buffer ((char *) class_def_copy.arrayZ))
-    {
-      hb_free ((char *) class_def_copy.arrayZ);
-      return false;
-    }
 
     auto& obj = c.graph.vertices_[dest_obj].obj;
     obj.head = (char *) class_def_copy.arrayZ;
     obj.tail = obj.head + class_def_copy.length;
-
-    hb_free (buffer);
     return true;
   }
 
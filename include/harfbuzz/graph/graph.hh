@@ -27,6 +27,7 @@
 #include "../hb-set.hh"
 #include "../hb-priority-queue.hh"
 #include "../hb-serialize.hh"
+#include "../hb-pool.hh"
 
 #ifndef GRAPH_GRAPH_HH
 #define GRAPH_GRAPH_HH
@@ -400,8 +401,7 @@ struct graph_t
       : parents_invalid (true),
         distance_invalid (true),
         positions_invalid (true),
-        successful (true),
-        buffers ()
+        successful (true)
   {
     num_roots_for_space_.push (1);
     bool removed_nil = false;
@@ -432,12 +432,6 @@ struct graph_t
     }
   }
 
-  ~graph_t ()
-  {
-    for (char* b : buffers)
-      hb_free (b);
-  }
-
   bool operator== (const graph_t& other) const
   {
     return root ().equals (other.root (), *this, other, 0);
@@ -475,10 +469,33 @@ struct graph_t
     return vertices_[i].obj;
   }
 
-  bool add_buffer (char* buffer)
+  /*
+   * Allocates zeroed storage for object data, released with the graph.
+   */
+  char* alloc_buffer (size_t size)
+  {
+    return (char*) arena.calloc (1, size);
+  }
+
+  void free_buffer (char* buffer)
+  {
+    arena.free (buffer);
+  }
+
+  /*
+   * Copies out what c serialized, into storage released with the graph.
+   */
+  hb_bytes_t copy_bytes (const hb_serialize_context_t& c)
   {
-    buffers.push (buffer);
-    return !buffers.in_error ();
+    unsigned len = (c.head - c.start) + (c.end - c.tail);
+    if (!len) return hb_bytes_t ();
+
+    char* p = (char*) arena.alloc (len);
+    if (unlikely (!p)) return hb_bytes_t ();
+
+    hb_memcpy (p, c.start, c.head - c.start);
+    hb_memcpy (p + (c.head - c.start), c.tail, c.end - c.tail);
+    return hb_bytes_t (p, len);
   }
 
   /*
@@ -1311,45 +1328,37 @@ struct graph_t
     // https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
     //
     // Implementation Note:
-    // Since our priority queue doesn't support fast priority decreases
-    // we instead just add new entries into the queue when a priority changes.
-    // Redundant ones are filtered out later on by the visited set.
-    // According to https://www3.cs.stonybrook.edu/~rezaul/papers/TR-07-54.pdf
-    // for practical performance this is faster then using a more advanced queue
-    // (such as a fibonacci queue) with a fast decrease priority.
+    // The queue is indexed by vertex and supports decreasing the priority of
+    // a queued vertex, so it holds each vertex at most once and never grows
+    // past the number of vertices, no matter how many edges there are.
     unsigned count = vertices_.length;
     for (unsigned i = 0; i < count; i++)
       vertices_.arrayZ[i].distance = hb_int_max (int64_t);
     vertices_.tail ().distance = 0;
 
-    hb_priority_queue_t queue;
+    hb_indexed_priority_queue_t queue;
+    if (unlikely (!check_success (queue.reset (count)))) return;
     queue.insert (0, vertices_.length - 1);
 
-    hb_vector_t<bool> visited;
-    visited.resize (vertices_.length);
-
     while (!queue.in_error () && !queue.is_empty ())
     {
       unsigned next_idx = queue.pop_minimum ().second;
-      if (visited[next_idx]) continue;
       const auto& next = vertices_[next_idx];
       int64_t next_distance = vertices_[next_idx].distance;
-      visited[next_idx] = true;
 
       for (const auto& link : next.obj.all_links ())
       {
-        if (visited[link.objidx]) continue;
-
         const auto& child = vertices_.arrayZ[link.objidx].obj;
         unsigned link_width = link.width ? link.width : 4; // treat virtual offsets as 32 bits wide
         int64_t child_weight = (child.tail - child.head) +
                                ((int64_t) 1 << (link_width * 8)) * (vertices_.arrayZ[link.objidx].space + 1);
         int64_t child_distance = next_distance + child_weight;
 
+        // Visited vertices already have a distance no larger than this.
         if (child_distance < vertices_.arrayZ[link.objidx].distance)
         {
           vertices_.arrayZ[link.objidx].distance = child_distance;
-          queue.insert (child_distance, link.objidx);
+          queue.insert_or_decrease (child_distance, link.objidx);
         }
       }
     }
@@ -1460,7 +1469,8 @@ struct graph_t
   bool positions_invalid;
   bool successful;
   hb_vector_t<unsigned> num_roots_for_space_;
-  hb_vector_t<char*> buffers;
+  // Repacking makes lots of short-lived object buffers.
+  hb_arena_t arena;
 };
 
 }
@@ -199,13 +199,8 @@ struct Lookup : public OT::Lookup
 
     size_t new_size = v.table_size ()
                       + new_subtable_count * OT::Offset16::static_size;
-    char* buffer = (char*) hb_calloc (1, new_size);
+    char* buffer = c.graph.alloc_buffer (new_size);
     if (!buffer) return false;
-    if (!c.add_buffer (buffer))
-    {
-      hb_free (buffer);
-     return false;
-    }
     hb_memcpy (buffer, v.obj.head, v.table_size());
 
     v.obj.head = buffer;
@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_ATOMIC_POOL_HH
+#define HB_ATOMIC_POOL_HH
+
+#include "hb.hh"
+
+/* A bounded pool of idle objects shared by threads, without locks.
+ *
+ * Objects are parked in a fixed array of atomic slots.  take() tries
+ * every slot once, starting at a different one each call to spread
+ * contention, and put() parks an object in the first free slot.  Neither
+ * ever waits on other threads; take() returns nullptr when it finds
+ * nothing and put() returns false when the pool is full, leaving it to
+ * the caller to create or destroy objects.  The pool does not own what it
+ * holds; call fini() with a destroy function before freeing it. */
+
+template <typename T, unsigned Size>
+struct hb_atomic_pool_t
+{
+  static_assert (Size > 0, "");
+
+  T *take () const
+  {
+    unsigned start = (unsigned) next.inc ();
+    for (unsigned i = 0; i < Size; i++)
+    {
+      auto &slot = slots[(start + i) % Size];
+      T *p = slot.get_acquire ();
+      if (p && slot.cmpexch (p, nullptr))
+	return p;
+    }
+    return nullptr;
+  }
+
+  bool put (T *p) const
+  {
+    for (unsigned i = 0; i < Size; i++)
+      if (slots[i].cmpexch (nullptr, p))
+	return true;
+    return false;
+  }
+
+  /* Approximate while other threads use the pool. */
+  unsigned get_idle () const
+  {
+    unsigned count = 0;
+    for (unsigned i = 0; i < Size; i++)
+      count += !!slots[i].get_relaxed ();
+    return count;
+  }
+
+  template <typename Destroy>
+  void fini (Destroy destroy)
+  {
+    for (unsigned i = 0; i < Size; i++)
+      if (T *p = slots[i].get_relaxed ())
+      {
+	slots[i].set_relaxed (nullptr);
+	destroy (p);
+      }
+  }
+
+  private:
+  mutable hb_atomic_ptr_t<T> slots[Size];
+  mutable hb_atomic_int_t next;
+};
+
+
+#endif /* HB_ATOMIC_POOL_HH */
@@ -100,10 +100,11 @@ struct hb_bit_page_t
   bool is_empty () const
   {
     if (has_population ()) return !population;
-    return
-    + hb_iter (v)
-    | hb_none
-    ;
+    /* Branch-free reductions over the whole page; these vectorize. */
+    elt_t bits = 0;
+    for (unsigned i = 0; i < len (); i++)
+      bits |= v[i];
+    return !bits;
   }
   uint32_t hash () const
   {
@@ -220,10 +221,10 @@ struct hb_bit_page_t
 
   bool is_equal (const hb_bit_page_t &other) const
   {
+    elt_t bits = 0;
     for (unsigned i = 0; i < len (); i++)
-      if (v[i] != other.v[i])
-	return false;
-    return true;
+      bits |= v[i] ^ other.v[i];
+    return !bits;
   }
   bool is_subset (const hb_bit_page_t &larger_page) const
   {
@@ -231,23 +232,46 @@ struct hb_bit_page_t
 	population > larger_page.population)
       return false;
 
+    elt_t bits = 0;
     for (unsigned i = 0; i < len (); i++)
-      if (~larger_page.v[i] & v[i])
-	return false;
-    return true;
+      bits |= ~larger_page.v[i] & v[i];
+    return !bits;
   }
 
   bool has_population () const { return population != UINT_MAX; }
   unsigned int get_population () const
   {
     if (has_population ()) return population;
-    population =
-    + hb_iter (v)
-    | hb_reduce ([] (unsigned pop, const elt_t &_) { return pop + hb_popcount (_); }, 0u)
-    ;
+    population = calc_population ();
     return population;
   }
 
+  unsigned int calc_population () const
+  {
+#if defined(__POPCNT__) || defined(__aarch64__) || defined(_M_ARM64)
+    /* Native population-count instruction available. */
+    unsigned pop = 0;
+    for (unsigned i = 0; i < len (); i++)
+      pop += hb_popcount (v[i]);
+    return pop;
+#else
+    /* Otherwise hb_popcount() is a libcall per word.  Count the whole
+     * page at once instead: per-byte counts of all words are summed
+     * (at most 64 per byte), then widened to 16-bit lanes and folded. */
+    static_assert (sizeof (elt_t) == 8, "");
+    uint64_t acc = 0;
+    for (unsigned i = 0; i < len (); i++)
+    {
+      uint64_t x = v[i];
+      x -= (x >> 1) & 0x5555555555555555ull;
+      x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+      acc += (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    }
+    acc = (acc & 0x00FF00FF00FF00FFull) + ((acc >> 8) & 0x00FF00FF00FF00FFull);
+    return (acc * 0x0001000100010001ull) >> 48;
+#endif
+  }
+
   bool next (hb_codepoint_t *codepoint) const
   {
     unsigned int m = (*codepoint + 1) & MASK;
@@ -301,6 +325,53 @@ struct hb_bit_page_t
     *codepoint = INVALID;
     return false;
   }
+  /* First bit at or after i that is not set, or PAGE_BITS if none. */
+  unsigned int get_next_zero (unsigned int i) const
+  {
+    unsigned int e = i / ELT_BITS;
+    elt_t x = ~v[e] & ~((elt_t (1) << (i & ELT_MASK)) - 1);
+    while (!x)
+    {
+      if (++e == len ()) return PAGE_BITS;
+      x = ~v[e];
+    }
+    return e * ELT_BITS + elt_get_min (x);
+  }
+  /* Last bit at or before i that is not set, or INVALID if none. */
+  unsigned int get_previous_zero (unsigned int i) const
+  {
+    unsigned int e = i / ELT_BITS;
+    unsigned int j = i & ELT_MASK;
+    const elt_t mask = j < ELT_BITS - 1 ? ((elt_t (1) << (j + 1)) - 1) : (elt_t) -1;
+    elt_t x = ~v[e] & mask;
+    while (!x)
+    {
+      if (!e) return INVALID;
+      x = ~v[--e];
+    }
+    return e * ELT_BITS + elt_get_max (x);
+  }
+  /* Adds the population of bits [a, b] to *pop, and the number of runs
+   * of consecutive set bits starting in them to *runs.  carry says
+   * whether the bit just before a is set, and is updated to bit b. */
+  void get_run_stats (unsigned a, unsigned b, bool *carry,
+		      unsigned *pop, unsigned *runs) const
+  {
+    elt_t c = *carry;
+    unsigned la = a / ELT_BITS, lb = b / ELT_BITS;
+    for (unsigned i = la; i <= lb; i++)
+    {
+      elt_t m = (elt_t) -1;
+      if (i == la) m &= ~(mask (a) - 1);
+      if (i == lb) m &= (mask (b) << 1) - 1;
+      elt_t x = v[i];
+      *pop += hb_popcount (x & m);
+      *runs += hb_popcount (x & ~((x << 1) | c) & m);
+      c = x >> ELT_MASK;
+    }
+    *carry = (v[lb] & mask (b)) != 0;
+  }
+
   hb_codepoint_t get_min () const
   {
     for (unsigned int i = 0; i < len (); i++)
@@ -313,7 +384,7 @@ struct hb_bit_page_t
     for (int i = len () - 1; i >= 0; i--)
       if (v[i])
 	return i * ELT_BITS + elt_get_max (v[i]);
-    return 0;
+    return INVALID;
   }
 
   static constexpr hb_codepoint_t INVALID = HB_SET_VALUE_INVALID;
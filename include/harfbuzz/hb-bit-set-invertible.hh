@@ -29,12 +29,12 @@
 #define HB_BIT_SET_INVERTIBLE_HH
 
 #include "hb.hh"
-#include "hb-bit-set.hh"
+#include "hb-bit-set-adaptive.hh"
 
 
 struct hb_bit_set_invertible_t
 {
-  hb_bit_set_t s;
+  hb_bit_set_adaptive_t s;
   bool inverted = false;
 
   hb_bit_set_invertible_t () = default;
@@ -44,7 +44,7 @@ struct hb_bit_set_invertible_t
   hb_bit_set_invertible_t& operator= (hb_bit_set_invertible_t&& other) { hb_swap (*this, other); return *this; }
   friend void swap (hb_bit_set_invertible_t &a, hb_bit_set_invertible_t &b)
   {
-    if (likely (!a.s.successful || !b.s.successful))
+    if (likely (a.s.in_error () || b.s.in_error ()))
       return;
     hb_swap (a.inverted, b.inverted);
     hb_swap (a.s, b.s);
@@ -65,12 +65,12 @@ struct hb_bit_set_invertible_t
   void clear ()
   {
     s.clear ();
-    if (likely (s.successful))
+    if (likely (!s.in_error ()))
       inverted = false;
   }
   void invert ()
   {
-    if (likely (s.successful))
+    if (likely (!s.in_error ()))
       inverted = !inverted;
   }
 
@@ -148,7 +148,7 @@ struct hb_bit_set_invertible_t
   void set (const hb_bit_set_invertible_t &other)
   {
     s.set (other.s);
-    if (likely (s.successful))
+    if (likely (!s.in_error ()))
       inverted = other.inverted;
   }
 
@@ -195,7 +195,7 @@ struct hb_bit_set_invertible_t
       else
 	process (hb_bitwise_lt, other);
     }
-    if (likely (s.successful))
+    if (likely (!s.in_error ()))
       inverted = inverted || other.inverted;
   }
   void intersect (const hb_bit_set_invertible_t &other)
@@ -214,7 +214,7 @@ struct hb_bit_set_invertible_t
       else
 	process (hb_bitwise_gt, other);
     }
-    if (likely (s.successful))
+    if (likely (!s.in_error ()))
       inverted = inverted && other.inverted;
   }
   void subtract (const hb_bit_set_invertible_t &other)
@@ -233,13 +233,13 @@ struct hb_bit_set_invertible_t
       else
 	process (hb_bitwise_and, other);
     }
-    if (likely (s.successful))
+    if (likely (!s.in_error ()))
       inverted = inverted && !other.inverted;
   }
   void symmetric_difference (const hb_bit_set_invertible_t &other)
   {
     process (hb_bitwise_xor, other);
-    if (likely (s.successful))
+    if (likely (!s.in_error ()))
       inverted = inverted ^ other.inverted;
   }
 
@@ -337,7 +337,7 @@ struct hb_bit_set_invertible_t
 		    : s.next_many (codepoint, out, size);
   }
 
-  static constexpr hb_codepoint_t INVALID = hb_bit_set_t::INVALID;
+  static constexpr hb_codepoint_t INVALID = hb_bit_set_adaptive_t::INVALID;
 
   /*
    * Iterator implementation.
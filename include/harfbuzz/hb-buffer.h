@@ -623,6 +623,8 @@ typedef enum { /*< flags >*/
  * hb_buffer_serialize_format_t:
  * @HB_BUFFER_SERIALIZE_FORMAT_TEXT: a human-readable, plain text format.
  * @HB_BUFFER_SERIALIZE_FORMAT_JSON: a machine-readable JSON format.
+ * @HB_BUFFER_SERIALIZE_FORMAT_BINARY: a compact, versioned binary format for
+ *   passing buffers between processes. Since: REPLACEME
  * @HB_BUFFER_SERIALIZE_FORMAT_INVALID: invalid format.
  *
  * The buffer serialization and de-serialization format used in
@@ -633,6 +635,7 @@ typedef enum { /*< flags >*/
 typedef enum {
   HB_BUFFER_SERIALIZE_FORMAT_TEXT	= HB_TAG('T','E','X','T'),
   HB_BUFFER_SERIALIZE_FORMAT_JSON	= HB_TAG('J','S','O','N'),
+  HB_BUFFER_SERIALIZE_FORMAT_BINARY	= HB_TAG('B','I','N','A'),
   HB_BUFFER_SERIALIZE_FORMAT_INVALID	= HB_TAG_NONE
 } hb_buffer_serialize_format_t;
 
@@ -794,6 +797,46 @@ hb_buffer_set_message_func (hb_buffer_t *buffer,
 			    void *user_data, hb_destroy_func_t destroy);
 
 
+/*
+ * Sampled verification
+ */
+
+/**
+ * hb_buffer_verify_func_t:
+ * @font: The #hb_font_t the text was shaped with
+ * @props: The #hb_segment_properties_t of the shaped text
+ * @text: The input text, serialized with hb_buffer_serialize_unicode()
+ * @features: The user features, serialized with hb_feature_to_string()
+ *   and separated by commas
+ * @glyphs: The shaping result, serialized with hb_buffer_serialize_glyphs()
+ * @message: What the verification found
+ * @user_data: User data pointer passed to hb_buffer_verify_set_sampling()
+ *
+ * A callback method called by hb_buffer_verify_run_pending() for every
+ * sampled shaping result that failed verification.  All strings are owned
+ * by HarfBuzz and only valid for the duration of the call.
+ *
+ * Since: REPLACEME
+ */
+typedef void (*hb_buffer_verify_func_t) (hb_font_t                     *font,
+					 const hb_segment_properties_t *props,
+					 const char                    *text,
+					 const char                    *features,
+					 const char                    *glyphs,
+					 const char                    *message,
+					 void                          *user_data);
+
+HB_EXTERN void
+hb_buffer_verify_set_sampling (unsigned int            rate,
+			       unsigned int            budget,
+			       hb_buffer_verify_func_t func,
+			       void                   *user_data,
+			       hb_destroy_func_t       destroy);
+
+HB_EXTERN unsigned int
+hb_buffer_verify_run_pending (unsigned int max_count);
+
+
 HB_END_DECLS
 
 #endif /* HB_BUFFER_H */
@@ -69,6 +69,10 @@ typedef unsigned __int64 uint64_t;
 #  include <stdint.h>
 #endif
 
+#ifndef __KERNEL__
+#  include <stddef.h>
+#endif
+
 #if defined(__GNUC__) && ((__GNUC__ > 3) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 1))
 #define HB_DEPRECATED __attribute__((__deprecated__))
 #elif defined(_MSC_VER) && (_MSC_VER >= 1300)
@@ -933,6 +937,30 @@ typedef struct hb_glyph_extents_t {
  */
 typedef struct hb_font_t hb_font_t;
 
+/**
+ * hb_allocator_t:
+ * @malloc_func: Replacement for malloc().
+ * @calloc_func: Replacement for calloc().
+ * @realloc_func: Replacement for realloc().
+ * @free_func: Replacement for free().
+ * @user_data: Passed to each of the functions above.
+ *
+ * A set of memory allocation functions for HarfBuzz to use instead of
+ * the C library ones.  See hb_allocator_set().
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_allocator_t {
+  void *(*malloc_func)  (size_t size, void *user_data);
+  void *(*calloc_func)  (size_t nmemb, size_t size, void *user_data);
+  void *(*realloc_func) (void *ptr, size_t size, void *user_data);
+  void  (*free_func)    (void *ptr, void *user_data);
+  void  *user_data;
+} hb_allocator_t;
+
+HB_EXTERN hb_bool_t
+hb_allocator_set (const hb_allocator_t *allocator);
+
 HB_END_DECLS
 
 #endif /* HB_COMMON_H */
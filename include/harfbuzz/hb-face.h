@@ -165,6 +165,131 @@ hb_face_collect_variation_unicodes (hb_face_t *face,
 				    hb_set_t  *out);
 
 
+/*
+ * Catalog information.
+ */
+
+/**
+ * hb_face_catalog_field_t:
+ * @HB_FACE_CATALOG_FIELD_NAMES: family, style, full and PostScript names.
+ * @HB_FACE_CATALOG_FIELD_STYLE: weight, width, italic, slant and optical
+ * size, as hb_style_get_value() returns them for the default instance.
+ * @HB_FACE_CATALOG_FIELD_UNICODE_RANGES: `OS/2` Unicode and code page ranges.
+ * @HB_FACE_CATALOG_FIELD_UNICODES: characters mapped by `cmap`.
+ * @HB_FACE_CATALOG_FIELD_VARIATIONS: variation axis and named instance counts.
+ * @HB_FACE_CATALOG_FIELD_COLOR: color glyph formats.
+ * @HB_FACE_CATALOG_FIELD_ALL: all of the above.
+ *
+ * Groups of #hb_face_catalog_info_t fields to fetch with
+ * hb_face_collect_catalog_info().
+ *
+ * Since: REPLACEME
+ */
+typedef enum { /*< flags >*/
+  HB_FACE_CATALOG_FIELD_NAMES		= 0x00000001u,
+  HB_FACE_CATALOG_FIELD_STYLE		= 0x00000002u,
+  HB_FACE_CATALOG_FIELD_UNICODE_RANGES	= 0x00000004u,
+  HB_FACE_CATALOG_FIELD_UNICODES	= 0x00000008u,
+  HB_FACE_CATALOG_FIELD_VARIATIONS	= 0x00000010u,
+  HB_FACE_CATALOG_FIELD_COLOR		= 0x00000020u,
+
+  HB_FACE_CATALOG_FIELD_ALL		= 0x0000003Fu
+} hb_face_catalog_field_t;
+
+/**
+ * hb_face_catalog_color_t:
+ * @HB_FACE_CATALOG_COLOR_NONE: no color glyphs.
+ * @HB_FACE_CATALOG_COLOR_LAYERS: `COLR` version 0 layered glyphs.
+ * @HB_FACE_CATALOG_COLOR_PAINT: `COLR` version 1 paint graphs.
+ * @HB_FACE_CATALOG_COLOR_PALETTES: `CPAL` color palettes.
+ * @HB_FACE_CATALOG_COLOR_SVG: `SVG ` glyph documents.
+ * @HB_FACE_CATALOG_COLOR_CBDT: `CBDT` bitmap glyphs.
+ * @HB_FACE_CATALOG_COLOR_SBIX: `sbix` bitmap glyphs.
+ *
+ * Color glyph formats present in a face.
+ *
+ * Since: REPLACEME
+ */
+typedef enum { /*< flags >*/
+  HB_FACE_CATALOG_COLOR_NONE		= 0x00000000u,
+  HB_FACE_CATALOG_COLOR_LAYERS		= 0x00000001u,
+  HB_FACE_CATALOG_COLOR_PAINT		= 0x00000002u,
+  HB_FACE_CATALOG_COLOR_PALETTES	= 0x00000004u,
+  HB_FACE_CATALOG_COLOR_SVG		= 0x00000008u,
+  HB_FACE_CATALOG_COLOR_CBDT		= 0x00000010u,
+  HB_FACE_CATALOG_COLOR_SBIX		= 0x00000020u
+} hb_face_catalog_color_t;
+
+/**
+ * hb_face_catalog_info_t:
+ * @family_name: typographic family name, or the font family name if there
+ * is none.  Owned by the face.
+ * @style_name: typographic subfamily name, or the font subfamily name if
+ * there is none.  Owned by the face.
+ * @full_name: full font name.  Owned by the face.
+ * @postscript_name: PostScript name.  Owned by the face.
+ * @weight: weight, see #HB_STYLE_TAG_WEIGHT.
+ * @width: width, see #HB_STYLE_TAG_WIDTH.
+ * @italic: italic, see #HB_STYLE_TAG_ITALIC.
+ * @slant_angle: slant angle, see #HB_STYLE_TAG_SLANT_ANGLE.
+ * @optical_size: optical size, see #HB_STYLE_TAG_OPTICAL_SIZE.
+ * @unicode_ranges: `OS/2` `ulUnicodeRange1` to `ulUnicodeRange4`.
+ * @code_page_ranges: `OS/2` `ulCodePageRange1` and `ulCodePageRange2`.
+ * @unicodes: set to add the characters mapped by `cmap` to; set by the
+ * caller, may be `NULL`.
+ * @axis_count: number of variation axes.
+ * @named_instance_count: number of named instances.
+ * @color: color glyph formats present.
+ *
+ * Metadata fetched by hb_face_collect_catalog_info().  Name strings are
+ * UTF-8, in English where available, and valid as long as the face is;
+ * missing names are `NULL`.  Builds that compile out the decoded name cache,
+ * such as those with `HB_MINIMIZE_MEMORY_USAGE`, have nowhere to keep the
+ * strings and leave all names `NULL`; use hb_ot_name_get_utf8() there.
+ *
+ * Since: REPLACEME
+ */
+typedef struct hb_face_catalog_info_t {
+  /* HB_FACE_CATALOG_FIELD_NAMES */
+  const char *family_name;
+  const char *style_name;
+  const char *full_name;
+  const char *postscript_name;
+
+  /* HB_FACE_CATALOG_FIELD_STYLE */
+  float weight;
+  float width;
+  float italic;
+  float slant_angle;
+  float optical_size;
+
+  /* HB_FACE_CATALOG_FIELD_UNICODE_RANGES */
+  uint32_t unicode_ranges[4];
+  uint32_t code_page_ranges[2];
+
+  /* HB_FACE_CATALOG_FIELD_UNICODES */
+  hb_set_t *unicodes;
+
+  /* HB_FACE_CATALOG_FIELD_VARIATIONS */
+  unsigned int axis_count;
+  unsigned int named_instance_count;
+
+  /* HB_FACE_CATALOG_FIELD_COLOR */
+  hb_face_catalog_color_t color;
+
+  /*< private >*/
+  hb_var_num_t reserved1;
+  hb_var_num_t reserved2;
+  hb_var_num_t reserved3;
+  hb_var_num_t reserved4;
+} hb_face_catalog_info_t;
+
+HB_EXTERN hb_face_catalog_field_t
+hb_face_collect_catalog_info (hb_face_t               *face,
+			      hb_face_catalog_field_t  fields,
+			      hb_face_catalog_info_t  *info /* IN/OUT */);
+
+
 /*
  * Builder face.
  */
@@ -139,6 +139,12 @@ hb_ft_hb_font_changed (hb_font_t *font);
 HB_EXTERN void
 hb_ft_font_set_funcs (hb_font_t *font);
 
+/* Gives the font per-thread FT_Face clones to spread FreeType calls
+ * across, instead of serializing them all on one FT_Face. */
+HB_EXTERN hb_bool_t
+hb_ft_font_set_face_clones (hb_font_t    *font,
+			    unsigned int  num_clones);
+
 
 HB_END_DECLS
 
@@ -159,23 +159,78 @@ struct hb_reference_count_t
 
 struct hb_user_data_array_t
 {
-  struct hb_user_data_item_t {
+  /* Lookups don't take the lock: the items live in a snapshot array that
+   * writers only ever append to, or replace with a bigger copy.  A slot,
+   * once published, keeps its key forever; removing an item just clears
+   * the slot for the key to be reused.  Replaced snapshots are kept around,
+   * since readers may still be looking at them, and freed in fini().
+   * Everything but the lookups happens under the lock. */
+
+  struct slot_t
+  {
     hb_user_data_key_t *key;
-    void *data;
+    hb_atomic_ptr_t<void> data;
     hb_destroy_func_t destroy;
+    bool present;
+  };
+
+  struct snapshot_t
+  {
+    snapshot_t *retired;
+    unsigned allocated;
+    hb_atomic_int_t length;
 
-    bool operator == (const hb_user_data_key_t *other_key) const { return key == other_key; }
-    bool operator == (const hb_user_data_item_t &other) const { return key == other.key; }
+    slot_t *slots () { return reinterpret_cast<slot_t *> (this + 1); }
 
-    void fini () { if (destroy) destroy (data); }
+    slot_t *lsearch (hb_user_data_key_t *key, unsigned count)
+    {
+      slot_t *array = slots ();
+      for (unsigned i = 0; i < count; i++)
+	if (array[i].key == key)
+	  return &array[i];
+      return nullptr;
+    }
   };
 
   hb_mutex_t lock;
-  hb_lockable_set_t<hb_user_data_item_t, hb_mutex_t> items;
+  hb_atomic_ptr_t<snapshot_t> snapshot;
 
-  void init () { lock.init (); items.init (); }
+  void init () { lock.init (); snapshot.init (); }
 
-  void fini () { items.fini (lock); lock.fini (); }
+  void fini ()
+  {
+    /* Destroy callbacks run unlocked, like in set (). */
+    while (snapshot.get_relaxed ())
+    {
+      lock.lock ();
+      snapshot_t *snap = snapshot.get_relaxed ();
+      slot_t *slot = nullptr;
+      for (unsigned i = snap->length.get_relaxed (); i; i--)
+	if (snap->slots ()[i - 1].present)
+	{
+	  slot = &snap->slots ()[i - 1];
+	  break;
+	}
+      if (!slot)
+      {
+	snapshot.set_relaxed (nullptr);
+	lock.unlock ();
+	while (snap)
+	{
+	  snapshot_t *retired = snap->retired;
+	  hb_free (snap);
+	  snap = retired;
+	}
+	break;
+      }
+      void *data = slot->data.get_relaxed ();
+      hb_destroy_func_t destroy = slot->destroy;
+      slot->present = false;
+      lock.unlock ();
+      if (destroy) destroy (data);
+    }
+    lock.fini ();
+  }
 
   bool set (hb_user_data_key_t *key,
 	    void *              data,
@@ -185,23 +240,89 @@ struct hb_user_data_array_t
     if (!key)
       return false;
 
-    if (replace) {
-      if (!data && !destroy) {
-	items.remove (key, lock);
-	return true;
+    lock.lock ();
+
+    snapshot_t *snap = snapshot.get_relaxed ();
+    unsigned length = snap ? snap->length.get_relaxed () : 0;
+    slot_t *slot = snap ? snap->lsearch (key, length) : nullptr;
+
+    if (slot && slot->present)
+    {
+      if (!replace)
+      {
+	lock.unlock ();
+	return false;
       }
+
+      void *old_data = slot->data.get_relaxed ();
+      hb_destroy_func_t old_destroy = slot->destroy;
+      /* Setting nothing removes the item. */
+      slot->present = data || destroy;
+      slot->destroy = destroy;
+      slot->data.set_release (data);
+      lock.unlock ();
+
+      if (old_destroy) old_destroy (old_data);
+      return true;
     }
-    hb_user_data_item_t item = {key, data, destroy};
-    bool ret = !!items.replace_or_insert (item, lock, (bool) replace);
 
-    return ret;
+    if (replace && !data && !destroy)
+    {
+      /* Nothing to remove. */
+      lock.unlock ();
+      return true;
+    }
+
+    if (!slot)
+    {
+      if (!snap || length == snap->allocated)
+      {
+	unsigned allocated = snap ? snap->allocated * 2 : 4;
+	snapshot_t *new_snap = (snapshot_t *) hb_calloc (1, sizeof (snapshot_t) + allocated * sizeof (slot_t));
+	if (unlikely (!new_snap))
+	{
+	  lock.unlock ();
+	  return false;
+	}
+	new_snap->retired = snap;
+	new_snap->allocated = allocated;
+	for (unsigned i = 0; i < length; i++)
+	{
+	  const slot_t &old_slot = snap->slots ()[i];
+	  slot_t &new_slot = new_snap->slots ()[i];
+	  new_slot.key = old_slot.key;
+	  new_slot.data.set_relaxed (old_slot.data.get_relaxed ());
+	  new_slot.destroy = old_slot.destroy;
+	  new_slot.present = old_slot.present;
+	}
+	new_snap->length.set_relaxed (length);
+	snapshot.set_release (new_snap);
+	snap = new_snap;
+      }
+      slot = &snap->slots ()[length];
+      slot->key = key;
+      slot->data.set_relaxed (data);
+      slot->destroy = destroy;
+      slot->present = true;
+      snap->length.set_release (length + 1);
+    }
+    else
+    {
+      slot->destroy = destroy;
+      slot->present = true;
+      slot->data.set_release (data);
+    }
+
+    lock.unlock ();
+    return true;
   }
 
   void *get (hb_user_data_key_t *key)
   {
-    hb_user_data_item_t item = {nullptr, nullptr, nullptr};
-
-    return items.find (key, &item, lock) ? item.data : nullptr;
+    snapshot_t *snap = snapshot.get_acquire ();
+    if (!snap) return nullptr;
+    slot_t *slot = snap->lsearch (key, snap->length.get_acquire ());
+    return slot ? slot->data.get_acquire () : nullptr;
   }
 };
 
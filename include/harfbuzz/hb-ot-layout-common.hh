@@ -1413,6 +1413,9 @@ struct Lookup
       if (!markFilteringSet.sanitize (c)) return_trace (false);
     }
 
+    /* Subtables are left to GSUBGPOS::accelerator_t::is_lookup_sane(). */
+    if (c->lazy_lookups) return_trace (true);
+
     if (unlikely (!get_subtables<TSubTable> ().sanitize (c, this, get_type ())))
       return_trace (false);
 
@@ -1574,7 +1577,7 @@ struct ClassDefFormat1_3
                const Coverage* glyph_filter = nullptr) const
   {
     TRACE_SUBSET (this);
-    const hb_map_t &glyph_map = c->plan->glyph_map_gsub;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_gsub_dense;
 
     hb_sorted_vector_t<hb_codepoint_pair_t> glyph_and_klass;
     hb_set_t orig_klasses;
@@ -1833,7 +1836,7 @@ struct ClassDefFormat2_4
                const Coverage* glyph_filter = nullptr) const
   {
     TRACE_SUBSET (this);
-    const hb_map_t &glyph_map = c->plan->glyph_map_gsub;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_gsub_dense;
     const hb_set_t &glyph_set = *c->plan->glyphset_gsub ();
 
     hb_sorted_vector_t<hb_codepoint_pair_t> glyph_and_klass;
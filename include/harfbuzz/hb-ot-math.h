@@ -327,6 +327,16 @@ hb_ot_math_get_glyph_assembly (hb_font_t *font,
 			       hb_ot_math_glyph_part_t *parts, /* OUT */
 			       hb_position_t *italics_correction /* OUT */);
 
+HB_EXTERN hb_bool_t
+hb_ot_math_get_glyph_construction (hb_font_t *font,
+				   hb_codepoint_t glyph,
+				   hb_direction_t direction,
+				   unsigned int *variants_count, /* IN/OUT */
+				   hb_ot_math_glyph_variant_t *variants, /* OUT */
+				   unsigned int *parts_count, /* IN/OUT */
+				   hb_ot_math_glyph_part_t *parts, /* OUT */
+				   hb_position_t *italics_correction, /* OUT */
+				   hb_position_t *min_connector_overlap /* OUT */);
 
 HB_END_DECLS
 
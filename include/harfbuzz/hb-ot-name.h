@@ -158,6 +158,35 @@ hb_ot_name_get_utf32 (hb_face_t       *face,
 		      unsigned int    *text_size /* IN/OUT */,
 		      uint32_t        *text      /* OUT */);
 
+/**
+ * hb_ot_name_collect_func_t:
+ * @face_index: index of the face in the collection
+ * @name_id: OpenType name identifier of @text
+ * @text: (array length=text_size): the name, in UTF-8 and NUL-terminated
+ * @text_size: length of @text, not including the NUL terminator
+ * @user_data: user data passed to hb_ot_name_collect_utf8()
+ *
+ * A callback for hb_ot_name_collect_utf8().  @text is only valid for
+ * the duration of the call.
+ *
+ * Return value: `true` to continue collecting, `false` to stop
+ *
+ * Since: REPLACEME
+ **/
+typedef hb_bool_t (*hb_ot_name_collect_func_t) (unsigned int     face_index,
+						hb_ot_name_id_t  name_id,
+						const char      *text,
+						unsigned int     text_size,
+						void            *user_data);
+
+HB_EXTERN unsigned int
+hb_ot_name_collect_utf8 (hb_blob_t                 *blob,
+			 const hb_ot_name_id_t     *name_ids,
+			 unsigned int               name_ids_count,
+			 hb_language_t              language,
+			 hb_ot_name_collect_func_t  func,
+			 void                      *user_data);
+
 
 HB_END_DECLS
 
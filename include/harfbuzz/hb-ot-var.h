@@ -185,6 +185,13 @@ hb_ot_var_normalize_coords (hb_face_t    *face,
 			    const float *design_coords, /* IN */
 			    int *normalized_coords /* OUT */);
 
+HB_EXTERN void
+hb_ot_var_normalize_coords_batch (hb_face_t    *face,
+				  unsigned int  coords_length,
+				  unsigned int  instance_count,
+				  const float  *design_coords, /* IN */
+				  int          *normalized_coords /* OUT */);
+
 
 HB_END_DECLS
 
@@ -104,4 +104,192 @@ struct hb_pool_t
 };
 
 
+/* Arena for short-lived allocations that die together.
+ *
+ * Blocks come off per-size-class free lists, carved out of a few large
+ * chunks, and free() puts them back on the list.  Every block starts with
+ * a header holding its size class, so free() and realloc() never look a
+ * pointer up.  Blocks too big for the largest size class get a chunk of
+ * their own.  All chunks are released in bulk when the arena is
+ * destroyed, along with anything still allocated from it.  Pointers
+ * passed to free() and realloc() must come from the same arena. */
+
+struct hb_arena_t
+{
+  hb_arena_t () = default;
+  hb_arena_t (const hb_arena_t &) = delete;
+  hb_arena_t& operator= (const hb_arena_t &) = delete;
+  ~hb_arena_t ()
+  {
+    free_chunks (chunks);
+    free_chunks (large_chunks);
+  }
+
+  void *alloc (size_t size)
+  {
+    if (unlikely (size > MAX_SIZE - HEADER_SIZE))
+      return alloc_large (size);
+
+    unsigned size_class = class_for (size + HEADER_SIZE);
+    block_t *block = free_lists[size_class];
+    if (block)
+      free_lists[size_class] = block->next;
+    else
+    {
+      block = (block_t *) bump (class_size (size_class));
+      if (unlikely (!block)) return nullptr;
+    }
+    block->size_class = size_class;
+    return (char *) block + HEADER_SIZE;
+  }
+
+  void *calloc (size_t nmemb, size_t size)
+  {
+    if (unlikely (size && nmemb > (size_t) -1 / size)) return nullptr;
+    void *p = alloc (nmemb * size);
+    if (likely (p)) hb_memset (p, 0, nmemb * size);
+    return p;
+  }
+
+  void *realloc (void *p, size_t size)
+  {
+    if (!p)
+      return alloc (size);
+    if (!size)
+    {
+      free (p);
+      return nullptr;
+    }
+
+    size_t old_size = usable_size (p);
+    if (size <= old_size)
+      return p;
+
+    void *new_p = alloc (size);
+    if (unlikely (!new_p)) return nullptr;
+    hb_memcpy (new_p, p, old_size);
+    free (p);
+    return new_p;
+  }
+
+  void free (void *p)
+  {
+    if (!p) return;
+    block_t *block = header (p);
+    unsigned size_class = block->size_class;
+    if (unlikely (size_class == LARGE_CLASS))
+    {
+      chunk_t *chunk = (chunk_t *) ((char *) block - DATA_OFFSET);
+      *chunk->prev = chunk->next;
+      if (chunk->next)
+	chunk->next->prev = chunk->prev;
+      ::hb_free (chunk); /* Not our free (). */
+      return;
+    }
+    block->next = free_lists[size_class];
+    free_lists[size_class] = block;
+  }
+
+  private:
+
+  static constexpr size_t HEADER_SIZE = alignof (std::max_align_t) < sizeof (void *) ?
+					sizeof (void *) : alignof (std::max_align_t);
+  static constexpr unsigned MIN_CLASS_BITS = 5;
+  static constexpr unsigned NUM_CLASSES = 12;
+  static constexpr unsigned LARGE_CLASS = NUM_CLASSES;
+  static constexpr size_t MAX_SIZE = (size_t) 1 << (MIN_CLASS_BITS + NUM_CLASSES - 1); /* 64kb */
+  static constexpr size_t MIN_CHUNK_SIZE = 1 << 14;
+  static constexpr size_t MAX_CHUNK_SIZE = 1 << 20;
+
+  static size_t class_size (unsigned size_class) { return (size_t) 1 << (MIN_CLASS_BITS + size_class); }
+  static unsigned class_for (size_t size)
+  {
+    unsigned size_class = 0;
+    while (class_size (size_class) < size)
+      size_class++;
+    return size_class;
+  }
+
+  struct block_t
+  {
+    union {
+      block_t *next;
+      unsigned size_class;
+    };
+  };
+
+  struct chunk_t
+  {
+    char *data () { return (char *) this + DATA_OFFSET; }
+
+    chunk_t *next;
+    chunk_t **prev; /* Only kept up to date for large chunks. */
+    size_t size;
+    size_t used;
+  };
+  static constexpr size_t DATA_OFFSET = (sizeof (chunk_t) + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+
+  static block_t *header (void *p) { return (block_t *) ((char *) p - HEADER_SIZE); }
+
+  static size_t usable_size (void *p)
+  {
+    block_t *block = header (p);
+    if (unlikely (block->size_class == LARGE_CLASS))
+      return ((chunk_t *) ((char *) block - DATA_OFFSET))->size - HEADER_SIZE;
+    return class_size (block->size_class) - HEADER_SIZE;
+  }
+
+  static void free_chunks (chunk_t *chunk)
+  {
+    while (chunk)
+    {
+      chunk_t *next = chunk->next;
+      ::hb_free (chunk);
+      chunk = next;
+    }
+  }
+
+  void *alloc_large (size_t size)
+  {
+    if (unlikely (size > (size_t) -1 - DATA_OFFSET - HEADER_SIZE)) return nullptr;
+    chunk_t *chunk = (chunk_t *) hb_malloc (DATA_OFFSET + HEADER_SIZE + size);
+    if (unlikely (!chunk)) return nullptr;
+    chunk->next = large_chunks;
+    chunk->prev = &large_chunks;
+    if (large_chunks)
+      large_chunks->prev = &chunk->next;
+    large_chunks = chunk;
+    chunk->size = chunk->used = HEADER_SIZE + size;
+
+    block_t *block = (block_t *) chunk->data ();
+    block->size_class = LARGE_CLASS;
+    return (char *) block + HEADER_SIZE;
+  }
+
+  void *bump (size_t size)
+  {
+    if (unlikely (!chunks || chunks->size - chunks->used < size))
+    {
+      /* Chunks grow geometrically up to 1mb.  Leftovers in the old chunk
+       * are dropped. */
+      size_t chunk_size = chunks ? hb_min (chunks->size * 2, (size_t) MAX_CHUNK_SIZE) : MIN_CHUNK_SIZE;
+      chunk_size = hb_max (chunk_size, size); /* Large size classes. */
+      chunk_t *chunk = (chunk_t *) hb_malloc (DATA_OFFSET + chunk_size);
+      if (unlikely (!chunk)) return nullptr;
+      chunk->next = chunks;
+      chunk->size = chunk_size;
+      chunk->used = 0;
+      chunks = chunk;
+    }
+    void *p = chunks->data () + chunks->used;
+    chunks->used += size;
+    return p;
+  }
+
+  chunk_t *chunks = nullptr;
+  chunk_t *large_chunks = nullptr;
+  block_t *free_lists[NUM_CLASSES] = {};
+};
+
+
 #endif /* HB_POOL_HH */
@@ -167,4 +167,162 @@ struct hb_priority_queue_t
   }
 };
 
+/*
+ * hb_indexed_priority_queue_t
+ *
+ * Priority queue of values in [0, num_values), each present at most once,
+ * implemented as a 4-ary heap.  Next to the heap it keeps the heap position
+ * of every value, which makes it possible to lower the priority of a value
+ * already in the queue instead of inserting it a second time.  The queue
+ * thus never holds more than num_values items.
+ *
+ * A 4-ary heap is shallower than a binary one; sifting down compares more
+ * children per level, but they sit next to each other in memory.
+ */
+struct hb_indexed_priority_queue_t
+{
+ private:
+  typedef hb_pair_t<int64_t, unsigned> item_t;
+  hb_vector_t<item_t> heap;
+  hb_vector_t<unsigned> positions;
+
+  static constexpr unsigned ARITY = 4;
+  static constexpr unsigned NOT_QUEUED = (unsigned) -1;
+
+ public:
+
+  /* Empties the queue and makes room for values up to num_values - 1. */
+  bool reset (unsigned num_values)
+  {
+    heap.resize (0);
+    if (unlikely (!heap.alloc (num_values, true) ||
+		  !positions.resize (num_values, false)))
+      return false;
+    hb_memset (positions.arrayZ, 0xFF, positions.get_size ());
+    return true;
+  }
+
+  bool in_error () const { return heap.in_error () || positions.in_error (); }
+
+  bool contains (unsigned value) const
+  { return value < positions.length && positions.arrayZ[value] != NOT_QUEUED; }
+
+  /* Inserts value, or lowers its priority if it is already queued with a
+   * higher one.  Returns whether the queue changed. */
+#ifndef HB_OPTIMIZE_SIZE
+  HB_ALWAYS_INLINE
+#endif
+  bool insert_or_decrease (int64_t priority, unsigned value)
+  {
+    assert (value < positions.length);
+    unsigned index = positions.arrayZ[value];
+    if (index == NOT_QUEUED)
+    {
+      heap.push (item_t (priority, value));
+      if (unlikely (heap.in_error ())) return false;
+      index = heap.length - 1;
+    }
+    else if (priority < heap.arrayZ[index].first)
+      heap.arrayZ[index].first = priority;
+    else
+      return false;
+
+    bubble_up (index);
+    return true;
+  }
+
+  void insert (int64_t priority, unsigned value)
+  {
+    assert (!contains (value));
+    insert_or_decrease (priority, value);
+  }
+
+#ifndef HB_OPTIMIZE_SIZE
+  HB_ALWAYS_INLINE
+#endif
+  item_t pop_minimum ()
+  {
+    assert (!is_empty ());
+
+    item_t result = heap.arrayZ[0];
+    positions.arrayZ[result.second] = NOT_QUEUED;
+
+    item_t last = heap.arrayZ[heap.length - 1];
+    heap.resize (heap.length - 1);
+
+    if (!is_empty ())
+      bubble_down (0, last);
+
+    return result;
+  }
+
+  const item_t& minimum () const
+  {
+    return heap[0];
+  }
+
+  bool is_empty () const { return heap.length == 0; }
+  explicit operator bool () const { return !is_empty (); }
+  unsigned int get_population () const { return heap.length; }
+
+ private:
+
+  static constexpr unsigned parent (unsigned index)
+  {
+    return (index - 1) / ARITY;
+  }
+
+  static constexpr unsigned first_child (unsigned index)
+  {
+    return ARITY * index + 1;
+  }
+
+  void place (unsigned index, const item_t &item)
+  {
+    heap.arrayZ[index] = item;
+    positions.arrayZ[item.second] = index;
+  }
+
+  /* Moves item down from the hole at index to where it belongs. */
+  HB_ALWAYS_INLINE
+  void bubble_down (unsigned index, item_t item)
+  {
+    unsigned length = heap.length;
+    while (true)
+    {
+      unsigned child = first_child (index);
+      if (child >= length) break;
+
+      unsigned end = hb_min (child + ARITY, length);
+      unsigned min_child = child;
+      for (unsigned i = child + 1; i < end; i++)
+	if (heap.arrayZ[i].first < heap.arrayZ[min_child].first)
+	  min_child = i;
+
+      if (item.first <= heap.arrayZ[min_child].first) break;
+
+      place (index, heap.arrayZ[min_child]);
+      index = min_child;
+    }
+    place (index, item);
+  }
+
+  HB_ALWAYS_INLINE
+  void bubble_up (unsigned index)
+  {
+    assert (index < heap.length);
+
+    item_t item = heap.arrayZ[index];
+    while (index)
+    {
+      unsigned parent_index = parent (index);
+      if (heap.arrayZ[parent_index].first <= item.first) break;
+
+      place (index, heap.arrayZ[parent_index]);
+      index = parent_index;
+    }
+    place (index, item);
+  }
+};
+
 #endif /* HB_PRIORITY_QUEUE_HH */
@@ -129,7 +129,8 @@ struct hb_sanitize_context_t :
 	blob (nullptr),
 	num_glyphs (65536),
 	num_glyphs_set (false),
-	lazy_some_gpos (false) {}
+	lazy_some_gpos (false),
+	lazy_lookups (false) {}
 
   const char *get_name () { return "SANITIZE"; }
   template <typename T, typename F>
@@ -506,6 +507,7 @@ struct hb_sanitize_context_t :
   bool  num_glyphs_set;
   public:
   bool lazy_some_gpos;
+  bool lazy_lookups;
 };
 
 struct hb_sanitize_with_object_t
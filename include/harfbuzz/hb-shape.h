@@ -69,6 +69,110 @@ HB_EXTERN const char **
 hb_shape_list_shapers (void);
 
 
+/**
+ * hb_feature_set_t:
+ *
+ * Data type for holding a list of features that is parsed and
+ * prepared once, then used for shaping any number of times.
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_feature_set_t hb_feature_set_t;
+
+HB_EXTERN hb_feature_set_t *
+hb_feature_set_create (const hb_feature_t *features,
+		       unsigned int        num_features);
+
+HB_EXTERN hb_feature_set_t *
+hb_feature_set_create_from_string (const char *str,
+				   int         len);
+
+HB_EXTERN hb_feature_set_t *
+hb_feature_set_get_empty (void);
+
+HB_EXTERN hb_feature_set_t *
+hb_feature_set_reference (hb_feature_set_t *feature_set);
+
+HB_EXTERN void
+hb_feature_set_destroy (hb_feature_set_t *feature_set);
+
+HB_EXTERN hb_bool_t
+hb_feature_set_set_user_data (hb_feature_set_t   *feature_set,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_feature_set_get_user_data (const hb_feature_set_t *feature_set,
+			      hb_user_data_key_t     *key);
+
+HB_EXTERN unsigned int
+hb_feature_set_get_features (const hb_feature_set_t *feature_set,
+			     unsigned int            start_offset,
+			     unsigned int           *feature_count, /* IN/OUT */
+			     hb_feature_t           *features /* OUT */);
+
+HB_EXTERN hb_bool_t
+hb_shape_with_feature_set (hb_font_t              *font,
+			   hb_buffer_t            *buffer,
+			   const hb_feature_set_t *feature_set,
+			   const char * const     *shaper_list);
+
+
+
+/**
+ * hb_shape_run_t:
+ * @font_index: index of the font the run was shaped with, in the font
+ *   list passed to hb_shape_itemized()
+ * @script: script the run was shaped with
+ * @direction: direction the run was shaped with
+ * @text_start: index of the first character of the run in the input buffer
+ * @text_end: index one past the last character of the run in the input buffer
+ * @glyph_start: index of the first glyph of the run in the output buffer
+ * @glyph_end: index one past the last glyph of the run in the output buffer
+ *
+ * Describes one run of text shaped by hb_shape_itemized().
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_shape_run_t {
+  unsigned int   font_index;
+  hb_script_t    script;
+  hb_direction_t direction;
+  unsigned int   text_start;
+  unsigned int   text_end;
+  unsigned int   glyph_start;
+  unsigned int   glyph_end;
+
+  /*< private >*/
+  hb_var_int_t   reserved1;
+  hb_var_int_t   reserved2;
+} hb_shape_run_t;
+
+/**
+ * hb_shape_run_func_t:
+ * @run: The run that was shaped
+ * @user_data: User data pointer passed to hb_shape_itemized()
+ *
+ * A callback method for hb_shape_itemized(), called once for every run
+ * after its glyphs have been added to the output buffer.
+ *
+ * Since: REPLACEME
+ **/
+typedef void (*hb_shape_run_func_t) (const hb_shape_run_t *run,
+				     void                 *user_data);
+
+HB_EXTERN hb_bool_t
+hb_shape_itemized (hb_font_t * const      *fonts,
+		   unsigned int            num_fonts,
+		   hb_buffer_t            *buffer,
+		   const hb_feature_set_t *feature_set,
+		   const char * const     *shaper_list,
+		   hb_shape_run_func_t     func,
+		   void                   *user_data);
+
+
 HB_END_DECLS
 
 #endif /* HB_SHAPE_H */
@@ -92,6 +92,9 @@ struct hb_subset_plan_t
   // Old -> New glyph id mapping
   hb_map_t *glyph_map; // Needs to be heap-allocated
   hb_map_t *reverse_glyph_map; // Needs to be heap-allocated
+  // Array-backed lookup views of the above; use these for per-glyph lookups.
+  hb_dense_map_t glyph_map_dense;
+  hb_dense_map_t reverse_glyph_map_dense;
 
   // Plan is only good for a specific source/dest so keep them with it
   hb_face_t *source;
@@ -202,7 +205,7 @@ struct hb_subset_plan_t
   inline bool new_gid_for_old_gid (hb_codepoint_t old_gid,
 				   hb_codepoint_t *new_gid) const
   {
-    hb_codepoint_t gid = glyph_map->get (old_gid);
+    hb_codepoint_t gid = glyph_map_dense.get (old_gid);
     if (gid == HB_MAP_VALUE_INVALID)
       return false;
 
@@ -213,7 +216,7 @@ struct hb_subset_plan_t
   inline bool old_gid_for_new_gid (hb_codepoint_t  new_gid,
 				   hb_codepoint_t *old_gid) const
   {
-    hb_codepoint_t gid = reverse_glyph_map->get (new_gid);
+    hb_codepoint_t gid = reverse_glyph_map_dense.get (new_gid);
     if (gid == HB_MAP_VALUE_INVALID)
       return false;
 
@@ -859,7 +859,7 @@ struct PaintGlyph
     auto *out = c->serializer->embed (this);
     if (unlikely (!out)) return_trace (false);
 
-    if (! c->serializer->check_assign (out->gid, c->plan->glyph_map->get (gid),
+    if (! c->serializer->check_assign (out->gid, c->plan->glyph_map_dense.get (gid),
                                        HB_SERIALIZE_ERROR_INT_OVERFLOW))
       return_trace (false);
 
@@ -901,7 +901,7 @@ struct PaintColrGlyph
     auto *out = c->serializer->embed (this);
     if (unlikely (!out)) return_trace (false);
 
-    return_trace (c->serializer->check_assign (out->gid, c->plan->glyph_map->get (gid),
+    return_trace (c->serializer->check_assign (out->gid, c->plan->glyph_map_dense.get (gid),
                                                HB_SERIALIZE_ERROR_INT_OVERFLOW));
   }
 
@@ -1679,7 +1679,7 @@ struct ClipList
     if (!c->serializer->check_assign (out->format, format, HB_SERIALIZE_ERROR_INT_OVERFLOW)) return_trace (false);
 
     const hb_set_t& glyphset = c->plan->_glyphset_colred;
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     hb_map_t new_gid_offset_map;
     hb_set_t new_gids;
@@ -1829,14 +1829,14 @@ struct BaseGlyphPaintRecord
   int cmp (hb_codepoint_t g) const
   { return g < glyphId ? -1 : g > glyphId ? 1 : 0; }
 
-  bool serialize (hb_serialize_context_t *s, const hb_map_t* glyph_map,
+  bool serialize (hb_serialize_context_t *s, const hb_dense_map_t& glyph_map,
                   const void* src_base, hb_subset_context_t *c,
                   const VarStoreInstancer &instancer) const
   {
     TRACE_SERIALIZE (this);
     auto *out = s->embed (this);
     if (unlikely (!out)) return_trace (false);
-    if (!s->check_assign (out->glyphId, glyph_map->get (glyphId),
+    if (!s->check_assign (out->glyphId, glyph_map.get (glyphId),
                           HB_SERIALIZE_ERROR_INT_OVERFLOW))
       return_trace (false);
 
@@ -1872,7 +1872,7 @@ struct BaseGlyphList : SortedArray32Of<BaseGlyphPaintRecord>
       unsigned gid = _.glyphId;
       if (!glyphset->has (gid)) continue;
 
-      if (_.serialize (c->serializer, c->plan->glyph_map, this, c, instancer)) out->len++;
+      if (_.serialize (c->serializer, c->plan->glyph_map_dense, this, c, instancer)) out->len++;
       else return_trace (false);
     }
 
@@ -2074,13 +2074,14 @@ struct COLR
       record->firstLayerIdx = numLayers;
       numLayers += record->numLayers;
     }
-    c->add_link (baseGlyphsZ, c->pop_pack ());
+    /* Per-glyph arrays never get shared; don't bother hashing them. */
+    c->add_link (baseGlyphsZ, c->pop_pack (false));
 
     c->push ();
     for (const hb_item_type<LayerIterator>& _ : + layer_it.iter ())
       _.as_array ().copy (c);
 
-    c->add_link (layersZ, c->pop_pack ());
+    c->add_link (layersZ, c->pop_pack (false));
 
     return_trace (true);
   }
@@ -2105,7 +2106,7 @@ struct COLR
   bool subset (hb_subset_context_t *c) const
   {
     TRACE_SUBSET (this);
-    const hb_map_t &reverse_glyph_map = *c->plan->reverse_glyph_map;
+    const hb_dense_map_t &reverse_glyph_map = c->plan->reverse_glyph_map_dense;
     const hb_set_t& glyphset = c->plan->_glyphset_colred;
 
     auto base_it =
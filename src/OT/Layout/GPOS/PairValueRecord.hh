@@ -29,11 +29,11 @@ struct PairValueRecord
 
   struct context_t
   {
-    const void          *base;
-    const ValueFormat   *valueFormats;
-    const ValueFormat   *newFormats;
-    unsigned            len1; /* valueFormats[0].get_len() */
-    const hb_map_t      *glyph_map;
+    const void           *base;
+    const ValueFormat    *valueFormats;
+    const ValueFormat    *newFormats;
+    unsigned             len1; /* valueFormats[0].get_len() */
+    const hb_dense_map_t *glyph_map;
     const hb_hashmap_t<unsigned, hb_pair_t<unsigned, int>> *layout_variation_idx_delta_map;
   };
 
@@ -165,7 +165,7 @@ struct Ligature
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     if (!intersects (&glyphset) || !glyphset.has (ligGlyph)) return_trace (false);
     // Ensure Coverage table is always packed after this.
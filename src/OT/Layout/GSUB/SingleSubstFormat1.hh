@@ -172,7 +172,7 @@ struct SingleSubstFormat1_3
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     hb_codepoint_t d = deltaGlyphID;
     hb_codepoint_t mask = get_mask ();
@@ -153,7 +153,7 @@ struct SingleSubstFormat2_4
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto it =
     + hb_zip (this+coverage, substitute)
@@ -138,7 +138,7 @@ struct CompositeGlyphRecord
     }
   }
 
-  bool get_points (contour_point_vector_t &points) const
+  bool get_points (component_point_vector_t &points) const
   {
     float matrix[4];
     contour_point_t trans;
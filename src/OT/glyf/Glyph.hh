@@ -310,9 +310,10 @@ struct Glyph
     if (!coords)
       coords = hb_array (font->coords, font->num_coords);
 
-    contour_point_vector_t stack_points;
-    contour_point_vector_t &points = type == SIMPLE ? all_points : stack_points;
-    unsigned old_length = points.length;
+    /* Simple glyphs load straight into all_points; composites collect
+     * one point per component here first. */
+    component_point_vector_t component_points;
+    unsigned old_length = all_points.length;
 
     switch (type) {
     case SIMPLE:
@@ -326,14 +327,14 @@ struct Glyph
     case COMPOSITE:
     {
       for (auto &item : get_composite_iterator ())
-        if (unlikely (!item.get_points (points))) return false;
+        if (unlikely (!item.get_points (component_points))) return false;
       break;
     }
 #ifndef HB_NO_VAR_COMPOSITES
     case VAR_COMPOSITE:
     {
       for (auto &item : get_var_composite_iterator ())
-        if (unlikely (!item.get_points (points))) return false;
+        if (unlikely (!item.get_points (component_points))) return false;
       break;
     }
 #endif
@@ -342,8 +343,18 @@ struct Glyph
     }
 
     /* Init phantom points */
-    if (unlikely (!points.resize (points.length + PHANTOM_COUNT))) return false;
-    hb_array_t<contour_point_t> phantoms = points.as_array ().sub_array (points.length - PHANTOM_COUNT, PHANTOM_COUNT);
+    hb_array_t<contour_point_t> points;
+    if (type == SIMPLE)
+    {
+      if (unlikely (!all_points.resize (all_points.length + PHANTOM_COUNT))) return false;
+      points = all_points.as_array ().sub_array (old_length);
+    }
+    else
+    {
+      if (unlikely (!component_points.resize (component_points.length + PHANTOM_COUNT))) return false;
+      points = component_points.as_array ();
+    }
+    hb_array_t<contour_point_t> phantoms = points.sub_array (points.length - PHANTOM_COUNT, PHANTOM_COUNT);
     {
       int lsb = 0;
       int h_delta = glyf_accelerator.hmtx->get_leading_bearing_without_var_unscaled (gid, &lsb) ?
@@ -374,7 +385,7 @@ struct Glyph
     if (coords)
       glyf_accelerator.gvar->apply_deltas_to_points (gid,
 						     coords,
-						     points.as_array ().sub_array (old_length),
+						     points,
 						     phantom_only && type == SIMPLE);
 #endif
 
@@ -382,8 +393,9 @@ struct Glyph
     // with child glyphs' points
     if (points_with_deltas != nullptr && depth == 0 && type == COMPOSITE)
     {
-      if (unlikely (!points_with_deltas->resize (points.length))) return false;
-      *points_with_deltas = points;
+      points_with_deltas->resize (0);
+      points_with_deltas->extend (points);
+      if (unlikely (points_with_deltas->in_error ())) return false;
     }
 
     switch (type) {
@@ -465,7 +477,7 @@ struct Glyph
 #ifndef HB_NO_VAR_COMPOSITES
     case VAR_COMPOSITE:
     {
-      hb_array_t<contour_point_t> points_left = points.as_array ();
+      hb_array_t<contour_point_t> points_left = points;
       for (auto &item : get_var_composite_iterator ())
       {
 	unsigned item_num_points = item.get_num_points ();
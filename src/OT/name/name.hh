@@ -510,15 +510,26 @@ struct name
 	this->names[j++] = this->names[i];
       }
       this->names.resize (j);
+
+#ifndef HB_NO_OT_NAME_CACHE
+      this->decoded = (hb_atomic_ptr_t<decoded_t> *) hb_calloc (this->names.length * NUM_ENCODINGS,
+								 sizeof (hb_atomic_ptr_t<decoded_t>));
+#endif
     }
     ~accelerator_t ()
     {
+#ifndef HB_NO_OT_NAME_CACHE
+      if (this->decoded)
+	for (unsigned int i = 0; i < this->names.length * NUM_ENCODINGS; i++)
+	  hb_free (this->decoded[i].get_relaxed ());
+      hb_free (this->decoded);
+#endif
       this->table.destroy ();
     }
 
-    int get_index (hb_ot_name_id_t  name_id,
-		   hb_language_t    language,
-		   unsigned int    *width=nullptr) const
+    /* Returns the position in names of the best entry, or -1. */
+    int get_entry (hb_ot_name_id_t  name_id,
+		   hb_language_t    language) const
     {
       const hb_ot_name_entry_t key = {name_id, {0}, language};
       const hb_ot_name_entry_t *entry = hb_bsearch (key, (const hb_ot_name_entry_t *) this->names,
@@ -539,12 +550,91 @@ struct name
       if (!entry)
 	return -1;
 
+      return entry - this->names.arrayZ;
+    }
+
+    /* 2 for UTF-16BE entries, 1 for ASCII ones. */
+    unsigned int get_entry_width (unsigned int entry) const
+    { return this->names[entry].entry_score < 10 ? 2 : 1; }
+
+    int get_index (hb_ot_name_id_t  name_id,
+		   hb_language_t    language,
+		   unsigned int    *width=nullptr) const
+    {
+      int entry = get_entry (name_id, language);
+      if (entry == -1)
+	return -1;
+
       if (width)
-	*width = entry->entry_score < 10 ? 2 : 1;
+	*width = get_entry_width (entry);
 
-      return entry->entry_index;
+      return this->names[entry].entry_index;
     }
 
+    template <typename utf_t>
+    unsigned int convert_entry (unsigned int entry,
+				unsigned int *text_size /* IN/OUT */,
+				typename utf_t::codepoint_t *text /* OUT */) const
+    {
+      hb_bytes_t bytes = get_name (this->names[entry].entry_index);
+      if (get_entry_width (entry) == 2)
+	return hb_ot_name_convert_utf<hb_utf16_be_t, utf_t> (bytes, text_size, text);
+      else
+	return hb_ot_name_convert_utf<hb_ascii_t, utf_t> (bytes, text_size, text);
+    }
+
+#ifndef HB_NO_OT_NAME_CACHE
+    /* A name string converted to one of UTF-8, UTF-16 or UTF-32, with
+     * NUL terminator. */
+    struct decoded_t
+    {
+      template <typename utf_t>
+      const typename utf_t::codepoint_t *text () const
+      { return (const typename utf_t::codepoint_t *) (this + 1); }
+
+      unsigned int length; /* In code units, without the terminator. */
+      /* Followed by length + 1 code units. */
+    };
+
+    /* Code units of the three output encodings are 1, 2 and 4 bytes. */
+    template <typename utf_t>
+    static unsigned int encoding_index ()
+    { return sizeof (typename utf_t::codepoint_t) / 2; }
+
+    /* Converts entry to utf_t on first use and keeps the result for the
+     * lifetime of the face.  Returns nullptr on allocation failure. */
+    template <typename utf_t>
+    const decoded_t *get_decoded (unsigned int entry) const
+    {
+      if (unlikely (!this->decoded))
+	return nullptr;
+
+      hb_atomic_ptr_t<decoded_t> &slot = this->decoded[entry * NUM_ENCODINGS + encoding_index<utf_t> ()];
+
+    retry:
+      decoded_t *d = slot.get_acquire ();
+      if (likely (d))
+	return d;
+
+      unsigned int length = convert_entry<utf_t> (entry, nullptr, nullptr);
+      d = (decoded_t *) hb_malloc (sizeof (decoded_t) +
+				   (length + 1) * sizeof (typename utf_t::codepoint_t));
+      if (unlikely (!d))
+	return nullptr;
+      d->length = length;
+      unsigned int size = length + 1;
+      convert_entry<utf_t> (entry, &size,
+			    const_cast<typename utf_t::codepoint_t *> (d->text<utf_t> ()));
+
+      if (unlikely (!slot.cmpexch (nullptr, d)))
+      {
+	hb_free (d);
+	goto retry;
+      }
+      return d;
+    }
+#endif
+
     hb_bytes_t get_name (unsigned int idx) const
     {
       const hb_array_t<const NameRecord> all_names (table->nameRecordZ.arrayZ, table->count);
@@ -556,6 +646,10 @@ struct name
     private:
     const char *pool;
     unsigned int pool_len;
+#ifndef HB_NO_OT_NAME_CACHE
+    static constexpr unsigned NUM_ENCODINGS = 3;
+    hb_atomic_ptr_t<decoded_t> *decoded;
+#endif
     public:
     hb_blob_ptr_t<name> table;
     hb_vector_t<hb_ot_name_entry_t> names;
@@ -107,30 +107,24 @@ struct Coverage : public OT::Layout::Common::Coverage
                              unsigned dest_obj,
                              unsigned max_size)
   {
-    char* buffer = (char*) hb_calloc (1, max_size);
+    char* buffer = c.graph.alloc_buffer (max_size);
+    if (!buffer) return false;
     hb_serialize_context_t serializer (buffer, max_size);
     OT::Layout::Common::Coverage_serialize (&serializer, glyphs);
     serializer.end_serialize ();
     if (serializer.in_error ())
     {
-      hb_free (buffer);
+      c.graph.free_buffer (buffer);
       return false;
     }
 
-    hb_bytes_t coverage_copy = serializer.copy_bytes ();
+    hb_bytes_t coverage_copy = c.graph.copy_bytes (serializer);
+    c.graph.free_buffer (buffer);
     if (!coverage_copy.arrayZ) return false;
-    // Give ownership to the context, it will cleanup the buffer.
-    if (!c.add_buffer ((char *) coverage_copy.arrayZ))
-    {
-      hb_free ((char *) coverage_copy.arrayZ);
-      return false;
-    }
 
     auto& obj = c.graph.vertices_[dest_obj].obj;
     obj.head = (char *) coverage_copy.arrayZ;
     obj.tail = obj.head + coverage_copy.length;
-
-    hb_free (buffer);
     return true;
   }
 
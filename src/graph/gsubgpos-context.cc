@@ -48,16 +48,10 @@ gsubgpos_graph_context_t::gsubgpos_graph_context_t (hb_tag_t table_tag_,
 
 unsigned gsubgpos_graph_context_t::create_node (unsigned size)
 {
-  char* buffer = (char*) hb_calloc (1, size);
+  char* buffer = graph.alloc_buffer (size);
   if (!buffer)
     return -1;
 
-  if (!add_buffer (buffer)) {
-    // Allocation did not get stored for freeing later.
-    hb_free (buffer);
-    return -1;
-  }
-
   return graph.new_node (buffer, buffer + size);
 }
 
@@ -47,11 +47,6 @@ struct gsubgpos_graph_context_t
 
   HB_INTERNAL unsigned create_node (unsigned size);
 
-  bool add_buffer (char* buffer)
-  {
-    return graph.add_buffer (buffer);
-  }
-
  private:
   HB_INTERNAL unsigned num_non_ext_subtables ();
 };
@@ -8,6 +8,7 @@
 #include "hb-common.cc"
 #include "hb-draw.cc"
 #include "hb-face-builder.cc"
+#include "hb-face-collection-index.cc"
 #include "hb-face.cc"
 #include "hb-fallback-shape.cc"
 #include "hb-font.cc"
@@ -60,3 +61,5 @@
 #include "hb-subset.cc"
 #include "hb-ucd.cc"
 #include "hb-unicode.cc"
+#include "hb-wasm-api.cc"
+#include "hb-wasm-shape.cc"
@@ -0,0 +1,779 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_BIT_SET_ADAPTIVE_HH
+#define HB_BIT_SET_ADAPTIVE_HH
+
+#include "hb.hh"
+#include "hb-bit-set.hh"
+
+
+/*
+ * hb_bit_set_adaptive_t
+ *
+ * Same interface as hb_bit_set_t.  Sets made of a few long runs, like
+ * Unicode blocks or unicode-range lists, are kept as a sorted list of
+ * disjoint, non-adjacent ranges; everything else lives in an
+ * hb_bit_set_t.  The representation switches automatically as the set
+ * changes: insertions that fragment a range list move it to bits, and
+ * bulk operations that leave a bit set with few runs move it back.
+ */
+
+struct hb_bit_set_adaptive_t
+{
+  hb_bit_set_adaptive_t () = default;
+  ~hb_bit_set_adaptive_t () = default;
+
+  hb_bit_set_adaptive_t (const hb_bit_set_adaptive_t& other) : hb_bit_set_adaptive_t () { set (other, true); }
+  hb_bit_set_adaptive_t ( hb_bit_set_adaptive_t&& other) : hb_bit_set_adaptive_t () { hb_swap (*this, other); }
+  hb_bit_set_adaptive_t& operator= (const hb_bit_set_adaptive_t& other) { set (other); return *this; }
+  hb_bit_set_adaptive_t& operator= (hb_bit_set_adaptive_t&& other) { hb_swap (*this, other); return *this; }
+  friend void swap (hb_bit_set_adaptive_t &a, hb_bit_set_adaptive_t &b)
+  {
+    if (unlikely (a.in_error () || b.in_error ()))
+      return;
+    hb_swap (a.use_bits, b.use_bits);
+    hb_swap (a.population, b.population);
+    hb_swap (a.runs, b.runs);
+    hb_swap (a.ranges, b.ranges);
+    hb_swap (a.bits, b.bits);
+  }
+
+  void init ()
+  {
+    successful = true;
+    use_bits = false;
+    population = 0;
+    runs = 0;
+    ranges.init ();
+    bits.init ();
+  }
+  void fini ()
+  {
+    ranges.fini ();
+    bits.fini ();
+  }
+
+  struct range_t
+  {
+    int cmp (hb_codepoint_t g) const
+    { return g < first ? -1 : g > last ? +1 : 0; }
+    bool operator != (const range_t &o) const
+    { return first != o.first || last != o.last; }
+
+    hb_codepoint_t first;
+    hb_codepoint_t last;
+  };
+
+  /* Stay on ranges while there are few of them, or while they are long
+   * on average; bits win for anything more fragmented than that. */
+  static constexpr unsigned MIN_RANGES = 32;
+  static constexpr unsigned MAX_RANGES = 4096;
+  static constexpr unsigned MIN_AVERAGE_RANGE = 32;
+  static bool ranges_pay_off (unsigned num_ranges, unsigned pop)
+  {
+    return num_ranges <= MIN_RANGES ||
+	   (num_ranges <= MAX_RANGES && pop / num_ranges >= MIN_AVERAGE_RANGE);
+  }
+
+  bool successful = true; /* Allocations successful */
+  bool use_bits = false;
+  /* On bits, population and runs are kept up to date by the edits that
+   * can do so cheaply, and runs is UINT_MAX once they are unknown. */
+  unsigned int population = 0;
+  unsigned int runs = 0; /* Only used on bits; ranges.length otherwise. */
+  hb_sorted_vector_t<range_t> ranges;
+  hb_bit_set_t bits;
+
+  void err () { if (successful) successful = false; }
+  bool in_error () const { return !successful || bits.in_error (); }
+
+  void alloc (unsigned sz) { if (use_bits) bits.alloc (sz); }
+
+  void reset ()
+  {
+    successful = true;
+    bits.reset ();
+    ranges.reset ();
+    clear ();
+  }
+
+  void clear ()
+  {
+    if (unlikely (in_error ())) return;
+    /* Keep the bit set's storage around for reuse. */
+    bits.clear ();
+    ranges.resize (0);
+    population = 0;
+    runs = 0;
+    use_bits = false;
+  }
+  bool is_empty () const { return use_bits ? bits.is_empty () : !ranges.length; }
+  explicit operator bool () const { return !is_empty (); }
+
+  uint32_t hash () const
+  {
+    if (use_bits) return bits.hash ();
+
+    /* Must match hb_bit_set_t::hash () for the same contents. */
+    uint32_t h = 0;
+    hb_bit_page_t page;
+    unsigned major = (unsigned) -1;
+    for (const range_t &r : ranges)
+    {
+      hb_codepoint_t a = r.first;
+      while (true)
+      {
+	unsigned m = a >> hb_bit_page_t::PAGE_BITS_LOG_2;
+	if (m != major)
+	{
+	  if (major != (unsigned) -1)
+	    h = h * 31 + hb_hash (major) + hb_hash (page);
+	  page.init0 ();
+	  major = m;
+	}
+	hb_codepoint_t page_last = a | hb_bit_page_t::PAGE_BITMASK;
+	page.add_range (a, hb_min (r.last, page_last));
+	if (r.last <= page_last) break;
+	a = page_last + 1;
+      }
+    }
+    if (major != (unsigned) -1)
+      h = h * 31 + hb_hash (major) + hb_hash (page);
+    return h;
+  }
+
+  void add (hb_codepoint_t g)
+  {
+    if (unlikely (!successful)) return;
+    if (unlikely (g == INVALID)) return;
+    if (use_bits)
+    {
+      if (has_run_stats () && !bits.get (g))
+      {
+	population++;
+	runs = runs + 1 - (g && bits.get (g - 1)) - bits.get (g + 1);
+      }
+      bits.add (g);
+      return;
+    }
+    add_range_ (g, g);
+  }
+  bool add_range (hb_codepoint_t a, hb_codepoint_t b)
+  {
+    if (unlikely (!successful)) return true; /* https://github.com/harfbuzz/harfbuzz/issues/657 */
+    if (unlikely (a > b || a == INVALID || b == INVALID)) return false;
+    if (use_bits)
+    {
+      bool ret = true;
+      update_run_stats (a, b, [&] () { ret = bits.add_range (a, b); });
+      if (b - a >= hb_bit_page_t::PAGE_BITS)
+	maybe_switch_to_ranges ();
+      return ret;
+    }
+    add_range_ (a, b);
+    return true;
+  }
+
+  template <typename T>
+  void set_array (bool v, const T *array, unsigned int count, unsigned int stride=sizeof(T))
+  {
+    if (unlikely (!successful)) return;
+    /* Feed runs of consecutive values to the range list for as long as
+     * it stays on ranges; hand the rest to the bit set. */
+    while (count && !use_bits)
+    {
+      hb_codepoint_t a = *array, b = a;
+      do
+      {
+	array = &hb_bit_set_t::StructAtOffsetUnaligned<T> (array, stride);
+	count--;
+      }
+      while (count && b + 1 == (hb_codepoint_t) *array && (b++, true));
+      if (unlikely (a == INVALID)) continue;
+      b = hb_min (b, INVALID - 1);
+      if (v) add_range_ (a, b); else del_range_ (a, b);
+      if (unlikely (!successful)) return;
+    }
+    if (count)
+    {
+      runs = UINT_MAX;
+      bits.set_array (v, array, count, stride);
+    }
+  }
+
+  template <typename T>
+  void add_array (const T *array, unsigned int count, unsigned int stride=sizeof(T))
+  { set_array (true, array, count, stride); }
+  template <typename T>
+  void add_array (const hb_array_t<const T>& arr) { add_array (&arr, arr.len ()); }
+
+  template <typename T>
+  void del_array (const T *array, unsigned int count, unsigned int stride=sizeof(T))
+  { set_array (false, array, count, stride); }
+  template <typename T>
+  void del_array (const hb_array_t<const T>& arr) { del_array (&arr, arr.len ()); }
+
+  /* Might return false if array looks unsorted.
+   * Used for faster rejection of corrupt data. */
+  template <typename T>
+  bool set_sorted_array (bool v, const T *array, unsigned int count, unsigned int stride=sizeof(T))
+  {
+    if (unlikely (!successful)) return true; /* https://github.com/harfbuzz/harfbuzz/issues/657 */
+    hb_codepoint_t last_g = count ? (hb_codepoint_t) *array : 0;
+    while (count && !use_bits)
+    {
+      hb_codepoint_t a = *array, b = a;
+      if (a < last_g) return false;
+      do
+      {
+	array = &hb_bit_set_t::StructAtOffsetUnaligned<T> (array, stride);
+	count--;
+      }
+      while (count && b + 1 == (hb_codepoint_t) *array && (b++, true));
+      last_g = b;
+      if (unlikely (a == INVALID)) continue;
+      b = hb_min (b, INVALID - 1);
+      if (v) add_range_ (a, b); else del_range_ (a, b);
+      if (unlikely (!successful)) return true;
+    }
+    if (count)
+    {
+      if (unlikely ((hb_codepoint_t) *array < last_g)) return false;
+      runs = UINT_MAX;
+      return bits.set_sorted_array (v, array, count, stride);
+    }
+    return true;
+  }
+
+  template <typename T>
+  bool add_sorted_array (const T *array, unsigned int count, unsigned int stride=sizeof(T))
+  { return set_sorted_array (true, array, count, stride); }
+  template <typename T>
+  bool add_sorted_array (const hb_sorted_array_t<const T>& arr) { return add_sorted_array (&arr, arr.len ()); }
+
+  template <typename T>
+  bool del_sorted_array (const T *array, unsigned int count, unsigned int stride=sizeof(T))
+  { return set_sorted_array (false, array, count, stride); }
+  template <typename T>
+  bool del_sorted_array (const hb_sorted_array_t<const T>& arr) { return del_sorted_array (&arr, arr.len ()); }
+
+  void del (hb_codepoint_t g)
+  {
+    if (unlikely (!successful)) return;
+    if (use_bits)
+    {
+      if (has_run_stats () && bits.get (g))
+      {
+	population--;
+	runs = runs - 1 + (g && bits.get (g - 1)) + bits.get (g + 1);
+      }
+      bits.del (g);
+      return;
+    }
+    if (unlikely (g == INVALID)) return;
+    del_range_ (g, g);
+  }
+  void del_range (hb_codepoint_t a, hb_codepoint_t b)
+  {
+    if (unlikely (!successful)) return;
+    if (unlikely (a > b || a == INVALID)) return;
+    if (use_bits)
+    {
+      update_run_stats (a, b, [&] () { bits.del_range (a, b); });
+      if (b - a >= hb_bit_page_t::PAGE_BITS)
+	maybe_switch_to_ranges ();
+      return;
+    }
+    del_range_ (a, b);
+  }
+
+  bool get (hb_codepoint_t g) const
+  {
+    if (use_bits) return bits.get (g);
+    return ranges.bfind (g);
+  }
+
+  /* Has interface. */
+  bool operator [] (hb_codepoint_t k) const { return get (k); }
+  bool has (hb_codepoint_t k) const { return (*this)[k]; }
+  /* Predicate. */
+  bool operator () (hb_codepoint_t k) const { return has (k); }
+
+  /* Sink interface. */
+  hb_bit_set_adaptive_t& operator << (hb_codepoint_t v)
+  { add (v); return *this; }
+  hb_bit_set_adaptive_t& operator << (const hb_codepoint_pair_t& range)
+  { add_range (range.first, range.second); return *this; }
+
+  bool intersects (hb_codepoint_t first, hb_codepoint_t last) const
+  {
+    hb_codepoint_t c = first - 1;
+    return next (&c) && c <= last;
+  }
+  void set (const hb_bit_set_adaptive_t &other, bool exact_size = false)
+  {
+    if (unlikely (!successful)) return;
+    if (other.use_bits)
+    {
+      bits.set (other.bits, exact_size);
+      if (unlikely (bits.in_error ())) return;
+      ranges.resize (0);
+      population = other.population;
+      runs = other.runs;
+    }
+    else
+    {
+      if (unlikely (!ranges.resize (other.ranges.length, false, exact_size)))
+      {
+	err ();
+	return;
+      }
+      hb_memcpy (ranges.arrayZ, other.ranges.arrayZ, ranges.get_size ());
+      population = other.population;
+      bits.clear ();
+    }
+    use_bits = other.use_bits;
+  }
+
+  bool is_equal (const hb_bit_set_adaptive_t &other) const
+  {
+    if (use_bits && other.use_bits)
+      return bits.is_equal (other.bits);
+    if (!use_bits && !other.use_bits)
+      return ranges.as_array () == other.ranges.as_array ();
+
+    if (get_population () != other.get_population ())
+      return false;
+    hb_codepoint_t a1 = INVALID, b1 = INVALID;
+    hb_codepoint_t a2 = INVALID, b2 = INVALID;
+    while (next_range (&a1, &b1))
+    {
+      if (!other.next_range (&a2, &b2) || a1 != a2 || b1 != b2)
+	return false;
+    }
+    return !other.next_range (&a2, &b2);
+  }
+
+  bool is_subset (const hb_bit_set_adaptive_t &larger_set) const
+  {
+    if (use_bits && larger_set.use_bits)
+      return bits.is_subset (larger_set.bits);
+
+    if (get_population () > larger_set.get_population ())
+      return false;
+    hb_codepoint_t a = INVALID, b = INVALID;
+    while (next_range (&a, &b))
+    {
+      /* The larger set's run starting at or after a must cover [a, b]. */
+      hb_codepoint_t la = a - 1, lb = a - 1;
+      if (!larger_set.next_range (&la, &lb) || la != a || lb < b)
+	return false;
+    }
+    return true;
+  }
+
+  template <typename Op>
+  void process (const Op& op, const hb_bit_set_adaptive_t &other)
+  {
+    if (unlikely (!successful)) return;
+
+    if (!use_bits && !other.use_bits)
+    {
+      process_ranges (op, other);
+      return;
+    }
+
+    if (!use_bits && unlikely (!switch_to_bits ())) return;
+    if (other.use_bits)
+      bits.process (op, other.bits);
+    else
+    {
+      hb_bit_set_t other_bits;
+      for (const range_t &r : other.ranges)
+	other_bits.add_range (r.first, r.last);
+      if (unlikely (other_bits.in_error ()))
+      {
+	err ();
+	return;
+      }
+      bits.process (op, other_bits);
+    }
+    runs = UINT_MAX;
+    maybe_switch_to_ranges ();
+  }
+
+  bool next (hb_codepoint_t *codepoint) const
+  {
+    if (use_bits) return bits.next (codepoint);
+
+    if (unlikely (*codepoint == INVALID))
+    {
+      *codepoint = get_min ();
+      return *codepoint != INVALID;
+    }
+
+    hb_codepoint_t g = *codepoint + 1;
+    unsigned i = 0;
+    if (unlikely (g == INVALID) ||
+	(!ranges.bfind (g, &i, HB_NOT_FOUND_STORE_CLOSEST) && i >= ranges.length))
+    {
+      *codepoint = INVALID;
+      return false;
+    }
+    *codepoint = hb_max (g, ranges.arrayZ[i].first);
+    return true;
+  }
+  bool previous (hb_codepoint_t *codepoint) const
+  {
+    if (use_bits) return bits.previous (codepoint);
+
+    if (unlikely (*codepoint == INVALID))
+    {
+      *codepoint = get_max ();
+      return *codepoint != INVALID;
+    }
+
+    unsigned i = 0;
+    if (unlikely (!*codepoint) ||
+	(!ranges.bfind (*codepoint - 1, &i, HB_NOT_FOUND_STORE_CLOSEST) && !i--))
+    {
+      *codepoint = INVALID;
+      return false;
+    }
+    *codepoint = hb_min (*codepoint - 1, ranges.arrayZ[i].last);
+    return true;
+  }
+  bool next_range (hb_codepoint_t *first, hb_codepoint_t *last) const
+  {
+    if (use_bits) return bits.next_range (first, last);
+
+    hb_codepoint_t i = *last;
+    if (!next (&i))
+    {
+      *last = *first = INVALID;
+      return false;
+    }
+    unsigned r = 0;
+    ranges.bfind (i, &r);
+    *first = i;
+    *last = ranges.arrayZ[r].last;
+    return true;
+  }
+  bool previous_range (hb_codepoint_t *first, hb_codepoint_t *last) const
+  {
+    if (use_bits) return bits.previous_range (first, last);
+
+    hb_codepoint_t i = *first;
+    if (!previous (&i))
+    {
+      *last = *first = INVALID;
+      return false;
+    }
+    unsigned r = 0;
+    ranges.bfind (i, &r);
+    *first = ranges.arrayZ[r].first;
+    *last = i;
+    return true;
+  }
+
+  unsigned int next_many (hb_codepoint_t  codepoint,
+			  hb_codepoint_t *out,
+			  unsigned int    size) const
+  {
+    if (use_bits) return bits.next_many (codepoint, out, size);
+
+    unsigned int initial_size = size;
+    hb_codepoint_t g = codepoint;
+    while (size && next (&g))
+    {
+      unsigned r = 0;
+      ranges.bfind (g, &r);
+      hb_codepoint_t last = ranges.arrayZ[r].last;
+      while (size)
+      {
+	*out++ = g;
+	size--;
+	if (g == last) break;
+	g++;
+      }
+    }
+    return initial_size - size;
+  }
+
+  unsigned int next_many_inverted (hb_codepoint_t  codepoint,
+				   hb_codepoint_t *out,
+				   unsigned int    size) const
+  {
+    if (use_bits) return bits.next_many_inverted (codepoint, out, size);
+
+    unsigned int initial_size = size;
+    hb_codepoint_t g = codepoint + 1;
+    unsigned r = 0;
+    ranges.bfind (g, &r, HB_NOT_FOUND_STORE_CLOSEST);
+    for (; g != INVALID && size; r++)
+    {
+      /* Emit the gap up to the next range, then jump over it. */
+      hb_codepoint_t end = r < ranges.length ? ranges.arrayZ[r].first : INVALID;
+      for (; g < end && size; g++, size--)
+	*out++ = g;
+      if (r >= ranges.length || !size) break;
+      g = ranges.arrayZ[r].last + 1;
+    }
+    return initial_size - size;
+  }
+
+  unsigned int get_population () const
+  { return use_bits && !has_run_stats () ? bits.get_population () : population; }
+  hb_codepoint_t get_min () const
+  {
+    if (use_bits) return bits.get_min ();
+    return ranges.length ? ranges.arrayZ[0].first : INVALID;
+  }
+  hb_codepoint_t get_max () const
+  {
+    if (use_bits) return bits.get_max ();
+    return ranges.length ? ranges.tail ().last : INVALID;
+  }
+
+  static constexpr hb_codepoint_t INVALID = hb_bit_set_t::INVALID;
+
+  /*
+   * Iterator implementation.
+   */
+  struct iter_t : hb_iter_with_fallback_t<iter_t, hb_codepoint_t>
+  {
+    static constexpr bool is_sorted_iterator = true;
+    static constexpr bool has_fast_len = true;
+    iter_t (const hb_bit_set_adaptive_t &s_ = Null (hb_bit_set_adaptive_t),
+	    bool init = true) : s (&s_), v (INVALID), l(0)
+    {
+      if (init)
+      {
+	l = s->get_population () + 1;
+	__next__ ();
+      }
+    }
+
+    typedef hb_codepoint_t __item_t__;
+    hb_codepoint_t __item__ () const { return v; }
+    bool __more__ () const { return v != INVALID; }
+    void __next__ () { s->next (&v); if (l) l--; }
+    void __prev__ () { s->previous (&v); }
+    unsigned __len__ () const { return l; }
+    iter_t end () const { return iter_t (*s, false); }
+    bool operator != (const iter_t& o) const
+    { return s != o.s || v != o.v; }
+
+    protected:
+    const hb_bit_set_adaptive_t *s;
+    hb_codepoint_t v;
+    unsigned l;
+  };
+  iter_t iter () const { return iter_t (*this); }
+  operator iter_t () const { return iter (); }
+
+  protected:
+
+  /* Replaces ranges[start, end) with the n ranges in rs. */
+  bool splice (unsigned start, unsigned end, const range_t *rs, unsigned n)
+  {
+    unsigned old_length = ranges.length;
+    unsigned new_length = old_length - (end - start) + n;
+    if (new_length > old_length &&
+	unlikely (!ranges.resize (new_length, false)))
+    {
+      err ();
+      return false;
+    }
+    memmove (ranges.arrayZ + start + n,
+	     ranges.arrayZ + end,
+	     (old_length - end) * ranges.item_size);
+    hb_memcpy (ranges.arrayZ + start, rs, n * ranges.item_size);
+    if (new_length < old_length)
+      ranges.resize (new_length);
+    return true;
+  }
+
+  void add_range_ (hb_codepoint_t a, hb_codepoint_t b)
+  {
+    /* Merge with every range overlapping or adjacent to [a, b]. */
+    unsigned start = 0, end = 0;
+    ranges.bfind (a ? a - 1 : a, &start, HB_NOT_FOUND_STORE_CLOSEST);
+    ranges.bfind (b + 1, &end, HB_NOT_FOUND_STORE_CLOSEST);
+    if (end < ranges.length && ranges.arrayZ[end].first <= b + 1)
+      end++;
+
+    range_t merged = {a, b};
+    unsigned removed = 0;
+    for (unsigned i = start; i < end; i++)
+    {
+      const range_t &r = ranges.arrayZ[i];
+      merged.first = hb_min (merged.first, r.first);
+      merged.last = hb_max (merged.last, r.last);
+      removed += r.last - r.first + 1;
+    }
+    if (unlikely (!splice (start, end, &merged, 1))) return;
+    population += (merged.last - merged.first + 1) - removed;
+
+    if (unlikely (!ranges_pay_off (ranges.length, population)))
+      switch_to_bits ();
+  }
+
+  void del_range_ (hb_codepoint_t a, hb_codepoint_t b)
+  {
+    unsigned start = 0, end = 0;
+    ranges.bfind (a, &start, HB_NOT_FOUND_STORE_CLOSEST);
+    if (!ranges.bfind (b, &end, HB_NOT_FOUND_STORE_CLOSEST))
+      ;
+    else
+      end++;
+    if (start >= end) return;
+
+    /* Keep the parts of the end ranges sticking out of [a, b]. */
+    range_t kept[2];
+    unsigned n = 0;
+    unsigned removed = 0;
+    for (unsigned i = start; i < end; i++)
+    {
+      const range_t &r = ranges.arrayZ[i];
+      removed += r.last - r.first + 1;
+    }
+    if (ranges.arrayZ[start].first < a)
+      kept[n++] = {ranges.arrayZ[start].first, a - 1};
+    if (ranges.arrayZ[end - 1].last > b)
+      kept[n++] = {b + 1, ranges.arrayZ[end - 1].last};
+    for (unsigned i = 0; i < n; i++)
+      removed -= kept[i].last - kept[i].first + 1;
+
+    if (unlikely (!splice (start, end, kept, n))) return;
+    population -= removed;
+
+    if (unlikely (!ranges_pay_off (ranges.length, population)))
+      switch_to_bits ();
+  }
+
+  template <typename Op>
+  void process_ranges (const Op& op, const hb_bit_set_adaptive_t &other)
+  {
+    /* Sweep over the boundaries of both range lists; within each
+     * segment membership in either set is constant. */
+    hb_sorted_vector_t<range_t> out;
+    unsigned pop = 0;
+    const range_t *ra = ranges.arrayZ, *rb = other.ranges.arrayZ;
+    unsigned na = ranges.length, nb = other.ranges.length;
+    unsigned i = 0, j = 0;
+    hb_codepoint_t pos = 0;
+    while (true)
+    {
+      bool in_a = i < na && ra[i].first <= pos;
+      bool in_b = j < nb && rb[j].first <= pos;
+      hb_codepoint_t end_a = i < na ? (in_a ? ra[i].last + 1 : ra[i].first) : INVALID;
+      hb_codepoint_t end_b = j < nb ? (in_b ? rb[j].last + 1 : rb[j].first) : INVALID;
+      hb_codepoint_t end = hb_min (end_a, end_b);
+
+      if (op ((unsigned) in_a, (unsigned) in_b) & 1)
+      {
+	if (out.length && out.tail ().last + 1 == pos)
+	  out.tail ().last = end - 1;
+	else
+	  out.push (range_t {pos, end - 1});
+	pop += end - pos;
+      }
+
+      if (end == INVALID) break;
+      pos = end;
+      if (in_a && pos == end_a) i++;
+      if (in_b && pos == end_b) j++;
+    }
+    if (unlikely (out.in_error ()))
+    {
+      err ();
+      return;
+    }
+
+    hb_swap (ranges, out);
+    population = pop;
+
+    if (unlikely (!ranges_pay_off (ranges.length, population)))
+      switch_to_bits ();
+  }
+
+  bool has_run_stats () const { return runs != UINT_MAX; }
+
+  /* Applies edit, which only touches [a, b], and updates population and
+   * runs from the difference it made there.  Runs can only start or stop
+   * being counted at a through b + 1, so only the pages of the range are
+   * visited rather than the whole set. */
+  template <typename Edit>
+  void update_run_stats (hb_codepoint_t a, hb_codepoint_t b, const Edit &edit)
+  {
+    if (!has_run_stats ())
+    {
+      edit ();
+      return;
+    }
+    hb_codepoint_t end = hb_min (b, INVALID - 2) + 1;
+    unsigned old_pop, old_runs, new_pop, new_runs;
+    bits.get_run_stats (a, end, &old_pop, &old_runs);
+    edit ();
+    bits.get_run_stats (a, end, &new_pop, &new_runs);
+    population = population - old_pop + new_pop;
+    runs = runs - old_runs + new_runs;
+  }
+
+  bool switch_to_bits ()
+  {
+    bits.clear ();
+    for (const range_t &r : ranges)
+      bits.add_range (r.first, r.last);
+    if (unlikely (bits.in_error ())) return false;
+    runs = ranges.length;
+    ranges.resize (0);
+    use_bits = true;
+    return true;
+  }
+
+  void maybe_switch_to_ranges ()
+  {
+    if (unlikely (bits.in_error ())) return;
+    /* Only recount after edits that could not keep the counts. */
+    if (!has_run_stats ())
+      bits.get_run_stats (0, INVALID - 1, &population, &runs);
+    /* Require twice the payoff to switch back, to avoid flip-flopping. */
+    if (runs > MAX_RANGES / 2 || !ranges_pay_off (runs * 2, population))
+      return;
+
+    ranges.resize (0);
+    if (unlikely (!ranges.alloc (runs, true))) { ranges.reset (); return; }
+    hb_codepoint_t a = INVALID, b = INVALID;
+    while (bits.next_range (&a, &b))
+      ranges.push (range_t {a, b});
+    bits.clear ();
+    use_bits = false;
+  }
+};
+
+
+#endif /* HB_BIT_SET_ADAPTIVE_HH */
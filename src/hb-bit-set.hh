@@ -252,7 +252,7 @@ struct hb_bit_set_t
 	last_g = g;
 
         if (g != INVALID && (v || page)) /* The v check is to optimize out the page check if v is true. */
-	  page->add (g);
+	  page->set (g, v);
 
 	array = &StructAtOffsetUnaligned<T> (array, stride);
 	count--;
@@ -409,24 +409,33 @@ struct hb_bit_set_t
 	population > larger_set.population)
       return false;
 
-    uint32_t spi = 0;
-    for (uint32_t lpi = 0; spi < page_map.length && lpi < larger_set.page_map.length; lpi++)
+    uint32_t spi = 0, lpi = 0;
+    while (spi < page_map.length && lpi < larger_set.page_map.length)
     {
       uint32_t spm = page_map[spi].major;
       uint32_t lpm = larger_set.page_map[lpi].major;
       auto sp = page_at (spi);
 
-      if (spm < lpm && !sp.is_empty ())
-        return false;
+      if (spm < lpm)
+      {
+        if (!sp.is_empty ())
+          return false;
+        spi++;
+        continue;
+      }
 
       if (lpm < spm)
+      {
+        lpi++;
         continue;
+      }
 
       auto lp = larger_set.page_at (lpi);
       if (!sp.is_subset (lp))
         return false;
 
       spi++;
+      lpi++;
     }
 
     while (spi < page_map.length)
@@ -708,12 +717,27 @@ struct hb_bit_set_t
       return false;
     }
 
-    /* TODO Speed up. */
-    *last = *first = i;
-    while (next (&i) && i == *last + 1)
-      (*last)++;
-
-    return true;
+    /* Extend the run a word at a time, then over consecutive full pages. */
+    *first = i;
+    unsigned int major = get_major (i);
+    unsigned int m = 0;
+    page_map.bfind (major, &m);
+    for (;;)
+    {
+      unsigned int z = page_at (m).get_next_zero (page_remainder (i));
+      if (z < page_t::PAGE_BITS)
+      {
+	*last = major_start (major) + z - 1;
+	return true;
+      }
+      if (++m >= page_map.length || page_map.arrayZ[m].major != major + 1)
+      {
+	*last = major_start (major + 1) - 1;
+	return true;
+      }
+      major++;
+      i = major_start (major);
+    }
   }
   bool previous_range (hb_codepoint_t *first, hb_codepoint_t *last) const
   {
@@ -726,12 +750,51 @@ struct hb_bit_set_t
       return false;
     }
 
-    /* TODO Speed up. */
-    *last = *first = i;
-    while (previous (&i) && i == *first - 1)
-      (*first)--;
+    *last = i;
+    unsigned int major = get_major (i);
+    unsigned int m = 0;
+    page_map.bfind (major, &m);
+    for (;;)
+    {
+      unsigned int z = page_at (m).get_previous_zero (page_remainder (i));
+      if (z != INVALID)
+      {
+	*first = major_start (major) + z + 1;
+	return true;
+      }
+      if (!m || page_map.arrayZ[m - 1].major + 1 != major)
+      {
+	*first = major_start (major);
+	return true;
+      }
+      m--;
+      major--;
+      i = major_start (major) + page_t::PAGE_BITMASK;
+    }
+  }
 
-    return true;
+  /* Population of [a, b], and number of runs of consecutive elements
+   * starting in it.  Only visits the pages overlapping the range. */
+  void get_run_stats (hb_codepoint_t a, hb_codepoint_t b,
+		      unsigned int *pop, unsigned int *runs) const
+  {
+    *pop = *runs = 0;
+    if (unlikely (a > b)) return;
+    unsigned int major_a = get_major (a), major_b = get_major (b);
+    unsigned int i = 0;
+    page_map.bfind (major_a, &i, HB_NOT_FOUND_STORE_CLOSEST);
+    bool carry = a && get (a - 1);
+    unsigned int next_major = major_a;
+    for (; i < page_map.length && page_map.arrayZ[i].major <= major_b; i++)
+    {
+      unsigned int m = page_map.arrayZ[i].major;
+      if (m != next_major)
+	carry = false;
+      page_at (i).get_run_stats (m == major_a ? a & page_t::PAGE_BITMASK : 0,
+				 m == major_b ? b & page_t::PAGE_BITMASK : page_t::PAGE_BITMASK,
+				 &carry, pop, runs);
+      next_major = m + 1;
+    }
   }
 
   unsigned int next_many (hb_codepoint_t  codepoint,
@@ -920,6 +983,12 @@ struct hb_bit_set_t
       auto &cached_page = page_map.arrayZ[i];
       if (cached_page.major == major)
 	return &pages.arrayZ[cached_page.index];
+      /* Walking glyphs in order usually moves on to the next page. */
+      if (i + 1 < page_map.length && page_map.arrayZ[i + 1].major == major)
+      {
+	last_page_lookup = i + 1;
+	return &pages.arrayZ[page_map.arrayZ[i + 1].index];
+      }
     }
 
     page_map_t map = {major, pages.length};
@@ -954,6 +1023,11 @@ struct hb_bit_set_t
       auto &cached_page = page_map.arrayZ[i];
       if (cached_page.major == major)
 	return &pages.arrayZ[cached_page.index];
+      if (i + 1 < page_map.length && page_map.arrayZ[i + 1].major == major)
+      {
+	last_page_lookup = i + 1;
+	return &pages.arrayZ[page_map.arrayZ[i + 1].index];
+      }
     }
 
     page_map_t key = {major};
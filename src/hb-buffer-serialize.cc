@@ -34,6 +34,7 @@
 static const char *_hb_buffer_serialize_formats[] = {
   "text",
   "json",
+  "binary",
   nullptr
 };
 
@@ -93,6 +94,7 @@ hb_buffer_serialize_format_to_string (hb_buffer_serialize_format_t format)
   {
     case HB_BUFFER_SERIALIZE_FORMAT_TEXT: return _hb_buffer_serialize_formats[0];
     case HB_BUFFER_SERIALIZE_FORMAT_JSON: return _hb_buffer_serialize_formats[1];
+    case HB_BUFFER_SERIALIZE_FORMAT_BINARY: return _hb_buffer_serialize_formats[2];
     default:
     case HB_BUFFER_SERIALIZE_FORMAT_INVALID:  return nullptr;
   }
@@ -392,6 +394,229 @@ _hb_buffer_serialize_unicode_text (hb_buffer_t *buffer,
   return end - start;
 }
 
+/*
+ * Binary format.
+ *
+ * Every call to hb_buffer_serialize_*() produces one self-contained record:
+ *
+ *   bytes 0..2  'H','B','B'
+ *   byte  3     format version (HB_BUFFER_SERIALIZE_BINARY_VERSION)
+ *   byte  4     hb_buffer_content_type_t of the payload
+ *   byte  5     hb_buffer_serialize_flags_t the payload was written with
+ *   bytes 6..9  number of items, little-endian
+ *
+ * followed by the items.  Every field is a LEB128 varint; signed fields are
+ * zigzag-encoded.  Glyph ids / codepoints and clusters are stored as deltas
+ * from the previous item of the record, positions are stored as-is.
+ */
+
+#define HB_BUFFER_SERIALIZE_BINARY_VERSION 1
+#define HB_BUFFER_SERIALIZE_BINARY_HEADER_SIZE 10
+
+static inline unsigned
+_hb_buffer_binary_put_uint (char *p, uint32_t v)
+{
+  unsigned l = 0;
+  while (v >= 0x80)
+  {
+    p[l++] = (char) (0x80 | (v & 0x7F));
+    v >>= 7;
+  }
+  p[l++] = (char) v;
+  return l;
+}
+
+static inline unsigned
+_hb_buffer_binary_put_int (char *p, int32_t v)
+{
+  return _hb_buffer_binary_put_uint (p, ((uint32_t) v << 1) ^ -((uint32_t) v >> 31));
+}
+
+static inline unsigned
+_hb_buffer_binary_put_delta (char *p, uint32_t v, uint32_t *last)
+{
+  unsigned l = _hb_buffer_binary_put_int (p, (int32_t) (v - *last));
+  *last = v;
+  return l;
+}
+
+static unsigned
+_hb_buffer_serialize_binary_header (char *buf,
+				    unsigned int buf_size,
+				    unsigned int *buf_consumed,
+				    hb_buffer_content_type_t content_type,
+				    hb_buffer_serialize_flags_t flags)
+{
+  if (buf_size <= HB_BUFFER_SERIALIZE_BINARY_HEADER_SIZE)
+    return 0;
+
+  buf[0] = 'H';
+  buf[1] = 'B';
+  buf[2] = 'B';
+  buf[3] = HB_BUFFER_SERIALIZE_BINARY_VERSION;
+  buf[4] = (char) content_type;
+  buf[5] = (char) flags;
+  hb_memset (buf + 6, 0, 4);
+  buf[HB_BUFFER_SERIALIZE_BINARY_HEADER_SIZE] = '\0';
+  *buf_consumed = HB_BUFFER_SERIALIZE_BINARY_HEADER_SIZE;
+  return HB_BUFFER_SERIALIZE_BINARY_HEADER_SIZE;
+}
+
+static unsigned int
+_hb_buffer_serialize_binary_finish (char *buf,
+				    unsigned int *buf_consumed,
+				    unsigned int count)
+{
+  if (!count)
+  {
+    /* Nothing fit; don't leave an empty record behind. */
+    *buf_consumed = 0;
+    *buf = '\0';
+    return 0;
+  }
+  buf[6] = (char) (count & 0xFF);
+  buf[7] = (char) ((count >> 8) & 0xFF);
+  buf[8] = (char) ((count >> 16) & 0xFF);
+  buf[9] = (char) ((count >> 24) & 0xFF);
+  return count;
+}
+
+static unsigned int
+_hb_buffer_serialize_glyphs_binary (hb_buffer_t *buffer,
+				    unsigned int start,
+				    unsigned int end,
+				    char *buf,
+				    unsigned int buf_size,
+				    unsigned int *buf_consumed,
+				    hb_font_t *font,
+				    hb_buffer_serialize_flags_t flags)
+{
+  hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, nullptr);
+  hb_glyph_position_t *pos = (flags & HB_BUFFER_SERIALIZE_FLAG_NO_POSITIONS) ?
+			     nullptr : hb_buffer_get_glyph_positions (buffer, nullptr);
+
+  /* Glyph names are never written. */
+  flags = (hb_buffer_serialize_flags_t) (flags & ~HB_BUFFER_SERIALIZE_FLAG_NO_GLYPH_NAMES &
+					 HB_BUFFER_SERIALIZE_FLAG_DEFINED);
+
+  *buf_consumed = 0;
+  char *header = buf;
+  unsigned int l = _hb_buffer_serialize_binary_header (buf, buf_size, buf_consumed,
+						       HB_BUFFER_CONTENT_TYPE_GLYPHS, flags);
+  if (unlikely (!l))
+    return 0;
+  buf += l;
+  buf_size -= l;
+
+  uint32_t last_glyph = 0, last_cluster = 0;
+  hb_position_t x = 0, y = 0;
+  unsigned int i;
+  for (i = start; i < end; i++)
+  {
+    /* At most eleven fields of five bytes each: glyph, cluster, flags,
+     * two offsets, two advances and four extents. */
+    char b[11 * 5];
+    char *p = b;
+
+    p += _hb_buffer_binary_put_delta (p, info[i].codepoint, &last_glyph);
+
+    if (!(flags & HB_BUFFER_SERIALIZE_FLAG_NO_CLUSTERS))
+      p += _hb_buffer_binary_put_delta (p, info[i].cluster, &last_cluster);
+
+    if (flags & HB_BUFFER_SERIALIZE_FLAG_GLYPH_FLAGS)
+      p += _hb_buffer_binary_put_uint (p, info[i].mask & HB_GLYPH_FLAG_DEFINED);
+
+    if (!(flags & HB_BUFFER_SERIALIZE_FLAG_NO_POSITIONS))
+    {
+      p += _hb_buffer_binary_put_int (p, x + pos[i].x_offset);
+      p += _hb_buffer_binary_put_int (p, y + pos[i].y_offset);
+      if (!(flags & HB_BUFFER_SERIALIZE_FLAG_NO_ADVANCES))
+      {
+	p += _hb_buffer_binary_put_int (p, pos[i].x_advance);
+	p += _hb_buffer_binary_put_int (p, pos[i].y_advance);
+      }
+    }
+
+    if (flags & HB_BUFFER_SERIALIZE_FLAG_GLYPH_EXTENTS)
+    {
+      hb_glyph_extents_t extents;
+      hb_font_get_glyph_extents (font, info[i].codepoint, &extents);
+      p += _hb_buffer_binary_put_int (p, extents.x_bearing);
+      p += _hb_buffer_binary_put_int (p, extents.y_bearing);
+      p += _hb_buffer_binary_put_int (p, extents.width);
+      p += _hb_buffer_binary_put_int (p, extents.height);
+    }
+
+    l = p - b;
+    if (buf_size > l)
+    {
+      hb_memcpy (buf, b, l);
+      buf += l;
+      buf_size -= l;
+      *buf_consumed += l;
+      *buf = '\0';
+    } else
+      break;
+
+    if (pos && (flags & HB_BUFFER_SERIALIZE_FLAG_NO_ADVANCES))
+    {
+      x += pos[i].x_advance;
+      y += pos[i].y_advance;
+    }
+  }
+
+  return _hb_buffer_serialize_binary_finish (header, buf_consumed, i - start);
+}
+
+static unsigned int
+_hb_buffer_serialize_unicode_binary (hb_buffer_t *buffer,
+				     unsigned int start,
+				     unsigned int end,
+				     char *buf,
+				     unsigned int buf_size,
+				     unsigned int *buf_consumed,
+				     hb_buffer_serialize_flags_t flags)
+{
+  hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, nullptr);
+
+  flags = (hb_buffer_serialize_flags_t) (flags & HB_BUFFER_SERIALIZE_FLAG_NO_CLUSTERS);
+
+  *buf_consumed = 0;
+  char *header = buf;
+  unsigned int l = _hb_buffer_serialize_binary_header (buf, buf_size, buf_consumed,
+						       HB_BUFFER_CONTENT_TYPE_UNICODE, flags);
+  if (unlikely (!l))
+    return 0;
+  buf += l;
+  buf_size -= l;
+
+  uint32_t last_codepoint = 0, last_cluster = 0;
+  unsigned int i;
+  for (i = start; i < end; i++)
+  {
+    char b[16];
+    char *p = b;
+
+    p += _hb_buffer_binary_put_delta (p, info[i].codepoint, &last_codepoint);
+
+    if (!(flags & HB_BUFFER_SERIALIZE_FLAG_NO_CLUSTERS))
+      p += _hb_buffer_binary_put_delta (p, info[i].cluster, &last_cluster);
+
+    l = p - b;
+    if (buf_size > l)
+    {
+      hb_memcpy (buf, b, l);
+      buf += l;
+      buf_size -= l;
+      *buf_consumed += l;
+      *buf = '\0';
+    } else
+      break;
+  }
+
+  return _hb_buffer_serialize_binary_finish (header, buf_consumed, i - start);
+}
+
 /**
  * hb_buffer_serialize_glyphs:
  * @buffer: an #hb_buffer_t buffer.
@@ -409,7 +634,7 @@ _hb_buffer_serialize_unicode_text (hb_buffer_t *buffer,
  *
  * Serializes @buffer into a textual representation of its glyph content,
  * useful for showing the contents of the buffer, for example during debugging.
- * There are currently two supported serialization formats:
+ * There are currently three supported serialization formats:
  *
  * ## text
  * A human-readable, plain text format.
@@ -450,6 +675,16 @@ _hb_buffer_serialize_unicode_text (hb_buffer_t *buffer,
  *    #hb_glyph_extents_t.width and #hb_glyph_extents_t.height respectively if
  *    #HB_BUFFER_SERIALIZE_FLAG_GLYPH_EXTENTS is set.
  *
+ * ## binary
+ * A compact format meant for passing shaped glyphs between processes, not
+ * for reading. Each call writes one record: a ten-byte header (`HBB`, the
+ * format version, the buffer content type, the flags and a little-endian
+ * 32-bit glyph count) followed by the glyphs. Glyph indices and clusters are
+ * delta-encoded against the previous glyph of the record, and every field is
+ * a (zigzag) varint. Glyph names are never written. Since @buf may contain
+ * zero bytes, use @buf_consumed for its length. Records can be concatenated
+ * and read back one at a time with hb_buffer_deserialize_glyphs().
+ *
  * Return value:
  * The number of serialized items.
  *
@@ -499,6 +734,11 @@ hb_buffer_serialize_glyphs (hb_buffer_t *buffer,
                  buf, buf_size, buf_consumed,
                  font, flags);
 
+    case HB_BUFFER_SERIALIZE_FORMAT_BINARY:
+      return _hb_buffer_serialize_glyphs_binary (buffer, start, end,
+                 buf, buf_size, buf_consumed,
+                 font, flags);
+
     default:
     case HB_BUFFER_SERIALIZE_FORMAT_INVALID:
       return 0;
@@ -522,7 +762,7 @@ hb_buffer_serialize_glyphs (hb_buffer_t *buffer,
  * Serializes @buffer into a textual representation of its content,
  * when the buffer contains Unicode codepoints (i.e., before shaping). This is
  * useful for showing the contents of the buffer, for example during debugging.
- * There are currently two supported serialization formats:
+ * There are currently three supported serialization formats:
  *
  * ## text
  * A human-readable, plain text format.
@@ -552,6 +792,10 @@ hb_buffer_serialize_glyphs (hb_buffer_t *buffer,
  * [{u:1617,cl:0},{u:1576,cl:1}]
  * ```
  *
+ * ## binary
+ * The same record layout as described in hb_buffer_serialize_glyphs(),
+ * carrying delta-encoded codepoints and clusters.
+ *
  * Return value:
  * The number of serialized items.
  *
@@ -592,6 +836,10 @@ hb_buffer_serialize_unicode (hb_buffer_t *buffer,
       return _hb_buffer_serialize_unicode_json (buffer, start, end,
                                                 buf, buf_size, buf_consumed, flags);
 
+    case HB_BUFFER_SERIALIZE_FORMAT_BINARY:
+      return _hb_buffer_serialize_unicode_binary (buffer, start, end,
+                                                  buf, buf_size, buf_consumed, flags);
+
     default:
     case HB_BUFFER_SERIALIZE_FORMAT_INVALID:
       return 0;
@@ -614,6 +862,14 @@ _hb_buffer_serialize_invalid (hb_buffer_t *buffer,
   unsigned int sconsumed;
   if (!buf_consumed)
     buf_consumed = &sconsumed;
+  if (format == HB_BUFFER_SERIALIZE_FORMAT_BINARY)
+  {
+    /* Like any other serialization of no items: no record at all. */
+    *buf_consumed = 0;
+    if (buf_size)
+      *buf = '\0';
+    return 0;
+  }
   if (buf_size < 3)
     return 0;
   if (format == HB_BUFFER_SERIALIZE_FORMAT_JSON) {
@@ -720,6 +976,145 @@ parse_hex (const char *pp, const char *end, uint32_t *pv)
   return true;
 }
 
+static bool
+_hb_buffer_binary_get_uint (const char **pp, const char *end, uint32_t *pv)
+{
+  const char *p = *pp;
+  uint32_t v = 0;
+  for (unsigned shift = 0; shift < 35; shift += 7)
+  {
+    if (unlikely (p == end))
+      return false;
+    uint8_t b = (uint8_t) *p++;
+    v |= (uint32_t) (b & 0x7F) << shift;
+    if (!(b & 0x80))
+    {
+      *pp = p;
+      *pv = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool
+_hb_buffer_binary_get_int (const char **pp, const char *end, int32_t *pv)
+{
+  uint32_t u;
+  if (unlikely (!_hb_buffer_binary_get_uint (pp, end, &u)))
+    return false;
+  *pv = (int32_t) ((u >> 1) ^ -(u & 1));
+  return true;
+}
+
+static bool
+_hb_buffer_binary_get_delta (const char **pp, const char *end, uint32_t *last)
+{
+  int32_t delta;
+  if (unlikely (!_hb_buffer_binary_get_int (pp, end, &delta)))
+    return false;
+  *last += (uint32_t) delta;
+  return true;
+}
+
+/* Decodes one record straight from @buf into the buffer's arrays; nothing
+ * is copied or tokenized in between.  A record is either taken whole or
+ * not at all: items are decoded past the end of the buffer and only
+ * committed, along with the content type, once all of them parsed.
+ * *end_ptr is only advanced past complete records. */
+static hb_bool_t
+_hb_buffer_deserialize_binary (hb_buffer_t *buffer,
+			       const char *buf,
+			       unsigned int buf_len,
+			       const char **end_ptr,
+			       hb_buffer_content_type_t expected)
+{
+  const char *p = buf, *pe = buf + buf_len;
+
+  if (unlikely (buf_len < HB_BUFFER_SERIALIZE_BINARY_HEADER_SIZE ||
+		p[0] != 'H' || p[1] != 'B' || p[2] != 'B' ||
+		p[3] != HB_BUFFER_SERIALIZE_BINARY_VERSION))
+    return false;
+
+  hb_buffer_content_type_t content_type = (hb_buffer_content_type_t) (uint8_t) p[4];
+  unsigned flags = (uint8_t) p[5];
+  unsigned count = (uint8_t) p[6]
+		 | (uint8_t) p[7] << 8
+		 | (uint8_t) p[8] << 16
+		 | (unsigned) (uint8_t) p[9] << 24;
+  p += HB_BUFFER_SERIALIZE_BINARY_HEADER_SIZE;
+
+  /* The record must match both the entry point and what the buffer
+   * already holds. */
+  if (unlikely (content_type != expected ||
+		(buffer->content_type != expected &&
+		 (buffer->content_type != HB_BUFFER_CONTENT_TYPE_INVALID || buffer->len))))
+    return false;
+  bool glyphs = content_type == HB_BUFFER_CONTENT_TYPE_GLYPHS;
+
+  /* Every item takes at least one byte; reject bogus counts before
+   * allocating for them. */
+  if (unlikely (count > (unsigned) (pe - p) ||
+		!buffer->ensure (buffer->len + count)))
+    return false;
+
+  hb_glyph_info_t *info = buffer->info + buffer->len;
+  hb_glyph_position_t *pos = glyphs ? buffer->pos + buffer->len : nullptr;
+  uint32_t codepoint = 0, cluster = 0;
+  for (unsigned i = 0; i < count; i++)
+  {
+    hb_memset (&info[i], 0, sizeof (info[i]));
+    if (unlikely (!_hb_buffer_binary_get_delta (&p, pe, &codepoint)))
+      return false;
+    info[i].codepoint = codepoint;
+
+    if (!(flags & HB_BUFFER_SERIALIZE_FLAG_NO_CLUSTERS) &&
+	unlikely (!_hb_buffer_binary_get_delta (&p, pe, &cluster)))
+      return false;
+    info[i].cluster = cluster;
+
+    if (!glyphs)
+      continue;
+
+    if (flags & HB_BUFFER_SERIALIZE_FLAG_GLYPH_FLAGS)
+    {
+      uint32_t mask;
+      if (unlikely (!_hb_buffer_binary_get_uint (&p, pe, &mask)))
+	return false;
+      info[i].mask = mask & HB_GLYPH_FLAG_DEFINED;
+    }
+
+    hb_memset (&pos[i], 0, sizeof (pos[i]));
+    if (!(flags & HB_BUFFER_SERIALIZE_FLAG_NO_POSITIONS))
+    {
+      if (unlikely (!_hb_buffer_binary_get_int (&p, pe, &pos[i].x_offset) ||
+		    !_hb_buffer_binary_get_int (&p, pe, &pos[i].y_offset)))
+	return false;
+      if (!(flags & HB_BUFFER_SERIALIZE_FLAG_NO_ADVANCES) &&
+	  unlikely (!_hb_buffer_binary_get_int (&p, pe, &pos[i].x_advance) ||
+		    !_hb_buffer_binary_get_int (&p, pe, &pos[i].y_advance)))
+	return false;
+    }
+
+    if (flags & HB_BUFFER_SERIALIZE_FLAG_GLYPH_EXTENTS)
+    {
+      /* Extents are informational only; skip them. */
+      uint32_t dummy;
+      for (unsigned j = 0; j < 4; j++)
+	if (unlikely (!_hb_buffer_binary_get_uint (&p, pe, &dummy)))
+	  return false;
+    }
+  }
+
+  if (glyphs)
+    /* Ensure we have positions; this zeroes existing items only. */
+    (void) hb_buffer_get_glyph_positions (buffer, nullptr);
+  buffer->content_type = content_type;
+  buffer->len += count;
+  *end_ptr = p;
+  return true;
+}
+
 #include "hb-buffer-deserialize-json.hh"
 #include "hb-buffer-deserialize-text-glyphs.hh"
 #include "hb-buffer-deserialize-text-unicode.hh"
@@ -737,6 +1132,10 @@ parse_hex (const char *pp, const char *end, uint32_t *pv)
  * Deserializes glyphs @buffer from textual representation in the format
  * produced by hb_buffer_serialize_glyphs().
  *
+ * For #HB_BUFFER_SERIALIZE_FORMAT_BINARY, @buf_len must be given and one
+ * record is decoded directly into @buffer.  Records of Unicode content are
+ * rejected.  On failure @buffer is left unchanged.
+ *
  * Return value: `true` if parse was successful, `false` if an error
  * occurred.
  *
@@ -765,7 +1164,12 @@ hb_buffer_deserialize_glyphs (hb_buffer_t *buffer,
   }
 
   if (buf_len == -1)
+  {
+    /* Binary data is not nul-terminated. */
+    if (unlikely (format == HB_BUFFER_SERIALIZE_FORMAT_BINARY))
+      return false;
     buf_len = strlen (buf);
+  }
 
   if (!buf_len)
   {
@@ -773,6 +1177,11 @@ hb_buffer_deserialize_glyphs (hb_buffer_t *buffer,
     return false;
   }
 
+  if (format == HB_BUFFER_SERIALIZE_FORMAT_BINARY)
+    return _hb_buffer_deserialize_binary (buffer,
+					  buf, buf_len, end_ptr,
+					  HB_BUFFER_CONTENT_TYPE_GLYPHS);
+
   hb_buffer_set_content_type (buffer, HB_BUFFER_CONTENT_TYPE_GLYPHS);
 
   if (!font)
@@ -791,6 +1200,7 @@ hb_buffer_deserialize_glyphs (hb_buffer_t *buffer,
                                           font);
 
     default:
+    case HB_BUFFER_SERIALIZE_FORMAT_BINARY: /* Handled above. */
     case HB_BUFFER_SERIALIZE_FORMAT_INVALID:
       return false;
 
@@ -810,6 +1220,10 @@ hb_buffer_deserialize_glyphs (hb_buffer_t *buffer,
  * Deserializes Unicode @buffer from textual representation in the format
  * produced by hb_buffer_serialize_unicode().
  *
+ * For #HB_BUFFER_SERIALIZE_FORMAT_BINARY, @buf_len must be given and one
+ * record is decoded directly into @buffer.  Records of glyph content are
+ * rejected.  On failure @buffer is left unchanged.
+ *
  * Return value: `true` if parse was successful, `false` if an error
  * occurred.
  *
@@ -837,7 +1251,12 @@ hb_buffer_deserialize_unicode (hb_buffer_t *buffer,
   }
 
   if (buf_len == -1)
+  {
+    /* Binary data is not nul-terminated. */
+    if (unlikely (format == HB_BUFFER_SERIALIZE_FORMAT_BINARY))
+      return false;
     buf_len = strlen (buf);
+  }
 
   if (!buf_len)
   {
@@ -845,6 +1264,11 @@ hb_buffer_deserialize_unicode (hb_buffer_t *buffer,
     return false;
   }
 
+  if (format == HB_BUFFER_SERIALIZE_FORMAT_BINARY)
+    return _hb_buffer_deserialize_binary (buffer,
+					  buf, buf_len, end_ptr,
+					  HB_BUFFER_CONTENT_TYPE_UNICODE);
+
   hb_buffer_set_content_type (buffer, HB_BUFFER_CONTENT_TYPE_UNICODE);
 
   hb_font_t* font = hb_font_get_empty ();
@@ -862,6 +1286,7 @@ hb_buffer_deserialize_unicode (hb_buffer_t *buffer,
                                           font);
 
     default:
+    case HB_BUFFER_SERIALIZE_FORMAT_BINARY: /* Handled above. */
     case HB_BUFFER_SERIALIZE_FORMAT_INVALID:
       return false;
 
@@ -84,6 +84,17 @@ buffer_verify_monotone (hb_buffer_t *buffer,
   return true;
 }
 
+/* Buffers the checks reshape with; never sampled themselves. */
+static hb_buffer_t *
+buffer_verify_create_fragment (hb_buffer_t *buffer)
+{
+  hb_buffer_t *fragment = hb_buffer_create_similar (buffer);
+  hb_buffer_set_flags (fragment, (hb_buffer_flags_t (hb_buffer_get_flags (fragment) & ~HB_BUFFER_FLAG_VERIFY)));
+  if (likely (fragment->successful))
+    fragment->verify_exempt = true;
+  return fragment;
+}
+
 static bool
 buffer_verify_unsafe_to_break (hb_buffer_t  *buffer,
 			       hb_buffer_t  *text_buffer,
@@ -101,8 +112,7 @@ buffer_verify_unsafe_to_break (hb_buffer_t  *buffer,
 
   /* Check that breaking up shaping at safe-to-break is indeed safe. */
 
-  hb_buffer_t *fragment = hb_buffer_create_similar (buffer);
-  hb_buffer_set_flags (fragment, (hb_buffer_flags_t (hb_buffer_get_flags (fragment) & ~HB_BUFFER_FLAG_VERIFY)));
+  hb_buffer_t *fragment = buffer_verify_create_fragment (buffer);
   hb_buffer_t *reconstruction = hb_buffer_create_similar (buffer);
   hb_buffer_set_flags (reconstruction, (hb_buffer_flags_t (hb_buffer_get_flags (reconstruction) & ~HB_BUFFER_FLAG_VERIFY)));
 
@@ -163,7 +173,7 @@ buffer_verify_unsafe_to_break (hb_buffer_t  *buffer,
 
     hb_buffer_append (fragment, text_buffer, text_start, text_end);
     if (!hb_shape_full (font, fragment, features, num_features, shapers) ||
-	fragment->successful || fragment->shaping_failed)
+	!fragment->successful || fragment->shaping_failed)
     {
       hb_buffer_destroy (reconstruction);
       hb_buffer_destroy (fragment);
@@ -239,10 +249,8 @@ buffer_verify_unsafe_to_concat (hb_buffer_t        *buffer,
    *    the one from original buffer in step 1.
    */
 
-  hb_buffer_t *fragments[2] {hb_buffer_create_similar (buffer),
-			     hb_buffer_create_similar (buffer)};
-  hb_buffer_set_flags (fragments[0], (hb_buffer_flags_t (hb_buffer_get_flags (fragments[0]) & ~HB_BUFFER_FLAG_VERIFY)));
-  hb_buffer_set_flags (fragments[1], (hb_buffer_flags_t (hb_buffer_get_flags (fragments[1]) & ~HB_BUFFER_FLAG_VERIFY)));
+  hb_buffer_t *fragments[2] {buffer_verify_create_fragment (buffer),
+			     buffer_verify_create_fragment (buffer)};
   hb_buffer_t *reconstruction = hb_buffer_create_similar (buffer);
   hb_buffer_set_flags (reconstruction, (hb_buffer_flags_t (hb_buffer_get_flags (reconstruction) & ~HB_BUFFER_FLAG_VERIFY)));
   hb_segment_properties_t props;
@@ -384,6 +392,78 @@ out:
   return ret;
 }
 
+/*
+ * Sampled verification.
+ *
+ * Sampled shapes only copy their input and output into a job; the checks
+ * themselves run whenever the client calls hb_buffer_verify_run_pending(),
+ * typically from an idle or worker thread.
+ */
+
+#ifndef HB_BUFFER_VERIFY_MAX_PENDING
+#define HB_BUFFER_VERIFY_MAX_PENDING 64
+#endif
+
+struct hb_buffer_verify_job_t
+{
+  ~hb_buffer_verify_job_t ()
+  {
+    hb_buffer_destroy (glyphs);
+    hb_buffer_destroy (text);
+    hb_font_destroy (font);
+  }
+
+  hb_buffer_verify_job_t *next = nullptr;
+  hb_font_t *font = nullptr;
+  unsigned int font_serial = 0;
+  hb_buffer_t *text = nullptr;
+  hb_buffer_t *glyphs = nullptr;
+  hb_vector_t<hb_feature_t> features;
+};
+
+struct hb_buffer_verify_closure_t
+{
+  hb_buffer_verify_func_t func;
+  void *user_data;
+  hb_destroy_func_t destroy;
+};
+
+static hb_atomic_int_t _hb_verify_rate;
+static hb_atomic_int_t _hb_verify_budget;
+static hb_atomic_int_t _hb_verify_buffers;
+static hb_atomic_int_t _hb_verify_used;
+static hb_atomic_int_t _hb_verify_atexit;
+
+/* Holds the failure callback, or _hb_verify_busy while
+ * hb_buffer_verify_run_pending() has taken it out.  Whoever takes a
+ * callback out of the slot owns it: if it was replaced in the meantime,
+ * the runner destroys it once done instead of putting it back. */
+static hb_buffer_verify_closure_t _hb_verify_busy;
+static hb_atomic_ptr_t<hb_buffer_verify_closure_t> _hb_verify_closure;
+
+static hb_atomic_ptr_t<hb_buffer_verify_job_t> _hb_verify_pending;
+static hb_atomic_int_t _hb_verify_pending_count;
+
+static bool
+buffer_verify_checks (hb_buffer_t        *buffer,
+		      hb_buffer_t        *text_buffer,
+		      hb_font_t          *font,
+		      const hb_feature_t *features,
+		      unsigned int        num_features,
+		      const char * const *shapers)
+{
+  bool ret = true;
+  if (!buffer_verify_monotone (buffer, font))
+    ret = false;
+  if (!buffer_verify_unsafe_to_break (buffer, text_buffer, font, features, num_features, shapers))
+    ret = false;
+  if ((buffer->flags & HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT) != 0 &&
+      !buffer_verify_unsafe_to_concat (buffer, text_buffer, font, features, num_features, shapers))
+    ret = false;
+
+  return ret;
+}
+
 bool
 hb_buffer_t::verify (hb_buffer_t        *text_buffer,
 		     hb_font_t          *font,
@@ -391,14 +471,7 @@ hb_buffer_t::verify (hb_buffer_t        *text_buffer,
 		     unsigned int        num_features,
 		     const char * const *shapers)
 {
-  bool ret = true;
-  if (!buffer_verify_monotone (this, font))
-    ret = false;
-  if (!buffer_verify_unsafe_to_break (this, text_buffer, font, features, num_features, shapers))
-    ret = false;
-  if ((flags & HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT) != 0 &&
-      !buffer_verify_unsafe_to_concat (this, text_buffer, font, features, num_features, shapers))
-    ret = false;
+  bool ret = buffer_verify_checks (this, text_buffer, font, features, num_features, shapers);
   if (!ret)
   {
 #ifndef HB_NO_BUFFER_SERIALIZE
@@ -419,5 +492,346 @@ hb_buffer_t::verify (hb_buffer_t        *text_buffer,
   return ret;
 }
 
+static void
+_hb_buffer_verify_job_destroy (hb_buffer_verify_job_t *job)
+{
+  job->~hb_buffer_verify_job_t ();
+  hb_free (job);
+  _hb_verify_pending_count.dec ();
+}
+
+static void
+_hb_buffer_verify_push (hb_buffer_verify_job_t *job)
+{
+retry:
+  hb_buffer_verify_job_t *first = _hb_verify_pending;
+  job->next = first;
+  if (unlikely (!_hb_verify_pending.cmpexch (first, job)))
+    goto retry;
+}
+
+static hb_buffer_verify_job_t *
+_hb_buffer_verify_take_all ()
+{
+retry:
+  hb_buffer_verify_job_t *first = _hb_verify_pending;
+  if (first && unlikely (!_hb_verify_pending.cmpexch (first, nullptr)))
+    goto retry;
+
+  /* Oldest first. */
+  hb_buffer_verify_job_t *jobs = nullptr;
+  while (first)
+  {
+    hb_buffer_verify_job_t *next = first->next;
+    first->next = jobs;
+    jobs = first;
+    first = next;
+  }
+  return jobs;
+}
+
+static void
+_hb_buffer_verify_closure_destroy (hb_buffer_verify_closure_t *closure)
+{
+  if (!closure || closure == &_hb_verify_busy)
+    return;
+  if (closure->destroy)
+    closure->destroy (closure->user_data);
+  hb_free (closure);
+}
+
+/* Returns the callback that was in the slot. */
+static hb_buffer_verify_closure_t *
+_hb_buffer_verify_closure_exchange (hb_buffer_verify_closure_t *closure)
+{
+retry:
+  hb_buffer_verify_closure_t *old = _hb_verify_closure;
+  if (unlikely (!_hb_verify_closure.cmpexch (old, closure)))
+    goto retry;
+  return old;
+}
+
+static inline void
+free_verify_pending ()
+{
+  hb_buffer_verify_job_t *jobs = _hb_buffer_verify_take_all ();
+  while (jobs)
+  {
+    hb_buffer_verify_job_t *next = jobs->next;
+    _hb_buffer_verify_job_destroy (jobs);
+    jobs = next;
+  }
+
+  _hb_buffer_verify_closure_destroy (_hb_buffer_verify_closure_exchange (nullptr));
+}
+
+bool
+hb_buffer_t::verify_sample ()
+{
+  unsigned int rate = _hb_verify_rate.get_relaxed ();
+  if (likely (!rate) || verify_exempt)
+    return false;
+
+  /* Shapes are counted per buffer, so that shaping with a reused buffer
+   * writes no shared state unless the call is sampled.  A buffer's count
+   * starts off staggered against the buffers counted before it, so that
+   * buffers shaped only once are sampled one in rate as well. */
+  if (unlikely (!verify_shapes))
+    verify_shapes = (unsigned int) _hb_verify_buffers.inc () + 1;
+  if (verify_shapes++ % rate)
+    return false;
+
+  /* The budget is shared, as it bounds the work queued for
+   * hb_buffer_verify_run_pending(); it is refilled every time the pending
+   * jobs are run. */
+  unsigned int budget = _hb_verify_budget.get_relaxed ();
+  return !budget || (unsigned int) _hb_verify_used.inc () < budget;
+}
+
+void
+hb_buffer_t::verify_deferred (hb_buffer_t        *text_buffer,
+			      hb_font_t          *font,
+			      const hb_feature_t *features,
+			      unsigned int        num_features)
+{
+  if (unlikely (_hb_verify_pending_count.inc () >= HB_BUFFER_VERIFY_MAX_PENDING))
+  {
+    /* Nobody is draining the queue fast enough; drop the sample. */
+    _hb_verify_pending_count.dec ();
+    return;
+  }
+
+  hb_buffer_verify_job_t *job = (hb_buffer_verify_job_t *) hb_calloc (1, sizeof (hb_buffer_verify_job_t));
+  if (unlikely (!job))
+  {
+    _hb_verify_pending_count.dec ();
+    return;
+  }
+  job = new (job) hb_buffer_verify_job_t ();
+
+  job->glyphs = hb_buffer_create_similar (this);
+  hb_buffer_set_flags (job->glyphs, (hb_buffer_flags_t (flags & ~HB_BUFFER_FLAG_VERIFY)));
+  hb_buffer_append (job->glyphs, this, 0, -1);
+  job->text = hb_buffer_reference (text_buffer);
+  job->font = hb_font_reference (font);
+  job->font_serial = hb_font_get_serial (font);
+  if (likely (job->features.resize (num_features)))
+    hb_memcpy (job->features.arrayZ, features, num_features * sizeof (features[0]));
+
+  if (unlikely (!job->glyphs->successful || job->features.in_error ()))
+  {
+    _hb_buffer_verify_job_destroy (job);
+    return;
+  }
+
+  _hb_buffer_verify_push (job);
+}
+
+static void
+_hb_buffer_verify_append (hb_vector_t<char> &v, const char *s, unsigned int len)
+{
+  unsigned int old_len = v.length;
+  if (likely (v.resize (old_len + len)))
+    hb_memcpy (v.arrayZ + old_len, s, len);
+}
+
+static hb_bool_t
+_hb_buffer_verify_collect_message (hb_buffer_t *buffer HB_UNUSED,
+				   hb_font_t   *font HB_UNUSED,
+				   const char  *message,
+				   void        *user_data)
+{
+  hb_vector_t<char> *messages = (hb_vector_t<char> *) user_data;
+  if (messages->length)
+    messages->push (' ');
+  _hb_buffer_verify_append (*messages, message, strlen (message));
+  return true;
+}
+
+static void
+_hb_buffer_verify_serialize (hb_buffer_t       *buffer,
+			     hb_font_t         *font,
+			     hb_vector_t<char> &out)
+{
+#ifndef HB_NO_BUFFER_SERIALIZE
+  unsigned int len = hb_buffer_get_length (buffer);
+  for (unsigned int start = 0; start < len;)
+  {
+    char b[1024];
+    unsigned int consumed;
+    unsigned int n = hb_buffer_serialize (buffer, start, len,
+					  b, sizeof (b), &consumed,
+					  font, HB_BUFFER_SERIALIZE_FORMAT_TEXT,
+					  HB_BUFFER_SERIALIZE_FLAG_GLYPH_FLAGS);
+    if (unlikely (!n))
+      break;
+    _hb_buffer_verify_append (out, b, consumed);
+    start += n;
+  }
+#endif
+  out.push ('\0');
+}
+
+/* Returns whether the job could be checked at all. */
+static bool
+_hb_buffer_verify_run_job (hb_buffer_verify_job_t           *job,
+			   const hb_buffer_verify_closure_t *closure)
+{
+  /* Results depend on the font settings at shaping time. */
+  if (hb_font_get_serial (job->font) != job->font_serial)
+    return false;
+
+  hb_buffer_t *buffer = hb_buffer_create_similar (job->glyphs);
+  hb_buffer_append (buffer, job->glyphs, 0, -1);
+  hb_vector_t<char> messages;
+  hb_buffer_set_message_func (buffer, _hb_buffer_verify_collect_message, &messages, nullptr);
+
+  bool ok = !buffer->successful ||
+	    buffer_verify_checks (buffer, job->text, job->font,
+				  job->features.arrayZ, job->features.length,
+				  nullptr);
+  hb_buffer_destroy (buffer);
+
+  if (ok || !closure)
+    return true;
+
+  hb_vector_t<char> text, glyphs, features;
+  _hb_buffer_verify_serialize (job->text, job->font, text);
+  _hb_buffer_verify_serialize (job->glyphs, job->font, glyphs);
+  for (hb_feature_t &feature : job->features)
+  {
+    char b[128];
+    hb_feature_to_string (&feature, b, sizeof (b));
+    if (features.length)
+      features.push (',');
+    _hb_buffer_verify_append (features, b, strlen (b));
+  }
+  features.push ('\0');
+  messages.push ('\0');
+
+  if (likely (!text.in_error () && !glyphs.in_error () &&
+	      !features.in_error () && !messages.in_error ()))
+    closure->func (job->font, &job->text->props,
+		   text.arrayZ, features.arrayZ, glyphs.arrayZ, messages.arrayZ,
+		   closure->user_data);
+
+  return true;
+}
+
+/**
+ * hb_buffer_verify_set_sampling:
+ * @rate: verify one in @rate shaping calls, or 0 to stop sampling
+ * @budget: the maximum number of shaping calls sampled between two calls
+ *   to hb_buffer_verify_run_pending(), or 0 for no limit
+ * @func: (closure user_data) (destroy destroy) (scope notified) (nullable):
+ *   callback function to report verification failures with
+ * @user_data: (nullable): data to pass to @func
+ * @destroy: (nullable): the function to call when @user_data is not needed anymore
+ *
+ * Enables sampled verification of shaping results, meant for running the
+ * checks of #HB_BUFFER_FLAG_VERIFY as a canary in production.
+ *
+ * Unlike #HB_BUFFER_FLAG_VERIFY, sampling does not change the result of
+ * hb_shape() or its variants: a sampled call only records a copy of its
+ * input and output, and the reshaping is done later, when
+ * hb_buffer_verify_run_pending() is called.  Calls with an explicit shaper
+ * list are never sampled.  At most 64 samples are kept pending; further
+ * samples are dropped until the pending ones are run.
+ *
+ * Shaping calls are counted per buffer, so a buffer that is reused is
+ * sampled once every @rate calls; new buffers are staggered, so that
+ * buffers shaped only once are also sampled one in @rate.  The budget is
+ * shared by all threads.  This can be called at any time, from any
+ * thread; a callback being replaced while hb_buffer_verify_run_pending()
+ * uses it is destroyed once that call is done with it.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_buffer_verify_set_sampling (unsigned int            rate,
+			       unsigned int            budget,
+			       hb_buffer_verify_func_t func,
+			       void                   *user_data,
+			       hb_destroy_func_t       destroy)
+{
+  if (!_hb_verify_atexit.get_relaxed () && !_hb_verify_atexit.inc ())
+    hb_atexit (free_verify_pending);
+
+  hb_buffer_verify_closure_t *closure = nullptr;
+  if (func)
+  {
+    closure = (hb_buffer_verify_closure_t *) hb_malloc (sizeof (hb_buffer_verify_closure_t));
+    if (unlikely (!closure))
+    {
+      if (destroy)
+	destroy (user_data);
+      return;
+    }
+    closure->func = func;
+    closure->user_data = user_data;
+    closure->destroy = destroy;
+  }
+  else if (destroy)
+    destroy (user_data);
+
+  _hb_buffer_verify_closure_destroy (_hb_buffer_verify_closure_exchange (closure));
+
+  _hb_verify_budget.set_relaxed (budget);
+  _hb_verify_rate.set_relaxed (rate);
+}
+
+/**
+ * hb_buffer_verify_run_pending:
+ * @max_count: the maximum number of samples to verify; pass `(unsigned) -1`
+ *   for all of them
+ *
+ * Verifies shaping calls sampled since the last call, reporting failures
+ * to the function set with hb_buffer_verify_set_sampling().  This reshapes
+ * every sample several times; call it off the latency-sensitive path, for
+ * example from a worker thread.  Samples whose font was modified after
+ * shaping are discarded.  Only one thread runs pending samples at a time;
+ * a call made while another one is running returns 0 right away.
+ *
+ * Return value: The number of samples verified.
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_buffer_verify_run_pending (unsigned int max_count)
+{
+retry:
+  hb_buffer_verify_closure_t *closure = _hb_verify_closure;
+  if (closure == &_hb_verify_busy)
+    return 0;
+  if (unlikely (!_hb_verify_closure.cmpexch (closure, &_hb_verify_busy)))
+    goto retry;
+
+  _hb_verify_used.set_relaxed (0);
+
+  hb_buffer_verify_job_t *jobs = _hb_buffer_verify_take_all ();
+  unsigned int count = 0;
+  while (jobs && count < max_count)
+  {
+    hb_buffer_verify_job_t *next = jobs->next;
+    if (_hb_buffer_verify_run_job (jobs, closure))
+      count++;
+    _hb_buffer_verify_job_destroy (jobs);
+    jobs = next;
+  }
+
+  /* Put back what we did not get to. */
+  while (jobs)
+  {
+    hb_buffer_verify_job_t *next = jobs->next;
+    _hb_buffer_verify_push (jobs);
+    jobs = next;
+  }
+
+  if (!_hb_verify_closure.cmpexch (&_hb_verify_busy, closure))
+    _hb_buffer_verify_closure_destroy (closure);
+
+  return count;
+}
+
 
 #endif
@@ -312,6 +312,27 @@ hb_buffer_t::clear ()
   scratch_flags = HB_BUFFER_SCRATCH_FLAG_DEFAULT;
 }
 
+/* Exchanges the contents, but not the settings or segment
+ * properties, of two buffers without copying. */
+void
+hb_buffer_t::swap_contents (hb_buffer_t &other)
+{
+  assert (!have_output && !other.have_output);
+
+  hb_swap (content_type, other.content_type);
+  hb_swap (successful, other.successful);
+  hb_swap (have_positions, other.have_positions);
+  hb_swap (idx, other.idx);
+  hb_swap (len, other.len);
+  hb_swap (out_len, other.out_len);
+  hb_swap (allocated, other.allocated);
+  hb_swap (info, other.info);
+  hb_swap (out_info, other.out_info);
+  hb_swap (pos, other.pos);
+  hb_swap (context, other.context);
+  hb_swap (context_len, other.context_len);
+}
+
 void
 hb_buffer_t::enter ()
 {
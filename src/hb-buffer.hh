@@ -122,6 +122,16 @@ struct hb_buffer_t
   /* The bits here reflect current allocations of the bytes in glyph_info_t's var1 and var2. */
 
 
+  /*
+   * Sampled verification
+   */
+
+#ifndef HB_NO_BUFFER_VERIFY
+  unsigned int verify_shapes; /* Shapes counted while sampling; 0 until first counted. */
+  bool verify_exempt; /* Verification reshaping buffer; never sampled. */
+#endif
+
+
   /*
    * Messaging callback
    */
@@ -199,6 +209,7 @@ struct hb_buffer_t
   HB_INTERNAL void similar (const hb_buffer_t &src);
   HB_INTERNAL void reset ();
   HB_INTERNAL void clear ();
+  HB_INTERNAL void swap_contents (hb_buffer_t &other);
 
   /* Called around shape() */
   HB_INTERNAL void enter ();
@@ -218,6 +229,29 @@ struct hb_buffer_t
   { return true; }
 #endif
 
+  /* Sampled verification; see hb_buffer_verify_set_sampling(). */
+#ifndef HB_NO_BUFFER_VERIFY
+  HB_INTERNAL
+#endif
+  bool verify_sample ()
+#ifndef HB_NO_BUFFER_VERIFY
+  ;
+#else
+  { return false; }
+#endif
+#ifndef HB_NO_BUFFER_VERIFY
+  HB_INTERNAL
+#endif
+  void verify_deferred (hb_buffer_t        *text_buffer,
+			hb_font_t          *font,
+			const hb_feature_t *features,
+			unsigned int        num_features)
+#ifndef HB_NO_BUFFER_VERIFY
+  ;
+#else
+  {}
+#endif
+
   unsigned int backtrack_len () const { return have_output ? out_len : idx; }
   unsigned int lookahead_len () const { return len - idx; }
   uint8_t next_serial () { return ++serial ? serial : ++serial; }
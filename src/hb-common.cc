@@ -64,6 +64,7 @@ _hb_options_init ()
 	if (0 == strncmp (c, name, p - c) && strlen (name) == static_cast<size_t>(p - c)) do { u.opts.symbol = true; } while (0)
 
       OPTION ("uniscribe-bug-compatible", uniscribe_bug_compatible);
+      OPTION ("lazy-layout-sanitize", lazy_layout_sanitize);
 
 #undef OPTION
 
@@ -227,11 +228,10 @@ lang_equal (hb_language_t  v1,
   return *p1 == canon_map[*p2];
 }
 
-#if 0
 static unsigned int
-lang_hash (const void *key)
+lang_hash (const char *key)
 {
-  const unsigned char *p = key;
+  const unsigned char *p = (const unsigned char *) key;
   unsigned int h = 0;
   while (canon_map[*p])
     {
@@ -241,7 +241,41 @@ lang_hash (const void *key)
 
   return h;
 }
-#endif
+
+/* Languages asked for most often; these never hit the table below.
+ * Canonicalized and sorted. */
+static const char common_langs[][8] = {
+  "ar", "bn", "c", "cs", "da", "de", "el", "en", "en-gb", "en-us", "es",
+  "fa", "fi", "fr", "gu", "he", "hi", "hu", "id", "it", "ja", "kn", "ko",
+  "ml", "mr", "ms", "nl", "no", "pa", "pl", "pt", "pt-br", "ro", "ru",
+  "sv", "ta", "te", "th", "tr", "uk", "ur", "vi", "zh", "zh-cn", "zh-hk",
+  "zh-tw",
+};
+
+static int
+_cmp_common_lang (const void *pa, const void *pb)
+{
+  return memcmp (pa, pb, sizeof (common_langs[0]));
+}
+
+static hb_language_t
+lang_find_common (const char *key)
+{
+  char tag[sizeof (common_langs[0])] = {};
+  for (unsigned i = 0; i < sizeof (tag); i++)
+  {
+    tag[i] = canon_map[(unsigned char) key[i]];
+    if (!tag[i])
+    {
+      const char *lang = (const char *) hb_bsearch (tag, common_langs,
+						    ARRAY_LENGTH (common_langs),
+						    sizeof (common_langs[0]),
+						    _cmp_common_lang);
+      return (hb_language_t) lang;
+    }
+  }
+  return nullptr;
+}
 
 
 struct hb_language_item_t {
@@ -271,31 +305,41 @@ struct hb_language_item_t {
 };
 
 
-/* Thread-safe lockfree language list */
+/* Thread-safe lockfree language table.
+ *
+ * A fixed number of buckets, each a lockfree list.  Items are never moved
+ * nor freed before exit, so hb_language_t values stay valid. */
 
-static hb_atomic_ptr_t <hb_language_item_t> langs;
+static constexpr unsigned LANG_BUCKETS = 256;
+static hb_atomic_ptr_t <hb_language_item_t> langs[LANG_BUCKETS];
+static hb_atomic_int_t langs_atexit;
 
 static inline void
 free_langs ()
 {
-retry:
-  hb_language_item_t *first_lang = langs;
-  if (unlikely (!langs.cmpexch (first_lang, nullptr)))
-    goto retry;
-
-  while (first_lang) {
-    hb_language_item_t *next = first_lang->next;
-    first_lang->fini ();
-    hb_free (first_lang);
-    first_lang = next;
+  for (unsigned i = 0; i < LANG_BUCKETS; i++)
+  {
+  retry:
+    hb_language_item_t *first_lang = langs[i];
+    if (unlikely (!langs[i].cmpexch (first_lang, nullptr)))
+      goto retry;
+
+    while (first_lang) {
+      hb_language_item_t *next = first_lang->next;
+      first_lang->fini ();
+      hb_free (first_lang);
+      first_lang = next;
+    }
   }
 }
 
 static hb_language_item_t *
 lang_find_or_insert (const char *key)
 {
+  hb_atomic_ptr_t <hb_language_item_t> &bucket = langs[lang_hash (key) % LANG_BUCKETS];
+
 retry:
-  hb_language_item_t *first_lang = langs;
+  hb_language_item_t *first_lang = bucket;
 
   for (hb_language_item_t *lang = first_lang; lang; lang = lang->next)
     if (*lang == key)
@@ -313,14 +357,14 @@ retry:
     return nullptr;
   }
 
-  if (unlikely (!langs.cmpexch (first_lang, lang)))
+  if (unlikely (!bucket.cmpexch (first_lang, lang)))
   {
     lang->fini ();
     hb_free (lang);
     goto retry;
   }
 
-  if (!first_lang)
+  if (!langs_atexit.get_relaxed () && !langs_atexit.inc ())
     hb_atexit (free_langs); /* First person registers atexit() callback. */
 
   return lang;
@@ -347,19 +391,21 @@ hb_language_from_string (const char *str, int len)
   if (!str || !len || !*str)
     return HB_LANGUAGE_INVALID;
 
-  hb_language_item_t *item = nullptr;
+  char strbuf[64];
   if (len >= 0)
   {
     /* NUL-terminate it. */
-    char strbuf[64];
     len = hb_min (len, (int) sizeof (strbuf) - 1);
     hb_memcpy (strbuf, str, len);
     strbuf[len] = '\0';
-    item = lang_find_or_insert (strbuf);
+    str = strbuf;
   }
-  else
-    item = lang_find_or_insert (str);
 
+  hb_language_t common = lang_find_common (str);
+  if (common)
+    return common;
+
+  hb_language_item_t *item = lang_find_or_insert (str);
   return likely (item) ? item->lang : HB_LANGUAGE_INVALID;
 }
 
@@ -1210,6 +1256,113 @@ uint8_t
 }
 
 
+
+/* Allocator. */
+
+#ifdef HB_RUNTIME_ALLOCATOR
+
+static hb_allocator_t _hb_allocator;
+static hb_atomic_int_t _hb_allocator_used;
+
+/* Starts at one for "nothing allocated yet"; the first hooked allocation
+ * drops that.  Then one for an installed allocator. */
+hb_atomic_int_t _hb_allocator_hooks {1};
+
+static inline void
+_hb_allocator_mark_used ()
+{
+  if (likely (_hb_allocator_used.get_relaxed ())) return;
+  /* Exactly one thread gets to drop the initial hook. */
+  if (_hb_allocator_used.inc () == 0)
+    _hb_allocator_hooks.dec ();
+}
+
+void *
+_hb_hooked_malloc (size_t size)
+{
+  _hb_allocator_mark_used ();
+  if (_hb_allocator.malloc_func)
+    return _hb_allocator.malloc_func (size, _hb_allocator.user_data);
+  return malloc (size);
+}
+
+void *
+_hb_hooked_calloc (size_t nmemb, size_t size)
+{
+  _hb_allocator_mark_used ();
+  if (_hb_allocator.calloc_func)
+    return _hb_allocator.calloc_func (nmemb, size, _hb_allocator.user_data);
+  return calloc (nmemb, size);
+}
+
+void *
+_hb_hooked_realloc (void *ptr, size_t size)
+{
+  _hb_allocator_mark_used ();
+  if (_hb_allocator.realloc_func)
+    return _hb_allocator.realloc_func (ptr, size, _hb_allocator.user_data);
+  return realloc (ptr, size);
+}
+
+void
+_hb_hooked_free (void *ptr)
+{
+  if (!ptr) return;
+  if (_hb_allocator.free_func)
+    _hb_allocator.free_func (ptr, _hb_allocator.user_data);
+  else
+    free (ptr);
+}
+
+#endif
+
+/**
+ * hb_allocator_set:
+ * @allocator: (nullable): the allocator to use, or `NULL` to go back
+ * to the C library allocator.
+ *
+ * Replaces the functions HarfBuzz uses to allocate memory.  All four
+ * functions in @allocator must be set.  The contents of @allocator are
+ * copied.
+ *
+ * This must be called before HarfBuzz allocates any memory, typically
+ * at the start of the program; once anything has been allocated, the
+ * allocator cannot be changed anymore.  This is not thread-safe.
+ *
+ * Return value: `true` if the allocator was installed, `false` if memory
+ * was already allocated, @allocator is incomplete, or the library was
+ * built without runtime allocator support.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_allocator_set (const hb_allocator_t *allocator HB_UNUSED)
+{
+#ifdef HB_RUNTIME_ALLOCATOR
+  if (_hb_allocator_used.get_relaxed ())
+    return false;
+
+  if (allocator &&
+      (!allocator->malloc_func ||
+       !allocator->calloc_func ||
+       !allocator->realloc_func ||
+       !allocator->free_func))
+    return false;
+
+  /* An installed allocator keeps everything on the hooked path. */
+  bool was_installed = _hb_allocator.malloc_func;
+  if (allocator && !was_installed)
+    _hb_allocator_hooks.inc ();
+  else if (!allocator && was_installed)
+    _hb_allocator_hooks.dec ();
+
+  _hb_allocator = allocator ? *allocator : hb_allocator_t ();
+  return true;
+#else
+  return false;
+#endif
+}
+
 /* If there is no visibility control, then hb-static.cc will NOT
  * define anything.  Instead, we get it to define one set in here
  * only, so only libharfbuzz.so defines them, not other libs. */
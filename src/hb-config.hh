@@ -57,6 +57,7 @@
 #ifdef HB_LEAN
 #define HB_DISABLE_DEPRECATED
 #define HB_NDEBUG
+#define HB_NO_ALLOCATOR
 #define HB_NO_ATEXIT
 #define HB_NO_BUFFER_MESSAGE
 #define HB_NO_BUFFER_SERIALIZE
@@ -186,11 +187,20 @@
 #define HB_NO_OT_RULESETS_FAST_PATH
 #endif
 
+#ifdef HB_NO_MATH
+#define HB_NO_OT_MATH_CACHE
+#endif
+
 #ifdef HB_MINIMIZE_MEMORY_USAGE
 #define HB_NO_GDEF_CACHE
 #define HB_NO_OT_LAYOUT_LOOKUP_CACHE
 #define HB_NO_OT_FONT_ADVANCE_CACHE
 #define HB_NO_OT_FONT_CMAP_CACHE
+#define HB_NO_OT_TAG_CACHE
+#define HB_NO_OT_METRICS_CACHE
+#define HB_NO_OT_NAME_CACHE
+#define HB_NO_OT_MATH_CACHE
+#define HB_NO_VAR_COORDS_CACHE
 #endif
 
 #ifdef HB_OPTIMIZE_SIZE
@@ -46,6 +46,7 @@ struct hb_options_t
   bool unused : 1; /* In-case sign bit is here. */
   bool initialized : 1;
   bool uniscribe_bug_compatible : 1;
+  bool lazy_layout_sanitize : 1;
 };
 
 union hb_options_union_t {
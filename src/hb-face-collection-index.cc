@@ -0,0 +1,747 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+
+#include "hb-buffer.hh"
+#include "hb-face.hh"
+#include "hb-map.hh"
+#include "hb-open-type.hh"
+#include "hb-set.hh"
+
+
+/**
+ * SECTION:hb-face-collection-index
+ * @title: hb-face-collection-index
+ * @short_description: Code point coverage index over a list of faces
+ * @include: hb.h
+ *
+ * Choosing a fallback font for a code point normally means asking every
+ * candidate face in turn whether its character map covers it.  A face
+ * collection index answers that question for all faces at once: faces
+ * are added in priority order, and hb_face_collection_index_lookup()
+ * returns the first one covering a code point.
+ * hb_face_collection_index_lookup_buffer() does the same for every
+ * character of a buffer.
+ *
+ * Internally the index is a sorted list of code point ranges, each
+ * pointing to a bitmap of the faces covering the range.  That compact
+ * form can be saved with hb_face_collection_index_serialize() and
+ * loaded back, for example from a memory-mapped file, with
+ * hb_face_collection_index_create_from_blob().
+ **/
+
+
+namespace OT {
+
+/*
+ * Serialized index.
+ *
+ * Ranges are sorted and disjoint, and only cover code points at least one
+ * face has.  Each range points to wordsPerBitmap 32-bit words of the
+ * bitmaps array, with bit (i % 32) of word (i / 32) set if face i covers
+ * the range.  Ranges with identical coverage share their bitmap.
+ */
+
+struct FaceCoverageRange
+{
+  int cmp (hb_codepoint_t u) const
+  { return u < first ? -1 : u <= last ? 0 : +1; }
+
+  bool sanitize (hb_sanitize_context_t *c) const
+  {
+    TRACE_SANITIZE (this);
+    return_trace (c->check_struct (this));
+  }
+
+  HBUINT32	first;		/* First code point of the range. */
+  HBUINT32	last;		/* Last code point of the range. */
+  HBUINT32	firstFace;	/* Index of the first face covering the range. */
+  HBUINT32	bitmapIndex;	/* Index of the first word of the range's
+				 * bitmap in the bitmaps array. */
+  public:
+  DEFINE_SIZE_STATIC (16);
+};
+
+struct FaceCoverageIndex
+{
+  static constexpr hb_tag_t tableTag = HB_TAG ('H','B','F','I');
+
+  unsigned get_face_count () const { return faceCount; }
+
+  const FaceCoverageRange *find (hb_codepoint_t u) const
+  { return ranges.as_array ().bsearch (u); }
+
+  void collect_faces (const FaceCoverageRange &range, hb_set_t *faces) const
+  {
+    const auto &words = this+bitmaps;
+    for (unsigned i = 0; i < wordsPerBitmap; i++)
+    {
+      uint32_t w = words[range.bitmapIndex + i];
+      for (; w; w &= w - 1)
+	faces->add (i * 32 + hb_ctz (w));
+    }
+  }
+
+  struct range_t
+  {
+    hb_codepoint_t first;
+    hb_codepoint_t last;
+    unsigned first_face;
+    unsigned bitmap_index;
+  };
+
+  bool serialize (hb_serialize_context_t *c,
+		  unsigned face_count,
+		  hb_array_t<const range_t> items,
+		  hb_array_t<const uint32_t> words)
+  {
+    TRACE_SERIALIZE (this);
+    if (unlikely (!c->extend_min (this))) return_trace (false);
+    magic = tableTag;
+    version = 1;
+    c->check_assign (wordsPerBitmap, (face_count + 31) / 32, HB_SERIALIZE_ERROR_INT_OVERFLOW);
+    faceCount = face_count;
+
+    if (unlikely (!ranges.serialize (c, items.length))) return_trace (false);
+    for (unsigned i = 0; i < items.length; i++)
+    {
+      FaceCoverageRange &range = ranges.arrayZ[i];
+      range.first = items[i].first;
+      range.last = items[i].last;
+      range.firstFace = items[i].first_face;
+      range.bitmapIndex = items[i].bitmap_index;
+    }
+
+    auto *array = c->start_embed<Array32Of<HBUINT32>> ();
+    if (unlikely (!array || !array->serialize (c, words.length))) return_trace (false);
+    for (unsigned i = 0; i < words.length; i++)
+      array->arrayZ[i] = words[i];
+    c->check_assign (bitmaps, (const char *) array - (const char *) this, HB_SERIALIZE_ERROR_OFFSET_OVERFLOW);
+
+    return_trace (!c->in_error ());
+  }
+
+  bool sanitize (hb_sanitize_context_t *c) const
+  {
+    TRACE_SANITIZE (this);
+    if (unlikely (!(c->check_struct (this) &&
+		    magic == tableTag &&
+		    version == 1 &&
+		    wordsPerBitmap == faceCount / 32 + (faceCount % 32 ? 1 : 0) &&
+		    ranges.sanitize_shallow (c) &&
+		    bitmaps.sanitize (c, this))))
+      return_trace (false);
+
+    /* Lookups rely on ranges being sorted, and on every range having
+     * a full bitmap and a valid first face. */
+    const auto &words = this+bitmaps;
+    const FaceCoverageRange *prev = nullptr;
+    for (const FaceCoverageRange &range : ranges)
+    {
+      if (unlikely (range.first > range.last ||
+		    (prev && range.first <= prev->last) ||
+		    range.firstFace >= faceCount ||
+		    range.bitmapIndex > words.len ||
+		    words.len - range.bitmapIndex < wordsPerBitmap))
+	return_trace (false);
+      prev = &range;
+    }
+    return_trace (true);
+  }
+
+  protected:
+  Tag		magic;		/* 'HBFI'. */
+  HBUINT16	version;	/* Set to 1. */
+  HBUINT16	wordsPerBitmap;	/* Number of 32-bit words per bitmap. */
+  HBUINT32	faceCount;	/* Number of faces in the index. */
+  Offset32To<Array32Of<HBUINT32>>
+		bitmaps;	/* Offset to face bitmaps, from beginning
+				 * of this table. */
+  SortedArray32Of<FaceCoverageRange>
+		ranges;		/* Code point ranges, sorted by first. */
+  public:
+  DEFINE_SIZE_ARRAY (20, ranges);
+};
+
+} /* namespace OT */
+
+
+/* The serialized bitmaps are indexed by 16-bit word counts. */
+#define HB_FACE_COLLECTION_INDEX_MAX_FACES (0xFFFFu * 32)
+
+struct hb_face_collection_index_t
+{
+  hb_object_header_t header;
+
+  unsigned face_count;
+  hb_vector_t<hb_set_t> faces;
+
+  /* Compiled index; built on first lookup and dropped when faces are added. */
+  mutable hb_atomic_ptr_t<hb_blob_t> data;
+
+  ~hb_face_collection_index_t () { hb_blob_destroy (data.get_relaxed ()); }
+
+  hb_blob_t *get_data () const
+  {
+    if (unlikely (header.is_inert ()))
+      return hb_blob_get_empty ();
+
+  retry:
+    hb_blob_t *blob = data.get_acquire ();
+    if (unlikely (!blob))
+    {
+      blob = compile ();
+      if (unlikely (!data.cmpexch (nullptr, blob)))
+      {
+	hb_blob_destroy (blob);
+	goto retry;
+      }
+    }
+    return blob;
+  }
+
+  const OT::FaceCoverageIndex &table () const
+  { return *get_data ()->as<OT::FaceCoverageIndex> (); }
+
+  hb_set_t *push_face ()
+  {
+    if (unlikely (hb_object_is_immutable (this) ||
+		  faces.length >= HB_FACE_COLLECTION_INDEX_MAX_FACES))
+      return nullptr;
+
+    hb_set_t *set = faces.push ();
+    if (unlikely (faces.in_error ()))
+      return nullptr;
+
+    hb_blob_destroy (data.get_relaxed ());
+    data.set_relaxed (nullptr);
+    return set;
+  }
+
+  unsigned commit_face ()
+  {
+    if (unlikely (faces.tail ().in_error ()))
+    {
+      faces.pop ();
+      return HB_FACE_COLLECTION_INDEX_NO_FACE;
+    }
+    return face_count++;
+  }
+
+  static int cmp_event (const void *pa, const void *pb)
+  {
+    uint64_t a = * (const uint64_t *) pa;
+    uint64_t b = * (const uint64_t *) pb;
+    return a < b ? -1 : a > b ? +1 : 0;
+  }
+
+  hb_blob_t *compile () const
+  {
+    /* Sweep the range boundaries of all faces in code point order,
+     * keeping track of which faces cover the current segment.  Events
+     * pack the code point in the high half and face index and
+     * whether the face starts or stops covering in the low half. */
+    hb_vector_t<uint64_t> events;
+    for (unsigned i = 0; i < faces.length; i++)
+    {
+      hb_codepoint_t first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+      while (faces.arrayZ[i].next_range (&first, &last))
+      {
+	events.push (((uint64_t) first << 32) | (i << 1) | 1);
+	events.push (((uint64_t) last + 1) << 32 | (i << 1));
+      }
+    }
+    events.qsort (cmp_event);
+
+    unsigned words_per_bitmap = (faces.length + 31) / 32;
+    hb_vector_t<uint32_t> bitmap;
+    hb_vector_t<uint32_t> words;
+    hb_vector_t<OT::FaceCoverageIndex::range_t> ranges;
+    hb_hashmap_t<uint32_t, unsigned> bitmap_indices;
+    bitmap.resize (words_per_bitmap);
+
+    unsigned active = 0;
+    for (unsigned i = 0; i < events.length && !bitmap.in_error ();)
+    {
+      hb_codepoint_t first = events.arrayZ[i] >> 32;
+      for (; i < events.length && (events.arrayZ[i] >> 32) == first; i++)
+      {
+	unsigned face = (events.arrayZ[i] & 0xFFFFFFFFu) >> 1;
+	uint32_t bit = 1u << (face % 32);
+	if (events.arrayZ[i] & 1)
+	{
+	  bitmap.arrayZ[face / 32] |= bit;
+	  active++;
+	}
+	else
+	{
+	  bitmap.arrayZ[face / 32] &= ~bit;
+	  active--;
+	}
+      }
+      if (!active || i == events.length)
+	continue;
+      hb_codepoint_t last = (events.arrayZ[i] >> 32) - 1;
+
+      uint32_t hash = 0;
+      unsigned first_face = HB_FACE_COLLECTION_INDEX_NO_FACE;
+      for (unsigned j = 0; j < words_per_bitmap; j++)
+      {
+	uint32_t w = bitmap.arrayZ[j];
+	hash = hash * 31 + hb_hash (w);
+	if (w && first_face == HB_FACE_COLLECTION_INDEX_NO_FACE)
+	  first_face = j * 32 + hb_ctz (w);
+      }
+
+      unsigned *cached;
+      unsigned bitmap_index;
+      if (bitmap_indices.has (hash, &cached) &&
+	  !hb_memcmp (words.arrayZ + *cached, bitmap.arrayZ, words_per_bitmap * sizeof (uint32_t)))
+	bitmap_index = *cached;
+      else
+      {
+	bitmap_index = words.length;
+	if (unlikely (!words.resize (bitmap_index + words_per_bitmap)))
+	  break;
+	hb_memcpy (words.arrayZ + bitmap_index, bitmap.arrayZ, words_per_bitmap * sizeof (uint32_t));
+	bitmap_indices.set (hash, bitmap_index);
+      }
+
+      if (ranges.length &&
+	  ranges.tail ().last + 1 == first &&
+	  ranges.tail ().bitmap_index == bitmap_index)
+	ranges.tail ().last = last;
+      else
+	ranges.push (OT::FaceCoverageIndex::range_t {first, last, first_face, bitmap_index});
+    }
+
+    if (unlikely (events.in_error () || bitmap.in_error () || words.in_error () ||
+		  ranges.in_error () || bitmap_indices.in_error ()))
+      return hb_blob_get_empty ();
+
+    unsigned size = OT::FaceCoverageIndex::min_size +
+		    ranges.length * OT::FaceCoverageRange::static_size +
+		    OT::Array32Of<OT::HBUINT32>::min_size +
+		    words.length * OT::HBUINT32::static_size;
+    char *buf = (char *) hb_malloc (size);
+    if (unlikely (!buf))
+      return hb_blob_get_empty ();
+
+    hb_serialize_context_t c (buf, size);
+    OT::FaceCoverageIndex *index = c.start_serialize<OT::FaceCoverageIndex> ();
+    bool ret = index->serialize (&c, faces.length, ranges.as_array (), words.as_array ());
+    c.end_serialize ();
+
+    if (unlikely (!ret))
+    {
+      hb_free (buf);
+      return hb_blob_get_empty ();
+    }
+
+    return hb_blob_create (buf, size, HB_MEMORY_MODE_READONLY, buf, hb_free);
+  }
+};
+
+
+/**
+ * hb_face_collection_index_create:
+ *
+ * Creates a new, initially empty, face collection index.
+ *
+ * Return value: (transfer full): The new face collection index
+ *
+ * Since: REPLACEME
+ **/
+hb_face_collection_index_t *
+hb_face_collection_index_create ()
+{
+  hb_face_collection_index_t *index;
+
+  if (!(index = hb_object_create<hb_face_collection_index_t> ()))
+    return hb_face_collection_index_get_empty ();
+
+  return index;
+}
+
+/**
+ * hb_face_collection_index_create_from_blob:
+ * @blob: A blob holding data from hb_face_collection_index_serialize()
+ *
+ * Creates a face collection index from serialized data.  The data is
+ * used in place, without copying, so @blob may well be a memory-mapped
+ * file.  The returned index is immutable.
+ *
+ * If the data is not a valid index, the returned index has no faces.
+ *
+ * Return value: (transfer full): The new face collection index
+ *
+ * Since: REPLACEME
+ **/
+hb_face_collection_index_t *
+hb_face_collection_index_create_from_blob (hb_blob_t *blob)
+{
+  hb_face_collection_index_t *index;
+
+  if (!(index = hb_object_create<hb_face_collection_index_t> ()))
+    return hb_face_collection_index_get_empty ();
+
+  hb_blob_t *data = hb_sanitize_context_t ().sanitize_blob<OT::FaceCoverageIndex> (hb_blob_reference (blob));
+  index->data.set_relaxed (data);
+  index->face_count = data->as<OT::FaceCoverageIndex> ()->get_face_count ();
+  hb_object_make_immutable (index);
+
+  return index;
+}
+
+/**
+ * hb_face_collection_index_get_empty:
+ *
+ * Fetches the singleton empty face collection index.
+ *
+ * Return value: (transfer full): The empty face collection index
+ *
+ * Since: REPLACEME
+ **/
+hb_face_collection_index_t *
+hb_face_collection_index_get_empty ()
+{
+  return const_cast<hb_face_collection_index_t *> (&Null (hb_face_collection_index_t));
+}
+
+/**
+ * hb_face_collection_index_reference: (skip)
+ * @index: A face collection index
+ *
+ * Increases the reference count on a face collection index.
+ *
+ * Return value: (transfer full): The face collection index
+ *
+ * Since: REPLACEME
+ **/
+hb_face_collection_index_t *
+hb_face_collection_index_reference (hb_face_collection_index_t *index)
+{
+  return hb_object_reference (index);
+}
+
+/**
+ * hb_face_collection_index_destroy: (skip)
+ * @index: A face collection index
+ *
+ * Decreases the reference count on a face collection index. When
+ * the reference count reaches zero, the index is destroyed, freeing
+ * all memory.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_collection_index_destroy (hb_face_collection_index_t *index)
+{
+  if (!hb_object_destroy (index)) return;
+
+  hb_free (index);
+}
+
+/**
+ * hb_face_collection_index_set_user_data: (skip)
+ * @index: A face collection index
+ * @key: The user-data key to set
+ * @data: A pointer to the user data to set
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified face collection index.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_face_collection_index_set_user_data (hb_face_collection_index_t *index,
+					hb_user_data_key_t         *key,
+					void *                      data,
+					hb_destroy_func_t           destroy,
+					hb_bool_t                   replace)
+{
+  return hb_object_set_user_data (index, key, data, destroy, replace);
+}
+
+/**
+ * hb_face_collection_index_get_user_data: (skip)
+ * @index: A face collection index
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified face collection index.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * Since: REPLACEME
+ **/
+void *
+hb_face_collection_index_get_user_data (const hb_face_collection_index_t *index,
+					hb_user_data_key_t               *key)
+{
+  return hb_object_get_user_data (index, key);
+}
+
+/**
+ * hb_face_collection_index_make_immutable:
+ * @index: A face collection index
+ *
+ * Makes @index immutable.  Faces can no longer be added to it, and
+ * it can be safely queried from multiple threads.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_collection_index_make_immutable (hb_face_collection_index_t *index)
+{
+  if (hb_object_is_immutable (index))
+    return;
+
+  hb_object_make_immutable (index);
+}
+
+/**
+ * hb_face_collection_index_is_immutable:
+ * @index: A face collection index
+ *
+ * Tests whether @index is immutable.
+ *
+ * Return value: `true` if @index is immutable, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_face_collection_index_is_immutable (const hb_face_collection_index_t *index)
+{
+  return hb_object_is_immutable (index);
+}
+
+
+/**
+ * hb_face_collection_index_add_face:
+ * @index: A face collection index
+ * @face: A face object
+ *
+ * Appends @face to @index, covering the Unicode characters collected
+ * by hb_face_collect_unicodes().  Faces added earlier take priority
+ * over faces added later in lookups.
+ *
+ * Adding faces is not thread-safe; it should be done before @index
+ * is shared with other threads.
+ *
+ * Return value: The index of the face within @index, or
+ * %HB_FACE_COLLECTION_INDEX_NO_FACE if @index is immutable or
+ * on allocation failure
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_collection_index_add_face (hb_face_collection_index_t *index,
+				   hb_face_t                  *face)
+{
+  hb_set_t *unicodes = index->push_face ();
+  if (unlikely (!unicodes))
+    return HB_FACE_COLLECTION_INDEX_NO_FACE;
+
+  hb_face_collect_unicodes (face, unicodes);
+  return index->commit_face ();
+}
+
+/**
+ * hb_face_collection_index_add_unicodes:
+ * @index: A face collection index
+ * @unicodes: The Unicode characters the face covers
+ *
+ * Appends a face covering @unicodes to @index.  This is useful when the
+ * coverage of a face is already known, for example from a font cache,
+ * and is otherwise like hb_face_collection_index_add_face().
+ *
+ * Return value: The index of the face within @index, or
+ * %HB_FACE_COLLECTION_INDEX_NO_FACE if @index is immutable or
+ * on allocation failure
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_collection_index_add_unicodes (hb_face_collection_index_t *index,
+				       const hb_set_t             *unicodes)
+{
+  hb_set_t *set = index->push_face ();
+  if (unlikely (!set))
+    return HB_FACE_COLLECTION_INDEX_NO_FACE;
+
+  set->union_ (*unicodes);
+  return index->commit_face ();
+}
+
+/**
+ * hb_face_collection_index_get_face_count:
+ * @index: A face collection index
+ *
+ * Fetches the number of faces in @index.
+ *
+ * Return value: Number of faces
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_collection_index_get_face_count (const hb_face_collection_index_t *index)
+{
+  return index->face_count;
+}
+
+
+/**
+ * hb_face_collection_index_lookup:
+ * @index: A face collection index
+ * @unicode: The Unicode code point to look up
+ *
+ * Finds the first face in @index, in the order faces were added, that
+ * covers @unicode.
+ *
+ * Return value: The index of the face, or %HB_FACE_COLLECTION_INDEX_NO_FACE
+ * if no face covers @unicode
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_collection_index_lookup (const hb_face_collection_index_t *index,
+				 hb_codepoint_t                    unicode)
+{
+  const OT::FaceCoverageRange *range = index->table ().find (unicode);
+  return range ? (unsigned) range->firstFace : HB_FACE_COLLECTION_INDEX_NO_FACE;
+}
+
+/**
+ * hb_face_collection_index_get_faces:
+ * @index: A face collection index
+ * @unicode: The Unicode code point to look up
+ * @faces: (out): The set to add face indices to
+ *
+ * Adds the indices of all faces in @index covering @unicode to @faces.
+ *
+ * Return value: `true` if any face covers @unicode, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_face_collection_index_get_faces (const hb_face_collection_index_t *index,
+				    hb_codepoint_t                    unicode,
+				    hb_set_t                         *faces /* OUT */)
+{
+  const OT::FaceCoverageIndex &table = index->table ();
+  const OT::FaceCoverageRange *range = table.find (unicode);
+  if (!range)
+    return false;
+
+  table.collect_faces (*range, faces);
+  return true;
+}
+
+/**
+ * hb_face_collection_index_lookup_buffer:
+ * @index: A face collection index
+ * @buffer: A buffer holding Unicode characters
+ * @face_indices: (out) (array): Array of the buffer's length to receive
+ *                the face index of each character
+ *
+ * Looks up every character of @buffer like hb_face_collection_index_lookup()
+ * does, storing %HB_FACE_COLLECTION_INDEX_NO_FACE for characters no face
+ * covers.  Consecutive characters falling in the same coverage range,
+ * which is typical of text, are resolved without searching again.
+ *
+ * @buffer must have content type %HB_BUFFER_CONTENT_TYPE_UNICODE;
+ * otherwise no character is considered covered.
+ *
+ * Return value: The number of characters no face covers
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_collection_index_lookup_buffer (const hb_face_collection_index_t *index,
+					hb_buffer_t                      *buffer,
+					unsigned int                     *face_indices /* OUT */)
+{
+  unsigned count = buffer->len;
+  if (unlikely (buffer->content_type != HB_BUFFER_CONTENT_TYPE_UNICODE))
+  {
+    for (unsigned i = 0; i < count; i++)
+      face_indices[i] = HB_FACE_COLLECTION_INDEX_NO_FACE;
+    return count;
+  }
+
+  const OT::FaceCoverageIndex &table = index->table ();
+  const hb_glyph_info_t *info = buffer->info;
+
+  /* Start with an empty cached range. */
+  hb_codepoint_t first = 1, last = 0;
+  unsigned face = HB_FACE_COLLECTION_INDEX_NO_FACE;
+  unsigned uncovered = 0;
+  for (unsigned i = 0; i < count; i++)
+  {
+    hb_codepoint_t u = info[i].codepoint;
+    if (u < first || u > last)
+    {
+      const OT::FaceCoverageRange *range = table.find (u);
+      if (range)
+      {
+	first = range->first;
+	last = range->last;
+	face = range->firstFace;
+      }
+      else
+      {
+	first = 1;
+	last = 0;
+	face = HB_FACE_COLLECTION_INDEX_NO_FACE;
+      }
+    }
+    face_indices[i] = face;
+    uncovered += face == HB_FACE_COLLECTION_INDEX_NO_FACE;
+  }
+
+  return uncovered;
+}
+
+
+/**
+ * hb_face_collection_index_serialize:
+ * @index: A face collection index
+ *
+ * Serializes @index to its compact binary form, suitable for saving to
+ * disk and loading back with hb_face_collection_index_create_from_blob().
+ *
+ * Return value: (transfer full): A blob holding the serialized index
+ *
+ * Since: REPLACEME
+ **/
+hb_blob_t *
+hb_face_collection_index_serialize (const hb_face_collection_index_t *index)
+{
+  return hb_blob_reference (index->get_data ());
+}
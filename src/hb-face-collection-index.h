@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#if !defined(HB_H_IN) && !defined(HB_NO_SINGLE_HEADER_ERROR)
+#error "Include <hb.h> instead."
+#endif
+
+#ifndef HB_FACE_COLLECTION_INDEX_H
+#define HB_FACE_COLLECTION_INDEX_H
+
+#include "hb.h"
+
+HB_BEGIN_DECLS
+
+/**
+ * HB_FACE_COLLECTION_INDEX_NO_FACE:
+ *
+ * Returned by the #hb_face_collection_index_t lookup functions when
+ * no face in the index covers a code point, and by
+ * hb_face_collection_index_add_face() on failure.
+ *
+ * Since: REPLACEME
+ **/
+#define HB_FACE_COLLECTION_INDEX_NO_FACE ((unsigned int) -1)
+
+/**
+ * hb_face_collection_index_t:
+ *
+ * Data type for holding a code point coverage index over a list of faces.
+ *
+ * The index maps each Unicode code point to the set of faces whose
+ * character map covers it, and answers "which is the first face, in
+ * the order the faces were added, that covers this code point" with a
+ * single binary search.  It is meant for choosing fallback fonts without
+ * querying every face in turn.
+ *
+ * An index can be serialized to a compact, read-only binary form that
+ * can be memory-mapped and loaded back with
+ * hb_face_collection_index_create_from_blob().
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_face_collection_index_t hb_face_collection_index_t;
+
+
+HB_EXTERN hb_face_collection_index_t *
+hb_face_collection_index_create (void);
+
+HB_EXTERN hb_face_collection_index_t *
+hb_face_collection_index_create_from_blob (hb_blob_t *blob);
+
+HB_EXTERN hb_face_collection_index_t *
+hb_face_collection_index_get_empty (void);
+
+HB_EXTERN hb_face_collection_index_t *
+hb_face_collection_index_reference (hb_face_collection_index_t *index);
+
+HB_EXTERN void
+hb_face_collection_index_destroy (hb_face_collection_index_t *index);
+
+HB_EXTERN hb_bool_t
+hb_face_collection_index_set_user_data (hb_face_collection_index_t *index,
+					hb_user_data_key_t         *key,
+					void *                      data,
+					hb_destroy_func_t           destroy,
+					hb_bool_t                   replace);
+
+HB_EXTERN void *
+hb_face_collection_index_get_user_data (const hb_face_collection_index_t *index,
+					hb_user_data_key_t               *key);
+
+HB_EXTERN void
+hb_face_collection_index_make_immutable (hb_face_collection_index_t *index);
+
+HB_EXTERN hb_bool_t
+hb_face_collection_index_is_immutable (const hb_face_collection_index_t *index);
+
+
+HB_EXTERN unsigned int
+hb_face_collection_index_add_face (hb_face_collection_index_t *index,
+				   hb_face_t                  *face);
+
+HB_EXTERN unsigned int
+hb_face_collection_index_add_unicodes (hb_face_collection_index_t *index,
+				       const hb_set_t             *unicodes);
+
+HB_EXTERN unsigned int
+hb_face_collection_index_get_face_count (const hb_face_collection_index_t *index);
+
+
+HB_EXTERN unsigned int
+hb_face_collection_index_lookup (const hb_face_collection_index_t *index,
+				 hb_codepoint_t                    unicode);
+
+HB_EXTERN hb_bool_t
+hb_face_collection_index_get_faces (const hb_face_collection_index_t *index,
+				    hb_codepoint_t                    unicode,
+				    hb_set_t                         *faces /* OUT */);
+
+HB_EXTERN unsigned int
+hb_face_collection_index_lookup_buffer (const hb_face_collection_index_t *index,
+					hb_buffer_t                      *buffer,
+					unsigned int                     *face_indices /* OUT */);
+
+
+HB_EXTERN hb_blob_t *
+hb_face_collection_index_serialize (const hb_face_collection_index_t *index);
+
+HB_END_DECLS
+
+#endif /* HB_FACE_COLLECTION_INDEX_H */
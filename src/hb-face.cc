@@ -33,6 +33,12 @@
 #include "hb-open-file.hh"
 #include "hb-ot-face.hh"
 #include "hb-ot-cmap-table.hh"
+#include "hb-ot-name-table.hh"
+#include "hb-ot-os2-table.hh"
+#ifndef HB_NO_COLOR
+#include "OT/Color/CBDT/CBDT.hh"
+#include "OT/Color/sbix/sbix.hh"
+#endif
 
 
 /**
@@ -141,6 +147,9 @@ hb_face_create_for_tables (hb_reference_table_func_t  reference_table_func,
 
   face->data.init0 (face);
   face->table.init0 (face);
+#if !defined(HB_NO_VAR) && !defined(HB_NO_VAR_COORDS_CACHE)
+  face->var_coords_lock.init ();
+#endif
 
   return face;
 }
@@ -303,6 +312,10 @@ hb_face_destroy (hb_face_t *face)
   }
 #endif
 
+#if !defined(HB_NO_VAR) && !defined(HB_NO_VAR_COORDS_CACHE)
+  face->fini_normalized_coords ();
+#endif
+
   face->data.fini ();
   face->table.fini ();
 
@@ -662,3 +675,179 @@ hb_face_collect_variation_unicodes (hb_face_t *face,
   face->table.cmap->collect_variation_unicodes (variation_selector, out);
 }
 #endif
+
+
+/*
+ * Catalog information.
+ */
+
+#if !defined(HB_NO_NAME) && !defined(HB_NO_OT_NAME_CACHE)
+static const char *
+_hb_face_catalog_get_name (hb_face_t *face, hb_ot_name_id_t name_id)
+{
+  const OT::name_accelerator_t &name = *face->table.name;
+  int entry = name.get_entry (name_id, hb_language_from_string ("en", 2));
+  if (entry == -1)
+    return nullptr;
+  const OT::name_accelerator_t::decoded_t *decoded = name.get_decoded<hb_utf8_t> (entry);
+  return decoded ? (const char *) decoded->text<hb_utf8_t> () : nullptr;
+}
+#endif
+
+/**
+ * hb_face_collect_catalog_info:
+ * @face: A face object
+ * @fields: The groups of fields to fetch
+ * @info: (inout): The #hb_face_catalog_info_t to fill in
+ *
+ * Fetches the metadata font catalogs and pickers index faces by, in one
+ * call: names, style values, `OS/2` ranges, character coverage, variation
+ * and color information.  Only the groups in @fields are touched; their
+ * fields are cleared first, except #hb_face_catalog_info_t.unicodes, which
+ * the caller sets to the set to add characters to, if any.
+ *
+ * The table directory is read once up front and tables the face does not
+ * have are not loaded.  None of this needs a font, and no shaping data is
+ * set up.  Faces sharing one blob, such as those of a font collection,
+ * share the underlying table data as usual.
+ *
+ * Return value: The groups of @fields that the face has data for.  Style
+ * and color information are always returned when requested.
+ *
+ * Since: REPLACEME
+ **/
+hb_face_catalog_field_t
+hb_face_collect_catalog_info (hb_face_t               *face,
+			      hb_face_catalog_field_t  fields,
+			      hb_face_catalog_info_t  *info /* IN/OUT */)
+{
+  unsigned int found = 0;
+
+  /* Tables some of the fields come from; see has_table(). */
+  enum {
+    TABLE_name, TABLE_OS2, TABLE_cmap, TABLE_fvar,
+    TABLE_COLR, TABLE_CPAL, TABLE_SVG, TABLE_CBDT, TABLE_sbix
+  };
+  static const hb_tag_t table_tags[] = {
+    HB_TAG ('n','a','m','e'), HB_TAG ('O','S','/','2'), HB_TAG ('c','m','a','p'),
+    HB_TAG ('f','v','a','r'), HB_TAG ('C','O','L','R'), HB_TAG ('C','P','A','L'),
+    HB_TAG ('S','V','G',' '), HB_TAG ('C','B','D','T'), HB_TAG ('s','b','i','x'),
+  };
+
+  /* One walk over the table directory.  Faces that cannot list their
+   * tables, like those from hb_face_create_for_tables(), may have any. */
+  unsigned int present = 0;
+  unsigned int offset = 0, total;
+  do
+  {
+    hb_tag_t tags[32];
+    unsigned int count = ARRAY_LENGTH (tags);
+    total = hb_face_get_table_tags (face, offset, &count, tags);
+    for (unsigned int i = 0; i < count; i++)
+      for (unsigned int j = 0; j < ARRAY_LENGTH (table_tags); j++)
+	if (tags[i] == table_tags[j])
+	  present |= 1u << j;
+    offset += count;
+    if (!count) break;
+  }
+  while (offset < total);
+  if (!total)
+    present = (unsigned int) -1;
+  auto has_table = [&] (unsigned int table) { return (bool) (present & (1u << table)); };
+
+  if (fields & HB_FACE_CATALOG_FIELD_NAMES)
+  {
+    info->family_name = info->style_name = info->full_name = info->postscript_name = nullptr;
+    /* Without the name cache there is no storage for the strings to live
+     * in; callers fall back to hb_ot_name_get_utf8(). */
+#if !defined(HB_NO_NAME) && !defined(HB_NO_OT_NAME_CACHE)
+    if (has_table (TABLE_name))
+    {
+      info->family_name = _hb_face_catalog_get_name (face, HB_OT_NAME_ID_TYPOGRAPHIC_FAMILY);
+      if (!info->family_name)
+	info->family_name = _hb_face_catalog_get_name (face, HB_OT_NAME_ID_FONT_FAMILY);
+      info->style_name = _hb_face_catalog_get_name (face, HB_OT_NAME_ID_TYPOGRAPHIC_SUBFAMILY);
+      if (!info->style_name)
+	info->style_name = _hb_face_catalog_get_name (face, HB_OT_NAME_ID_FONT_SUBFAMILY);
+      info->full_name = _hb_face_catalog_get_name (face, HB_OT_NAME_ID_FULL_NAME);
+      info->postscript_name = _hb_face_catalog_get_name (face, HB_OT_NAME_ID_POSTSCRIPT_NAME);
+    }
+#endif
+    if (info->family_name || info->style_name || info->full_name || info->postscript_name)
+      found |= HB_FACE_CATALOG_FIELD_NAMES;
+  }
+
+#ifndef HB_NO_STYLE
+  if (fields & HB_FACE_CATALOG_FIELD_STYLE)
+  {
+    info->weight = _hb_style_get_value (face, nullptr, 0, 0.f, 0.f, HB_STYLE_TAG_WEIGHT);
+    info->width = _hb_style_get_value (face, nullptr, 0, 0.f, 0.f, HB_STYLE_TAG_WIDTH);
+    info->italic = _hb_style_get_value (face, nullptr, 0, 0.f, 0.f, HB_STYLE_TAG_ITALIC);
+    info->slant_angle = _hb_style_get_value (face, nullptr, 0, 0.f, 0.f, HB_STYLE_TAG_SLANT_ANGLE);
+    info->optical_size = _hb_style_get_value (face, nullptr, 0, 0.f, 0.f, HB_STYLE_TAG_OPTICAL_SIZE);
+    found |= HB_FACE_CATALOG_FIELD_STYLE;
+  }
+#endif
+
+  if (fields & HB_FACE_CATALOG_FIELD_UNICODE_RANGES)
+  {
+    hb_memset (info->unicode_ranges, 0, sizeof (info->unicode_ranges));
+    hb_memset (info->code_page_ranges, 0, sizeof (info->code_page_ranges));
+    if (has_table (TABLE_OS2) && face->table.OS2->has_data ())
+    {
+      const OT::OS2 &os2 = *face->table.OS2;
+      for (unsigned int i = 0; i < 4; i++)
+	info->unicode_ranges[i] = os2.ulUnicodeRange[i];
+      info->code_page_ranges[0] = os2.v1 ().ulCodePageRange1;
+      info->code_page_ranges[1] = os2.v1 ().ulCodePageRange2;
+      found |= HB_FACE_CATALOG_FIELD_UNICODE_RANGES;
+    }
+  }
+
+#ifndef HB_NO_FACE_COLLECT_UNICODES
+  if ((fields & HB_FACE_CATALOG_FIELD_UNICODES) && info->unicodes && has_table (TABLE_cmap) &&
+      face->table.cmap->table.get_length ())
+  {
+    face->table.cmap->collect_unicodes (info->unicodes, face->get_num_glyphs ());
+    found |= HB_FACE_CATALOG_FIELD_UNICODES;
+  }
+#endif
+
+#ifndef HB_NO_VAR
+  if (fields & HB_FACE_CATALOG_FIELD_VARIATIONS)
+  {
+    info->axis_count = info->named_instance_count = 0;
+    if (has_table (TABLE_fvar))
+    {
+      info->axis_count = hb_ot_var_get_axis_count (face);
+      info->named_instance_count = hb_ot_var_get_named_instance_count (face);
+    }
+    if (info->axis_count)
+      found |= HB_FACE_CATALOG_FIELD_VARIATIONS;
+  }
+#endif
+
+#ifndef HB_NO_COLOR
+  if (fields & HB_FACE_CATALOG_FIELD_COLOR)
+  {
+    unsigned int color = HB_FACE_CATALOG_COLOR_NONE;
+    if (has_table (TABLE_COLR))
+    {
+      if (hb_ot_color_has_layers (face)) color |= HB_FACE_CATALOG_COLOR_LAYERS;
+      if (hb_ot_color_has_paint (face)) color |= HB_FACE_CATALOG_COLOR_PAINT;
+    }
+    if (has_table (TABLE_CPAL) && hb_ot_color_has_palettes (face))
+      color |= HB_FACE_CATALOG_COLOR_PALETTES;
+    if (has_table (TABLE_SVG) && hb_ot_color_has_svg (face))
+      color |= HB_FACE_CATALOG_COLOR_SVG;
+    if (has_table (TABLE_CBDT) && face->table.CBDT->has_data ())
+      color |= HB_FACE_CATALOG_COLOR_CBDT;
+    if (has_table (TABLE_sbix) && face->table.sbix->has_data ())
+      color |= HB_FACE_CATALOG_COLOR_SBIX;
+    info->color = (hb_face_catalog_color_t) color;
+    found |= HB_FACE_CATALOG_FIELD_COLOR;
+  }
+#endif
+
+  return (hb_face_catalog_field_t) found;
+}
@@ -68,6 +68,19 @@ struct hb_face_t
 #ifndef HB_NO_SHAPER
   hb_atomic_ptr_t<plan_node_t> shape_plans;
 #endif
+#if !defined(HB_NO_VAR) && !defined(HB_NO_VAR_COORDS_CACHE)
+  /* Recently normalized design coordinates, most recent first. */
+  struct var_coords_node_t
+  {
+    uint32_t hash;
+    unsigned num_coords;
+    float *design_coords () { return (float *) (this + 1); }
+    int *normalized_coords () { return (int *) (design_coords () + num_coords); }
+  };
+  enum { VAR_COORDS_CACHE_SIZE = 16 };
+  mutable hb_mutex_t var_coords_lock;
+  mutable var_coords_node_t *var_coords_cache[VAR_COORDS_CACHE_SIZE];
+#endif
 
   hb_blob_t *reference_table (hb_tag_t tag) const
   {
@@ -101,11 +114,31 @@ struct hb_face_t
     return ret;
   }
 
+#if !defined(HB_NO_VAR) && !defined(HB_NO_VAR_COORDS_CACHE)
+  HB_INTERNAL bool get_normalized_coords (unsigned int coords_length,
+					  const float *design_coords,
+					  int *normalized_coords) const;
+  HB_INTERNAL void set_normalized_coords (unsigned int coords_length,
+					  const float *design_coords,
+					  const int *normalized_coords) const;
+  HB_INTERNAL void fini_normalized_coords ();
+#endif
+
   private:
   HB_INTERNAL unsigned int load_upem () const;
   HB_INTERNAL unsigned int load_num_glyphs () const;
 };
 DECLARE_NULL_INSTANCE (hb_face_t);
 
+#ifndef HB_NO_STYLE
+HB_INTERNAL float
+_hb_style_get_value (hb_face_t      *face,
+		     const float    *design_coords,
+		     unsigned int    num_coords,
+		     float           ptem,
+		     float           slant,
+		     hb_style_tag_t  style_tag);
+#endif
+
 
 #endif /* HB_FACE_HH */
@@ -1997,6 +1997,10 @@ hb_font_destroy (hb_font_t *font)
 
   hb_free (font->coords);
   hb_free (font->design_coords);
+#ifndef HB_NO_OT_METRICS_CACHE
+  hb_free (font->metrics_snapshot.get_relaxed ());
+#endif
+  font->drop_math_cache ();
 
   hb_free (font);
 }
@@ -2394,6 +2398,8 @@ hb_font_set_ppem (hb_font_t    *font,
 
   font->x_ppem = x_ppem;
   font->y_ppem = y_ppem;
+
+  font->drop_math_cache ();
 }
 
 /**
@@ -35,6 +35,14 @@
 #include "hb-shaper.hh"
 
 
+struct hb_ot_metrics_snapshot_t;
+struct hb_ot_math_cache_t;
+
+#ifndef HB_NO_OT_MATH_CACHE
+HB_INTERNAL void
+hb_ot_math_cache_destroy (hb_ot_math_cache_t *cache);
+#endif
+
 /*
  * hb_font_funcs_t
  */
@@ -145,6 +153,15 @@ struct hb_font_t
 
   hb_shaper_object_dataset_t<hb_font_t> data; /* Various shaper data. */
 
+#ifndef HB_NO_OT_METRICS_CACHE
+  /* Resolved metrics; see hb-ot-metrics.cc. */
+  hb_atomic_ptr_t<hb_ot_metrics_snapshot_t> metrics_snapshot;
+#endif
+#ifndef HB_NO_OT_MATH_CACHE
+  /* Resolved MATH glyph data; see hb-ot-math.cc. */
+  hb_atomic_ptr_t<hb_ot_math_cache_t> math_cache;
+#endif
+
 
   /* Convert from font-space to user-space */
   int64_t dir_mult (hb_direction_t direction)
@@ -703,6 +720,20 @@ struct hb_font_t
     slant_xy = y_scale ? slant * x_scale / y_scale : 0.f;
 
     data.fini ();
+#ifndef HB_NO_OT_METRICS_CACHE
+    hb_free (metrics_snapshot.get_relaxed ());
+    metrics_snapshot.set_relaxed (nullptr);
+#endif
+    drop_math_cache ();
+  }
+
+  /* MATH values also depend on ppem, through device tables. */
+  void drop_math_cache ()
+  {
+#ifndef HB_NO_OT_MATH_CACHE
+    hb_ot_math_cache_destroy (math_cache.get_relaxed ());
+    math_cache.set_relaxed (nullptr);
+#endif
   }
 
   hb_position_t em_mult (int16_t v, int64_t mult)
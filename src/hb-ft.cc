@@ -85,7 +85,101 @@
  */
 
 
-using hb_ft_advance_cache_t = hb_cache_t<16, 24, 8, false>;
+using hb_ft_advance_cache_t = hb_cache_t<16, 24, 8, true>;
+
+/* Glyph-extents cache that can be read without taking any lock.
+ *
+ * Each item is guarded by a sequence number, seqlock style: a writer
+ * makes it odd while it updates the item and even again when done; a
+ * reader gives up if the number is odd or changes under it.  Writers are
+ * serialized by hb_ft_font_t::cache_lock.  The whole cache is tied to
+ * one hb_font_t serial and is dropped when the font changes. */
+struct hb_ft_extents_cache_t
+{
+  void clear ()
+  {
+    serial.set_release (-1);
+  }
+
+  bool get (unsigned font_serial,
+	    hb_codepoint_t glyph,
+	    hb_glyph_extents_t *extents) const
+  {
+    if ((unsigned) serial.get_acquire () != font_serial)
+      return false;
+
+    const item_t &item = items[glyph % ARRAY_LENGTH (items)];
+    int seq = item.seq.get_acquire ();
+    if (seq & 1)
+      return false;
+    hb_codepoint_t g = (unsigned) item.glyph.get_relaxed ();
+    hb_glyph_extents_t e = {item.v[0].get_relaxed (),
+			    item.v[1].get_relaxed (),
+			    item.v[2].get_relaxed (),
+			    item.v[3].get_relaxed ()};
+    _hb_memory_r_barrier ();
+    if (item.seq.get_relaxed () != seq || g != glyph)
+      return false;
+
+    *extents = e;
+    return true;
+  }
+
+  /* Must be called with hb_ft_font_t::cache_lock held. */
+  void set (unsigned font_serial,
+	    hb_codepoint_t glyph,
+	    const hb_glyph_extents_t &extents)
+  {
+    if ((unsigned) serial.get_relaxed () != font_serial)
+    {
+      for (item_t &item : items)
+	item.write (HB_CODEPOINT_INVALID, nullptr);
+      serial.set_release (font_serial);
+    }
+
+    items[glyph % ARRAY_LENGTH (items)].write (glyph, &extents);
+  }
+
+  private:
+  struct item_t
+  {
+    void write (hb_codepoint_t g, const hb_glyph_extents_t *extents)
+    {
+      int s = seq.get_relaxed ();
+      seq.set_relaxed (s + 1);
+      _hb_memory_w_barrier ();
+      glyph.set_relaxed ((int) g);
+      if (extents)
+      {
+	v[0].set_relaxed (extents->x_bearing);
+	v[1].set_relaxed (extents->y_bearing);
+	v[2].set_relaxed (extents->width);
+	v[3].set_relaxed (extents->height);
+      }
+      seq.set_release (s + 2);
+    }
+
+    hb_atomic_int_t seq;
+    hb_atomic_int_t glyph;
+    hb_atomic_int_t v[4];
+  };
+
+  hb_atomic_int_t serial;
+  item_t items[256];
+};
+
+/* An extra FT_Face over the same font data, so that FreeType calls from
+ * different threads don't all contend on one lock.  Clones follow the
+ * hb_font_t settings on their own; see hb_ft_font_set_face_clones(). */
+struct hb_ft_face_clone_t
+{
+  hb_mutex_t lock; /* Protects members below. */
+  FT_Face ft_face;
+  unsigned cached_serial;
+  bool transform;
+
+  hb_atomic_int_t users; /* Hint only, to spread threads across clones. */
+};
 
 struct hb_ft_font_t
 {
@@ -97,7 +191,36 @@ struct hb_ft_font_t
   mutable hb_mutex_t lock; /* Protects members below. */
   FT_Face ft_face;
   mutable unsigned cached_serial;
+
+  /* Readable without any lock. */
   mutable hb_ft_advance_cache_t advance_cache;
+  mutable hb_ft_extents_cache_t extents_cache;
+  mutable hb_atomic_int_t advance_serial; /* Font serial advance_cache is for, with clones. */
+  mutable hb_mutex_t cache_lock; /* Serializes cache writers. */
+
+  unsigned num_clones;
+  hb_ft_face_clone_t *clones;
+  mutable hb_atomic_int_t next_clone; /* Round-robin start for pick_clone(). */
+
+  hb_ft_face_clone_t *pick_clone () const
+  {
+    unsigned start = (unsigned) next_clone.inc () % num_clones;
+    for (unsigned i = 0; i < num_clones; i++)
+    {
+      hb_ft_face_clone_t *clone = &clones[(start + i) % num_clones];
+      if (!clone->users.get_relaxed ())
+	return clone;
+    }
+    return &clones[start];
+  }
+
+  /* Without clones, advance_cache follows ft_face and is cleared
+   * when that changes.  Clones follow the font on their own, so
+   * then the cache is tied to the font serial instead. */
+  bool advance_cache_valid (unsigned font_serial) const
+  {
+    return !num_clones || (unsigned) advance_serial.get_acquire () == font_serial;
+  }
 };
 
 static hb_ft_font_t *
@@ -115,6 +238,9 @@ _hb_ft_font_create (FT_Face ft_face, bool symbol, bool unref)
 
   ft_font->cached_serial = (unsigned) -1;
   new (&ft_font->advance_cache) hb_ft_advance_cache_t;
+  ft_font->advance_serial.set_relaxed (-1);
+  ft_font->extents_cache.clear ();
+  ft_font->cache_lock.init ();
 
   return ft_font;
 }
@@ -125,25 +251,39 @@ _hb_ft_face_destroy (void *data)
   FT_Done_Face ((FT_Face) data);
 }
 
+static void
+_hb_ft_font_destroy_clones (hb_ft_font_t *ft_font)
+{
+  for (unsigned i = 0; i < ft_font->num_clones; i++)
+  {
+    FT_Done_Face (ft_font->clones[i].ft_face);
+    ft_font->clones[i].lock.fini ();
+  }
+  hb_free (ft_font->clones);
+  ft_font->clones = nullptr;
+  ft_font->num_clones = 0;
+}
+
 static void
 _hb_ft_font_destroy (void *data)
 {
   hb_ft_font_t *ft_font = (hb_ft_font_t *) data;
 
+  _hb_ft_font_destroy_clones (ft_font);
+
   if (ft_font->unref)
     _hb_ft_face_destroy (ft_font->ft_face);
 
+  ft_font->cache_lock.fini ();
   ft_font->lock.fini ();
 
   hb_free (ft_font);
 }
 
-
-/* hb_font changed, update FT_Face. */
-static void _hb_ft_hb_font_changed (hb_font_t *font, FT_Face ft_face)
+/* hb_font changed, update FT_Face.  Returns whether a transform was set. */
+static bool _hb_ft_hb_font_changed (hb_font_t *font, FT_Face ft_face)
 {
-  hb_ft_font_t *ft_font = (hb_ft_font_t *) font->user_data;
-
+  bool transform = false;
   float x_mult = 1.f, y_mult = 1.f;
 
   if (font->x_scale < 0) x_mult = -x_mult;
@@ -181,7 +321,7 @@ static void _hb_ft_hb_font_changed (hb_font_t *font, FT_Face ft_face)
     FT_Matrix matrix = { (int) roundf (x_mult * (1<<16)), 0,
 			  0, (int) roundf (y_mult * (1<<16))};
     FT_Set_Transform (ft_face, &matrix, nullptr);
-    ft_font->transform = true;
+    transform = true;
   }
 
 #if defined(HAVE_FT_GET_VAR_BLEND_COORDINATES) && !defined(HB_NO_VAR)
@@ -199,23 +339,86 @@ static void _hb_ft_hb_font_changed (hb_font_t *font, FT_Face ft_face)
     }
   }
 #endif
+
+  return transform;
 }
 
 /* Check if hb_font changed, update FT_Face. */
 static inline bool
 _hb_ft_hb_font_check_changed (hb_font_t *font,
-			      const hb_ft_font_t *ft_font)
+			      hb_ft_font_t *ft_font)
 {
   if (font->serial != ft_font->cached_serial)
   {
-    _hb_ft_hb_font_changed (font, ft_font->ft_face);
+    if (_hb_ft_hb_font_changed (font, ft_font->ft_face))
+      ft_font->transform = true;
+    /* Metrics read since the font changed came from the FT_Face as it
+     * was, but were cached under the new serial. */
     ft_font->advance_cache.clear ();
+    ft_font->extents_cache.clear ();
     ft_font->cached_serial = font->serial;
     return true;
   }
   return false;
 }
 
+/* Locks an FT_Face to serve @font with: a clone if the font has any,
+ * the main face otherwise.  Clones are brought up to date with @font
+ * as needed. */
+struct hb_ft_locked_face_t
+{
+  hb_ft_locked_face_t (hb_font_t *font, const hb_ft_font_t *ft_font)
+  {
+    if (!ft_font->num_clones)
+    {
+      clone = nullptr;
+      lock = &ft_font->lock;
+      lock->lock ();
+      ft_face = ft_font->ft_face;
+      transform = ft_font->transform;
+      return;
+    }
+
+    clone = ft_font->pick_clone ();
+    clone->users.inc ();
+    lock = &clone->lock;
+    lock->lock ();
+
+    if (clone->cached_serial != font->serial)
+    {
+      if (_hb_ft_hb_font_changed (font, clone->ft_face))
+	clone->transform = true;
+      clone->cached_serial = font->serial;
+    }
+    if (!ft_font->advance_cache_valid (font->serial))
+    {
+      hb_lock_t cache_lock (ft_font->cache_lock);
+      if (!ft_font->advance_cache_valid (font->serial))
+      {
+	ft_font->advance_cache.clear ();
+	ft_font->advance_serial.set_release (font->serial);
+      }
+    }
+
+    ft_face = clone->ft_face;
+    transform = clone->transform;
+  }
+
+  ~hb_ft_locked_face_t ()
+  {
+    lock->unlock ();
+    if (clone)
+      clone->users.dec ();
+  }
+
+  FT_Face ft_face;
+  bool transform;
+
+  private:
+  hb_mutex_t *lock;
+  hb_ft_face_clone_t *clone;
+};
+
 
 /**
  * hb_ft_font_set_load_flags:
@@ -244,6 +447,9 @@ hb_ft_font_set_load_flags (hb_font_t *font, int load_flags)
   hb_ft_font_t *ft_font = (hb_ft_font_t *) font->user_data;
 
   ft_font->load_flags = load_flags;
+
+  ft_font->advance_cache.clear ();
+  ft_font->extents_cache.clear ();
 }
 
 /**
@@ -354,8 +560,9 @@ hb_ft_get_nominal_glyph (hb_font_t *font,
 			 void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  unsigned int g = FT_Get_Char_Index (ft_font->ft_face, unicode);
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
+  unsigned int g = FT_Get_Char_Index (ft_face, unicode);
 
   if (unlikely (!g))
   {
@@ -369,14 +576,14 @@ hb_ft_get_nominal_glyph (hb_font_t *font,
 	   * Windows seems to do, and that's hinted about at:
 	   * https://docs.microsoft.com/en-us/typography/opentype/spec/recom
 	   * under "Non-Standard (Symbol) Fonts". */
-	  g = FT_Get_Char_Index (ft_font->ft_face, 0xF000u + unicode);
+	  g = FT_Get_Char_Index (ft_face, 0xF000u + unicode);
 	break;
 #ifndef HB_NO_OT_SHAPER_ARABIC_FALLBACK
       case OT::OS2::font_page_t::FONT_PAGE_SIMP_ARABIC:
-	g = FT_Get_Char_Index (ft_font->ft_face, _hb_arabic_pua_simp_map (unicode));
+	g = FT_Get_Char_Index (ft_face, _hb_arabic_pua_simp_map (unicode));
 	break;
       case OT::OS2::font_page_t::FONT_PAGE_TRAD_ARABIC:
-	g = FT_Get_Char_Index (ft_font->ft_face, _hb_arabic_pua_trad_map (unicode));
+	g = FT_Get_Char_Index (ft_face, _hb_arabic_pua_trad_map (unicode));
 	break;
 #endif
       default:
@@ -394,7 +601,7 @@ hb_ft_get_nominal_glyph (hb_font_t *font,
 }
 
 static unsigned int
-hb_ft_get_nominal_glyphs (hb_font_t *font HB_UNUSED,
+hb_ft_get_nominal_glyphs (hb_font_t *font,
 			  void *font_data,
 			  unsigned int count,
 			  const hb_codepoint_t *first_unicode,
@@ -404,10 +611,10 @@ hb_ft_get_nominal_glyphs (hb_font_t *font HB_UNUSED,
 			  void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
+  hb_ft_locked_face_t face (font, ft_font);
   unsigned int done;
   for (done = 0;
-       done < count && (*first_glyph = FT_Get_Char_Index (ft_font->ft_face, *first_unicode));
+       done < count && (*first_glyph = FT_Get_Char_Index (face.ft_face, *first_unicode));
        done++)
   {
     first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
@@ -420,7 +627,7 @@ hb_ft_get_nominal_glyphs (hb_font_t *font HB_UNUSED,
 
 
 static hb_bool_t
-hb_ft_get_variation_glyph (hb_font_t *font HB_UNUSED,
+hb_ft_get_variation_glyph (hb_font_t *font,
 			   void *font_data,
 			   hb_codepoint_t unicode,
 			   hb_codepoint_t variation_selector,
@@ -428,8 +635,8 @@ hb_ft_get_variation_glyph (hb_font_t *font HB_UNUSED,
 			   void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  unsigned int g = FT_Face_GetCharVariantIndex (ft_font->ft_face, unicode, variation_selector);
+  hb_ft_locked_face_t face (font, ft_font);
+  unsigned int g = FT_Face_GetCharVariantIndex (face.ft_face, unicode, variation_selector);
 
   if (unlikely (!g))
     return false;
@@ -449,45 +656,63 @@ hb_ft_get_glyph_h_advances (hb_font_t* font, void* font_data,
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
   hb_position_t *orig_first_advance = first_advance;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
-  int load_flags = ft_font->load_flags;
-  float x_mult;
-#ifdef HAVE_FT_GET_TRANSFORM
-  if (ft_font->transform)
-  {
-    FT_Matrix matrix;
-    FT_Get_Transform (ft_face, &matrix, nullptr);
-    x_mult = sqrtf ((float)matrix.xx * matrix.xx + (float)matrix.xy * matrix.xy) / 65536.f;
-    x_mult *= font->x_scale < 0 ? -1 : +1;
-  }
-  else
-#endif
-  {
-    x_mult = font->x_scale < 0 ? -1 : +1;
-  }
+  unsigned int i = 0;
 
-  for (unsigned int i = 0; i < count; i++)
-  {
-    FT_Fixed v = 0;
-    hb_codepoint_t glyph = *first_glyph;
+  /* Serve as much as we can from the cache before locking a face. */
+  if (ft_font->advance_cache_valid (font->serial))
+    for (; i < count; i++)
+    {
+      unsigned int cv;
+      if (!ft_font->advance_cache.get (*first_glyph, &cv))
+	break;
+
+      *first_advance = cv;
+      first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
+    }
 
-    unsigned int cv;
-    if (ft_font->advance_cache.get (glyph, &cv))
-      v = cv;
+  if (i < count)
+  {
+    hb_ft_locked_face_t face (font, ft_font);
+    FT_Face ft_face = face.ft_face;
+    int load_flags = ft_font->load_flags;
+    float x_mult;
+#ifdef HAVE_FT_GET_TRANSFORM
+    if (face.transform)
+    {
+      FT_Matrix matrix;
+      FT_Get_Transform (ft_face, &matrix, nullptr);
+      x_mult = sqrtf ((float)matrix.xx * matrix.xx + (float)matrix.xy * matrix.xy) / 65536.f;
+      x_mult *= font->x_scale < 0 ? -1 : +1;
+    }
     else
+#endif
     {
-      FT_Get_Advance (ft_face, glyph, load_flags, &v);
-      /* Work around bug that FreeType seems to return negative advance
-       * for variable-set fonts if x_scale is negative! */
-      v = abs (v);
-      v = (int) (v * x_mult + (1<<9)) >> 10;
-      ft_font->advance_cache.set (glyph, v);
+      x_mult = font->x_scale < 0 ? -1 : +1;
     }
 
-    *first_advance = v;
-    first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
-    first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
+    for (; i < count; i++)
+    {
+      FT_Fixed v = 0;
+      hb_codepoint_t glyph = *first_glyph;
+
+      unsigned int cv;
+      if (ft_font->advance_cache.get (glyph, &cv))
+	v = cv;
+      else
+      {
+	FT_Get_Advance (ft_face, glyph, load_flags, &v);
+	/* Work around bug that FreeType seems to return negative advance
+	 * for variable-set fonts if x_scale is negative! */
+	v = abs (v);
+	v = (int) (v * x_mult + (1<<9)) >> 10;
+	ft_font->advance_cache.set (glyph, v);
+      }
+
+      *first_advance = v;
+      first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
+    }
   }
 
   if (font->x_strength && !font->embolden_in_place)
@@ -511,14 +736,15 @@ hb_ft_get_glyph_v_advance (hb_font_t *font,
 			   void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
   FT_Fixed v;
   float y_mult;
 #ifdef HAVE_FT_GET_TRANSFORM
-  if (ft_font->transform)
+  if (face.transform)
   {
     FT_Matrix matrix;
-    FT_Get_Transform (ft_font->ft_face, &matrix, nullptr);
+    FT_Get_Transform (ft_face, &matrix, nullptr);
     y_mult = sqrtf ((float)matrix.yx * matrix.yx + (float)matrix.yy * matrix.yy) / 65536.f;
     y_mult *= font->y_scale < 0 ? -1 : +1;
   }
@@ -528,7 +754,7 @@ hb_ft_get_glyph_v_advance (hb_font_t *font,
     y_mult = font->y_scale < 0 ? -1 : +1;
   }
 
-  if (unlikely (FT_Get_Advance (ft_font->ft_face, glyph, ft_font->load_flags | FT_LOAD_VERTICAL_LAYOUT, &v)))
+  if (unlikely (FT_Get_Advance (ft_face, glyph, ft_font->load_flags | FT_LOAD_VERTICAL_LAYOUT, &v)))
     return 0;
 
   v = (int) (y_mult * v);
@@ -551,11 +777,11 @@ hb_ft_get_glyph_v_origin (hb_font_t *font,
 			  void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
   float x_mult, y_mult;
 #ifdef HAVE_FT_GET_TRANSFORM
-  if (ft_font->transform)
+  if (face.transform)
   {
     FT_Matrix matrix;
     FT_Get_Transform (ft_face, &matrix, nullptr);
@@ -595,11 +821,11 @@ hb_ft_get_glyph_h_kerning (hb_font_t *font,
 			   void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
+  hb_ft_locked_face_t face (font, ft_font);
   FT_Vector kerningv;
 
   FT_Kerning_Mode mode = font->x_ppem ? FT_KERNING_DEFAULT : FT_KERNING_UNFITTED;
-  if (FT_Get_Kerning (ft_font->ft_face, left_glyph, right_glyph, mode, &kerningv))
+  if (FT_Get_Kerning (face.ft_face, left_glyph, right_glyph, mode, &kerningv))
     return 0;
 
   return kerningv.x;
@@ -614,12 +840,15 @@ hb_ft_get_glyph_extents (hb_font_t *font,
 			 void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
+  if (ft_font->extents_cache.get (font->serial, glyph, extents))
+    return true;
+
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
   float x_mult, y_mult;
   float slant_xy = font->slant_xy;
 #ifdef HAVE_FT_GET_TRANSFORM
-  if (ft_font->transform)
+  if (face.transform)
   {
     FT_Matrix matrix;
     FT_Get_Transform (ft_face, &matrix, nullptr);
@@ -673,11 +902,14 @@ hb_ft_get_glyph_extents (hb_font_t *font,
     extents->width += x_shift;
   }
 
+  hb_lock_t cache_lock (ft_font->cache_lock);
+  ft_font->extents_cache.set (font->serial, glyph, *extents);
+
   return true;
 }
 
 static hb_bool_t
-hb_ft_get_glyph_contour_point (hb_font_t *font HB_UNUSED,
+hb_ft_get_glyph_contour_point (hb_font_t *font,
 			       void *font_data,
 			       hb_codepoint_t glyph,
 			       unsigned int point_index,
@@ -686,8 +918,8 @@ hb_ft_get_glyph_contour_point (hb_font_t *font HB_UNUSED,
 			       void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
 
   if (unlikely (FT_Load_Glyph (ft_face, glyph, ft_font->load_flags)))
       return false;
@@ -705,15 +937,15 @@ hb_ft_get_glyph_contour_point (hb_font_t *font HB_UNUSED,
 }
 
 static hb_bool_t
-hb_ft_get_glyph_name (hb_font_t *font HB_UNUSED,
+hb_ft_get_glyph_name (hb_font_t *font,
 		      void *font_data,
 		      hb_codepoint_t glyph,
 		      char *name, unsigned int size,
 		      void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
 
   hb_bool_t ret = !FT_Get_Glyph_Name (ft_face, glyph, name, size);
   if (ret && (size && !*name))
@@ -723,15 +955,15 @@ hb_ft_get_glyph_name (hb_font_t *font HB_UNUSED,
 }
 
 static hb_bool_t
-hb_ft_get_glyph_from_name (hb_font_t *font HB_UNUSED,
+hb_ft_get_glyph_from_name (hb_font_t *font,
 			   void *font_data,
 			   const char *name, int len, /* -1 means nul-terminated */
 			   hb_codepoint_t *glyph,
 			   void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
 
   if (len < 0)
     *glyph = FT_Get_Name_Index (ft_face, (FT_String *) name);
@@ -757,17 +989,17 @@ hb_ft_get_glyph_from_name (hb_font_t *font HB_UNUSED,
 }
 
 static hb_bool_t
-hb_ft_get_font_h_extents (hb_font_t *font HB_UNUSED,
+hb_ft_get_font_h_extents (hb_font_t *font,
 			  void *font_data,
 			  hb_font_extents_t *metrics,
 			  void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
   float y_mult;
 #ifdef HAVE_FT_GET_TRANSFORM
-  if (ft_font->transform)
+  if (face.transform)
   {
     FT_Matrix matrix;
     FT_Get_Transform (ft_face, &matrix, nullptr);
@@ -853,8 +1085,8 @@ hb_ft_draw_glyph (hb_font_t *font,
 		  void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
+  hb_ft_locked_face_t face (font, ft_font);
+  FT_Face ft_face = face.ft_face;
 
   if (unlikely (FT_Load_Glyph (ft_face, glyph,
 			       FT_LOAD_NO_BITMAP | ft_font->load_flags)))
@@ -1336,6 +1568,7 @@ hb_ft_font_changed (hb_font_t *font)
 #endif
 
   ft_font->advance_cache.clear ();
+  ft_font->extents_cache.clear ();
   ft_font->cached_serial = font->serial;
 }
 
@@ -1494,7 +1727,107 @@ hb_ft_font_set_funcs (hb_font_t *font)
   _hb_ft_font_set_funcs (font, ft_face, true);
   hb_ft_font_set_load_flags (font, FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING);
 
-  _hb_ft_hb_font_changed (font, ft_face);
+  if (_hb_ft_hb_font_changed (font, ft_face) &&
+      font->destroy == (hb_destroy_func_t) _hb_ft_font_destroy)
+    ((hb_ft_font_t *) font->user_data)->transform = true;
+}
+
+/**
+ * hb_ft_font_set_face_clones:
+ * @font: #hb_font_t to work upon
+ * @num_clones: Number of extra FT_Face objects to use, or zero
+ *
+ * Makes @font use @num_clones FT_Face objects of its own, opened
+ * with FT_New_Memory_Face() over the blob of the font's #hb_face_t,
+ * instead of its main FT_Face for the font functions.  Each clone has
+ * its own lock, so threads sharing @font only contend when they end up
+ * on the same clone.  Glyph advances and extents are additionally
+ * cached per font and read without taking any lock.
+ *
+ * Clones are set up from the #hb_font_t settings (scale, variations,
+ * ...), and pick up changes to it automatically; changes made directly
+ * to the main FT_Face are not seen by them.  Painting, and access via
+ * hb_ft_font_lock_face(), always use the main FT_Face.
+ *
+ * Passing zero for @num_clones removes existing clones.
+ *
+ * This function works with #hb_font_t objects created by
+ * hb_ft_font_create(), hb_ft_font_create_referenced() or configured
+ * with hb_ft_font_set_funcs().  It is not thread-safe; call it before
+ * sharing @font between threads.
+ *
+ * Return value: `true` if the clones were created, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ft_font_set_face_clones (hb_font_t    *font,
+			    unsigned int  num_clones)
+{
+  if (hb_object_is_immutable (font))
+    return false;
+
+  if (unlikely (font->destroy != (hb_destroy_func_t) _hb_ft_font_destroy))
+    return false;
+
+  hb_ft_font_t *ft_font = (hb_ft_font_t *) font->user_data;
+
+  _hb_ft_font_destroy_clones (ft_font);
+  ft_font->advance_cache.clear ();
+  if (!num_clones)
+    return true;
+
+  hb_ft_face_clone_t *clones = (hb_ft_face_clone_t *) hb_calloc (num_clones, sizeof (hb_ft_face_clone_t));
+  if (unlikely (!clones))
+    return false;
+
+  FT_Face ft_face = ft_font->ft_face;
+  int charmap_index = ft_face->charmap ? FT_Get_Charmap_Index (ft_face->charmap) : -1;
+
+  /* For faces not backed by a blob, this loads the whole font file;
+   * do it once and share the data between all clones. */
+  hb_blob_t *blob = hb_face_reference_blob (font->face);
+  unsigned int blob_length;
+  const char *blob_data = hb_blob_get_data (blob, &blob_length);
+
+  unsigned int i;
+  for (i = 0; i < num_clones; i++)
+  {
+    FT_Face clone = nullptr;
+    if (unlikely (!blob_length ||
+		  FT_New_Memory_Face (get_ft_library (),
+				      (const FT_Byte *) blob_data,
+				      blob_length,
+				      hb_face_get_index (font->face),
+				      &clone)))
+    {
+      DEBUG_MSG (FT, font, "Font face clone FT_New_Memory_Face() failed");
+      break;
+    }
+
+    clone->generic.data = hb_blob_reference (blob);
+    clone->generic.finalizer = _release_blob;
+
+    if (charmap_index >= 0 && charmap_index < clone->num_charmaps)
+      FT_Set_Charmap (clone, clone->charmaps[charmap_index]);
+
+    clones[i].lock.init ();
+    clones[i].ft_face = clone;
+    clones[i].cached_serial = (unsigned) -1;
+  }
+  hb_blob_destroy (blob);
+
+  ft_font->clones = clones;
+  ft_font->num_clones = i;
+
+  if (unlikely (i < num_clones))
+  {
+    _hb_ft_font_destroy_clones (ft_font);
+    return false;
+  }
+
+  ft_font->advance_serial.set_relaxed (-1);
+  return true;
 }
 
 #endif
@@ -68,13 +68,12 @@ struct hb_hashmap_t
   struct item_t
   {
     K key;
-    uint32_t is_real_ : 1;
     uint32_t is_used_ : 1;
-    uint32_t hash : 30;
+    uint32_t hash : 31;
     V value;
 
     item_t () : key (),
-		is_real_ (false), is_used_ (false),
+		is_used_ (false),
 		hash (0),
 		value () {}
 
@@ -84,8 +83,8 @@ struct hb_hashmap_t
 
     bool is_used () const { return is_used_; }
     void set_used (bool is_used) { is_used_ = is_used; }
-    void set_real (bool is_real) { is_real_ = is_real; }
-    bool is_real () const { return is_real_; }
+    /* There are no tombstones; every used item is real. */
+    bool is_real () const { return is_used_; }
 
     template <bool v = minus_one,
 	      hb_enable_if (v == false)>
@@ -104,7 +103,7 @@ struct hb_hashmap_t
     hb_pair_t<const K &, V &> get_pair_ref() { return hb_pair_t<const K &, V &> (key, value); }
 
     uint32_t total_hash () const
-    { return (hash * 31) + hb_hash (value); }
+    { return ((uint32_t) hash * 31) + hb_hash (value); }
 
     static constexpr bool is_trivial = std::is_trivially_constructible<K>::value &&
 				       std::is_trivially_destructible<K>::value &&
@@ -114,10 +113,9 @@ struct hb_hashmap_t
 
   hb_object_header_t header;
   unsigned int successful : 1; /* Allocations successful */
-  unsigned int population : 31; /* Not including tombstones. */
-  unsigned int occupancy; /* Including tombstones. */
+  unsigned int population : 31;
   unsigned int mask;
-  unsigned int prime;
+  unsigned int shift; /* 31 - log2 (size) */
   unsigned int max_chain_length;
   item_t *items;
 
@@ -129,9 +127,8 @@ struct hb_hashmap_t
     a.population = b.population;
     b.population = tmp;
     //hb_swap (a.population, b.population);
-    hb_swap (a.occupancy, b.occupancy);
     hb_swap (a.mask, b.mask);
-    hb_swap (a.prime, b.prime);
+    hb_swap (a.shift, b.shift);
     hb_swap (a.max_chain_length, b.max_chain_length);
     hb_swap (a.items, b.items);
   }
@@ -140,9 +137,9 @@ struct hb_hashmap_t
     hb_object_init (this);
 
     successful = true;
-    population = occupancy = 0;
+    population = 0;
     mask = 0;
-    prime = 0;
+    shift = 31;
     max_chain_length = 0;
     items = nullptr;
   }
@@ -159,7 +156,7 @@ struct hb_hashmap_t
       hb_free (items);
       items = nullptr;
     }
-    population = occupancy = 0;
+    population = 0;
   }
 
   void reset ()
@@ -194,20 +191,20 @@ struct hb_hashmap_t
     item_t *old_items = items;
 
     /* Switch to new, empty, array. */
-    population = occupancy = 0;
+    population = 0;
     mask = new_size - 1;
-    prime = prime_for (power);
+    shift = 31 - power;
     max_chain_length = power * 2;
     items = new_items;
 
     /* Insert back old items. */
     for (unsigned int i = 0; i < old_size; i++)
     {
-      if (old_items[i].is_real ())
+      if (old_items[i].is_used ())
       {
-	set_with_hash (std::move (old_items[i].key),
-		       old_items[i].hash,
-		       std::move (old_items[i].value));
+	insert_with_mixed_hash (std::move (old_items[i].key),
+				old_items[i].hash,
+				std::move (old_items[i].value));
       }
       if (!item_t::is_trivial)
 	old_items[i].~item_t ();
@@ -218,17 +215,33 @@ struct hb_hashmap_t
     return true;
   }
 
+  /* Items store their hash after a multiplicative (Fibonacci) mix, and
+   * the home bucket is its top bits.  That spreads even poor hashes over
+   * a power-of-two table without the division a prime modulus needs.
+   *
+   * Collisions are resolved with Robin Hood linear probing: items in a
+   * chain are kept ordered by their home bucket, so a lookup can stop as
+   * soon as it meets an item closer to home than itself, and deletion
+   * shifts the rest of the chain back instead of leaving tombstones. */
+  static uint32_t mix_hash (uint32_t hash) { return (hash * 2654435769u) >> 1; }
+  unsigned probe_distance (unsigned i) const
+  { return (i - (items[i].hash >> shift)) & mask; }
+
   template <typename KK, typename VV>
   bool set_with_hash (KK&& key, uint32_t hash, VV&& value, bool overwrite = true)
+  {
+    return insert_with_mixed_hash (std::forward<KK> (key), mix_hash (hash),
+				   std::forward<VV> (value), overwrite);
+  }
+
+  template <typename KK, typename VV>
+  bool insert_with_mixed_hash (KK&& key, uint32_t hash, VV&& value, bool overwrite = true)
   {
     if (unlikely (!successful)) return false;
-    if (unlikely ((occupancy + occupancy / 2) >= mask && !alloc ())) return false;
+    if (unlikely (((unsigned) population + population / 2) >= mask && !alloc ())) return false;
 
-    hash &= 0x3FFFFFFF; // We only store lower 30bit of hash
-    unsigned int tombstone = (unsigned int) -1;
-    unsigned int i = hash % prime;
+    unsigned int i = hash >> shift;
     unsigned length = 0;
-    unsigned step = 0;
     while (items[i].is_used ())
     {
       if ((std::is_integral<K>::value || items[i].hash == hash) &&
@@ -236,33 +249,35 @@ struct hb_hashmap_t
       {
         if (!overwrite)
 	  return false;
-        else
-	  break;
+	items[i].key = std::forward<KK> (key);
+	items[i].value = std::forward<VV> (value);
+	return true;
       }
-      if (!items[i].is_real () && tombstone == (unsigned) -1)
-        tombstone = i;
-      i = (i + ++step) & mask;
+      if (probe_distance (i) < length)
+	break;
+      i = (i + 1) & mask;
       length++;
     }
 
-    item_t &item = items[tombstone == (unsigned) -1 ? i : tombstone];
-
-    if (item.is_used ())
+    if (items[i].is_used ())
     {
-      occupancy--;
-      population -= item.is_real ();
+      /* Make room by shifting the rest of the chain down by one. */
+      unsigned end = i;
+      while (items[end].is_used ())
+	end = (end + 1) & mask;
+      for (unsigned j = end; j != i; j = (j - 1) & mask)
+	items[j] = std::move (items[(j - 1) & mask]);
     }
 
+    item_t &item = items[i];
     item.key = std::forward<KK> (key);
     item.value = std::forward<VV> (value);
     item.hash = hash;
     item.set_used (true);
-    item.set_real (true);
 
-    occupancy++;
     population++;
 
-    if (unlikely (length > max_chain_length) && occupancy * 8 > mask)
+    if (unlikely (length > max_chain_length) && (unsigned) population * 8 > mask)
       alloc (mask - 8); // This ensures we jump to next larger size
 
     return true;
@@ -280,7 +295,7 @@ struct hb_hashmap_t
   const V& get_with_hash (const K &key, uint32_t hash) const
   {
     if (!items) return item_t::default_value ();
-    auto *item = fetch_item (key, hb_hash (key));
+    auto *item = fetch_item (key, hash);
     if (item)
       return item->value;
     return item_t::default_value ();
@@ -295,11 +310,21 @@ struct hb_hashmap_t
   {
     if (!items) return;
     auto *item = fetch_item (key, hb_hash (key));
-    if (item)
+    if (!item) return;
+
+    /* Backward-shift the rest of the chain over the deleted item. */
+    unsigned i = item - items;
+    for (;;)
     {
-      item->set_real (false);
-      population--;
+      unsigned j = (i + 1) & mask;
+      if (!items[j].is_used () || !probe_distance (j))
+	break;
+      items[i] = std::move (items[j]);
+      i = j;
     }
+    items[i].~item_t ();
+    new (&items[i]) item_t ();
+    population--;
   }
 
   /* Has interface. */
@@ -318,20 +343,18 @@ struct hb_hashmap_t
   }
   item_t *fetch_item (const K &key, uint32_t hash) const
   {
-    hash &= 0x3FFFFFFF; // We only store lower 30bit of hash
-    unsigned int i = hash % prime;
-    unsigned step = 0;
+    hash = mix_hash (hash);
+    unsigned int i = hash >> shift;
+    unsigned length = 0;
     while (items[i].is_used ())
     {
       if ((std::is_integral<K>::value || items[i].hash == hash) &&
 	  items[i] == key)
-      {
-	if (items[i].is_real ())
-	  return &items[i];
-	else
-	  return nullptr;
-      }
-      i = (i + ++step) & mask;
+	return &items[i];
+      if (probe_distance (i) < length)
+	return nullptr;
+      i = (i + 1) & mask;
+      length++;
     }
     return nullptr;
   }
@@ -351,7 +374,7 @@ struct hb_hashmap_t
       new (&_) item_t ();
     }
 
-    population = occupancy = 0;
+    population = 0;
   }
 
   bool is_empty () const { return population == 0; }
@@ -460,57 +483,6 @@ struct hb_hashmap_t
   { set (std::move (v.first), v.second); return *this; }
   hb_hashmap_t& operator << (const hb_pair_t<K&&, V&&>& v)
   { set (std::move (v.first), std::move (v.second)); return *this; }
-
-  static unsigned int prime_for (unsigned int shift)
-  {
-    /* Following comment and table copied from glib. */
-    /* Each table size has an associated prime modulo (the first prime
-     * lower than the table size) used to find the initial bucket. Probing
-     * then works modulo 2^n. The prime modulo is necessary to get a
-     * good distribution with poor hash functions.
-     */
-    /* Not declaring static to make all kinds of compilers happy... */
-    /*static*/ const unsigned int prime_mod [32] =
-    {
-      1,          /* For 1 << 0 */
-      2,
-      3,
-      7,
-      13,
-      31,
-      61,
-      127,
-      251,
-      509,
-      1021,
-      2039,
-      4093,
-      8191,
-      16381,
-      32749,
-      65521,      /* For 1 << 16 */
-      131071,
-      262139,
-      524287,
-      1048573,
-      2097143,
-      4194301,
-      8388593,
-      16777213,
-      33554393,
-      67108859,
-      134217689,
-      268435399,
-      536870909,
-      1073741789,
-      2147483647  /* For 1 << 31 */
-    };
-
-    if (unlikely (shift >= ARRAY_LENGTH (prime_mod)))
-      return prime_mod[ARRAY_LENGTH (prime_mod) - 1];
-
-    return prime_mod[shift];
-  }
 };
 
 /*
@@ -537,5 +509,91 @@ struct hb_map_t : hb_hashmap_t<hb_codepoint_t,
   hb_map_t (const Iterable &o) : hashmap (o) {}
 };
 
+/*
+ * hb_dense_map_t
+ *
+ * Read-only lookup view of an hb_map_t.  When the keys of the map are
+ * dense enough, values are copied into a flat array indexed by key and
+ * lookups become a bounds-check plus a load; otherwise lookups fall
+ * through to the hash map.  Iteration always goes through the wrapped
+ * map.  The wrapped map must not be modified after init().
+ */
+
+struct hb_dense_map_t
+{
+  /* Use the flat array if it costs at most this many slots per key. */
+  static constexpr unsigned DENSITY_FACTOR = 4;
+
+  hb_dense_map_t () = default;
+  hb_dense_map_t (const hb_dense_map_t &) = delete;
+  hb_dense_map_t& operator= (const hb_dense_map_t &) = delete;
+
+  const hb_map_t *map = nullptr;
+  hb_vector_t<hb_codepoint_t> array;
+
+  void init (const hb_map_t *map_)
+  {
+    map = map_;
+    array.resize (0);
+
+    unsigned population = map->get_population ();
+    if (!population) return;
+
+    hb_codepoint_t max_key = 0;
+    for (hb_codepoint_t k : map->keys ())
+      max_key = hb_max (max_key, k);
+    if (max_key / DENSITY_FACTOR >= population) return;
+
+    if (unlikely (!array.resize_exact (max_key + 1, false)))
+    {
+      /* Not fatal; keep using the hash map. */
+      array.reset ();
+      return;
+    }
+    hb_memset (array.arrayZ, 0xFF, array.get_size ());
+    for (auto _ : map->iter ())
+      array.arrayZ[_.first] = _.second;
+  }
+
+  bool in_error () const { return map && map->in_error (); }
+  bool is_dense () const { return array.length; }
+
+  hb_codepoint_t get (hb_codepoint_t k) const
+  {
+    if (array.length)
+      return likely (k < array.length) ? array.arrayZ[k] : HB_MAP_VALUE_INVALID;
+    return map ? map->get (k) : HB_MAP_VALUE_INVALID;
+  }
+  bool has (hb_codepoint_t k, const hb_codepoint_t **vp = nullptr) const
+  {
+    if (array.length)
+    {
+      if (unlikely (k >= array.length) || array.arrayZ[k] == HB_MAP_VALUE_INVALID)
+	return false;
+      if (vp) *vp = &array.arrayZ[k];
+      return true;
+    }
+    hb_codepoint_t *v;
+    if (!map || !map->has (k, &v)) return false;
+    if (vp) *vp = v;
+    return true;
+  }
+
+  /* Has interface. */
+  hb_codepoint_t operator [] (hb_codepoint_t k) const { return get (k); }
+  /* Projection. */
+  hb_codepoint_t operator () (hb_codepoint_t k) const { return get (k); }
+
+  bool is_empty () const { return !map || map->is_empty (); }
+  explicit operator bool () const { return !is_empty (); }
+  unsigned int get_population () const { return map ? map->get_population () : 0; }
+
+  /* Iterators; only valid after init(). */
+  auto iter () const HB_AUTO_RETURN (map->iter ())
+  auto keys () const HB_AUTO_RETURN (map->keys ())
+  auto values () const HB_AUTO_RETURN (map->values ())
+};
+
+
 
 #endif /* HB_MAP_HH */
@@ -41,7 +41,7 @@ namespace GPOS_impl {
 template <typename context_t>
 /*static*/ typename context_t::return_t PosLookup::dispatch_recurse_func (context_t *c, unsigned int lookup_index)
 {
-  const PosLookup &l = c->face->table.GPOS.get_relaxed ()->table->get_lookup (lookup_index);
+  const PosLookup &l = c->face->table.GPOS.get_relaxed ()->get_lookup (lookup_index);
   return l.dispatch (c);
 }
 
@@ -49,7 +49,7 @@ template <>
 inline hb_closure_lookups_context_t::return_t
 PosLookup::dispatch_recurse_func<hb_closure_lookups_context_t> (hb_closure_lookups_context_t *c, unsigned this_index)
 {
-  const PosLookup &l = c->face->table.GPOS.get_relaxed ()->table->get_lookup (this_index);
+  const PosLookup &l = c->face->table.GPOS.get_relaxed ()->get_lookup (this_index);
   return l.closure_lookups (c, this_index);
 }
 
@@ -57,7 +57,7 @@ template <>
 inline bool PosLookup::dispatch_recurse_func<hb_ot_apply_context_t> (hb_ot_apply_context_t *c, unsigned int lookup_index)
 {
   auto *gpos = c->face->table.GPOS.get_relaxed ();
-  const PosLookup &l = gpos->table->get_lookup (lookup_index);
+  const PosLookup &l = gpos->get_lookup (lookup_index);
   unsigned int saved_lookup_props = c->lookup_props;
   unsigned int saved_lookup_index = c->lookup_index;
   c->set_lookup_index (lookup_index);
@@ -2411,7 +2411,7 @@ struct ContextFormat1_4
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto *out = c->serializer->start_embed (*this);
     if (unlikely (!c->serializer->extend_min (out))) return_trace (false);
@@ -3601,7 +3601,7 @@ struct ChainContextFormat1_4
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = *c->plan->glyphset_gsub ();
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto *out = c->serializer->start_embed (*this);
     if (unlikely (!c->serializer->extend_min (out))) return_trace (false);
@@ -4766,8 +4766,40 @@ struct GSUBGPOS
     {
       hb_sanitize_context_t sc;
       sc.lazy_some_gpos = true;
+#ifndef HB_NO_GETENV
+      /* In lazy mode only the top-level lists and the lookup headers are
+       * sanitized here; each lookup's subtables are sanitized the first
+       * time the lookup is fetched.  See is_lookup_sane(). */
+      sc.lazy_lookups = hb_options ().lazy_layout_sanitize;
+#endif
       this->table = sc.reference_table<T> (face);
 
+      if (sc.lazy_lookups && table->get_lookup_count ())
+      {
+	/* Two bitmaps: lookups verified sane, followed by lookups verified insane. */
+	this->verdict_words = (table->get_lookup_count () + 31) / 32;
+	this->verdicts = (hb_atomic_int_t *) hb_calloc (2 * this->verdict_words, sizeof (*verdicts));
+	if (likely (this->verdicts))
+	{
+	  this->num_glyphs = face->get_num_glyphs ();
+	  unsigned m;
+	  if (unlikely (hb_unsigned_mul_overflows (table.get_length (), HB_SANITIZE_MAX_OPS_FACTOR, &m)))
+	    m = HB_SANITIZE_MAX_OPS_MAX;
+	  this->sanitize_ops_left = (int) hb_clamp (m,
+						    (unsigned) HB_SANITIZE_MAX_OPS_MIN,
+						    (unsigned) HB_SANITIZE_MAX_OPS_MAX);
+	}
+	else
+	{
+	  /* Can't cache verdicts; sanitize everything upfront instead. */
+	  this->verdict_words = 0;
+	  this->table.destroy ();
+	  hb_sanitize_context_t eager;
+	  eager.lazy_some_gpos = true;
+	  this->table = eager.reference_table<T> (face);
+	}
+      }
+
       if (unlikely (this->table->is_blocklisted (this->table.get_blob (), face)))
       {
 	hb_blob_destroy (this->table.get_blob ());
@@ -4789,6 +4821,7 @@ struct GSUBGPOS
       for (unsigned int i = 0; i < this->lookup_count; i++)
 	hb_free (this->accels[i]);
       hb_free (this->accels);
+      hb_free (this->verdicts);
       this->table.destroy ();
     }
 
@@ -4802,7 +4835,7 @@ struct GSUBGPOS
       auto *accel = accels[lookup_index].get_acquire ();
       if (unlikely (!accel))
       {
-	accel = hb_ot_layout_lookup_accelerator_t::create (table->get_lookup (lookup_index));
+	accel = hb_ot_layout_lookup_accelerator_t::create (get_lookup (lookup_index));
 	if (unlikely (!accel))
 	  return nullptr;
 
@@ -4816,9 +4849,73 @@ struct GSUBGPOS
       return accel;
     }
 
+    /* Lookups must be fetched through here, not through table, since in lazy
+     * mode the table itself only guarantees the lookup headers are sane. */
+    const typename T::Lookup& get_lookup (unsigned lookup_index) const
+    {
+      if (unlikely (!is_lookup_sane (lookup_index)))
+	return Null (typename T::Lookup);
+      return table->get_lookup (lookup_index);
+    }
+
+    /* In lazy mode the sanitizer budgets, for ops and for subtables
+     * visited, are shared by all lookups, like eager sanitizing shares them
+     * across the table.  The difference
+     * is what happens when it runs out: eager sanitizing drops the whole
+     * table, while here only the lookups not checked by then are treated
+     * as empty; lookups already found sane keep applying. */
+    bool is_lookup_sane (unsigned lookup_index) const
+    {
+      if (likely (!verdict_words) || unlikely (lookup_index >= lookup_count))
+	return true;
+
+      /* Verdicts are only ever recorded, never revoked, so a racing
+       * update that drops another thread's bit merely causes that
+       * lookup to be sanitized again. */
+      unsigned word = lookup_index / 32;
+      int bit = 1 << (lookup_index % 32);
+      if (verdicts[word].get_relaxed () & bit) return true;
+      if (verdicts[verdict_words + word].get_relaxed () & bit) return false;
+
+      bool sane = sanitize_lookup (lookup_index);
+      hb_atomic_int_t &w = verdicts[sane ? word : verdict_words + word];
+      w.set_relaxed (w.get_relaxed () | bit);
+      return sane;
+    }
+
+    private:
+    bool sanitize_lookup (unsigned lookup_index) const
+    {
+      int ops = sanitize_ops_left.get_relaxed ();
+      if (unlikely (ops <= 0)) return false;
+
+      /* The blob is immutable by now, so a lookup that would need
+       * neutering fails as a whole and is treated as empty. */
+      hb_sanitize_context_t c (table.get_blob ());
+      c.set_num_glyphs (num_glyphs);
+      c.set_max_ops (ops);
+      c.max_subtables = sanitize_subtables.get_relaxed ();
+      c.lazy_some_gpos = true;
+      bool sane = c.dispatch (table->get_lookup (lookup_index));
+
+      /* One budget for the whole table, same as eager sanitizing.  Lookups
+       * sanitized on several threads at once may each spend from the same
+       * remainder, so it is only approximate then. */
+      sanitize_ops_left.set_relaxed (hb_max (c.max_ops, 0));
+      sanitize_subtables.set_relaxed (c.max_subtables);
+      return sane;
+    }
+
+    public:
     hb_blob_ptr_t<T> table;
     unsigned int lookup_count;
     hb_atomic_ptr_t<hb_ot_layout_lookup_accelerator_t> *accels;
+    private:
+    unsigned int verdict_words = 0;
+    hb_atomic_int_t *verdicts = nullptr;
+    unsigned int num_glyphs = 0;
+    mutable hb_atomic_int_t sanitize_ops_left;
+    mutable hb_atomic_int_t sanitize_subtables;
   };
 
   protected:
@@ -89,9 +89,9 @@ hb_ot_map_builder_t::hb_ot_map_builder_t (hb_face_t *face_,
 
 hb_ot_map_builder_t::~hb_ot_map_builder_t ()
 {
-  feature_infos.fini ();
-  for (unsigned int table_index = 0; table_index < 2; table_index++)
-    stages[table_index].fini ();
+  /* feature_infos and stages clean up after themselves; finishing them
+   * here as well trips GCC's -Wfree-nonheap-object on their inline
+   * storage. */
 }
 
 void hb_ot_map_builder_t::add_feature (hb_tag_t tag,
@@ -289,8 +289,8 @@ struct hb_ot_map_builder_t
   private:
 
   unsigned int current_stage[2]; /* GSUB/GPOS */
-  hb_vector_t<feature_info_t> feature_infos;
-  hb_vector_t<stage_info_t> stages[2]; /* GSUB/GPOS */
+  hb_small_vector_t<feature_info_t, 32> feature_infos;
+  hb_small_vector_t<stage_info_t, 8> stages[2]; /* GSUB/GPOS */
 };
 
 
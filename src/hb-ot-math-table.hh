@@ -201,7 +201,7 @@ struct MathItalicsCorrectionInfo
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = c->plan->_glyphset_mathed;
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto *out = c->serializer->start_embed (*this);
     if (unlikely (!c->serializer->extend_min (out))) return_trace (false);
@@ -254,7 +254,7 @@ struct MathTopAccentAttachment
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = c->plan->_glyphset_mathed;
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto *out = c->serializer->start_embed (*this);
     if (unlikely (!c->serializer->extend_min (out))) return_trace (false);
@@ -485,7 +485,7 @@ struct MathKernInfo
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = c->plan->_glyphset_mathed;
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto *out = c->serializer->start_embed (*this);
     if (unlikely (!c->serializer->extend_min (out))) return_trace (false);
@@ -566,7 +566,7 @@ struct MathGlyphInfo
     out->mathTopAccentAttachment.serialize_subset (c, mathTopAccentAttachment, this);
 
     const hb_set_t &glyphset = c->plan->_glyphset_mathed;
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto it =
     + hb_iter (this+extendedShapeCoverage)
@@ -656,7 +656,7 @@ struct MathGlyphVariantRecord
     auto *out = c->serializer->embed (this);
     if (unlikely (!out)) return_trace (false);
 
-    const hb_map_t& glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t& glyph_map = c->plan->glyph_map_dense;
     return_trace (c->serializer->check_assign (out->variantGlyph, glyph_map.get (variantGlyph), HB_SERIALIZE_ERROR_INT_OVERFLOW));
   }
 
@@ -699,7 +699,7 @@ struct MathGlyphPartRecord
     auto *out = c->serializer->embed (this);
     if (unlikely (!out)) return_trace (false);
 
-    const hb_map_t& glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t& glyph_map = c->plan->glyph_map_dense;
     return_trace (c->serializer->check_assign (out->glyph, glyph_map.get (glyph), HB_SERIALIZE_ERROR_INT_OVERFLOW));
   }
 
@@ -915,7 +915,7 @@ struct MathVariants
                                      unsigned end_index,
                                      hb_set_t& indices,
                                      const hb_set_t& glyphset,
-                                     const hb_map_t& glyph_map) const
+                                     const hb_dense_map_t& glyph_map) const
   {
     if (!coverage) return;
 
@@ -936,7 +936,7 @@ struct MathVariants
   {
     TRACE_SUBSET (this);
     const hb_set_t &glyphset = c->plan->_glyphset_mathed;
-    const hb_map_t &glyph_map = *c->plan->glyph_map;
+    const hb_dense_map_t &glyph_map = c->plan->glyph_map_dense;
 
     auto *out = c->serializer->start_embed (*this);
     if (unlikely (!c->serializer->extend_min (out))) return_trace (false);
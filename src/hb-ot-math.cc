@@ -31,6 +31,248 @@
 #include "hb-ot-math-table.hh"
 
 
+#ifndef HB_NO_OT_MATH_CACHE
+/* Per-font cache of resolved MATH glyph data.
+ *
+ * Equation layout asks for the constructions and kern ladders of the same
+ * few operators over and over; each of those is a coverage lookup plus
+ * device-table resolution.  The cache holds the fully scaled results per
+ * glyph, in fixed buckets of lockfree lists; items are immutable once
+ * published.  Scale, variations and ppem all feed into the values, so the
+ * font drops the whole cache when any of them changes.  Until then nothing
+ * is evicted, so a bucket stops taking new items once it holds
+ * MATH_CACHE_BUCKET_LENGTH of them; glyphs that don't fit are resolved
+ * uncached every time. */
+
+enum hb_ot_math_cache_kind_t
+{
+  MATH_CACHE_HORIZONTAL_CONSTRUCTION,
+  MATH_CACHE_VERTICAL_CONSTRUCTION,
+  MATH_CACHE_KERN /* + hb_ot_math_kern_t */
+};
+
+struct hb_ot_math_cache_item_t
+{
+  hb_ot_math_cache_item_t *next;
+  hb_codepoint_t glyph;
+  unsigned int kind;
+  /* Variants, or kern entries. */
+  unsigned int count;
+  unsigned int parts_count;
+  hb_position_t italics_correction;
+  /* Followed by count variants then parts_count parts, or count kern entries. */
+
+  const hb_ot_math_glyph_variant_t *variants () const
+  { return (const hb_ot_math_glyph_variant_t *) (this + 1); }
+  const hb_ot_math_glyph_part_t *parts () const
+  { return (const hb_ot_math_glyph_part_t *) (variants () + count); }
+  const hb_ot_math_kern_entry_t *kern_entries () const
+  { return (const hb_ot_math_kern_entry_t *) (this + 1); }
+
+  /* Same search as OT::MathKern::get_value(), over the scaled ladder. */
+  hb_position_t get_kerning (hb_position_t correction_height, hb_font_t *font) const
+  {
+    if (!count) return 0;
+    const hb_ot_math_kern_entry_t *entries = kern_entries ();
+    int sign = font->y_scale < 0 ? -1 : +1;
+
+    unsigned int i = 0;
+    unsigned int n = count - 1;
+    while (n > 0)
+    {
+      unsigned int half = n / 2;
+      if (sign * entries[i + half].max_correction_height < sign * correction_height)
+      {
+	i += half + 1;
+	n -= half + 1;
+      } else
+	n = half;
+    }
+    return entries[i].kern_value;
+  }
+};
+
+static constexpr unsigned MATH_CACHE_BUCKETS = 64;
+static constexpr unsigned MATH_CACHE_BUCKET_LENGTH = 8;
+
+struct hb_ot_math_cache_t
+{
+  hb_atomic_ptr_t<hb_ot_math_cache_item_t> buckets[MATH_CACHE_BUCKETS];
+};
+
+void
+hb_ot_math_cache_destroy (hb_ot_math_cache_t *cache)
+{
+  if (!cache) return;
+  for (unsigned i = 0; i < MATH_CACHE_BUCKETS; i++)
+  {
+    hb_ot_math_cache_item_t *item = cache->buckets[i].get_relaxed ();
+    while (item)
+    {
+      hb_ot_math_cache_item_t *next = item->next;
+      hb_free (item);
+      item = next;
+    }
+  }
+  hb_free (cache);
+}
+
+static hb_ot_math_cache_t *
+_hb_ot_math_get_cache (hb_font_t *font)
+{
+  if (unlikely (font->header.is_inert ()))
+    return nullptr;
+
+retry:
+  hb_ot_math_cache_t *cache = font->math_cache.get_acquire ();
+  if (likely (cache))
+    return cache;
+
+  cache = (hb_ot_math_cache_t *) hb_calloc (1, sizeof (hb_ot_math_cache_t));
+  if (unlikely (!cache))
+    return nullptr;
+
+  if (unlikely (!font->math_cache.cmpexch (nullptr, cache)))
+  {
+    hb_free (cache);
+    goto retry;
+  }
+  return cache;
+}
+
+static hb_ot_math_cache_item_t *
+_hb_ot_math_resolve_construction (hb_font_t *font,
+				  hb_codepoint_t glyph,
+				  hb_direction_t direction)
+{
+  const OT::MathVariants &variants = font->face->table.MATH->get_variants ();
+
+  unsigned int count = variants.get_glyph_variants (glyph, direction, font, 0, nullptr, nullptr);
+  unsigned int parts_count = variants.get_glyph_parts (glyph, direction, font, 0, nullptr, nullptr, nullptr);
+
+  hb_ot_math_cache_item_t *item = (hb_ot_math_cache_item_t *)
+    hb_calloc (1, sizeof (hb_ot_math_cache_item_t) +
+		  count * sizeof (hb_ot_math_glyph_variant_t) +
+		  parts_count * sizeof (hb_ot_math_glyph_part_t));
+  if (unlikely (!item))
+    return nullptr;
+
+  item->count = count;
+  item->parts_count = parts_count;
+  variants.get_glyph_variants (glyph, direction, font, 0, &count,
+			       const_cast<hb_ot_math_glyph_variant_t *> (item->variants ()));
+  variants.get_glyph_parts (glyph, direction, font, 0, &parts_count,
+			    const_cast<hb_ot_math_glyph_part_t *> (item->parts ()),
+			    &item->italics_correction);
+  return item;
+}
+
+static hb_ot_math_cache_item_t *
+_hb_ot_math_resolve_kernings (hb_font_t *font,
+			      hb_codepoint_t glyph,
+			      hb_ot_math_kern_t kern)
+{
+  const OT::MathGlyphInfo &info = font->face->table.MATH->get_glyph_info ();
+
+  unsigned int count = info.get_kernings (glyph, kern, 0, nullptr, nullptr, font);
+
+  hb_ot_math_cache_item_t *item = (hb_ot_math_cache_item_t *)
+    hb_calloc (1, sizeof (hb_ot_math_cache_item_t) +
+		  count * sizeof (hb_ot_math_kern_entry_t));
+  if (unlikely (!item))
+    return nullptr;
+
+  item->count = count;
+  info.get_kernings (glyph, kern, 0, &count,
+		     const_cast<hb_ot_math_kern_entry_t *> (item->kern_entries ()),
+		     font);
+  return item;
+}
+
+static const hb_ot_math_cache_item_t *
+_hb_ot_math_cache_find_or_insert (hb_font_t *font,
+				  hb_codepoint_t glyph,
+				  unsigned int kind)
+{
+  hb_ot_math_cache_t *cache = _hb_ot_math_get_cache (font);
+  if (unlikely (!cache))
+    return nullptr;
+
+  uint32_t h = hb_hash (glyph) ^ kind;
+  hb_atomic_ptr_t<hb_ot_math_cache_item_t> &bucket = cache->buckets[h % MATH_CACHE_BUCKETS];
+
+retry:
+  hb_ot_math_cache_item_t *first = bucket;
+
+  unsigned length = 0;
+  for (hb_ot_math_cache_item_t *item = first; item; item = item->next, length++)
+    if (item->glyph == glyph && item->kind == kind)
+      return item;
+  if (length >= MATH_CACHE_BUCKET_LENGTH)
+    return nullptr;
+
+  /* Not found; resolve and insert. */
+  hb_ot_math_cache_item_t *item;
+  if (kind >= MATH_CACHE_KERN)
+    item = _hb_ot_math_resolve_kernings (font, glyph, (hb_ot_math_kern_t) (kind - MATH_CACHE_KERN));
+  else
+    item = _hb_ot_math_resolve_construction (font, glyph,
+					     kind == MATH_CACHE_VERTICAL_CONSTRUCTION ?
+					     HB_DIRECTION_TTB : HB_DIRECTION_LTR);
+  if (unlikely (!item))
+    return nullptr;
+  item->next = first;
+  item->glyph = glyph;
+  item->kind = kind;
+
+  if (unlikely (!bucket.cmpexch (first, item)))
+  {
+    hb_free (item);
+    goto retry;
+  }
+
+  return item;
+}
+
+static const hb_ot_math_cache_item_t *
+_hb_ot_math_get_construction (hb_font_t *font,
+			      hb_codepoint_t glyph,
+			      hb_direction_t direction)
+{
+  return _hb_ot_math_cache_find_or_insert (font, glyph,
+					   HB_DIRECTION_IS_VERTICAL (direction) ?
+					   MATH_CACHE_VERTICAL_CONSTRUCTION :
+					   MATH_CACHE_HORIZONTAL_CONSTRUCTION);
+}
+
+static const hb_ot_math_cache_item_t *
+_hb_ot_math_get_kernings (hb_font_t *font,
+			  hb_codepoint_t glyph,
+			  hb_ot_math_kern_t kern)
+{
+  if (unlikely ((unsigned) kern > HB_OT_MATH_KERN_BOTTOM_LEFT))
+    return nullptr;
+  return _hb_ot_math_cache_find_or_insert (font, glyph, MATH_CACHE_KERN + (unsigned) kern);
+}
+
+template <typename Type>
+static unsigned int
+_hb_ot_math_copy_out (const Type *array, unsigned int len,
+		      unsigned int start_offset,
+		      unsigned int *count, /* IN/OUT */
+		      Type *out /* OUT */)
+{
+  if (count)
+  {
+    unsigned int start = hb_min (start_offset, len);
+    *count = hb_min (*count, len - start);
+    hb_memcpy (out, array + start, *count * sizeof (Type));
+  }
+  return len;
+}
+#endif
+
+
 /**
  * SECTION:hb-ot-math
  * @title: hb-ot-math
@@ -178,6 +420,11 @@ hb_ot_math_get_glyph_kerning (hb_font_t *font,
 			      hb_ot_math_kern_t kern,
 			      hb_position_t correction_height)
 {
+#ifndef HB_NO_OT_MATH_CACHE
+  const hb_ot_math_cache_item_t *item = _hb_ot_math_get_kernings (font, glyph, kern);
+  if (likely (item))
+    return item->get_kerning (correction_height, font);
+#endif
   return font->face->table.MATH->get_glyph_info().get_kerning (glyph,
 							       kern,
 							       correction_height,
@@ -221,6 +468,12 @@ hb_ot_math_get_glyph_kernings (hb_font_t *font,
 			       unsigned int *entries_count, /* IN/OUT */
 			       hb_ot_math_kern_entry_t *kern_entries /* OUT */)
 {
+#ifndef HB_NO_OT_MATH_CACHE
+  const hb_ot_math_cache_item_t *item = _hb_ot_math_get_kernings (font, glyph, kern);
+  if (likely (item))
+    return _hb_ot_math_copy_out (item->kern_entries (), item->count,
+				 start_offset, entries_count, kern_entries);
+#endif
   return font->face->table.MATH->get_glyph_info().get_kernings (glyph,
 								kern,
 								start_offset,
@@ -260,6 +513,12 @@ hb_ot_math_get_glyph_variants (hb_font_t *font,
 			       unsigned int *variants_count, /* IN/OUT */
 			       hb_ot_math_glyph_variant_t *variants /* OUT */)
 {
+#ifndef HB_NO_OT_MATH_CACHE
+  const hb_ot_math_cache_item_t *item = _hb_ot_math_get_construction (font, glyph, direction);
+  if (likely (item))
+    return _hb_ot_math_copy_out (item->variants (), item->count,
+				 start_offset, variants_count, variants);
+#endif
   return font->face->table.MATH->get_variants().get_glyph_variants (glyph, direction, font,
 								    start_offset,
 								    variants_count,
@@ -325,6 +584,16 @@ hb_ot_math_get_glyph_assembly (hb_font_t *font,
 			       hb_ot_math_glyph_part_t *parts, /* OUT */
 			       hb_position_t *italics_correction /* OUT */)
 {
+#ifndef HB_NO_OT_MATH_CACHE
+  const hb_ot_math_cache_item_t *item = _hb_ot_math_get_construction (font, glyph, direction);
+  if (likely (item))
+  {
+    if (italics_correction)
+      *italics_correction = item->italics_correction;
+    return _hb_ot_math_copy_out (item->parts (), item->parts_count,
+				 start_offset, parts_count, parts);
+  }
+#endif
   return font->face->table.MATH->get_variants().get_glyph_parts (glyph,
 								 direction,
 								 font,
@@ -335,4 +604,68 @@ hb_ot_math_get_glyph_assembly (hb_font_t *font,
 }
 
 
+/**
+ * hb_ot_math_get_glyph_construction:
+ * @font: #hb_font_t to work upon
+ * @glyph: The index of the glyph to stretch
+ * @direction: direction of the stretching (horizontal or vertical)
+ * @variants_count: (inout) (optional): Input = the maximum number of variants to return;
+ *                                      Output = the total number of variants available
+ * @variants: (out) (array length=variants_count) (optional): array of variants returned
+ * @parts_count: (inout) (optional): Input = the maximum number of glyph parts to return;
+ *                                   Output = the total number of parts in the glyph assembly
+ * @parts: (out) (array length=parts_count) (optional): the glyph parts returned
+ * @italics_correction: (out) (optional): italics correction of the glyph assembly
+ * @min_connector_overlap: (out) (optional): minimum connector overlap for @direction
+ *
+ * Fetches everything needed to stretch @glyph in @direction in one call:
+ * the size variants of hb_ot_math_get_glyph_variants(), the glyph assembly
+ * of hb_ot_math_get_glyph_assembly(), and the minimum connector overlap of
+ * hb_ot_math_get_min_connector_overlap().
+ *
+ * Unlike those functions, @variants_count and @parts_count are set to the
+ * totals available; if a total is larger than the input value, only as many
+ * items as the input value are written and the caller can retry with a larger
+ * array.
+ *
+ * <note>The @direction parameter is only used to select between horizontal
+ * or vertical directions for the construction. Even though all #hb_direction_t
+ * values are accepted, only the result of #HB_DIRECTION_IS_HORIZONTAL is
+ * considered.</note>
+ *
+ * Return value: `true` if @glyph has size variants or a glyph assembly in
+ * @direction, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ot_math_get_glyph_construction (hb_font_t *font,
+				   hb_codepoint_t glyph,
+				   hb_direction_t direction,
+				   unsigned int *variants_count, /* IN/OUT */
+				   hb_ot_math_glyph_variant_t *variants, /* OUT */
+				   unsigned int *parts_count, /* IN/OUT */
+				   hb_ot_math_glyph_part_t *parts, /* OUT */
+				   hb_position_t *italics_correction, /* OUT */
+				   hb_position_t *min_connector_overlap /* OUT */)
+{
+  if (min_connector_overlap)
+    *min_connector_overlap = hb_ot_math_get_min_connector_overlap (font, direction);
+
+  unsigned int num_variants = variants_count && variants ? *variants_count : 0;
+  unsigned int num_parts = parts_count && parts ? *parts_count : 0;
+
+  unsigned int total_variants = hb_ot_math_get_glyph_variants (font, glyph, direction, 0,
+							       &num_variants, variants);
+  unsigned int total_parts = hb_ot_math_get_glyph_assembly (font, glyph, direction, 0,
+							    &num_parts, parts,
+							    italics_correction);
+
+  if (variants_count) *variants_count = total_variants;
+  if (parts_count) *parts_count = total_parts;
+
+  return total_variants || total_parts;
+}
+
+
 #endif
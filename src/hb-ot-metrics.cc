@@ -56,10 +56,10 @@ _fix_ascender_descender (float value, hb_ot_metrics_tag_t metrics_tag)
 
 /* The common part of _get_position logic needed on hb-ot-font and here
    to be able to have slim builds without the not always needed parts */
-bool
-_hb_ot_metrics_get_position_common (hb_font_t           *font,
-				    hb_ot_metrics_tag_t  metrics_tag,
-				    hb_position_t       *position     /* OUT.  May be NULL. */)
+static bool
+_hb_ot_metrics_get_position_common_uncached (hb_font_t           *font,
+					     hb_ot_metrics_tag_t  metrics_tag,
+					     hb_position_t       *position     /* OUT.  May be NULL. */)
 {
   hb_face_t *face = font->face;
   switch ((unsigned) metrics_tag)
@@ -122,21 +122,10 @@ _get_gasp (hb_face_t *face, float *result, hb_ot_metrics_tag_t metrics_tag)
 #define _HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP_OS2   HB_TAG ('O','l','g','p')
 #define _HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP_HHEA  HB_TAG ('H','l','g','p')
 
-/**
- * hb_ot_metrics_get_position:
- * @font: an #hb_font_t object.
- * @metrics_tag: tag of metrics value you like to fetch.
- * @position: (out) (optional): result of metrics value from the font.
- *
- * Fetches metrics value corresponding to @metrics_tag from @font.
- *
- * Returns: Whether found the requested metrics in the font.
- * Since: 2.6.0
- **/
-hb_bool_t
-hb_ot_metrics_get_position (hb_font_t           *font,
-			    hb_ot_metrics_tag_t  metrics_tag,
-			    hb_position_t       *position     /* OUT.  May be NULL. */)
+static hb_bool_t
+_hb_ot_metrics_get_position_uncached (hb_font_t           *font,
+				      hb_ot_metrics_tag_t  metrics_tag,
+				      hb_position_t       *position     /* OUT.  May be NULL. */)
 {
   hb_face_t *face = font->face;
   switch ((unsigned) metrics_tag)
@@ -146,7 +135,7 @@ hb_ot_metrics_get_position (hb_font_t           *font,
   case HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP:
   case HB_OT_METRICS_TAG_VERTICAL_ASCENDER:
   case HB_OT_METRICS_TAG_VERTICAL_DESCENDER:
-  case HB_OT_METRICS_TAG_VERTICAL_LINE_GAP:           return _hb_ot_metrics_get_position_common (font, metrics_tag, position);
+  case HB_OT_METRICS_TAG_VERTICAL_LINE_GAP:           return _hb_ot_metrics_get_position_common_uncached (font, metrics_tag, position);
 #ifndef HB_NO_VAR
 #define GET_VAR hb_ot_metrics_get_variation (font, metrics_tag)
 #else
@@ -237,6 +226,178 @@ hb_ot_metrics_get_position (hb_font_t           *font,
   default:                                        return false;
   }
 }
+#endif
+
+
+#ifndef HB_NO_OT_METRICS_CACHE
+/* Every metric hb_ot_metrics_get_position() serves, resolved for a font's
+ * current scale, slant and variation coordinates.  Built the first time a
+ * metric is asked for, and dropped by hb_font_t::mults_changed() whenever
+ * any of those change, so MVAR is only consulted once per font state. */
+
+#ifndef HB_NO_VERTICAL
+#define HB_OT_METRICS_CACHE_VERTICAL_TAGS \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_VERTICAL_ASCENDER) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_VERTICAL_DESCENDER) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_VERTICAL_LINE_GAP)
+#else
+#define HB_OT_METRICS_CACHE_VERTICAL_TAGS
+#endif
+#define HB_OT_METRICS_CACHE_COMMON_TAGS \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP) \
+  HB_OT_METRICS_CACHE_VERTICAL_TAGS
+
+#ifndef HB_NO_METRICS
+#define HB_OT_METRICS_CACHE_TAGS \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_CLIPPING_ASCENT) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_CLIPPING_DESCENT) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_CARET_RISE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_CARET_RUN) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_HORIZONTAL_CARET_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_VERTICAL_CARET_RISE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_VERTICAL_CARET_RUN) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_VERTICAL_CARET_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_X_HEIGHT) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_CAP_HEIGHT) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUBSCRIPT_EM_X_SIZE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUBSCRIPT_EM_Y_SIZE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUBSCRIPT_EM_X_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUBSCRIPT_EM_Y_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUPERSCRIPT_EM_X_SIZE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUPERSCRIPT_EM_Y_SIZE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUPERSCRIPT_EM_X_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_SUPERSCRIPT_EM_Y_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_STRIKEOUT_SIZE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_STRIKEOUT_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_UNDERLINE_SIZE) \
+  HB_OT_METRICS_CACHE_TAG (HB_OT_METRICS_TAG_UNDERLINE_OFFSET) \
+  HB_OT_METRICS_CACHE_TAG (_HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER_OS2) \
+  HB_OT_METRICS_CACHE_TAG (_HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER_HHEA) \
+  HB_OT_METRICS_CACHE_TAG (_HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER_OS2) \
+  HB_OT_METRICS_CACHE_TAG (_HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER_HHEA) \
+  HB_OT_METRICS_CACHE_TAG (_HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP_OS2) \
+  HB_OT_METRICS_CACHE_TAG (_HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP_HHEA)
+#else
+#define HB_OT_METRICS_CACHE_TAGS
+#endif
+
+struct hb_ot_metrics_snapshot_t
+{
+  enum slot_t
+  {
+#define HB_OT_METRICS_CACHE_TAG(tag) SLOT_##tag,
+    HB_OT_METRICS_CACHE_COMMON_TAGS
+    HB_OT_METRICS_CACHE_TAGS
+#undef HB_OT_METRICS_CACHE_TAG
+    SLOT_COUNT
+  };
+
+  static int get_slot (hb_ot_metrics_tag_t metrics_tag)
+  {
+    switch ((unsigned) metrics_tag)
+    {
+#define HB_OT_METRICS_CACHE_TAG(tag) case tag: return SLOT_##tag;
+    HB_OT_METRICS_CACHE_COMMON_TAGS
+    HB_OT_METRICS_CACHE_TAGS
+#undef HB_OT_METRICS_CACHE_TAG
+    default: return -1;
+    }
+  }
+
+  void init (hb_font_t *font)
+  {
+#define HB_OT_METRICS_CACHE_TAG(tag) \
+    found[SLOT_##tag] = _hb_ot_metrics_get_position_common_uncached (font, (hb_ot_metrics_tag_t) tag, &positions[SLOT_##tag]);
+    HB_OT_METRICS_CACHE_COMMON_TAGS
+#undef HB_OT_METRICS_CACHE_TAG
+#ifndef HB_NO_METRICS
+#define HB_OT_METRICS_CACHE_TAG(tag) \
+    found[SLOT_##tag] = _hb_ot_metrics_get_position_uncached (font, (hb_ot_metrics_tag_t) tag, &positions[SLOT_##tag]);
+    HB_OT_METRICS_CACHE_TAGS
+#undef HB_OT_METRICS_CACHE_TAG
+#endif
+  }
+
+  bool get_position (int slot, hb_position_t *position) const
+  {
+    if (!found[slot])
+      return false;
+    if (position)
+      *position = positions[slot];
+    return true;
+  }
+
+  hb_position_t positions[SLOT_COUNT];
+  bool found[SLOT_COUNT];
+};
+
+static const hb_ot_metrics_snapshot_t *
+_hb_ot_metrics_get_snapshot (hb_font_t *font)
+{
+  if (unlikely (font->header.is_inert ()))
+    return nullptr;
+
+retry:
+  hb_ot_metrics_snapshot_t *snapshot = font->metrics_snapshot.get_acquire ();
+  if (likely (snapshot))
+    return snapshot;
+
+  snapshot = (hb_ot_metrics_snapshot_t *) hb_calloc (1, sizeof (hb_ot_metrics_snapshot_t));
+  if (unlikely (!snapshot))
+    return nullptr;
+  snapshot->init (font);
+
+  if (unlikely (!font->metrics_snapshot.cmpexch (nullptr, snapshot)))
+  {
+    hb_free (snapshot);
+    goto retry;
+  }
+  return snapshot;
+}
+#endif
+
+bool
+_hb_ot_metrics_get_position_common (hb_font_t           *font,
+				    hb_ot_metrics_tag_t  metrics_tag,
+				    hb_position_t       *position     /* OUT.  May be NULL. */)
+{
+#ifndef HB_NO_OT_METRICS_CACHE
+  int slot = hb_ot_metrics_snapshot_t::get_slot (metrics_tag);
+  const hb_ot_metrics_snapshot_t *snapshot;
+  if (likely (slot >= 0 && (snapshot = _hb_ot_metrics_get_snapshot (font))))
+    return snapshot->get_position (slot, position);
+#endif
+  return _hb_ot_metrics_get_position_common_uncached (font, metrics_tag, position);
+}
+
+#ifndef HB_NO_METRICS
+
+/**
+ * hb_ot_metrics_get_position:
+ * @font: an #hb_font_t object.
+ * @metrics_tag: tag of metrics value you like to fetch.
+ * @position: (out) (optional): result of metrics value from the font.
+ *
+ * Fetches metrics value corresponding to @metrics_tag from @font.
+ *
+ * Returns: Whether found the requested metrics in the font.
+ * Since: 2.6.0
+ **/
+hb_bool_t
+hb_ot_metrics_get_position (hb_font_t           *font,
+			    hb_ot_metrics_tag_t  metrics_tag,
+			    hb_position_t       *position     /* OUT.  May be NULL. */)
+{
+#ifndef HB_NO_OT_METRICS_CACHE
+  int slot = hb_ot_metrics_snapshot_t::get_slot (metrics_tag);
+  const hb_ot_metrics_snapshot_t *snapshot;
+  if (likely (slot >= 0 && (snapshot = _hb_ot_metrics_get_snapshot (font))))
+    return snapshot->get_position (slot, position);
+#endif
+  return _hb_ot_metrics_get_position_uncached (font, metrics_tag, position);
+}
 
 /**
  * hb_ot_metrics_get_position_with_fallback:
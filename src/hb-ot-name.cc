@@ -64,6 +64,42 @@ hb_ot_name_list_names (hb_face_t    *face,
   return (const hb_ot_name_entry_t *) name.names;
 }
 
+#ifndef HB_NO_OT_NAME_CACHE
+/* Whether a code unit continues a character rather than starting one. */
+static inline bool
+hb_ot_name_is_trailing (uint8_t u)
+{ return (u & 0xC0u) == 0x80u; }
+static inline bool
+hb_ot_name_is_trailing (uint16_t u)
+{ return hb_in_range<unsigned> (u, 0xDC00u, 0xDFFFu); }
+static inline bool
+hb_ot_name_is_trailing (uint32_t u HB_UNUSED)
+{ return false; }
+
+/* Copies a cached string out the way hb_ot_name_convert_utf() would have
+ * written it: truncated to whole characters that fit, NUL-terminated. */
+template <typename utf_t>
+static inline unsigned int
+hb_ot_name_copy_decoded (const OT::name_accelerator_t::decoded_t *decoded,
+			 unsigned int *text_size /* IN/OUT */,
+			 typename utf_t::codepoint_t *text /* OUT */)
+{
+  const typename utf_t::codepoint_t *src = decoded->text<utf_t> ();
+
+  if (text_size && *text_size)
+  {
+    unsigned int len = hb_min (*text_size - 1, decoded->length);
+    if (len < decoded->length)
+      while (len && hb_ot_name_is_trailing (src[len]))
+	len--;
+    hb_memcpy (text, src, len * sizeof (*src));
+    text[len] = 0;
+    *text_size = len;
+  }
+  return decoded->length;
+}
+#endif
+
 template <typename utf_t>
 static inline unsigned int
 hb_ot_name_get_utf (hb_face_t       *face,
@@ -77,17 +113,15 @@ hb_ot_name_get_utf (hb_face_t       *face,
   if (!language)
     language = hb_language_from_string ("en", 2);
 
-  unsigned int width;
-  int idx = name.get_index (name_id, language, &width);
-  if (idx != -1)
+  int entry = name.get_entry (name_id, language);
+  if (entry != -1)
   {
-    hb_bytes_t bytes = name.get_name (idx);
-
-    if (width == 2) /* UTF16-BE */
-      return OT::hb_ot_name_convert_utf<hb_utf16_be_t, utf_t> (bytes, text_size, text);
-
-    if (width == 1) /* ASCII */
-      return OT::hb_ot_name_convert_utf<hb_ascii_t, utf_t> (bytes, text_size, text);
+#ifndef HB_NO_OT_NAME_CACHE
+    const OT::name_accelerator_t::decoded_t *decoded = name.get_decoded<utf_t> (entry);
+    if (likely (decoded))
+      return hb_ot_name_copy_decoded<utf_t> (decoded, text_size, text);
+#endif
+    return name.convert_entry<utf_t> (entry, text_size, text);
   }
 
   if (text_size)
@@ -181,4 +215,70 @@ hb_ot_name_get_utf32 (hb_face_t       *face,
   return hb_ot_name_get_utf<hb_utf32_t> (face, name_id, language, text_size, text);
 }
 
+/**
+ * hb_ot_name_collect_utf8:
+ * @blob: a font file or font collection.
+ * @name_ids: (array length=name_ids_count): name identifiers to fetch.
+ * @name_ids_count: number of entries in @name_ids.
+ * @language: language to fetch the names for.
+ * @func: (scope call): callback to receive the names.
+ * @user_data: data to pass to @func.
+ *
+ * Fetches the requested names from every face in @blob, in UTF-8, in a
+ * single pass.  For each face, in order, @func is called once for each of
+ * @name_ids that the face has a name for; missing names are skipped.
+ * If @language is #HB_LANGUAGE_INVALID, English ("en") is assumed, with
+ * the same fallback as hb_ot_name_get_utf8().
+ *
+ * This is meant for listing many font files: faces are only opened long
+ * enough to read their name table, and strings are converted without
+ * populating the per-face name cache.
+ *
+ * Returns: the number of faces in @blob.
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_ot_name_collect_utf8 (hb_blob_t                 *blob,
+			 const hb_ot_name_id_t     *name_ids,
+			 unsigned int               name_ids_count,
+			 hb_language_t              language,
+			 hb_ot_name_collect_func_t  func,
+			 void                      *user_data)
+{
+  if (!language)
+    language = hb_language_from_string ("en", 2);
+
+  unsigned int face_count = hb_face_count (blob);
+  hb_vector_t<char> text;
+  bool stop = false;
+
+  for (unsigned int face_index = 0; face_index < face_count && !stop; face_index++)
+  {
+    hb_face_t *face = hb_face_create (blob, face_index);
+    const OT::name_accelerator_t &name = *face->table.name;
+
+    for (unsigned int i = 0; i < name_ids_count; i++)
+    {
+      int entry = name.get_entry (name_ids[i], language);
+      if (entry == -1)
+	continue;
+
+      unsigned int text_size = name.convert_entry<hb_utf8_t> (entry, nullptr, nullptr) + 1;
+      if (unlikely (!text.resize (text_size, false)))
+	continue;
+      name.convert_entry<hb_utf8_t> (entry, &text_size, (uint8_t *) text.arrayZ);
+
+      if (!func (face_index, name_ids[i], text.arrayZ, text_size, user_data))
+      {
+	stop = true;
+	break;
+      }
+    }
+
+    hb_face_destroy (face);
+  }
+
+  return face_count;
+}
+
 #endif
@@ -71,7 +71,7 @@ HB_INTERNAL bool postV2Tail::subset (hb_subset_context_t *c) const
 {
   TRACE_SUBSET (this);
 
-  const hb_map_t &reverse_glyph_map = *c->plan->reverse_glyph_map;
+  const hb_dense_map_t &reverse_glyph_map = c->plan->reverse_glyph_map_dense;
   unsigned num_glyphs = c->plan->num_output_glyphs ();
   hb_map_t old_new_index_map, old_gid_new_index_map;
   unsigned i = 0;
@@ -409,30 +409,13 @@ parse_private_use_subtag (const char     *private_use_subtag,
   return true;
 }
 
-/**
- * hb_ot_tags_from_script_and_language:
- * @script: an #hb_script_t to convert.
- * @language: (nullable): an #hb_language_t to convert.
- * @script_count: (inout) (optional): maximum number of script tags to retrieve (IN)
- * and actual number of script tags retrieved (OUT)
- * @script_tags: (out) (optional): array of size at least @script_count to store the
- * script tag results
- * @language_count: (inout) (optional): maximum number of language tags to retrieve
- * (IN) and actual number of language tags retrieved (OUT)
- * @language_tags: (out) (optional): array of size at least @language_count to store
- * the language tag results
- *
- * Converts an #hb_script_t and an #hb_language_t to script and language tags.
- *
- * Since: 2.0.0
- **/
-void
-hb_ot_tags_from_script_and_language (hb_script_t   script,
-				     hb_language_t language,
-				     unsigned int *script_count /* IN/OUT */,
-				     hb_tag_t     *script_tags /* OUT */,
-				     unsigned int *language_count /* IN/OUT */,
-				     hb_tag_t     *language_tags /* OUT */)
+static void
+hb_ot_tags_from_script_and_language_impl (hb_script_t   script,
+					  hb_language_t language,
+					  unsigned int *script_count /* IN/OUT */,
+					  hb_tag_t     *script_tags /* OUT */,
+					  unsigned int *language_count /* IN/OUT */,
+					  hb_tag_t     *language_tags /* OUT */)
 {
   bool needs_script = true;
 
@@ -484,6 +467,142 @@ hb_ot_tags_from_script_and_language (hb_script_t   script,
     hb_ot_all_tags_from_script (script, script_count, script_tags);
 }
 
+#ifndef HB_NO_OT_TAG_CACHE
+/* Cache of resolved tags, keyed by script and language.
+ *
+ * Like the language list in hb-common.cc, a fixed number of buckets, each
+ * a lockfree list; entries are immutable once published and only freed at
+ * exit.  Since nothing is evicted, a bucket stops taking new entries once
+ * it holds TAGS_CACHE_BUCKET_LENGTH of them; pairs that don't fit are
+ * resolved uncached every time. */
+
+struct hb_ot_tags_cache_item_t
+{
+  hb_ot_tags_cache_item_t *next;
+  hb_script_t script;
+  hb_language_t language;
+  unsigned int script_count;
+  unsigned int language_count;
+  hb_tag_t script_tags[HB_OT_MAX_TAGS_PER_SCRIPT];
+  hb_tag_t language_tags[HB_OT_MAX_TAGS_PER_LANGUAGE];
+};
+
+static constexpr unsigned TAGS_CACHE_BUCKETS = 64;
+static constexpr unsigned TAGS_CACHE_BUCKET_LENGTH = 8;
+static hb_atomic_ptr_t<hb_ot_tags_cache_item_t> tags_cache[TAGS_CACHE_BUCKETS];
+static hb_atomic_int_t tags_cache_atexit;
+
+static inline void
+free_tags_cache ()
+{
+  for (unsigned i = 0; i < TAGS_CACHE_BUCKETS; i++)
+  {
+  retry:
+    hb_ot_tags_cache_item_t *first = tags_cache[i];
+    if (unlikely (!tags_cache[i].cmpexch (first, nullptr)))
+      goto retry;
+
+    while (first)
+    {
+      hb_ot_tags_cache_item_t *next = first->next;
+      hb_free (first);
+      first = next;
+    }
+  }
+}
+
+static const hb_ot_tags_cache_item_t *
+tags_cache_find_or_insert (hb_script_t script, hb_language_t language)
+{
+  uint32_t h = hb_hash ((hb_tag_t) script) ^ hb_hash ((uintptr_t) language);
+  hb_atomic_ptr_t<hb_ot_tags_cache_item_t> &bucket = tags_cache[h % TAGS_CACHE_BUCKETS];
+
+retry:
+  hb_ot_tags_cache_item_t *first = bucket;
+
+  unsigned length = 0;
+  for (hb_ot_tags_cache_item_t *item = first; item; item = item->next, length++)
+    if (item->script == script && item->language == language)
+      return item;
+  if (length >= TAGS_CACHE_BUCKET_LENGTH)
+    return nullptr;
+
+  /* Not found; resolve and insert. */
+  hb_ot_tags_cache_item_t *item = (hb_ot_tags_cache_item_t *) hb_calloc (1, sizeof (hb_ot_tags_cache_item_t));
+  if (unlikely (!item))
+    return nullptr;
+  item->next = first;
+  item->script = script;
+  item->language = language;
+  item->script_count = HB_OT_MAX_TAGS_PER_SCRIPT;
+  item->language_count = HB_OT_MAX_TAGS_PER_LANGUAGE;
+  hb_ot_tags_from_script_and_language_impl (script, language,
+					    &item->script_count, item->script_tags,
+					    &item->language_count, item->language_tags);
+
+  if (unlikely (!bucket.cmpexch (first, item)))
+  {
+    hb_free (item);
+    goto retry;
+  }
+
+  if (!tags_cache_atexit.get_relaxed () && !tags_cache_atexit.inc ())
+    hb_atexit (free_tags_cache); /* First person registers atexit() callback. */
+
+  return item;
+}
+#endif
+
+/**
+ * hb_ot_tags_from_script_and_language:
+ * @script: an #hb_script_t to convert.
+ * @language: (nullable): an #hb_language_t to convert.
+ * @script_count: (inout) (optional): maximum number of script tags to retrieve (IN)
+ * and actual number of script tags retrieved (OUT)
+ * @script_tags: (out) (optional): array of size at least @script_count to store the
+ * script tag results
+ * @language_count: (inout) (optional): maximum number of language tags to retrieve
+ * (IN) and actual number of language tags retrieved (OUT)
+ * @language_tags: (out) (optional): array of size at least @language_count to store
+ * the language tag results
+ *
+ * Converts an #hb_script_t and an #hb_language_t to script and language tags.
+ *
+ * Since: 2.0.0
+ **/
+void
+hb_ot_tags_from_script_and_language (hb_script_t   script,
+				     hb_language_t language,
+				     unsigned int *script_count /* IN/OUT */,
+				     hb_tag_t     *script_tags /* OUT */,
+				     unsigned int *language_count /* IN/OUT */,
+				     hb_tag_t     *language_tags /* OUT */)
+{
+#ifndef HB_NO_OT_TAG_CACHE
+  /* Results for fewer tags are prefixes of the results for the maximum
+   * number of tags, which is what the cache holds. */
+  const hb_ot_tags_cache_item_t *item = tags_cache_find_or_insert (script, language);
+  if (likely (item))
+  {
+    if (script_count && script_tags && *script_count)
+    {
+      *script_count = hb_min (*script_count, item->script_count);
+      hb_memcpy (script_tags, item->script_tags, *script_count * sizeof (hb_tag_t));
+    }
+    if (language_count && language_tags && *language_count)
+    {
+      *language_count = hb_min (*language_count, item->language_count);
+      hb_memcpy (language_tags, item->language_tags, *language_count * sizeof (hb_tag_t));
+    }
+    return;
+  }
+#endif
+
+  hb_ot_tags_from_script_and_language_impl (script, language,
+					    script_count, script_tags,
+					    language_count, language_tags);
+}
+
 /**
  * hb_ot_tag_to_language:
  * @tag: an language tag
@@ -645,10 +764,59 @@ test_langs_sorted ()
 #endif
 }
 
+#ifndef HB_NO_OT_TAG_CACHE
+static inline unsigned
+tags_cache_population ()
+{
+  unsigned population = 0;
+  for (unsigned i = 0; i < TAGS_CACHE_BUCKETS; i++)
+    for (const hb_ot_tags_cache_item_t *item = tags_cache[i]; item; item = item->next)
+      population++;
+  return population;
+}
+
+static inline void
+test_tags_cache ()
+{
+  static const hb_script_t scripts[] = {HB_SCRIPT_LATIN, HB_SCRIPT_ARABIC,
+					HB_SCRIPT_DEVANAGARI, HB_SCRIPT_INVALID};
+  static const char *languages[] = {"en", "fa", "mr", "zh-hant-hk", "x-hbotabcd",
+				    "sr-x-hbscdflt", "und-Latn", ""};
+
+  /* Well past what the cache holds; all must still resolve as uncached. */
+  for (unsigned round = 0; round < 2; round++)
+    for (unsigned i = 0; i < 50 * TAGS_CACHE_BUCKETS; i++)
+    {
+      char s[32];
+      snprintf (s, sizeof (s), "%s-x%u", languages[i % ARRAY_LENGTH (languages)], i);
+      hb_language_t language = hb_language_from_string (s, -1);
+      hb_script_t script = scripts[i % ARRAY_LENGTH (scripts)];
+
+      for (unsigned count = 1; count <= HB_OT_MAX_TAGS_PER_LANGUAGE; count++)
+      {
+	hb_tag_t st[HB_OT_MAX_TAGS_PER_SCRIPT], lt[HB_OT_MAX_TAGS_PER_LANGUAGE];
+	hb_tag_t est[HB_OT_MAX_TAGS_PER_SCRIPT], elt[HB_OT_MAX_TAGS_PER_LANGUAGE];
+	unsigned sc = hb_min (count, (unsigned) HB_OT_MAX_TAGS_PER_SCRIPT), lc = count;
+	unsigned esc = sc, elc = lc;
+	hb_ot_tags_from_script_and_language (script, language, &sc, st, &lc, lt);
+	hb_ot_tags_from_script_and_language_impl (script, language, &esc, est, &elc, elt);
+	assert (sc == esc && lc == elc);
+	assert (!memcmp (st, est, sc * sizeof (st[0])));
+	assert (!memcmp (lt, elt, lc * sizeof (lt[0])));
+      }
+    }
+
+  assert (tags_cache_population () <= TAGS_CACHE_BUCKETS * TAGS_CACHE_BUCKET_LENGTH);
+}
+#endif
+
 int
 main ()
 {
   test_langs_sorted ();
+#ifndef HB_NO_OT_TAG_CACHE
+  test_tags_cache ();
+#endif
   return 0;
 }
 
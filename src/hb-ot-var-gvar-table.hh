@@ -60,12 +60,13 @@ struct contour_point_t
   bool is_end_point;
 };
 
-struct contour_point_vector_t : hb_vector_t<contour_point_t>
+template <unsigned int inline_points>
+struct contour_point_small_vector_t : hb_small_vector_t<contour_point_t, inline_points>
 {
   void extend (const hb_array_t<contour_point_t> &a)
   {
-    unsigned int old_len = length;
-    if (unlikely (!resize (old_len + a.length, false)))
+    unsigned int old_len = this->length;
+    if (unlikely (!this->resize (old_len + a.length, false)))
       return;
     auto arrayZ = this->arrayZ + old_len;
     unsigned count = a.length;
@@ -73,6 +74,12 @@ struct contour_point_vector_t : hb_vector_t<contour_point_t>
   }
 };
 
+/* Holds a whole glyph outline; most simple glyphs fit inline. */
+typedef contour_point_small_vector_t<64> contour_point_vector_t;
+/* Component offsets of one composite glyph, plus phantom points.  Lives
+ * on the stack at every nesting level, so keep it small. */
+typedef contour_point_small_vector_t<8> component_point_vector_t;
+
 struct GlyphVariationData : TupleVariationData
 {};
 
@@ -292,6 +292,19 @@ hb_ot_var_normalize_variations (hb_face_t            *face,
   face->table.avar->map_coords (coords, coords_length);
 }
 
+static void
+_hb_ot_var_normalize_coords (hb_face_t    *face,
+			     unsigned int coords_length,
+			     const float *design_coords, /* IN */
+			     int *normalized_coords /* OUT */)
+{
+  const OT::fvar &fvar = *face->table.fvar;
+  for (unsigned int i = 0; i < coords_length; i++)
+    normalized_coords[i] = fvar.normalize_axis_value (i, design_coords[i]);
+
+  face->table.avar->map_coords (normalized_coords, coords_length);
+}
+
 /**
  * hb_ot_var_normalize_coords:
  * @face: The #hb_face_t to work on
@@ -317,12 +330,128 @@ hb_ot_var_normalize_coords (hb_face_t    *face,
 			    const float *design_coords, /* IN */
 			    int *normalized_coords /* OUT */)
 {
-  const OT::fvar &fvar = *face->table.fvar;
-  for (unsigned int i = 0; i < coords_length; i++)
-    normalized_coords[i] = fvar.normalize_axis_value (i, design_coords[i]);
+#ifndef HB_NO_VAR_COORDS_CACHE
+  if (face->get_normalized_coords (coords_length, design_coords, normalized_coords))
+    return;
+#endif
 
-  face->table.avar->map_coords (normalized_coords, coords_length);
+  _hb_ot_var_normalize_coords (face, coords_length, design_coords, normalized_coords);
+
+#ifndef HB_NO_VAR_COORDS_CACHE
+  face->set_normalized_coords (coords_length, design_coords, normalized_coords);
+#endif
 }
 
+/**
+ * hb_ot_var_normalize_coords_batch:
+ * @face: The #hb_face_t to work on
+ * @coords_length: The number of coordinates in each instance
+ * @instance_count: The number of instances
+ * @design_coords: (array): The design-space coordinates to normalize,
+ *   @coords_length values for each of the @instance_count instances
+ * @normalized_coords: (out) (array): The normalized coordinates, laid out
+ *   like @design_coords
+ *
+ * Normalizes the design-space coordinates of many instances at once, as
+ * hb_ot_var_normalize_coords() would one instance at a time.  Useful to
+ * precompute, for example, the steps of an animation along an axis.
+ *
+ * The instances are not added to the cache of recently normalized
+ * coordinates that hb_ot_var_normalize_coords() keeps for @face.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_ot_var_normalize_coords_batch (hb_face_t    *face,
+				  unsigned int  coords_length,
+				  unsigned int  instance_count,
+				  const float  *design_coords, /* IN */
+				  int          *normalized_coords /* OUT */)
+{
+  if (unlikely (!coords_length))
+    return;
+
+  for (unsigned int n = 0; n < instance_count; n++)
+  {
+    /* Consecutive instances often repeat, eg. when holding a pose. */
+    if (n && !hb_memcmp (design_coords, design_coords - coords_length,
+			 coords_length * sizeof (design_coords[0])))
+      hb_memcpy (normalized_coords, normalized_coords - coords_length,
+		 coords_length * sizeof (normalized_coords[0]));
+    else
+      _hb_ot_var_normalize_coords (face, coords_length, design_coords, normalized_coords);
+
+    design_coords += coords_length;
+    normalized_coords += coords_length;
+  }
+}
+
+#ifndef HB_NO_VAR_COORDS_CACHE
+bool
+hb_face_t::get_normalized_coords (unsigned int coords_length,
+				  const float *design_coords,
+				  int *normalized_coords) const
+{
+  if (unlikely (!coords_length || header.is_inert ()))
+    return false;
+
+  unsigned int size = coords_length * sizeof (design_coords[0]);
+  uint32_t hash = hb_bytes_t ((const char *) design_coords, size).hash ();
+
+  hb_lock_t lock (var_coords_lock);
+  for (unsigned i = 0; i < VAR_COORDS_CACHE_SIZE && var_coords_cache[i]; i++)
+  {
+    var_coords_node_t *node = var_coords_cache[i];
+    if (node->hash != hash ||
+	node->num_coords != coords_length ||
+	hb_memcmp (node->design_coords (), design_coords, size))
+      continue;
+
+    hb_memcpy (normalized_coords, node->normalized_coords (), coords_length * sizeof (normalized_coords[0]));
+
+    /* Move to front. */
+    for (; i; i--)
+      var_coords_cache[i] = var_coords_cache[i - 1];
+    var_coords_cache[0] = node;
+    return true;
+  }
+  return false;
+}
+
+void
+hb_face_t::set_normalized_coords (unsigned int coords_length,
+				  const float *design_coords,
+				  const int *normalized_coords) const
+{
+  if (unlikely (!coords_length || header.is_inert ()))
+    return;
+
+  unsigned int size = coords_length * sizeof (design_coords[0]);
+  var_coords_node_t *node = (var_coords_node_t *) hb_malloc (sizeof (var_coords_node_t) +
+							     coords_length * (sizeof (design_coords[0]) +
+									      sizeof (normalized_coords[0])));
+  if (unlikely (!node))
+    return;
+
+  node->hash = hb_bytes_t ((const char *) design_coords, size).hash ();
+  node->num_coords = coords_length;
+  hb_memcpy (node->design_coords (), design_coords, size);
+  hb_memcpy (node->normalized_coords (), normalized_coords, coords_length * sizeof (normalized_coords[0]));
+
+  hb_lock_t lock (var_coords_lock);
+  hb_free (var_coords_cache[VAR_COORDS_CACHE_SIZE - 1]);
+  for (unsigned i = VAR_COORDS_CACHE_SIZE - 1; i; i--)
+    var_coords_cache[i] = var_coords_cache[i - 1];
+  var_coords_cache[0] = node;
+}
+
+void
+hb_face_t::fini_normalized_coords ()
+{
+  for (unsigned i = 0; i < VAR_COORDS_CACHE_SIZE; i++)
+    hb_free (var_coords_cache[i]);
+  var_coords_lock.fini ();
+}
+#endif
 
 #endif
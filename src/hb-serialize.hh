@@ -88,6 +88,8 @@ struct hb_serialize_context_t
       virtual_links.alloc (o.num_virtual_links, true);
       for (unsigned i = 0; i < o.num_virtual_links; i++)
         virtual_links.push (o.virtual_links[i]);
+
+      rehash_links ();
     }
 #endif
 
@@ -98,6 +100,7 @@ struct hb_serialize_context_t
       hb_swap (a.next, b.next);
       hb_swap (a.real_links, b.real_links);
       hb_swap (a.virtual_links, b.virtual_links);
+      hb_swap (a.links_hash, b.links_hash);
     }
 
     bool operator == (const object_t &o) const
@@ -113,8 +116,7 @@ struct hb_serialize_context_t
     {
       // Virtual links aren't considered for equality since they don't affect the functionality
       // of the object.
-      return hb_bytes_t (head, hb_min (128, tail - head)).hash () ^
-          real_links.as_bytes ().hash ();
+      return hb_bytes_t (head, hb_min (128, tail - head)).hash () ^ links_hash;
     }
 
     struct link_t
@@ -147,13 +149,28 @@ struct hb_serialize_context_t
 
         return ((const link_t*)a)->objidx - ((const link_t*)b)->objidx;
       }
+
+      uint32_t hash () const
+      { return hb_bytes_t ((const char *) this, sizeof (*this)).hash (); }
     };
 
+    /* Real links are hashed as they are added, so that packing an object
+     * with many links doesn't need another pass over them. */
+    void hash_link (const link_t &link)
+    { links_hash = links_hash * 31 + link.hash (); }
+    void rehash_links ()
+    {
+      links_hash = 0;
+      for (const link_t &link : real_links)
+        hash_link (link);
+    }
+
     char *head;
     char *tail;
     hb_vector_t<link_t> real_links;
     hb_vector_t<link_t> virtual_links;
     object_t *next;
+    uint32_t links_hash;
 
     auto all_links () const HB_AUTO_RETURN
         (( hb_concat (this->real_links, this->virtual_links) ));
@@ -200,6 +217,8 @@ struct hb_serialize_context_t
       current = current->next;
       _->fini ();
     }
+
+    link_pool.fini ();
   }
 
   bool in_error () const { return bool (errors); }
@@ -323,6 +342,8 @@ struct hb_serialize_context_t
       obj->head = head;
       obj->tail = tail;
       obj->next = current;
+      if (link_pool.length)
+	obj->real_links = link_pool.pop ();
       current = obj;
     }
     return start_embed<Type> ();
@@ -338,13 +359,14 @@ struct hb_serialize_context_t
     current = current->next;
     revert (zerocopy ? zerocopy : obj->head, obj->tail);
     zerocopy = nullptr;
-    obj->fini ();
-    object_pool.release (obj);
+    release_object (obj);
   }
 
   /* Set share to false when an object is unlikely shareable with others
-   * so not worth an attempt, or a contiguous table is serialized as
-   * multiple consecutive objects in the reverse order so can't be shared.
+   * so not worth an attempt (eg. glyph data or other per-glyph arrays),
+   * or a contiguous table is serialized as multiple consecutive objects
+   * in the reverse order so can't be shared.  Unshared objects skip the
+   * hashing and the packed_map entry altogether.
    */
   objidx_t pop_pack (bool share=true)
   {
@@ -367,6 +389,7 @@ struct hb_serialize_context_t
     {
       assert (!obj->real_links.length);
       assert (!obj->virtual_links.length);
+      release_object (obj);
       return 0;
     }
 
@@ -379,7 +402,7 @@ struct hb_serialize_context_t
       if (objidx)
       {
         merge_virtual_links (obj, objidx);
-	obj->fini ();
+	release_object (obj);
 	return objidx;
       }
     }
@@ -419,7 +442,11 @@ struct hb_serialize_context_t
     assert (snap.current == current);
     if (current)
     {
-      current->real_links.shrink (snap.num_real_links);
+      if (current->real_links.length != snap.num_real_links)
+      {
+	current->real_links.shrink (snap.num_real_links);
+	current->rehash_links ();
+      }
       current->virtual_links.shrink (snap.num_virtual_links);
     }
     errors = snap.errors;
@@ -508,6 +535,7 @@ struct hb_serialize_context_t
       link.whence = 0;
       link.position = 0;
       link.bias = 0;
+      current->hash_link (link);
       return;
     }
 
@@ -515,6 +543,7 @@ struct hb_serialize_context_t
     link.whence = (unsigned) whence;
     link.position = (const char *) &ofs - current->head;
     link.bias = bias;
+    current->hash_link (link);
   }
 
   unsigned to_bias (const void *base) const
@@ -772,9 +801,28 @@ struct hb_serialize_context_t
     }
   }
 
+  /* Returns an object that never made it to packed back to the pool,
+   * keeping its real_links storage around for the next push(). */
+  void release_object (object_t *obj)
+  {
+    if (obj->real_links.allocated &&
+	!obj->real_links.in_error () &&
+	link_pool.length < MAX_LINK_POOL_LEN)
+    {
+      obj->real_links.reset ();
+      link_pool.push (std::move (obj->real_links));
+    }
+    obj->fini ();
+    object_pool.release (obj);
+  }
+
   /* Object memory pool. */
   hb_pool_t<object_t> object_pool;
 
+  /* Spare link vectors of released objects. */
+  static constexpr unsigned MAX_LINK_POOL_LEN = 64;
+  hb_vector_t<hb_vector_t<object_t::link_t>> link_pool;
+
   /* Stack of currently under construction objects. */
   object_t *current;
 
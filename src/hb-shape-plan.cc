@@ -65,16 +65,25 @@ hb_shape_plan_key_t::init (bool                           copy,
 			   unsigned int                   num_user_features,
 			   const int                     *coords,
 			   unsigned int                   num_coords,
-			   const char * const            *shaper_list)
+			   const char * const            *shaper_list,
+			   const hb_feature_set_t        *feature_set)
 {
   hb_feature_t *features = nullptr;
-  if (copy && num_user_features && !(features = (hb_feature_t *) hb_calloc (num_user_features, sizeof (hb_feature_t))))
+  /* Features from a feature set are immutable; share them instead of copying. */
+  bool copy_features = copy && !feature_set;
+  this->user_feature_set = nullptr;
+  if (copy_features && num_user_features && !(features = (hb_feature_t *) hb_calloc (num_user_features, sizeof (hb_feature_t))))
     goto bail;
 
   this->props = *props;
   this->num_user_features = num_user_features;
-  this->user_features = copy ? features : user_features;
-  if (copy && num_user_features)
+  this->user_features = copy_features ? features : user_features;
+  this->user_features_hash = feature_set ? feature_set->hash
+			   : hb_feature_set_t::hash_features (user_features, num_user_features);
+  this->user_feature_set = copy && feature_set
+			 ? hb_feature_set_reference (const_cast<hb_feature_set_t *> (feature_set))
+			 : nullptr;
+  if (copy_features && num_user_features)
   {
     hb_memcpy (features, user_features, num_user_features * sizeof (hb_feature_t));
     /* Make start/end uniform to easier catch bugs. */
@@ -133,14 +142,34 @@ hb_shape_plan_key_t::init (bool                           copy,
 
 bail:
   ::hb_free (features);
+  if (this->user_feature_set)
+  {
+    hb_feature_set_destroy (this->user_feature_set);
+    this->user_feature_set = nullptr;
+  }
   return false;
 }
 
+void
+hb_shape_plan_key_t::fini ()
+{
+  if (user_feature_set)
+    hb_feature_set_destroy (user_feature_set);
+  else
+    hb_free ((void *) user_features);
+  user_feature_set = nullptr;
+  user_features = nullptr;
+}
+
 bool
 hb_shape_plan_key_t::user_features_match (const hb_shape_plan_key_t *other)
 {
-  if (this->num_user_features != other->num_user_features)
+  if (this->num_user_features != other->num_user_features ||
+      this->user_features_hash != other->user_features_hash)
     return false;
+  /* Same feature set. */
+  if (this->user_features == other->user_features)
+    return true;
   for (unsigned int i = 0; i < num_user_features; i++)
   {
     if (this->user_features[i].tag   != other->user_features[i].tag   ||
@@ -199,29 +228,12 @@ hb_shape_plan_create (hb_face_t                     *face,
 				shaper_list);
 }
 
-/**
- * hb_shape_plan_create2:
- * @face: #hb_face_t to use
- * @props: The #hb_segment_properties_t of the segment
- * @user_features: (array length=num_user_features): The list of user-selected features
- * @num_user_features: The number of user-selected features
- * @coords: (array length=num_coords): The list of variation-space coordinates
- * @num_coords: The number of variation-space coordinates
- * @shaper_list: (array zero-terminated=1): List of shapers to try
- *
- * The variable-font version of #hb_shape_plan_create. 
- * Constructs a shaping plan for a combination of @face, @user_features, @props,
- * and @shaper_list, plus the variation-space coordinates @coords.
- *
- * Return value: (transfer full): The shaping plan
- *
- * Since: 1.4.0
- **/
-hb_shape_plan_t *
-hb_shape_plan_create2 (hb_face_t                     *face,
+static hb_shape_plan_t *
+_hb_shape_plan_create (hb_face_t                     *face,
 		       const hb_segment_properties_t *props,
 		       const hb_feature_t            *user_features,
 		       unsigned int                   num_user_features,
+		       const hb_feature_set_t        *feature_set,
 		       const int                     *coords,
 		       unsigned int                   num_coords,
 		       const char * const            *shaper_list)
@@ -255,7 +267,8 @@ hb_shape_plan_create2 (hb_face_t                     *face,
 				       num_user_features,
 				       coords,
 				       num_coords,
-				       shaper_list)))
+				       shaper_list,
+				       feature_set)))
     goto bail2;
 #ifndef HB_NO_OT_SHAPE
   if (unlikely (!shape_plan->ot.init0 (face, &shape_plan->key)))
@@ -274,6 +287,41 @@ bail:
   return hb_shape_plan_get_empty ();
 }
 
+/**
+ * hb_shape_plan_create2:
+ * @face: #hb_face_t to use
+ * @props: The #hb_segment_properties_t of the segment
+ * @user_features: (array length=num_user_features): The list of user-selected features
+ * @num_user_features: The number of user-selected features
+ * @coords: (array length=num_coords): The list of variation-space coordinates
+ * @num_coords: The number of variation-space coordinates
+ * @shaper_list: (array zero-terminated=1): List of shapers to try
+ *
+ * The variable-font version of #hb_shape_plan_create. 
+ * Constructs a shaping plan for a combination of @face, @user_features, @props,
+ * and @shaper_list, plus the variation-space coordinates @coords.
+ *
+ * Return value: (transfer full): The shaping plan
+ *
+ * Since: 1.4.0
+ **/
+hb_shape_plan_t *
+hb_shape_plan_create2 (hb_face_t                     *face,
+		       const hb_segment_properties_t *props,
+		       const hb_feature_t            *user_features,
+		       unsigned int                   num_user_features,
+		       const int                     *coords,
+		       unsigned int                   num_coords,
+		       const char * const            *shaper_list)
+{
+  return _hb_shape_plan_create (face, props,
+				user_features, num_user_features,
+				nullptr,
+				coords, num_coords,
+				shaper_list);
+}
+
+
 /**
  * hb_shape_plan_get_empty:
  *
@@ -518,6 +566,23 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 			      const int                     *coords,
 			      unsigned int                   num_coords,
 			      const char * const            *shaper_list)
+{
+  return _hb_shape_plan_create_cached (face, props,
+				       user_features, num_user_features,
+				       nullptr,
+				       coords, num_coords,
+				       shaper_list);
+}
+
+hb_shape_plan_t *
+_hb_shape_plan_create_cached (hb_face_t                     *face,
+			      const hb_segment_properties_t *props,
+			      const hb_feature_t            *user_features,
+			      unsigned int                   num_user_features,
+			      const hb_feature_set_t        *feature_set,
+			      const int                     *coords,
+			      unsigned int                   num_coords,
+			      const char * const            *shaper_list)
 {
   DEBUG_MSG_FUNC (SHAPE_PLAN, nullptr,
 		  "face=%p num_features=%u shaper_list=%p",
@@ -540,7 +605,8 @@ retry:
 		   num_user_features,
 		   coords,
 		   num_coords,
-		   shaper_list))
+		   shaper_list,
+		   feature_set))
       return hb_shape_plan_get_empty ();
 
     for (hb_face_t::plan_node_t *node = cached_plan_nodes; node; node = node->next)
@@ -551,8 +617,9 @@ retry:
       }
   }
 
-  hb_shape_plan_t *shape_plan = hb_shape_plan_create2 (face, props,
+  hb_shape_plan_t *shape_plan = _hb_shape_plan_create (face, props,
 						       user_features, num_user_features,
+						       feature_set,
 						       coords, num_coords,
 						       shaper_list);
 
@@ -32,12 +32,38 @@
 #include "hb-ot-shape.hh"
 
 
+struct hb_feature_set_t
+{
+  hb_object_header_t header;
+
+  hb_vector_t<hb_feature_t> features;
+  uint32_t hash;
+
+  /* Covers what hb_shape_plan_key_t::user_features_match() compares. */
+  static uint32_t hash_features (const hb_feature_t *features,
+				 unsigned int        num_features)
+  {
+    uint32_t h = 0;
+    for (unsigned int i = 0; i < num_features; i++)
+    {
+      bool global = features[i].start == HB_FEATURE_GLOBAL_START &&
+		    features[i].end   == HB_FEATURE_GLOBAL_END;
+      h = h * 31 + hb_hash (features[i].tag);
+      h = h * 31 + hb_hash (features[i].value * 2 + global);
+    }
+    return h;
+  }
+};
+
 struct hb_shape_plan_key_t
 {
   hb_segment_properties_t  props;
 
   const hb_feature_t      *user_features;
   unsigned int             num_user_features;
+  uint32_t                 user_features_hash;
+  /* If set, user_features belongs to it rather than to us. */
+  hb_feature_set_t        *user_feature_set;
 
 #ifndef HB_NO_OT_SHAPE
   hb_ot_shape_plan_key_t   ot;
@@ -53,9 +79,10 @@ struct hb_shape_plan_key_t
 			 unsigned int                   num_user_features,
 			 const int                     *coords,
 			 unsigned int                   num_coords,
-			 const char * const            *shaper_list);
+			 const char * const            *shaper_list,
+			 const hb_feature_set_t        *feature_set = nullptr);
 
-  HB_INTERNAL void fini () { hb_free ((void *) user_features); user_features = nullptr; }
+  HB_INTERNAL void fini ();
 
   HB_INTERNAL bool user_features_match (const hb_shape_plan_key_t *other);
 
@@ -73,5 +100,15 @@ struct hb_shape_plan_t
 #endif
 };
 
+HB_INTERNAL hb_shape_plan_t *
+_hb_shape_plan_create_cached (hb_face_t                     *face,
+			      const hb_segment_properties_t *props,
+			      const hb_feature_t            *user_features,
+			      unsigned int                   num_user_features,
+			      const hb_feature_set_t        *feature_set,
+			      const int                     *coords,
+			      unsigned int                   num_coords,
+			      const char * const            *shaper_list);
+
 
 #endif /* HB_SHAPE_PLAN_HH */
@@ -103,30 +103,13 @@ hb_shape_list_shapers ()
 }
 
 
-/**
- * hb_shape_full:
- * @font: an #hb_font_t to use for shaping
- * @buffer: an #hb_buffer_t to shape
- * @features: (array length=num_features) (nullable): an array of user
- *    specified #hb_feature_t or `NULL`
- * @num_features: the length of @features array
- * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
- *    array of shapers to use or `NULL`
- *
- * See hb_shape() for details. If @shaper_list is not `NULL`, the specified
- * shapers will be used in the given order, otherwise the default shapers list
- * will be used.
- *
- * Return value: false if all shapers failed, true otherwise
- *
- * Since: 0.9.2
- **/
-hb_bool_t
-hb_shape_full (hb_font_t          *font,
-	       hb_buffer_t        *buffer,
-	       const hb_feature_t *features,
-	       unsigned int        num_features,
-	       const char * const *shaper_list)
+static hb_bool_t
+_hb_shape_full (hb_font_t              *font,
+		hb_buffer_t            *buffer,
+		const hb_feature_t     *features,
+		unsigned int            num_features,
+		const hb_feature_set_t *feature_set,
+		const char * const     *shaper_list)
 {
   if (unlikely (!buffer->len))
     return true;
@@ -134,14 +117,18 @@ hb_shape_full (hb_font_t          *font,
   buffer->enter ();
 
   hb_buffer_t *text_buffer = nullptr;
-  if (buffer->flags & HB_BUFFER_FLAG_VERIFY)
+  /* Shapes with an explicit shaper list cannot be replayed later. */
+  bool sampled = !(buffer->flags & HB_BUFFER_FLAG_VERIFY) && !shaper_list &&
+		 buffer->verify_sample ();
+  if ((buffer->flags & HB_BUFFER_FLAG_VERIFY) || sampled)
   {
     text_buffer = hb_buffer_create ();
     hb_buffer_append (text_buffer, buffer, 0, -1);
   }
 
-  hb_shape_plan_t *shape_plan = hb_shape_plan_create_cached2 (font->face, &buffer->props,
+  hb_shape_plan_t *shape_plan = _hb_shape_plan_create_cached (font->face, &buffer->props,
 							      features, num_features,
+							      feature_set,
 							      font->coords, font->num_coords,
 							      shaper_list);
 
@@ -155,13 +142,17 @@ hb_shape_full (hb_font_t          *font,
   if (text_buffer)
   {
     if (res && buffer->successful && !buffer->shaping_failed
-	    && text_buffer->successful
-	    && !buffer->verify (text_buffer,
+	    && text_buffer->successful)
+    {
+      if (sampled)
+	buffer->verify_deferred (text_buffer, font, features, num_features);
+      else if (!buffer->verify (text_buffer,
 				font,
 				features,
 				num_features,
 				shaper_list))
-      res = false;
+	res = false;
+    }
     hb_buffer_destroy (text_buffer);
   }
 
@@ -170,6 +161,34 @@ hb_shape_full (hb_font_t          *font,
   return res;
 }
 
+/**
+ * hb_shape_full:
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * See hb_shape() for details. If @shaper_list is not `NULL`, the specified
+ * shapers will be used in the given order, otherwise the default shapers list
+ * will be used.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * Since: 0.9.2
+ **/
+hb_bool_t
+hb_shape_full (hb_font_t          *font,
+	       hb_buffer_t        *buffer,
+	       const hb_feature_t *features,
+	       unsigned int        num_features,
+	       const char * const *shaper_list)
+{
+  return _hb_shape_full (font, buffer, features, num_features, nullptr, shaper_list);
+}
+
 /**
  * hb_shape:
  * @font: an #hb_font_t to use for shaping
@@ -196,6 +215,562 @@ hb_shape (hb_font_t           *font,
 }
 
 
+/*
+ * hb_feature_set_t
+ */
+
+static bool
+_hb_feature_set_add (hb_feature_set_t *feature_set, const hb_feature_t &feature)
+{
+  bool global = feature.start == HB_FEATURE_GLOBAL_START &&
+		feature.end   == HB_FEATURE_GLOBAL_END;
+
+  /* A global feature fully overrides an earlier global feature with the
+   * same tag, unless a ranged one of that tag comes in between.  Drop the
+   * earlier one, so equivalent lists end up the same. */
+  auto &features = feature_set->features;
+  for (unsigned i = features.length; i; i--)
+  {
+    const hb_feature_t &prev = features.arrayZ[i - 1];
+    if (prev.tag != feature.tag) continue;
+    if (global &&
+	prev.start == HB_FEATURE_GLOBAL_START &&
+	prev.end   == HB_FEATURE_GLOBAL_END)
+      features.remove_ordered (i - 1);
+    break;
+  }
+
+  features.push (feature);
+  return !features.in_error ();
+}
+
+static hb_feature_set_t *
+_hb_feature_set_finish (hb_feature_set_t *feature_set)
+{
+  if (unlikely (feature_set->features.in_error ()))
+  {
+    hb_feature_set_destroy (feature_set);
+    return hb_feature_set_get_empty ();
+  }
+  feature_set->features.shrink (feature_set->features.length);
+  feature_set->hash = hb_feature_set_t::hash_features (feature_set->features.arrayZ,
+						       feature_set->features.length);
+  return feature_set;
+}
+
+/**
+ * hb_feature_set_create:
+ * @features: (array length=num_features) (nullable): an array of
+ *    #hb_feature_t
+ * @num_features: the length of @features array
+ *
+ * Creates a new feature set holding @features.  The features are
+ * canonicalized: global features overridden by a later global feature
+ * with the same tag are dropped.
+ *
+ * Feature sets are immutable and can be shared between threads.  Shaping
+ * with the same feature set repeatedly, see hb_shape_with_feature_set(),
+ * is cheaper than passing the same feature array every time.
+ *
+ * Return value: (transfer full): The new feature set, or the empty
+ * feature set if allocation failed
+ *
+ * Since: REPLACEME
+ **/
+hb_feature_set_t *
+hb_feature_set_create (const hb_feature_t *features,
+		       unsigned int        num_features)
+{
+  hb_feature_set_t *feature_set;
+
+  if (!(feature_set = hb_object_create<hb_feature_set_t> ()))
+    return hb_feature_set_get_empty ();
+
+  feature_set->features.alloc (num_features, true);
+  for (unsigned int i = 0; i < num_features; i++)
+    if (unlikely (!_hb_feature_set_add (feature_set, features[i])))
+      break;
+
+  return _hb_feature_set_finish (feature_set);
+}
+
+/**
+ * hb_feature_set_create_from_string:
+ * @str: (array length=len) (element-type uint8_t): a string to parse
+ * @len: length of @str, or -1 if string is `NULL` terminated
+ *
+ * Creates a new feature set from a comma-separated list of features
+ * in the format understood by hb_feature_from_string(), for example
+ * `"kern,-liga,aalt[3:5]=2"`.  Entries that fail to parse are skipped.
+ *
+ * Return value: (transfer full): The new feature set, or the empty
+ * feature set if allocation failed
+ *
+ * Since: REPLACEME
+ **/
+hb_feature_set_t *
+hb_feature_set_create_from_string (const char *str,
+				   int         len)
+{
+  hb_feature_set_t *feature_set;
+
+  if (!(feature_set = hb_object_create<hb_feature_set_t> ()))
+    return hb_feature_set_get_empty ();
+
+  if (!str) len = 0;
+  if (len < 0) len = strlen (str);
+
+  const char *end = str + len;
+  while (str < end)
+  {
+    const char *p = (const char *) memchr (str, ',', end - str);
+    if (!p) p = end;
+
+    hb_feature_t feature;
+    if (hb_feature_from_string (str, p - str, &feature) &&
+	unlikely (!_hb_feature_set_add (feature_set, feature)))
+      break;
+
+    str = p + 1;
+  }
+
+  return _hb_feature_set_finish (feature_set);
+}
+
+/**
+ * hb_feature_set_get_empty:
+ *
+ * Fetches the singleton empty feature set.
+ *
+ * Return value: (transfer full): The empty feature set
+ *
+ * Since: REPLACEME
+ **/
+hb_feature_set_t *
+hb_feature_set_get_empty ()
+{
+  return const_cast<hb_feature_set_t *> (&Null (hb_feature_set_t));
+}
+
+/**
+ * hb_feature_set_reference: (skip)
+ * @feature_set: A feature set
+ *
+ * Increases the reference count on @feature_set.
+ *
+ * Return value: (transfer full): @feature_set
+ *
+ * Since: REPLACEME
+ **/
+hb_feature_set_t *
+hb_feature_set_reference (hb_feature_set_t *feature_set)
+{
+  return hb_object_reference (feature_set);
+}
+
+/**
+ * hb_feature_set_destroy: (skip)
+ * @feature_set: A feature set
+ *
+ * Decreases the reference count on @feature_set, and if it
+ * reaches zero, destroys it, freeing all memory.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_feature_set_destroy (hb_feature_set_t *feature_set)
+{
+  if (!hb_object_destroy (feature_set)) return;
+
+  hb_free (feature_set);
+}
+
+/**
+ * hb_feature_set_set_user_data: (skip)
+ * @feature_set: A feature set
+ * @key: The user-data key to set
+ * @data: A pointer to the user data
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified feature set.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_feature_set_set_user_data (hb_feature_set_t   *feature_set,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace)
+{
+  return hb_object_set_user_data (feature_set, key, data, destroy, replace);
+}
+
+/**
+ * hb_feature_set_get_user_data: (skip)
+ * @feature_set: A feature set
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified feature set.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * Since: REPLACEME
+ **/
+void *
+hb_feature_set_get_user_data (const hb_feature_set_t *feature_set,
+			      hb_user_data_key_t     *key)
+{
+  return hb_object_get_user_data (feature_set, key);
+}
+
+/**
+ * hb_feature_set_get_features:
+ * @feature_set: A feature set
+ * @start_offset: The index of the first feature to retrieve
+ * @feature_count: (inout) (optional): Input = the maximum number of features
+ *     to return; Output = the actual number of features returned (may be zero)
+ * @features: (out) (array length=feature_count) (optional): The array of
+ *     features found
+ *
+ * Fetches the canonicalized features held by @feature_set.
+ *
+ * Return value: Total number of features in @feature_set
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_feature_set_get_features (const hb_feature_set_t *feature_set,
+			     unsigned int            start_offset,
+			     unsigned int           *feature_count, /* IN/OUT */
+			     hb_feature_t           *features /* OUT */)
+{
+  if (feature_count)
+  {
+    + feature_set->features.as_array ().sub_array (start_offset, feature_count)
+    | hb_sink (hb_array (features, *feature_count))
+    ;
+  }
+  return feature_set->features.length;
+}
+
+/**
+ * hb_shape_with_feature_set:
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @feature_set: (nullable): an #hb_feature_set_t, or `NULL`
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * Like hb_shape_full(), but takes the features from @feature_set.  Shape
+ * plans made with a feature set are looked up by the feature set's hash and
+ * identity, instead of comparing the features one by one.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_shape_with_feature_set (hb_font_t              *font,
+			   hb_buffer_t            *buffer,
+			   const hb_feature_set_t *feature_set,
+			   const char * const     *shaper_list)
+{
+  if (!feature_set)
+    feature_set = hb_feature_set_get_empty ();
+  return _hb_shape_full (font, buffer,
+			 feature_set->features.arrayZ, feature_set->features.length,
+			 feature_set,
+			 shaper_list);
+}
+
+
+/*
+ * Itemized shaping
+ */
+
+struct hb_shape_item_t
+{
+  unsigned start;
+  unsigned end;
+  unsigned font_index;
+  hb_script_t script;
+};
+
+static inline bool
+_hb_shape_font_covers (hb_font_t *font, hb_codepoint_t u)
+{
+  hb_codepoint_t glyph;
+  return font->get_nominal_glyph (u, &glyph);
+}
+
+static inline bool
+_hb_shape_script_is_weak (hb_script_t script)
+{
+  return script == HB_SCRIPT_COMMON ||
+	 script == HB_SCRIPT_INHERITED ||
+	 script == HB_SCRIPT_UNKNOWN;
+}
+
+/* Splits the buffer into items of one font and one script, in a single
+ * pass.  Each character goes to the first font covering it, except that
+ * marks and default-ignorables stay with the preceding character, and
+ * script-neutral characters stay in the current font if it covers them.
+ * Characters no font covers stay in the current font, so they shape
+ * to its .notdef glyph. */
+static void
+_hb_shape_itemize (hb_font_t * const                 *fonts,
+		   unsigned                           num_fonts,
+		   const hb_buffer_t                 *buffer,
+		   hb_vector_t<hb_shape_item_t>      &items)
+{
+  hb_unicode_funcs_t *unicode = buffer->unicode;
+  bool itemize_script = buffer->props.script == HB_SCRIPT_INVALID;
+  const hb_glyph_info_t *info = buffer->info;
+  unsigned count = buffer->len;
+
+  hb_shape_item_t item = {0, 0, 0, HB_SCRIPT_COMMON};
+  for (unsigned i = 0; i < count; i++)
+  {
+    hb_codepoint_t u = info[i].codepoint;
+    hb_script_t script = itemize_script ? unicode->script (u) : buffer->props.script;
+    bool weak = _hb_shape_script_is_weak (script);
+    bool attached = i &&
+		    (HB_UNICODE_GENERAL_CATEGORY_IS_MARK (unicode->general_category (u)) ||
+		     unicode->is_default_ignorable (u));
+
+    unsigned font_index = item.font_index;
+    if (!attached &&
+	!(i && weak && _hb_shape_font_covers (fonts[font_index], u)))
+    {
+      for (unsigned j = 0; j < num_fonts; j++)
+	if (_hb_shape_font_covers (fonts[j], u))
+	{
+	  font_index = j;
+	  break;
+	}
+    }
+
+    bool script_break = !attached && !weak &&
+			item.script != HB_SCRIPT_COMMON &&
+			script != item.script;
+    if (i && (font_index != item.font_index || script_break))
+    {
+      item.end = i;
+      items.push (item);
+      item.start = i;
+      item.script = HB_SCRIPT_COMMON;
+    }
+    item.font_index = font_index;
+    if (!weak && item.script == HB_SCRIPT_COMMON)
+      item.script = script;
+  }
+  item.end = count;
+  items.push (item);
+
+  /* Items with only script-neutral characters take the script of the
+   * preceding item, or of the following one at the start of text. */
+  hb_script_t script = HB_SCRIPT_COMMON;
+  for (hb_shape_item_t &_ : items)
+    if (_.script == HB_SCRIPT_COMMON)
+      _.script = script;
+    else
+      script = _.script;
+  for (hb_shape_item_t &_ : items)
+  {
+    if (_.script != HB_SCRIPT_COMMON)
+    {
+      script = _.script;
+      break;
+    }
+  }
+  for (hb_shape_item_t &_ : items)
+  {
+    if (_.script != HB_SCRIPT_COMMON)
+      break;
+    _.script = script;
+  }
+}
+
+/**
+ * hb_shape_itemized:
+ * @fonts: (array length=num_fonts): fonts to shape with, in order of priority
+ * @num_fonts: the length of @fonts array
+ * @buffer: an #hb_buffer_t to shape
+ * @feature_set: (nullable): the features to apply, or `NULL`
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ * @func: (nullable) (scope call): callback to call for each shaped run, or `NULL`
+ * @user_data: User data to pass to @func
+ *
+ * Splits the text of @buffer into runs of a single script and font, and
+ * shapes each run, leaving the glyphs of all runs in @buffer.  This is
+ * what a text layout engine does before calling hb_shape() on every run,
+ * with the text itemized in a single pass.
+ *
+ * Each character is assigned the first font in @fonts whose character
+ * map covers it.  Combining marks and default-ignorable characters
+ * always stay in the font of the preceding character, and characters
+ * without a script of their own, like spaces and punctuation, stay in
+ * the current font if it covers them.  Characters no font covers are
+ * shaped with the current font, or the first font at the start of text.
+ *
+ * If the script of @buffer is set, all text is shaped in that script and
+ * runs are only split by font.  Otherwise each run is shaped with the
+ * script detected by the #hb_unicode_funcs_t of @buffer.  Likewise, if
+ * the direction of @buffer is set it is used for all runs; otherwise
+ * each run uses the horizontal direction of its script.  Either way,
+ * bidirectional reordering is left to the caller.
+ *
+ * Glyph clusters keep the cluster values of the input characters, and
+ * shaping of every run sees the neighbouring text as context.  The runs
+ * are output in logical order, or in reverse when the direction of
+ * @buffer is set and is backward, so the output has the same order
+ * shaping the whole buffer at once would give.
+ *
+ * The segment properties of @buffer are left as they were, including
+ * any that were unset; the ones each run was shaped with are passed to
+ * @func.  If shaping any run fails, shaping stops there and @buffer is
+ * left holding its input text.
+ *
+ * Return value: false if shaping any run failed, true otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_shape_itemized (hb_font_t * const      *fonts,
+		   unsigned int            num_fonts,
+		   hb_buffer_t            *buffer,
+		   const hb_feature_set_t *feature_set,
+		   const char * const     *shaper_list,
+		   hb_shape_run_func_t     func,
+		   void                   *user_data)
+{
+  if (unlikely (!num_fonts))
+    return false;
+  if (unlikely (!buffer->len))
+    return true;
+
+  buffer->assert_unicode ();
+
+  if (!feature_set)
+    feature_set = hb_feature_set_get_empty ();
+  const hb_feature_t *features = feature_set->features.arrayZ;
+  unsigned num_features = feature_set->features.length;
+
+  hb_vector_t<hb_shape_item_t> items;
+  _hb_shape_itemize (fonts, num_fonts, buffer, items);
+  if (unlikely (items.in_error ()))
+    return false;
+
+  hb_segment_properties_t buffer_props = buffer->props;
+  hb_segment_properties_t props = buffer_props;
+  if (!props.language)
+    props.language = hb_language_get_default ();
+  auto get_props = [&] (const hb_shape_item_t &item) -> hb_segment_properties_t
+  {
+    hb_segment_properties_t item_props = props;
+    item_props.script = item.script;
+    if (!HB_DIRECTION_IS_VALID (item_props.direction))
+      item_props.direction = hb_script_get_horizontal_direction (item.script);
+    if (!HB_DIRECTION_IS_VALID (item_props.direction))
+      item_props.direction = HB_DIRECTION_LTR;
+    return item_props;
+  };
+  auto report = [&] (const hb_shape_item_t &item,
+		     const hb_segment_properties_t &item_props,
+		     unsigned glyph_start, unsigned glyph_end)
+  {
+    if (!func)
+      return;
+    hb_shape_run_t run = {item.font_index, item_props.script, item_props.direction,
+			  item.start, item.end, glyph_start, glyph_end};
+    func (&run, user_data);
+  };
+
+  /* One run: shape in place. */
+  if (items.length == 1)
+  {
+    const hb_shape_item_t &item = items[0];
+    buffer->props = get_props (item);
+    hb_bool_t ret = _hb_shape_full (fonts[item.font_index], buffer,
+				    features, num_features, feature_set,
+				    shaper_list);
+    hb_segment_properties_t item_props = buffer->props;
+    buffer->props = buffer_props;
+    if (unlikely (!ret))
+      return false;
+    report (item, item_props, 0, buffer->len);
+    return true;
+  }
+
+  /* Move the text out of the buffer, then shape each run in a scratch
+   * buffer and append its glyphs back. */
+  hb_buffer_t *text = hb_buffer_create ();
+  hb_buffer_t *run = hb_buffer_create ();
+  if (unlikely (!text->successful || !run->successful))
+  {
+    hb_buffer_destroy (text);
+    hb_buffer_destroy (run);
+    return false;
+  }
+  text->swap_contents (*buffer);
+  run->similar (*buffer);
+#ifndef HB_NO_BUFFER_MESSAGE
+  run->message_func = buffer->message_func;
+  run->message_data = buffer->message_data;
+#endif
+
+  bool backward = HB_DIRECTION_IS_BACKWARD (buffer->props.direction);
+  hb_bool_t ret = true;
+  for (unsigned i = 0; i < items.length; i++)
+  {
+    const hb_shape_item_t &item = items[backward ? items.length - 1 - i : i];
+
+    run->clear ();
+    hb_buffer_append (run, text, item.start, item.end);
+    run->props = get_props (item);
+    run->flags = buffer->flags;
+    if (item.start)
+      run->flags = (hb_buffer_flags_t) (run->flags & ~HB_BUFFER_FLAG_BOT);
+    if (item.end < text->len)
+      run->flags = (hb_buffer_flags_t) (run->flags & ~HB_BUFFER_FLAG_EOT);
+
+    if (unlikely (!_hb_shape_full (fonts[item.font_index], run,
+				   features, num_features, feature_set,
+				   shaper_list)))
+    {
+      ret = false;
+      break;
+    }
+
+    unsigned glyph_start = buffer->len;
+    hb_buffer_append (buffer, run, 0, run->len);
+    if (unlikely (!buffer->successful))
+    {
+      ret = false;
+      break;
+    }
+    report (item, run->props, glyph_start, buffer->len);
+  }
+
+  /* Appending runs filled in whatever properties were unset. */
+  buffer->props = buffer_props;
+  /* Put the text back rather than leave some runs shaped. */
+  if (unlikely (!ret))
+    buffer->swap_contents (*text);
+
+  hb_buffer_destroy (run);
+  hb_buffer_destroy (text);
+
+  return ret;
+}
+
+
 #ifdef HB_EXPERIMENTAL_API
 
 static float
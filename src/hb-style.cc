@@ -55,39 +55,33 @@ _hb_ratio_to_angle (float r)
   return atanf (r) * -180.f / HB_PI;
 }
 
-/**
- * hb_style_get_value:
- * @font: a #hb_font_t object.
- * @style_tag: a style tag.
- *
- * Searches variation axes of a #hb_font_t object for a specific axis first,
- * if not set, then tries to get default style values from different
- * tables of the font.
- *
- * Returns: Corresponding axis or default value to a style tag.
- *
- * Since: 3.0.0
- **/
+/* hb_style_get_value() for a face at the given design coordinates,
+ * point size and synthetic slant. */
 float
-hb_style_get_value (hb_font_t *font, hb_style_tag_t style_tag)
+_hb_style_get_value (hb_face_t      *face,
+		     const float    *design_coords,
+		     unsigned int    num_coords,
+		     float           ptem,
+		     float           slant,
+		     hb_style_tag_t  style_tag)
 {
   if (unlikely (style_tag == HB_STYLE_TAG_SLANT_RATIO))
-    return _hb_angle_to_ratio (hb_style_get_value (font, HB_STYLE_TAG_SLANT_ANGLE));
-
-  hb_face_t *face = font->face;
+    return _hb_angle_to_ratio (_hb_style_get_value (face, design_coords, num_coords,
+						    ptem, slant,
+						    HB_STYLE_TAG_SLANT_ANGLE));
 
 #ifndef HB_NO_VAR
   hb_ot_var_axis_info_t axis;
   if (hb_ot_var_find_axis_info (face, style_tag, &axis))
   {
-    if (axis.axis_index < font->num_coords) return font->design_coords[axis.axis_index];
+    if (axis.axis_index < num_coords) return design_coords[axis.axis_index];
     /* If a face is variable, fvar's default_value is better than STAT records */
     return axis.default_value;
   }
 #endif
 
-  if (style_tag == HB_STYLE_TAG_OPTICAL_SIZE && font->ptem)
-    return font->ptem;
+  if (style_tag == HB_STYLE_TAG_OPTICAL_SIZE && ptem)
+    return ptem;
 
   /* STAT */
   float value;
@@ -111,8 +105,8 @@ hb_style_get_value (hb_font_t *font, hb_style_tag_t style_tag)
   {
     float angle = face->table.post->table->italicAngle.to_float ();
 
-    if (font->slant)
-      angle = _hb_ratio_to_angle (font->slant + _hb_angle_to_ratio (angle));
+    if (slant)
+      angle = _hb_ratio_to_angle (slant + _hb_angle_to_ratio (angle));
 
     return angle;
   }
@@ -131,4 +125,26 @@ hb_style_get_value (hb_font_t *font, hb_style_tag_t style_tag)
   }
 }
 
+/**
+ * hb_style_get_value:
+ * @font: a #hb_font_t object.
+ * @style_tag: a style tag.
+ *
+ * Searches variation axes of a #hb_font_t object for a specific axis first,
+ * if not set, then tries to get default style values from different
+ * tables of the font.
+ *
+ * Returns: Corresponding axis or default value to a style tag.
+ *
+ * Since: 3.0.0
+ **/
+float
+hb_style_get_value (hb_font_t *font, hb_style_tag_t style_tag)
+{
+  return _hb_style_get_value (font->face,
+			      font->design_coords, font->num_coords,
+			      font->ptem, font->slant,
+			      style_tag);
+}
+
 #endif
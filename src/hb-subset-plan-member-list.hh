@@ -60,6 +60,7 @@ HB_SUBSET_PLAN_MEMBER (hb_set_t, drop_tables)
 
 // Old -> New glyph id mapping
 HB_SUBSET_PLAN_MEMBER (hb_map_t, glyph_map_gsub)
+HB_SUBSET_PLAN_MEMBER (hb_dense_map_t, glyph_map_gsub_dense)
 
 HB_SUBSET_PLAN_MEMBER (hb_set_t, _glyphset)
 HB_SUBSET_PLAN_MEMBER (hb_set_t, _glyphset_gsub)
@@ -790,13 +790,13 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
 
 static void
 _create_glyph_map_gsub (const hb_set_t* glyph_set_gsub,
-                        const hb_map_t* glyph_map,
+                        const hb_dense_map_t& glyph_map,
                         hb_map_t* out)
 {
   out->alloc (glyph_set_gsub->get_population ());
   + hb_iter (glyph_set_gsub)
   | hb_map ([&] (hb_codepoint_t gid) {
-    return hb_codepoint_pair_t (gid, glyph_map->get (gid));
+    return hb_codepoint_pair_t (gid, glyph_map.get (gid));
   })
   | hb_sink (out)
   ;
@@ -1123,17 +1123,21 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
     return;
   }
 
+  glyph_map_dense.init (glyph_map);
+  reverse_glyph_map_dense.init (reverse_glyph_map);
+
   _create_glyph_map_gsub (
       &_glyphset_gsub,
-      glyph_map,
+      glyph_map_dense,
       &glyph_map_gsub);
+  glyph_map_gsub_dense.init (&glyph_map_gsub);
 
   // Now that we have old to new gid map update the unicode to new gid list.
   for (unsigned i = 0; i < unicode_to_new_gid_list.length; i++)
   {
     // Use raw array access for performance.
     unicode_to_new_gid_list.arrayZ[i].second =
-        glyph_map->get(unicode_to_new_gid_list.arrayZ[i].second);
+        glyph_map_dense.get(unicode_to_new_gid_list.arrayZ[i].second);
   }
 
   bounds_width_vec.resize (_num_output_glyphs, false);
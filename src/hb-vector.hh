@@ -553,4 +553,313 @@ struct hb_vector_t
 template <typename Type>
 using hb_sorted_vector_t = hb_vector_t<Type, true>;
 
+
+/*
+ * hb_small_vector_t
+ *
+ * Like hb_vector_t, but keeps up to N items in inline storage and only
+ * goes to the heap once it outgrows that.  Meant for short-lived vectors
+ * that usually hold a handful of items.  Not convertible to hb_vector_t&,
+ * whose growth paths don't know about the inline storage.
+ */
+
+template <typename Type,
+	  unsigned int N,
+	  bool sorted=false>
+struct hb_small_vector_t : private hb_vector_t<Type, sorted>
+{
+  static_assert (N > 0, "");
+  typedef hb_vector_t<Type, sorted> vector_t;
+  typedef typename vector_t::item_t item_t;
+  using vector_t::item_size;
+  using array_t = typename vector_t::array_t;
+  using c_array_t = typename vector_t::c_array_t;
+
+  hb_small_vector_t () { use_inline (); }
+  hb_small_vector_t (std::initializer_list<Type> lst) : hb_small_vector_t ()
+  {
+    alloc (lst.size (), true);
+    for (auto&& item : lst)
+      push (item);
+  }
+  template <typename Iterable,
+	    hb_requires (hb_is_iterable (Iterable))>
+  hb_small_vector_t (const Iterable &o) : hb_small_vector_t ()
+  {
+    auto iter = hb_iter (o);
+    if (iter.is_random_access_iterator || iter.has_fast_len)
+      alloc (hb_len (iter), true);
+    hb_copy (iter, *this);
+  }
+  hb_small_vector_t (const hb_small_vector_t &o) : hb_small_vector_t ()
+  {
+    alloc (o.length, true);
+    if (unlikely (in_error ())) return;
+    this->copy_array (o.as_array ());
+  }
+  hb_small_vector_t (hb_small_vector_t &&o) : hb_small_vector_t ()
+  { *this = std::move (o); }
+  ~hb_small_vector_t ()
+  {
+    fini ();
+    /* Leave nothing for ~hb_vector_t() to free. */
+    vector_t::init ();
+  }
+
+  using vector_t::length;
+  using vector_t::arrayZ;
+
+  void init ()
+  {
+    vector_t::init ();
+    use_inline ();
+  }
+
+  void fini ()
+  {
+    if (is_inline ())
+      this->shrink_vector (0);
+    else
+      vector_t::fini ();
+    use_inline ();
+  }
+
+  void reset ()
+  {
+    if (unlikely (in_error ()))
+      this->reset_error ();
+    resize (0);
+  }
+
+  friend void swap (hb_small_vector_t& a, hb_small_vector_t& b)
+  {
+    hb_small_vector_t t (std::move (a));
+    a = std::move (b);
+    b = std::move (t);
+  }
+
+  hb_small_vector_t& operator = (const hb_small_vector_t &o)
+  {
+    reset ();
+    alloc (o.length, true);
+    if (unlikely (in_error ())) return *this;
+
+    this->copy_array (o.as_array ());
+
+    return *this;
+  }
+  hb_small_vector_t& operator = (hb_small_vector_t &&o)
+  {
+    if (unlikely (this == &o)) return *this;
+    fini ();
+    if (o.is_inline ())
+    {
+      /* Can't steal inline storage; move the items over instead.
+       * Inline length never exceeds N; spelling that out keeps GCC's
+       * -Warray-bounds from assuming otherwise. */
+      move_items (arrayZ, o.arrayZ, hb_min (o.length, N));
+      length = o.length;
+      this->allocated = o.allocated;
+      o.length = 0;
+      o.use_inline ();
+    }
+    else
+    {
+      arrayZ = o.arrayZ;
+      length = o.length;
+      this->allocated = o.allocated;
+      o.use_inline ();
+    }
+    return *this;
+  }
+
+  using vector_t::as_bytes;
+  bool operator == (const hb_small_vector_t &o) const { return as_array () == o.as_array (); }
+  bool operator != (const hb_small_vector_t &o) const { return !(*this == o); }
+  using vector_t::hash;
+
+  using vector_t::operator [];
+  using vector_t::tail;
+  using vector_t::operator bool;
+  using vector_t::get_size;
+
+  /* Sink interface. */
+  template <typename T>
+  hb_small_vector_t& operator << (T&& v) { push (std::forward<T> (v)); return *this; }
+
+  using vector_t::as_array;
+
+  /* Iterator. */
+  typedef c_array_t   iter_t;
+  typedef array_t   writer_t;
+    iter_t   iter () const { return as_array (); }
+  writer_t writer ()       { return as_array (); }
+  operator   iter_t () const { return   iter (); }
+  operator writer_t ()       { return writer (); }
+
+  using vector_t::begin;
+  using vector_t::end;
+  using vector_t::as_sorted_array;
+  using vector_t::operator +;
+
+  Type *push ()
+  {
+    if (unlikely (!resize (length + 1)))
+      return std::addressof (Crap (Type));
+    return std::addressof (arrayZ[length - 1]);
+  }
+  template <typename T,
+	    typename T2 = Type,
+	    hb_enable_if (!std::is_copy_constructible<T2>::value &&
+			  std::is_copy_assignable<T>::value)>
+  Type *push (T&& v)
+  {
+    Type *p = push ();
+    if (p == std::addressof (Crap (Type)))
+      return p;
+    *p = std::forward<T> (v);
+    return p;
+  }
+  template <typename T,
+	    typename T2 = Type,
+	    hb_enable_if (std::is_copy_constructible<T2>::value)>
+  Type *push (T&& v)
+  {
+    if (unlikely ((int) length >= this->allocated && !alloc (length + 1)))
+      return std::addressof (Crap (Type));
+
+    /* Emplace. */
+    Type *p = std::addressof (arrayZ[length++]);
+    return new (p) Type (std::forward<T> (v));
+  }
+
+  using vector_t::in_error;
+
+  /* Allocate for size but don't adjust length. */
+  bool alloc (unsigned int size, bool exact=false)
+  {
+    if (unlikely (in_error ()))
+      return false;
+
+    if (!is_inline ())
+    {
+      if (exact && hb_max (size, length) <= N)
+      {
+	/* Shrinking; move back into inline storage. */
+	Type *old_array = arrayZ;
+	arrayZ = inline_items ();
+	move_items (arrayZ, old_array, length);
+	hb_free (old_array);
+	this->allocated = N;
+	return true;
+      }
+      return vector_t::alloc (size, exact);
+    }
+
+    if (likely (size <= N))
+      return true;
+
+    unsigned int new_allocated = N;
+    if (exact)
+      new_allocated = size;
+    else
+      while (size > new_allocated)
+	new_allocated += (new_allocated >> 1) + 8;
+
+    if (unlikely (new_allocated < size ||
+		  hb_unsigned_mul_overflows (new_allocated, sizeof (Type))))
+    {
+      this->set_error ();
+      return false;
+    }
+
+    Type *new_array = (Type *) hb_malloc (new_allocated * sizeof (Type));
+    if (unlikely (!new_array))
+    {
+      this->set_error ();
+      return false;
+    }
+    move_items (new_array, arrayZ, length);
+
+    arrayZ = new_array;
+    this->allocated = new_allocated;
+    return true;
+  }
+
+  bool resize (int size_, bool initialize = true, bool exact = false)
+  {
+    unsigned int size = size_ < 0 ? 0u : (unsigned int) size_;
+    if (!alloc (size, exact))
+      return false;
+
+    if (size > length)
+    {
+      if (initialize)
+	this->grow_vector (size, hb_prioritize);
+    }
+    else if (size < length)
+    {
+      if (initialize)
+	this->shrink_vector (size);
+    }
+
+    length = size;
+    return true;
+  }
+  bool resize_exact (int size_, bool initialize = true)
+  {
+    return resize (size_, initialize, true);
+  }
+
+  using vector_t::pop;
+  using vector_t::remove_ordered;
+  using vector_t::remove_unordered;
+
+  void shrink (int size_, bool shrink_memory = true)
+  {
+    unsigned int size = size_ < 0 ? 0u : (unsigned int) size_;
+    if (size >= length)
+      return;
+
+    this->shrink_vector (size);
+
+    if (shrink_memory)
+      alloc (size, true); /* To force shrinking memory if needed. */
+  }
+
+  using vector_t::qsort;
+  using vector_t::lsearch;
+  using vector_t::lfind;
+  using vector_t::bsearch;
+  using vector_t::bfind;
+
+  private:
+  Type *inline_items () { return reinterpret_cast<Type *> (storage); }
+  bool is_inline () const { return (const void *) arrayZ == (const void *) storage; }
+  void use_inline ()
+  {
+    arrayZ = inline_items ();
+    length = 0;
+    this->allocated = N;
+  }
+
+  template <typename T = Type,
+	    hb_enable_if (hb_is_trivially_copyable (T))>
+  static void move_items (Type *dst, Type *src, unsigned count)
+  { hb_memcpy ((void *) dst, (const void *) src, count * sizeof (Type)); }
+  template <typename T = Type,
+	    hb_enable_if (!hb_is_trivially_copyable (T))>
+  static void move_items (Type *dst, Type *src, unsigned count)
+  {
+    for (unsigned i = 0; i < count; i++)
+    {
+      new (std::addressof (dst[i])) Type ();
+      dst[i] = std::move (src[i]);
+      src[i].~Type ();
+    }
+  }
+
+  alignas (Type) char storage[N * sizeof (Type)];
+};
+
 #endif /* HB_VECTOR_HH */
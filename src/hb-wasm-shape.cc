@@ -56,8 +56,10 @@
  * requires support from the host that seems to be missing from wasm-micro-runtime?
  */
 
+#include "hb-wasm.h"
 #include "hb-wasm-api.hh"
 #include "hb-wasm-api-list.hh"
+#include "hb-atomic-pool.hh"
 
 #ifndef HB_WASM_NO_MODULES
 #define HB_WASM_NO_MODULES
@@ -104,6 +106,25 @@ _hb_wasm_module_destroyer (uint8_t *buffer, uint32_t size)
 
 #define HB_WASM_TAG_WASM HB_TAG('W','a','s','m')
 
+/* Idle module instances, with their shape plans, are kept in a per-face
+ * pool, so that concurrent shaping with one face does not instantiate
+ * the module again and again.  HB_WASM_SHAPE_PLAN_POOL_WARM of them are
+ * created when the face is first shaped. */
+#ifndef HB_WASM_SHAPE_PLAN_POOL_SIZE
+#ifdef HB_MINIMIZE_MEMORY_USAGE
+#define HB_WASM_SHAPE_PLAN_POOL_SIZE 1
+#else
+#define HB_WASM_SHAPE_PLAN_POOL_SIZE 8
+#endif
+#endif
+#ifndef HB_WASM_SHAPE_PLAN_POOL_WARM
+#ifdef HB_MINIMIZE_MEMORY_USAGE
+#define HB_WASM_SHAPE_PLAN_POOL_WARM 0
+#else
+#define HB_WASM_SHAPE_PLAN_POOL_WARM 2
+#endif
+#endif
+
 struct hb_wasm_shape_plan_t {
   wasm_module_inst_t module_inst;
   wasm_exec_env_t exec_env;
@@ -113,9 +134,22 @@ struct hb_wasm_shape_plan_t {
 struct hb_wasm_face_data_t {
   hb_blob_t *wasm_blob;
   wasm_module_t wasm_module;
-  mutable hb_atomic_ptr_t<hb_wasm_shape_plan_t> plan;
+  hb_atomic_pool_t<hb_wasm_shape_plan_t, HB_WASM_SHAPE_PLAN_POOL_SIZE> plans;
+  mutable hb_atomic_int_t warmed;
+
+  /* Metrics; see hb_wasm_shaper_get_stats(). */
+  mutable hb_atomic_int_t instantiations;
+  mutable hb_atomic_int_t checkouts;
+  mutable hb_atomic_int_t misses;
+  mutable hb_atomic_int_t discards;
 };
 
+static hb_wasm_shape_plan_t *
+create_shape_plan (hb_face_t *face,
+		   const hb_wasm_face_data_t *face_data);
+static void
+destroy_shape_plan (hb_wasm_shape_plan_t *plan);
+
 static bool
 _hb_wasm_init ()
 {
@@ -206,17 +240,14 @@ fail:
 }
 
 static hb_wasm_shape_plan_t *
-acquire_shape_plan (hb_face_t *face,
-		    const hb_wasm_face_data_t *face_data)
+create_shape_plan (hb_face_t *face,
+		   const hb_wasm_face_data_t *face_data)
 {
   char error[128];
 
-  /* Fetch cached one if available. */
-  hb_wasm_shape_plan_t *plan = face_data->plan.get_acquire ();
-  if (likely (plan && face_data->plan.cmpexch (plan, nullptr)))
-    return plan;
-
-  plan = (hb_wasm_shape_plan_t *) hb_calloc (1, sizeof (hb_wasm_shape_plan_t));
+  hb_wasm_shape_plan_t *plan = (hb_wasm_shape_plan_t *) hb_calloc (1, sizeof (hb_wasm_shape_plan_t));
+  if (unlikely (!plan))
+    return nullptr;
 
   wasm_module_inst_t module_inst = nullptr;
   wasm_exec_env_t exec_env = nullptr;
@@ -269,6 +300,7 @@ acquire_shape_plan (hb_face_t *face,
     plan->wasm_shape_planptr = results[0].of.i32;
   }
 
+  face_data->instantiations.inc ();
   return plan;
 
 fail:
@@ -281,14 +313,64 @@ fail:
   return nullptr;
 }
 
+/* Fills the pool on the first shaping with the face.  This is not done
+ * when creating the face data, since that may happen on several threads
+ * at once, all but one of them throwing their instances away, and since
+ * shape_plan_create() calls back into the face while it is half set up.
+ * Failing here is not fatal; shaping will retry and report. */
+static void
+warm_up_shape_plans (hb_face_t *face,
+		     const hb_wasm_face_data_t *face_data)
+{
+  if (likely (face_data->warmed.get_relaxed ()) || face_data->warmed.inc ())
+    return;
+
+  unsigned warm = hb_min (HB_WASM_SHAPE_PLAN_POOL_WARM, HB_WASM_SHAPE_PLAN_POOL_SIZE);
+  for (unsigned i = 0; i < warm; i++)
+  {
+    hb_wasm_shape_plan_t *plan = create_shape_plan (face, face_data);
+    if (unlikely (!plan))
+      break;
+    if (unlikely (!face_data->plans.put (plan)))
+    {
+      destroy_shape_plan (plan);
+      break;
+    }
+  }
+}
+
+static hb_wasm_shape_plan_t *
+acquire_shape_plan (hb_face_t *face,
+		    const hb_wasm_face_data_t *face_data)
+{
+  warm_up_shape_plans (face, face_data);
+
+  hb_wasm_shape_plan_t *plan = face_data->plans.take ();
+  if (plan)
+  {
+    face_data->checkouts.inc ();
+    return plan;
+  }
+
+  face_data->misses.inc ();
+  return create_shape_plan (face, face_data);
+}
+
 static void
 release_shape_plan (const hb_wasm_face_data_t *face_data,
 		    hb_wasm_shape_plan_t *plan,
 		    bool cache = false)
 {
-  if (cache && face_data->plan.cmpexch (nullptr, plan))
+  if (cache && face_data->plans.put (plan))
     return;
 
+  face_data->discards.inc ();
+  destroy_shape_plan (plan);
+}
+
+static void
+destroy_shape_plan (hb_wasm_shape_plan_t *plan)
+{
   auto *module_inst = plan->module_inst;
   auto *exec_env = plan->exec_env;
 
@@ -324,8 +406,7 @@ release_shape_plan (const hb_wasm_face_data_t *face_data,
 void
 _hb_wasm_shaper_face_data_destroy (hb_wasm_face_data_t *data)
 {
-  if (data->plan.get_relaxed ())
-    release_shape_plan (data, data->plan);
+  data->plans.fini (destroy_shape_plan);
   wasm_runtime_unload (data->wasm_module);
   hb_blob_destroy (data->wasm_blob);
   hb_free (data);
@@ -424,7 +505,7 @@ retry:
 				  ARRAY_LENGTH (arguments), arguments);
 
   if (num_features)
-    wasm_runtime_module_free (module_inst, arguments[2].of.i32);
+    wasm_runtime_module_free (module_inst, arguments[3].of.i32);
 
   if (unlikely (!ret || !results[0].of.i32))
   {
@@ -467,4 +548,42 @@ fail:
   return ret;
 }
 
+
+/*
+ * metrics
+ */
+
+/**
+ * hb_wasm_shaper_get_stats:
+ * @face: A face object
+ * @stats: (out): Return location for the counters
+ *
+ * Fetches the counters describing how the Wasm shaper has been reusing
+ * module instances for @face.  They are only available once @face has
+ * been shaped with the Wasm shaper.
+ *
+ * Return value: `true` if @face has Wasm shaper data, `false` otherwise,
+ * in which case @stats is zeroed
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_wasm_shaper_get_stats (hb_face_t              *face,
+			  hb_wasm_shaper_stats_t *stats /* OUT */)
+{
+  hb_memset (stats, 0, sizeof (*stats));
+
+  const hb_wasm_face_data_t *data = face->data.wasm.get_stored ();
+  if (!data)
+    return false;
+
+  stats->pool_size = HB_WASM_SHAPE_PLAN_POOL_SIZE;
+  stats->pool_idle = data->plans.get_idle ();
+  stats->instantiations = data->instantiations.get_relaxed ();
+  stats->checkouts = data->checkouts.get_relaxed ();
+  stats->misses = data->misses.get_relaxed ();
+  stats->discards = data->discards.get_relaxed ();
+  return true;
+}
+
 #endif
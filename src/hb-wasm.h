@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_WASM_H
+#define HB_WASM_H
+
+#include "hb.h"
+
+HB_BEGIN_DECLS
+
+
+/**
+ * hb_wasm_shaper_stats_t:
+ * @pool_size: maximum number of idle module instances kept for the face
+ * @pool_idle: number of module instances currently idle
+ * @instantiations: number of module instances created for the face,
+ *   including those made when the face was first shaped
+ * @checkouts: number of times shaping reused an idle module instance
+ * @misses: number of times shaping found no idle module instance and
+ *   had to create one
+ * @discards: number of module instances destroyed after shaping, because
+ *   shaping failed or the pool was full
+ *
+ * Counters describing how the Wasm shaper reuses module instances for
+ * a face.  The counters are updated without synchronization with each
+ * other, so they are only approximately consistent while other threads
+ * are shaping.
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_wasm_shaper_stats_t {
+  unsigned int pool_size;
+  unsigned int pool_idle;
+  unsigned int instantiations;
+  unsigned int checkouts;
+  unsigned int misses;
+  unsigned int discards;
+
+  /*< private >*/
+  hb_var_int_t reserved1;
+  hb_var_int_t reserved2;
+} hb_wasm_shaper_stats_t;
+
+HB_EXTERN hb_bool_t
+hb_wasm_shaper_get_stats (hb_face_t              *face,
+			  hb_wasm_shaper_stats_t *stats /* OUT */);
+
+
+HB_END_DECLS
+
+#endif /* HB_WASM_H */
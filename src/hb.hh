@@ -235,11 +235,18 @@ extern "C" void  hb_free_impl(void *ptr);
 #define hb_calloc hb_calloc_impl
 #define hb_realloc hb_realloc_impl
 #define hb_free hb_free_impl
-#else
+#elif defined(HB_NO_ALLOCATOR)
 #define hb_malloc malloc
 #define hb_calloc calloc
 #define hb_realloc realloc
 #define hb_free free
+#else
+/* Runtime allocator support; see hb_allocator_set(). */
+#define HB_RUNTIME_ALLOCATOR 1
+#define hb_malloc _hb_malloc
+#define hb_calloc _hb_calloc
+#define hb_realloc _hb_realloc
+#define hb_free _hb_free
 #endif
 
 
@@ -296,6 +303,19 @@ extern "C" void  hb_free_impl(void *ptr);
 # endif
 #endif
 
+#ifdef HB_RUNTIME_ALLOCATOR
+/* Defined at the end of this file, once hb-atomic.hh is in. */
+static inline void *_hb_malloc (size_t size);
+static inline void *_hb_calloc (size_t nmemb, size_t size);
+static inline void *_hb_realloc (void *ptr, size_t size);
+static inline void  _hb_free (void *ptr);
+/* Same, for when an allocator may be installed; in hb-common.cc. */
+HB_INTERNAL void *_hb_hooked_malloc (size_t size);
+HB_INTERNAL void *_hb_hooked_calloc (size_t nmemb, size_t size);
+HB_INTERNAL void *_hb_hooked_realloc (void *ptr, size_t size);
+HB_INTERNAL void  _hb_hooked_free (void *ptr);
+#endif
+
 /* https://github.com/harfbuzz/harfbuzz/issues/1651 */
 #if defined(__clang__) && __clang_major__ < 10
 #define static_const static
@@ -540,4 +560,33 @@ static_assert ((sizeof (hb_var_int_t) == 4), "");
 #include "hb-vector.hh"	// Requires: hb-array hb-null
 #include "hb-object.hh"	// Requires: hb-atomic hb-mutex hb-vector
 
+
+#ifdef HB_RUNTIME_ALLOCATOR
+/* Nonzero while an allocator is installed, and until the first
+ * allocation (see hb_allocator_set()).  Otherwise allocations go straight
+ * to the C library. */
+extern HB_INTERNAL hb_atomic_int_t _hb_allocator_hooks;
+
+static inline void *_hb_malloc (size_t size)
+{
+  if (likely (!_hb_allocator_hooks.get_relaxed ())) return malloc (size);
+  return _hb_hooked_malloc (size);
+}
+static inline void *_hb_calloc (size_t nmemb, size_t size)
+{
+  if (likely (!_hb_allocator_hooks.get_relaxed ())) return calloc (nmemb, size);
+  return _hb_hooked_calloc (nmemb, size);
+}
+static inline void *_hb_realloc (void *ptr, size_t size)
+{
+  if (likely (!_hb_allocator_hooks.get_relaxed ())) return realloc (ptr, size);
+  return _hb_hooked_realloc (ptr, size);
+}
+static inline void _hb_free (void *ptr)
+{
+  if (likely (!_hb_allocator_hooks.get_relaxed ())) { free (ptr); return; }
+  _hb_hooked_free (ptr);
+}
+#endif
+
 #endif /* HB_HH */
@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-atomic-pool.hh"
+
+#include <thread>
+
+/* Checks that hb_atomic_pool_t hands every parked object out once, and
+ * that objects neither get lost nor shared when threads take and put
+ * them concurrently, the way the Wasm shaper pools module instances. */
+
+struct object_t
+{
+  hb_atomic_int_t in_use;
+  unsigned id;
+};
+
+typedef hb_atomic_pool_t<object_t, 4> pool_t;
+
+static void
+test_single ()
+{
+  pool_t pool {};
+  object_t objects[5] = {};
+
+  assert (!pool.take ());
+  assert (!pool.get_idle ());
+
+  for (unsigned i = 0; i < 4; i++)
+    assert (pool.put (&objects[i]));
+  assert (!pool.put (&objects[4])); /* Full. */
+  assert (pool.get_idle () == 4);
+
+  /* Each parked object comes out exactly once. */
+  unsigned seen = 0;
+  for (unsigned i = 0; i < 4; i++)
+  {
+    object_t *p = pool.take ();
+    assert (p && p >= objects && p < objects + 4);
+    assert (!(seen & (1u << (p - objects))));
+    seen |= 1u << (p - objects);
+  }
+  assert (seen == 0xF);
+  assert (!pool.take ());
+  assert (!pool.get_idle ());
+
+  /* A lone object is found whichever slot the search starts at. */
+  for (unsigned i = 0; i < 10; i++)
+  {
+    assert (pool.put (&objects[i % 5]));
+    assert (pool.take () == &objects[i % 5]);
+  }
+
+  /* fini() hands back what is left. */
+  assert (pool.put (&objects[0]) && pool.put (&objects[3]));
+  unsigned destroyed = 0;
+  pool.fini ([&] (object_t *p) { assert (p == &objects[0] || p == &objects[3]); destroyed++; });
+  assert (destroyed == 2);
+  assert (!pool.get_idle () && !pool.take ());
+}
+
+static void
+test_threads ()
+{
+  static pool_t pool {};
+  static hb_atomic_int_t created, destroyed;
+  const unsigned num_threads = 8, iterations = 20000;
+
+  auto worker = [] (unsigned seed)
+  {
+    for (unsigned i = 0; i < iterations; i++)
+    {
+      object_t *p = pool.take ();
+      if (!p)
+      {
+	p = new object_t ();
+	p->id = created.inc ();
+      }
+      /* Nobody else may hold it. */
+      assert (!p->in_use.inc ());
+
+      seed = seed * 1103515245u + 12345u;
+      bool keep = (seed >> 16) % 8 != 0; /* Like a failed shaping. */
+
+      p->in_use.dec ();
+      if (!keep || !pool.put (p))
+      {
+	destroyed.inc ();
+	delete p;
+      }
+    }
+  };
+
+  std::thread threads[num_threads];
+  for (unsigned i = 0; i < num_threads; i++)
+    threads[i] = std::thread (worker, i + 1);
+  for (auto &t : threads)
+    t.join ();
+
+  /* Everything made is either destroyed or still parked. */
+  unsigned idle = pool.get_idle ();
+  assert (idle <= 4);
+  assert ((unsigned) created.get_relaxed () == (unsigned) destroyed.get_relaxed () + idle);
+  assert ((unsigned) created.get_relaxed () < num_threads * iterations);
+
+  pool.fini ([] (object_t *p) { destroyed.inc (); delete p; });
+  assert (created.get_relaxed () == destroyed.get_relaxed ());
+}
+
+int
+main (int argc, char **argv)
+{
+  test_single ();
+  test_threads ();
+  return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+#include "hb-bit-set-invertible.hh"
+
+#include <algorithm>
+#include <set>
+
+/* Differential test of the range-list / bit-set representations against
+ * std::set, through every operation that may switch representation. */
+
+typedef hb_bit_set_invertible_t set_t;
+typedef std::set<hb_codepoint_t> ref_t;
+
+static unsigned rng_state = 1;
+static unsigned
+rng ()
+{
+  rng_state = rng_state * 1103515245u + 12345u;
+  return rng_state >> 8;
+}
+
+/* The counts kept across edits on bits must match a full recount. */
+static void
+check_run_stats (const set_t &x)
+{
+  const hb_bit_set_adaptive_t &s = x.s;
+  if (!s.use_bits || s.runs == UINT_MAX) return;
+  unsigned pop, runs;
+  s.bits.get_run_stats (0, HB_SET_VALUE_INVALID - 1, &pop, &runs);
+  assert (s.population == pop);
+  assert (s.runs == runs);
+}
+
+static void
+check (const set_t &x, const ref_t &r)
+{
+  check_run_stats (x);
+  assert (!x.in_error ());
+  assert (x.get_population () == r.size ());
+  assert (x.is_empty () == r.empty ());
+  if (!r.empty ())
+  {
+    assert (x.get_min () == *r.begin ());
+    assert (x.get_max () == *r.rbegin ());
+  }
+
+  hb_codepoint_t c = HB_SET_VALUE_INVALID;
+  auto it = r.begin ();
+  while (x.next (&c))
+  {
+    assert (it != r.end () && *it == c);
+    ++it;
+  }
+  assert (it == r.end ());
+
+  c = HB_SET_VALUE_INVALID;
+  auto rit = r.rbegin ();
+  while (x.previous (&c))
+  {
+    assert (rit != r.rend () && *rit == c);
+    ++rit;
+  }
+  assert (rit == r.rend ());
+
+  hb_codepoint_t first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+  unsigned count = 0;
+  while (x.next_range (&first, &last))
+  {
+    assert (!first || !r.count (first - 1));
+    assert (!r.count (last + 1));
+    for (hb_codepoint_t i = first; i <= last; i++)
+      assert (r.count (i));
+    count += last - first + 1;
+  }
+  assert (count == r.size ());
+
+  first = last = HB_SET_VALUE_INVALID;
+  count = 0;
+  while (x.previous_range (&first, &last))
+  {
+    assert (!first || !r.count (first - 1));
+    assert (!r.count (last + 1));
+    count += last - first + 1;
+  }
+  assert (count == r.size ());
+
+  hb_codepoint_t out[64];
+  unsigned n = x.next_many (HB_SET_VALUE_INVALID, out, ARRAY_LENGTH (out));
+  it = r.begin ();
+  for (unsigned i = 0; i < n; i++, ++it)
+    assert (*it == out[i]);
+
+  /* Built element by element, so possibly in the other representation. */
+  set_t copy;
+  for (hb_codepoint_t v : r)
+    copy.add (v);
+  assert (copy.hash () == x.hash ());
+  assert (copy.is_equal (x) && x.is_equal (copy));
+  assert (copy.is_subset (x) && x.is_subset (copy));
+}
+
+static void
+test_run_stats ()
+{
+  /* Fragmented enough to live on bits. */
+  set_t s;
+  for (hb_codepoint_t g = 0; g < 200000; g += 2)
+    s.add (g);
+  assert (s.s.use_bits && s.s.runs == 100000);
+
+  /* Range edits keep the counts, also across pages and at the top. */
+  s.add_range (1000, 5000);
+  assert (s.s.runs == 100000 - 2000);
+  s.add_range (511, 513);
+  assert (s.s.runs == 100000 - 2000 - 2);
+  s.del_range (6000, 6000);
+  assert (s.s.runs == 100000 - 2000 - 3);
+  s.add_range (HB_SET_VALUE_INVALID - 3, HB_SET_VALUE_INVALID - 1);
+  s.del (HB_SET_VALUE_INVALID - 2);
+  s.add (HB_SET_VALUE_INVALID - 2);
+  check_run_stats (s);
+
+  /* Arrays drop them; the next range edit recounts once. */
+  hb_codepoint_t arr[] = {1, 3, 5};
+  s.add_array (arr, ARRAY_LENGTH (arr));
+  assert (s.s.runs == UINT_MAX);
+  s.add_range (0, 1023);
+  assert (s.s.runs != UINT_MAX);
+  check_run_stats (s);
+
+  /* Covering it all switches back to ranges. */
+  s.add_range (0, 300000);
+  assert (!s.s.use_bits && s.s.ranges.length == 2);
+  assert (s.get_population () == 300001 + 3);
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned modes[2] = {0, 0};
+
+  test_run_stats ();
+
+  for (unsigned iter = 0; iter < 1500; iter++)
+  {
+    set_t s, t;
+    ref_t rs, rt;
+    /* Mix dense and sparse sets, short and long runs. */
+    unsigned span = iter % 3 == 0 ? 200 : iter % 3 == 1 ? 5000 : 200000;
+    unsigned max_len = iter % 2 ? 3 : 700;
+
+    unsigned num_ops = rng () % 200;
+    for (unsigned k = 0; k < num_ops; k++)
+    {
+      set_t &x = k & 1 ? s : t;
+      ref_t &r = k & 1 ? rs : rt;
+      hb_codepoint_t a = rng () % span;
+      hb_codepoint_t b = a + rng () % max_len;
+      switch (rng () % 4)
+      {
+      case 0: x.add (a); r.insert (a); break;
+      case 1: x.add_range (a, b); for (hb_codepoint_t i = a; i <= b; i++) r.insert (i); break;
+      case 2: x.del (a); r.erase (a); break;
+      case 3: x.del_range (a, b); for (hb_codepoint_t i = a; i <= b; i++) r.erase (i); break;
+      }
+      assert (x.get_population () == r.size ());
+      check_run_stats (x);
+    }
+    modes[s.s.use_bits]++;
+    check (s, rs);
+    check (t, rt);
+
+    ref_t u (rs), in, mi, sy;
+    u.insert (rt.begin (), rt.end ());
+    for (hb_codepoint_t v : rs)
+      (rt.count (v) ? in : mi).insert (v);
+    sy = mi;
+    for (hb_codepoint_t v : rt)
+      if (!rs.count (v)) sy.insert (v);
+
+    set_t a;
+    a = s; a.union_ (t); check (a, u);
+    a = s; a.intersect (t); check (a, in);
+    a = s; a.subtract (t); check (a, mi);
+    a = s; a.symmetric_difference (t); check (a, sy);
+    a = s; a.invert (); a.invert (); check (a, rs);
+
+    hb_codepoint_t arr[50];
+    for (unsigned i = 0; i < ARRAY_LENGTH (arr); i++)
+      arr[i] = rng () % span;
+    ref_t ra (rs);
+    ra.insert (arr, arr + ARRAY_LENGTH (arr));
+    a = s; a.add_array (arr, ARRAY_LENGTH (arr)); check (a, ra);
+    std::sort (arr, arr + ARRAY_LENGTH (arr));
+    a = s; a.add_sorted_array (arr, ARRAY_LENGTH (arr)); check (a, ra);
+    ra = rs;
+    for (hb_codepoint_t v : arr)
+      ra.erase (v);
+    a = s; a.s.del_sorted_array (arr, ARRAY_LENGTH (arr)); check (a, ra);
+  }
+
+  /* Both representations must have been exercised. */
+  assert (modes[0] && modes[1]);
+
+  return 0;
+}
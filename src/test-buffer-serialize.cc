@@ -36,6 +36,258 @@
 #define hb_blob_create_from_file_or_fail(x)  hb_blob_get_empty ()
 #endif
 
+#ifndef HB_NO_BUFFER_SERIALIZE
+
+/* Serializes @buf in chunks of at most @chunk_size bytes, then reads the
+ * records back one by one. */
+static hb_buffer_t *
+binary_round_trip (hb_buffer_t *buf,
+		   hb_font_t *font,
+		   unsigned chunk_size,
+		   hb_buffer_serialize_flags_t flags)
+{
+  bool glyphs = hb_buffer_get_content_type (buf) == HB_BUFFER_CONTENT_TYPE_GLYPHS;
+  unsigned count = hb_buffer_get_length (buf);
+
+  char *data = (char *) malloc (16 * count + 64);
+  unsigned data_len = 0, records = 0;
+  char chunk[BUFSIZ];
+  assert (chunk_size <= sizeof (chunk));
+  for (unsigned offset = 0; offset < count; records++)
+  {
+    unsigned len, n;
+    if (glyphs)
+      n = hb_buffer_serialize_glyphs (buf, offset, count,
+				      chunk, chunk_size, &len,
+				      font, HB_BUFFER_SERIALIZE_FORMAT_BINARY, flags);
+    else
+      n = hb_buffer_serialize_unicode (buf, offset, count,
+				       chunk, chunk_size, &len,
+				       HB_BUFFER_SERIALIZE_FORMAT_BINARY, flags);
+    assert (n && len > 10);
+    memcpy (data + data_len, chunk, len);
+    data_len += len;
+    offset += n;
+  }
+
+  hb_buffer_t *out = hb_buffer_create ();
+  const char *p = data, *end = data + data_len;
+  for (unsigned i = 0; i < records; i++)
+  {
+    bool ok = glyphs ?
+	      hb_buffer_deserialize_glyphs (out, p, end - p, &p, font,
+					    HB_BUFFER_SERIALIZE_FORMAT_BINARY) :
+	      hb_buffer_deserialize_unicode (out, p, end - p, &p,
+					     HB_BUFFER_SERIALIZE_FORMAT_BINARY);
+    assert (ok);
+  }
+  assert (p == end);
+  assert (hb_buffer_get_length (out) == count);
+
+  free (data);
+  return out;
+}
+
+static hb_bool_t
+widest_extents (hb_font_t *font HB_UNUSED, void *font_data HB_UNUSED,
+		hb_codepoint_t glyph HB_UNUSED, hb_glyph_extents_t *extents,
+		void *user_data HB_UNUSED)
+{
+  extents->x_bearing = extents->y_bearing = INT32_MIN;
+  extents->width = extents->height = INT32_MIN;
+  return true;
+}
+
+static void
+test_binary (hb_font_t *font)
+{
+  hb_buffer_t *buf = hb_buffer_create ();
+  hb_buffer_set_content_type (buf, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+  for (unsigned i = 0; i < 1000; i++)
+    hb_buffer_add (buf, (i * 7919) % 70000, i / 3 * 5);
+  hb_buffer_add (buf, 0xFFFFFFFFu, 0);
+  hb_buffer_add (buf, 0, 0x7FFFFFFFu);
+
+  unsigned count;
+  hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buf, &count);
+  hb_glyph_position_t *pos = hb_buffer_get_glyph_positions (buf, nullptr);
+  for (unsigned i = 0; i < count; i++)
+  {
+    info[i].mask = i % 4 ? 0 : HB_GLYPH_FLAG_UNSAFE_TO_BREAK | HB_GLYPH_FLAG_UNSAFE_TO_CONCAT;
+    pos[i].x_advance = 500 + (int) (i % 37) * 13;
+    pos[i].y_advance = i % 11 ? 0 : -1200;
+    pos[i].x_offset = i % 5 ? 0 : -(int) i;
+    pos[i].y_offset = i % 7 ? 0 : INT32_MAX - (int) i;
+  }
+  pos[count - 1].x_advance = INT32_MIN;
+
+  /* Everything survives, whether in one record or many small ones. */
+  for (unsigned chunk_size : {(unsigned) BUFSIZ, 100u, 40u})
+  {
+    hb_buffer_t *out = binary_round_trip (buf, font, chunk_size,
+					  HB_BUFFER_SERIALIZE_FLAG_GLYPH_FLAGS);
+    assert (hb_buffer_diff (out, buf, (hb_codepoint_t) -1, 0) == HB_BUFFER_DIFF_FLAG_EQUAL);
+    hb_buffer_destroy (out);
+  }
+
+  /* Fields left out come back as zero. */
+  {
+    hb_buffer_t *out = binary_round_trip (buf, font, 64,
+					  (hb_buffer_serialize_flags_t) (HB_BUFFER_SERIALIZE_FLAG_NO_CLUSTERS |
+									 HB_BUFFER_SERIALIZE_FLAG_NO_POSITIONS));
+    hb_glyph_info_t *out_info = hb_buffer_get_glyph_infos (out, nullptr);
+    hb_glyph_position_t *out_pos = hb_buffer_get_glyph_positions (out, nullptr);
+    for (unsigned i = 0; i < count; i++)
+    {
+      assert (out_info[i].codepoint == info[i].codepoint);
+      assert (out_info[i].cluster == 0);
+      assert (out_info[i].mask == 0);
+      assert (!out_pos[i].x_advance && !out_pos[i].x_offset);
+    }
+    hb_buffer_destroy (out);
+  }
+
+  /* Without advances, offsets carry the pen position within a record. */
+  {
+    char data[BUFSIZ];
+    unsigned len;
+    assert (hb_buffer_serialize_glyphs (buf, 0, 200, data, sizeof (data), &len,
+					font, HB_BUFFER_SERIALIZE_FORMAT_BINARY,
+					(hb_buffer_serialize_flags_t) (HB_BUFFER_SERIALIZE_FLAG_NO_ADVANCES |
+								       HB_BUFFER_SERIALIZE_FLAG_GLYPH_EXTENTS)) == 200);
+    hb_buffer_t *out = hb_buffer_create ();
+    assert (hb_buffer_deserialize_glyphs (out, data, len, nullptr, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (hb_buffer_get_length (out) == 200);
+    hb_glyph_position_t *out_pos = hb_buffer_get_glyph_positions (out, nullptr);
+    hb_position_t x = 0;
+    for (unsigned i = 0; i < 200; i++)
+    {
+      assert (out_pos[i].x_offset == x + pos[i].x_offset);
+      assert (out_pos[i].x_advance == 0);
+      x += pos[i].x_advance;
+    }
+    hb_buffer_destroy (out);
+  }
+
+  /* The encoding is compact. */
+  {
+    char data[BUFSIZ];
+    unsigned len;
+    assert (hb_buffer_serialize_glyphs (buf, 0, 100, data, sizeof (data), &len,
+					font, HB_BUFFER_SERIALIZE_FORMAT_BINARY,
+					HB_BUFFER_SERIALIZE_FLAG_DEFAULT) == 100);
+    assert (len < 10 + 100 * 10);
+
+    /* Bad input is rejected and leaves the buffer alone. */
+    hb_buffer_t *out = hb_buffer_create ();
+    const char *p = data;
+    assert (!hb_buffer_deserialize_glyphs (out, data, -1, &p, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (!hb_buffer_deserialize_glyphs (out, data, len - 1, &p, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (p == data && hb_buffer_get_length (out) == 0);
+    hb_buffer_t *unicode = hb_buffer_create ();
+    assert (!hb_buffer_deserialize_unicode (unicode, data, len, &p, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (hb_buffer_get_length (unicode) == 0);
+    assert (hb_buffer_get_content_type (unicode) == HB_BUFFER_CONTENT_TYPE_INVALID);
+    hb_buffer_destroy (unicode);
+    data[3]++;
+    assert (!hb_buffer_deserialize_glyphs (out, data, len, &p, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    data[3]--;
+    data[9] = 0x7F;
+    assert (!hb_buffer_deserialize_glyphs (out, data, len, &p, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (p == data && hb_buffer_get_length (out) == 0);
+    assert (hb_buffer_get_content_type (out) == HB_BUFFER_CONTENT_TYPE_INVALID);
+    data[9] = 0;
+
+    /* A failed record appended to glyphs leaves them as they were. */
+    assert (hb_buffer_deserialize_glyphs (out, data, len, &p, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (hb_buffer_get_length (out) == 100);
+    assert (!hb_buffer_deserialize_glyphs (out, data, len - 1, &p, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (hb_buffer_get_length (out) == 100);
+    assert (hb_buffer_get_content_type (out) == HB_BUFFER_CONTENT_TYPE_GLYPHS);
+    hb_buffer_destroy (out);
+  }
+
+  /* A record with every field at its widest is written whole. */
+  {
+    hb_font_t *sub = hb_font_create_sub_font (font);
+    hb_font_funcs_t *funcs = hb_font_funcs_create ();
+    hb_font_funcs_set_glyph_extents_func (funcs, widest_extents, nullptr, nullptr);
+    hb_font_set_funcs (sub, funcs, nullptr, nullptr);
+    hb_font_funcs_destroy (funcs);
+
+    hb_buffer_t *wide = hb_buffer_create ();
+    hb_buffer_set_content_type (wide, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+    hb_buffer_add (wide, 0x7FFFFFFFu, 0x7FFFFFFFu);
+    hb_glyph_info_t *wide_info = hb_buffer_get_glyph_infos (wide, nullptr);
+    hb_glyph_position_t *wide_pos = hb_buffer_get_glyph_positions (wide, nullptr);
+    wide_info[0].mask = HB_GLYPH_FLAG_DEFINED;
+    wide_pos[0].x_offset = wide_pos[0].y_offset = INT32_MIN;
+    wide_pos[0].x_advance = wide_pos[0].y_advance = INT32_MIN;
+
+    /* Ten bytes of header, five per field but one for the flags. */
+    char data[10 + 10 * 5 + 1 + 1];
+    unsigned len;
+    assert (hb_buffer_serialize_glyphs (wide, 0, 1, data, sizeof (data), &len,
+					sub, HB_BUFFER_SERIALIZE_FORMAT_BINARY,
+					(hb_buffer_serialize_flags_t) (HB_BUFFER_SERIALIZE_FLAG_GLYPH_FLAGS |
+								       HB_BUFFER_SERIALIZE_FLAG_GLYPH_EXTENTS)) == 1);
+    assert (len == sizeof (data) - 1);
+    hb_buffer_t *out = hb_buffer_create ();
+    assert (hb_buffer_deserialize_glyphs (out, data, len, nullptr, sub, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (hb_buffer_diff (out, wide, (hb_codepoint_t) -1, 0) == HB_BUFFER_DIFF_FLAG_EQUAL);
+    hb_buffer_destroy (out);
+    hb_buffer_destroy (wide);
+    hb_font_destroy (sub);
+  }
+
+  hb_buffer_destroy (buf);
+
+  /* Unicode buffers. */
+  buf = hb_buffer_create ();
+  hb_buffer_add_utf8 (buf, "\xd8\xa8\xd9\x90\xd8\xb3\xd9\x92 Latin \xf0\x9f\x98\x80", -1, 0, -1);
+  {
+    hb_buffer_t *out = binary_round_trip (buf, font, 16, HB_BUFFER_SERIALIZE_FLAG_DEFAULT);
+    assert (hb_buffer_get_content_type (out) == HB_BUFFER_CONTENT_TYPE_UNICODE);
+    assert (hb_buffer_diff (out, buf, (hb_codepoint_t) -1, 0) == HB_BUFFER_DIFF_FLAG_EQUAL);
+    hb_buffer_destroy (out);
+  }
+  {
+    /* Unicode records are not glyphs. */
+    char data[BUFSIZ];
+    unsigned len;
+    assert (hb_buffer_serialize_unicode (buf, 0, -1, data, sizeof (data), &len,
+					 HB_BUFFER_SERIALIZE_FORMAT_BINARY,
+					 HB_BUFFER_SERIALIZE_FLAG_DEFAULT));
+    hb_buffer_t *out = hb_buffer_create ();
+    assert (!hb_buffer_deserialize_glyphs (out, data, len, nullptr, font, HB_BUFFER_SERIALIZE_FORMAT_BINARY));
+    assert (hb_buffer_get_length (out) == 0);
+    assert (hb_buffer_get_content_type (out) == HB_BUFFER_CONTENT_TYPE_INVALID);
+    hb_buffer_destroy (out);
+  }
+  hb_buffer_destroy (buf);
+
+  /* Buffers with nothing in them write no record, whatever their content. */
+  {
+    char data[16];
+    unsigned len = 1;
+    buf = hb_buffer_create ();
+    assert (!hb_buffer_serialize (buf, 0, -1, data, sizeof (data), &len, font,
+				  HB_BUFFER_SERIALIZE_FORMAT_BINARY, HB_BUFFER_SERIALIZE_FLAG_DEFAULT));
+    assert (len == 0 && !data[0]);
+    hb_buffer_set_content_type (buf, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+    len = 1;
+    assert (!hb_buffer_serialize (buf, 0, -1, data, sizeof (data), &len, font,
+				  HB_BUFFER_SERIALIZE_FORMAT_BINARY, HB_BUFFER_SERIALIZE_FLAG_DEFAULT));
+    assert (len == 0 && !data[0]);
+    hb_buffer_destroy (buf);
+  }
+
+  assert (hb_buffer_serialize_format_from_string ("binary", -1) == HB_BUFFER_SERIALIZE_FORMAT_BINARY);
+  assert (!strcmp (hb_buffer_serialize_format_to_string (HB_BUFFER_SERIALIZE_FORMAT_BINARY), "binary"));
+}
+
+#endif
+
 int
 main (int argc, char **argv)
 {
@@ -57,6 +309,8 @@ main (int argc, char **argv)
   hb_face_destroy (face);
   hb_font_set_scale (font, upem, upem);
 
+  test_binary (font);
+
   hb_buffer_t *buf;
   buf = hb_buffer_create ();
 
@@ -92,6 +346,14 @@ main (int argc, char **argv)
     }
 
     unsigned count = hb_buffer_get_length (buf);
+
+    if (count)
+    {
+      hb_buffer_t *copy = binary_round_trip (buf, font, 64, HB_BUFFER_SERIALIZE_FLAG_GLYPH_FLAGS);
+      assert (hb_buffer_diff (copy, buf, (hb_codepoint_t) -1, 0) == HB_BUFFER_DIFF_FLAG_EQUAL);
+      hb_buffer_destroy (copy);
+    }
+
     for (unsigned offset = 0; offset < count;)
     {
       unsigned len;
@@ -0,0 +1,238 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+
+/* Glyph ids depend on a generation counter, so reshaping after bumping it
+ * no longer matches what was sampled. */
+static unsigned generation;
+static bool unstable; /* Bump it on every lookup. */
+
+static hb_bool_t
+nominal_glyph (hb_font_t *font HB_UNUSED, void *font_data HB_UNUSED,
+	       hb_codepoint_t unicode, hb_codepoint_t *glyph,
+	       void *user_data HB_UNUSED)
+{
+  *glyph = unicode + 1000 * (unstable ? generation++ : generation);
+  return true;
+}
+
+struct report_t
+{
+  unsigned count;
+  bool destroyed;
+  char text[64];
+  char features[64];
+  char glyphs[256];
+  char message[256];
+};
+
+static void
+report (hb_font_t *font HB_UNUSED, const hb_segment_properties_t *props,
+	const char *text, const char *features, const char *glyphs,
+	const char *message, void *user_data)
+{
+  report_t *r = (report_t *) user_data;
+  assert (props->direction == HB_DIRECTION_LTR);
+  r->count++;
+  strncpy (r->text, text, sizeof (r->text) - 1);
+  strncpy (r->features, features, sizeof (r->features) - 1);
+  strncpy (r->glyphs, glyphs, sizeof (r->glyphs) - 1);
+  strncpy (r->message, message, sizeof (r->message) - 1);
+}
+
+static void
+report_destroy (void *user_data)
+{
+  ((report_t *) user_data)->destroyed = true;
+}
+
+static hb_font_t *
+create_font ()
+{
+  hb_face_t *face = hb_face_builder_create ();
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  hb_font_funcs_t *funcs = hb_font_funcs_create ();
+  hb_font_funcs_set_nominal_glyph_func (funcs, nominal_glyph, nullptr, nullptr);
+  hb_font_set_funcs (font, funcs, nullptr, nullptr);
+  hb_font_funcs_destroy (funcs);
+  return font;
+}
+
+static bool
+shape (hb_font_t *font, unsigned times = 1,
+       const char * const *shapers = nullptr)
+{
+  hb_feature_t feature;
+  hb_feature_from_string ("liga=0", -1, &feature);
+  bool ret = true;
+  for (unsigned i = 0; i < times; i++)
+  {
+    hb_buffer_t *buffer = hb_buffer_create ();
+    hb_buffer_set_flags (buffer, HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT);
+    hb_buffer_add_utf8 (buffer, "abc", -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    ret = hb_shape_full (font, buffer, &feature, 1, shapers) && ret;
+    /* Sampling never changes the result. */
+    assert (hb_buffer_get_length (buffer) == 3);
+    assert (hb_buffer_get_glyph_infos (buffer, nullptr)[0].codepoint == 'a' + 1000 * generation);
+    hb_buffer_destroy (buffer);
+  }
+  return ret;
+}
+
+static void
+test_sampling (hb_font_t *font)
+{
+  /* Off by default. */
+  shape (font, 10);
+  assert (hb_buffer_verify_run_pending (-1) == 0);
+
+  /* One in three. */
+  hb_buffer_verify_set_sampling (3, 0, nullptr, nullptr, nullptr);
+  shape (font, 9);
+  assert (hb_buffer_verify_run_pending (-1) == 3);
+  shape (font, 30);
+  assert (hb_buffer_verify_run_pending (-1) == 10);
+
+  /* A reused buffer is counted on its own. */
+  hb_buffer_t *buffer = hb_buffer_create ();
+  for (unsigned i = 0; i < 30; i++)
+  {
+    hb_buffer_reset (buffer);
+    hb_buffer_add_utf8 (buffer, "abc", -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    hb_shape (font, buffer, nullptr, 0);
+  }
+  hb_buffer_destroy (buffer);
+  assert (hb_buffer_verify_run_pending (-1) == 10);
+
+  /* The budget is refilled by every run. */
+  hb_buffer_verify_set_sampling (1, 2, nullptr, nullptr, nullptr);
+  shape (font, 5);
+  assert (hb_buffer_verify_run_pending (-1) == 2);
+  shape (font, 5);
+  assert (hb_buffer_verify_run_pending (-1) == 2);
+
+  /* Explicit shaper lists are not sampled. */
+  hb_buffer_verify_set_sampling (1, 0, nullptr, nullptr, nullptr);
+  const char *shapers[] = {"ot", "fallback", nullptr};
+  shape (font, 5, shapers);
+  assert (hb_buffer_verify_run_pending (-1) == 0);
+
+  /* Stopping. */
+  hb_buffer_verify_set_sampling (0, 0, nullptr, nullptr, nullptr);
+  shape (font, 5);
+  assert (hb_buffer_verify_run_pending (-1) == 0);
+}
+
+static void
+test_pending (hb_font_t *font)
+{
+  hb_buffer_verify_set_sampling (1, 0, nullptr, nullptr, nullptr);
+
+  /* The queue is capped. */
+  shape (font, 100);
+  assert (hb_buffer_verify_run_pending (-1) == 64);
+  assert (hb_buffer_verify_run_pending (-1) == 0);
+
+  /* What is not run is put back, oldest first. */
+  shape (font, 5);
+  assert (hb_buffer_verify_run_pending (2) == 2);
+  assert (hb_buffer_verify_run_pending (0) == 0);
+  assert (hb_buffer_verify_run_pending (-1) == 3);
+  assert (hb_buffer_verify_run_pending (-1) == 0);
+
+  /* Samples whose font changed are dropped. */
+  shape (font, 3);
+  hb_font_set_scale (font, 2000, 2000);
+  assert (hb_buffer_verify_run_pending (-1) == 0);
+
+  hb_buffer_verify_set_sampling (0, 0, nullptr, nullptr, nullptr);
+}
+
+static void
+test_report (hb_font_t *font)
+{
+  report_t r = {};
+  hb_buffer_verify_set_sampling (1, 0, report, &r, report_destroy);
+
+  /* Stable results pass. */
+  assert (shape (font));
+  assert (hb_buffer_verify_run_pending (-1) == 1);
+  assert (!r.count);
+
+  /* Results that change on reshaping are reported, with the inputs. */
+  assert (shape (font));
+  generation++;
+  assert (hb_buffer_verify_run_pending (-1) == 1);
+  assert (r.count == 1);
+  assert (!strcmp (r.text, "<U+0061=0|U+0062=1|U+0063=2>"));
+  assert (!strcmp (r.features, "-liga"));
+  assert (strstr (r.glyphs, "gid97=0"));
+  assert (strstr (r.message, "unsafe-to-break test failed."));
+
+  /* Replacing the callback releases the old one. */
+  assert (!r.destroyed);
+  report_t r2 = {};
+  hb_buffer_verify_set_sampling (1, 0, report, &r2, report_destroy);
+  assert (r.destroyed && !r2.destroyed);
+  assert (shape (font));
+  generation++;
+  assert (hb_buffer_verify_run_pending (-1) == 1);
+  assert (r.count == 1 && r2.count == 1);
+
+  hb_buffer_verify_set_sampling (0, 0, nullptr, nullptr, nullptr);
+  assert (r2.destroyed);
+}
+
+static void
+test_verify_flag (hb_font_t *font)
+{
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_buffer_set_flags (buffer, HB_BUFFER_FLAG_VERIFY);
+  hb_buffer_add_utf8 (buffer, "abc", -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+
+  /* The unsafe-to-break check reshapes the fragments. */
+  unstable = true;
+  assert (!hb_shape_full (font, buffer, nullptr, 0, nullptr));
+  unstable = false;
+
+  hb_buffer_destroy (buffer);
+}
+
+int
+main (int argc, char **argv)
+{
+  hb_font_t *font = create_font ();
+  test_sampling (font);
+  test_pending (font);
+  test_report (font);
+  test_verify_flag (font);
+  hb_font_destroy (font);
+  return 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-ot.h"
+
+#include <string.h>
+
+/* Checks hb_face_collect_catalog_info() against the individual calls it
+ * stands in for, on compiled and builder faces, and that requested groups
+ * are cleared on faces that lack their tables. */
+
+static void
+push16 (hb_vector_t<char> &v, unsigned x)
+{
+  v.push ((char) (x >> 8));
+  v.push ((char) x);
+}
+
+static void
+push32 (hb_vector_t<char> &v, unsigned x)
+{
+  push16 (v, x >> 16);
+  push16 (v, x & 0xFFFF);
+}
+
+static void
+add_table (hb_face_t *face, hb_tag_t tag, const hb_vector_t<char> &t)
+{
+  assert (!t.in_error ());
+  hb_blob_t *blob = hb_blob_create (t.arrayZ, t.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+  hb_face_builder_add_table (face, tag, blob);
+  hb_blob_destroy (blob);
+}
+
+/* Windows English names: family, subfamily, full and PostScript names, and
+ * a typographic family that takes precedence over the family. */
+static void
+add_name (hb_face_t *face)
+{
+  static const struct { unsigned name_id; const char *text; } records[] = {
+    {1, "Sample"},
+    {2, "Bold"},
+    {4, "Sample Display Bold"},
+    {6, "SampleDisplay-Bold"},
+    {16, "Sample Display"},
+  };
+  hb_vector_t<char> t, strings;
+  push16 (t, 0);
+  push16 (t, ARRAY_LENGTH (records));
+  push16 (t, 6 + 12 * ARRAY_LENGTH (records));
+  for (const auto &r : records)
+  {
+    unsigned offset = strings.length;
+    for (const char *p = r.text; *p; p++)
+      push16 (strings, (unsigned char) *p);
+    push16 (t, 3); push16 (t, 1); push16 (t, 0x0409); push16 (t, r.name_id);
+    push16 (t, strings.length - offset); push16 (t, offset);
+  }
+  for (char c : strings)
+    t.push (c);
+  add_table (face, HB_TAG ('n','a','m','e'), t);
+}
+
+/* Version 1, weight 700, width 3, with distinct range bits. */
+static void
+add_os2 (hb_face_t *face)
+{
+  hb_vector_t<char> t;
+  push16 (t, 1);		/* version */
+  push16 (t, 500);		/* xAvgCharWidth */
+  push16 (t, 700);		/* usWeightClass */
+  push16 (t, 3);		/* usWidthClass */
+  while (t.length < 42)
+    t.push (0);
+  push32 (t, 0x00000003);	/* ulUnicodeRange1 */
+  push32 (t, 0x10000000);	/* ulUnicodeRange2 */
+  push32 (t, 0x00000040);	/* ulUnicodeRange3 */
+  push32 (t, 0x00000100);	/* ulUnicodeRange4 */
+  push32 (t, HB_TAG ('N','O','N','E'));
+  push16 (t, 0x0020);		/* fsSelection: bold */
+  push16 (t, 0x20); push16 (t, 0x5A);
+  while (t.length < 78)
+    t.push (0);
+  push32 (t, 0x00000001);	/* ulCodePageRange1 */
+  push32 (t, 0x80000000);	/* ulCodePageRange2 */
+  add_table (face, HB_TAG ('O','S','/','2'), t);
+}
+
+/* Format 12: U+0041..U+005A and U+1F600..U+1F601. */
+static void
+add_cmap (hb_face_t *face)
+{
+  hb_vector_t<char> t;
+  push16 (t, 0); push16 (t, 1);
+  push16 (t, 3); push16 (t, 10); push32 (t, 12);
+  push16 (t, 12); push16 (t, 0); push32 (t, 16 + 2 * 12); push32 (t, 0); push32 (t, 2);
+  push32 (t, 0x41); push32 (t, 0x5A); push32 (t, 1);
+  push32 (t, 0x1F600); push32 (t, 0x1F601); push32 (t, 27);
+  add_table (face, HB_TAG ('c','m','a','p'), t);
+}
+
+static hb_face_t *
+create_face (bool full, bool compile)
+{
+  hb_face_t *face = hb_face_builder_create ();
+  if (full)
+  {
+    add_name (face);
+    add_os2 (face);
+    add_cmap (face);
+  }
+  static const char maxp[] = {0,0,0x50,0, 0,30};
+  hb_blob_t *blob = hb_blob_create (maxp, sizeof (maxp), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_TAG ('m','a','x','p'), blob);
+  hb_blob_destroy (blob);
+  if (!compile)
+    return face;
+
+  blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static void
+check_name (hb_face_t *face, const char *name, hb_ot_name_id_t name_id)
+{
+  char text[64];
+  unsigned size = sizeof (text);
+  hb_ot_name_get_utf8 (face, name_id, hb_language_from_string ("en", -1), &size, text);
+#ifndef HB_NO_OT_NAME_CACHE
+  assert (name && !strcmp (name, text));
+#else
+  /* Nowhere to keep the strings; callers use hb_ot_name_get_utf8(). */
+  assert (!name && size);
+#endif
+}
+
+/* Fills everything with junk, to check that requested groups are cleared. */
+static void
+scribble (hb_face_catalog_info_t *info, hb_set_t *unicodes)
+{
+  memset (info, 0xAB, sizeof (*info));
+  info->unicodes = unicodes;
+}
+
+static void
+test_full (bool compile)
+{
+  hb_face_t *face = create_face (true, compile);
+  hb_font_t *font = hb_font_create (face);
+  hb_set_t *unicodes = hb_set_create ();
+  hb_face_catalog_info_t info;
+  scribble (&info, unicodes);
+
+  unsigned found = hb_face_collect_catalog_info (face, HB_FACE_CATALOG_FIELD_ALL, &info);
+  unsigned expected = HB_FACE_CATALOG_FIELD_STYLE | HB_FACE_CATALOG_FIELD_UNICODE_RANGES |
+		      HB_FACE_CATALOG_FIELD_UNICODES | HB_FACE_CATALOG_FIELD_COLOR;
+#ifndef HB_NO_OT_NAME_CACHE
+  expected |= HB_FACE_CATALOG_FIELD_NAMES;
+#endif
+  assert (found == expected);
+
+  check_name (face, info.family_name, HB_OT_NAME_ID_TYPOGRAPHIC_FAMILY);
+  check_name (face, info.style_name, HB_OT_NAME_ID_FONT_SUBFAMILY);
+  check_name (face, info.full_name, HB_OT_NAME_ID_FULL_NAME);
+  check_name (face, info.postscript_name, HB_OT_NAME_ID_POSTSCRIPT_NAME);
+#ifndef HB_NO_OT_NAME_CACHE
+  assert (!strcmp (info.family_name, "Sample Display"));
+  /* Same storage on the next call. */
+  hb_face_catalog_info_t again;
+  scribble (&again, nullptr);
+  hb_face_collect_catalog_info (face, HB_FACE_CATALOG_FIELD_NAMES, &again);
+  assert (again.family_name == info.family_name && again.postscript_name == info.postscript_name);
+#endif
+
+  assert (info.weight == hb_style_get_value (font, HB_STYLE_TAG_WEIGHT));
+  assert (info.width == hb_style_get_value (font, HB_STYLE_TAG_WIDTH));
+  assert (info.italic == hb_style_get_value (font, HB_STYLE_TAG_ITALIC));
+  assert (info.slant_angle == hb_style_get_value (font, HB_STYLE_TAG_SLANT_ANGLE));
+  assert (info.optical_size == hb_style_get_value (font, HB_STYLE_TAG_OPTICAL_SIZE));
+  assert (info.weight == 700.f);
+
+  assert (info.unicode_ranges[0] == 0x00000003 && info.unicode_ranges[1] == 0x10000000 &&
+	  info.unicode_ranges[2] == 0x00000040 && info.unicode_ranges[3] == 0x00000100);
+  assert (info.code_page_ranges[0] == 0x00000001 && info.code_page_ranges[1] == 0x80000000);
+
+  hb_set_t *direct = hb_set_create ();
+  hb_face_collect_unicodes (face, direct);
+  assert (hb_set_get_population (unicodes) == 28);
+  assert (hb_set_is_equal (unicodes, direct));
+  assert (info.unicodes == unicodes);
+  hb_set_destroy (direct);
+
+  assert (!info.axis_count && !info.named_instance_count);
+  assert (info.color == HB_FACE_CATALOG_COLOR_NONE);
+
+  hb_set_destroy (unicodes);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+test_empty (bool compile)
+{
+  hb_face_t *face = create_face (false, compile);
+  hb_set_t *unicodes = hb_set_create ();
+  hb_face_catalog_info_t info;
+  scribble (&info, unicodes);
+
+  unsigned found = hb_face_collect_catalog_info (face, HB_FACE_CATALOG_FIELD_ALL, &info);
+  assert (found == (HB_FACE_CATALOG_FIELD_STYLE | HB_FACE_CATALOG_FIELD_COLOR));
+  assert (!info.family_name && !info.style_name && !info.full_name && !info.postscript_name);
+  for (unsigned i = 0; i < 4; i++)
+    assert (!info.unicode_ranges[i]);
+  assert (!info.code_page_ranges[0] && !info.code_page_ranges[1]);
+  assert (hb_set_is_empty (unicodes));
+  assert (!info.axis_count && !info.named_instance_count);
+  assert (info.color == HB_FACE_CATALOG_COLOR_NONE);
+
+  hb_set_destroy (unicodes);
+  hb_face_destroy (face);
+}
+
+static void
+test_untouched ()
+{
+  hb_face_t *face = create_face (true, true);
+  hb_face_catalog_info_t info, before;
+  scribble (&info, nullptr);
+  before = info;
+
+  /* Only the requested group is written to. */
+  unsigned found = hb_face_collect_catalog_info (face, HB_FACE_CATALOG_FIELD_UNICODE_RANGES, &info);
+  assert (found == HB_FACE_CATALOG_FIELD_UNICODE_RANGES);
+  assert (info.unicode_ranges[0] == 0x00000003);
+  hb_memcpy (info.unicode_ranges, before.unicode_ranges, sizeof (info.unicode_ranges));
+  hb_memcpy (info.code_page_ranges, before.code_page_ranges, sizeof (info.code_page_ranges));
+  assert (!memcmp (&info, &before, sizeof (info)));
+
+  /* No set, no characters. */
+  found = hb_face_collect_catalog_info (face, HB_FACE_CATALOG_FIELD_UNICODES, &info);
+  assert (!found);
+
+  hb_face_destroy (face);
+}
+
+int
+main ()
+{
+  test_full (true);
+  test_full (false);
+  test_empty (true);
+  test_empty (false);
+  test_untouched ();
+  return 0;
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-set.hh"
+
+#include <stdlib.h>
+
+/* Checks hb_face_collection_index_t lookups against the coverage sets it
+ * was built from, before and after a serialize / load round trip, and that
+ * damaged serialized indices are rejected. */
+
+static void
+push16 (hb_vector_t<char> &v, unsigned x)
+{
+  v.push ((char) (x >> 8));
+  v.push ((char) x);
+}
+
+static void
+push32 (hb_vector_t<char> &v, unsigned x)
+{
+  push16 (v, x >> 16);
+  push16 (v, x & 0xFFFF);
+}
+
+static unsigned
+get32 (const char *p)
+{
+  return (uint8_t) p[0] << 24 | (uint8_t) p[1] << 16 | (uint8_t) p[2] << 8 | (uint8_t) p[3];
+}
+
+static void
+set32 (char *p, unsigned v)
+{
+  p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+/* A face whose format 12 cmap maps every code point of @unicodes. */
+static hb_face_t *
+create_face (const hb_set_t *unicodes)
+{
+  hb_vector_t<char> t;
+  unsigned num_groups = 0;
+  hb_codepoint_t first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+  while (hb_set_next_range (unicodes, &first, &last))
+    num_groups++;
+
+  push16 (t, 0); push16 (t, 1);
+  push16 (t, 3); push16 (t, 10); push32 (t, 12);
+  push16 (t, 12); push16 (t, 0); push32 (t, 16 + 12 * num_groups); push32 (t, 0); push32 (t, num_groups);
+  first = last = HB_SET_VALUE_INVALID;
+  while (hb_set_next_range (unicodes, &first, &last))
+  {
+    push32 (t, first); push32 (t, last); push32 (t, 1);
+  }
+  assert (!t.in_error ());
+
+  hb_face_t *builder = hb_face_builder_create ();
+  hb_blob_t *blob = hb_blob_create (t.arrayZ, t.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+  hb_face_builder_add_table (builder, HB_TAG ('c','m','a','p'), blob);
+  hb_blob_destroy (blob);
+  static const char maxp[] = {0,0,0x50,0, (char) 0xFF,(char) 0xFF};
+  blob = hb_blob_create (maxp, sizeof (maxp), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+  hb_face_builder_add_table (builder, HB_TAG ('m','a','x','p'), blob);
+  hb_blob_destroy (blob);
+
+  blob = hb_face_reference_blob (builder);
+  hb_face_destroy (builder);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static unsigned
+expected_face (const hb_vector_t<hb_set_t *> &sets, hb_codepoint_t u)
+{
+  for (unsigned i = 0; i < sets.length; i++)
+    if (hb_set_has (sets[i], u))
+      return i;
+  return HB_FACE_COLLECTION_INDEX_NO_FACE;
+}
+
+static void
+check_index (const hb_face_collection_index_t *index,
+	     const hb_vector_t<hb_set_t *> &sets,
+	     const hb_set_t *probes)
+{
+  assert (hb_face_collection_index_get_face_count (index) == sets.length);
+  hb_set_t *faces = hb_set_create ();
+  for (hb_codepoint_t u : probes->iter ())
+  {
+    unsigned want = expected_face (sets, u);
+    assert (hb_face_collection_index_lookup (index, u) == want);
+
+    hb_set_clear (faces);
+    assert ((bool) hb_face_collection_index_get_faces (index, u, faces) ==
+	    (want != HB_FACE_COLLECTION_INDEX_NO_FACE));
+    for (unsigned i = 0; i < sets.length; i++)
+      assert ((bool) hb_set_has (faces, i) == (bool) hb_set_has (sets[i], u));
+  }
+  hb_set_destroy (faces);
+}
+
+static void
+check_buffer (const hb_face_collection_index_t *index,
+	      const hb_vector_t<hb_set_t *> &sets)
+{
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_buffer_add_utf8 (buffer, "Hello, \xD0\xBC\xD0\xB8\xD1\x80! \xE4\xBD\xA0 \xF0\x9F\x98\x80 \xCE\xB1\xCE\xB2", -1, 0, -1);
+  unsigned len = hb_buffer_get_length (buffer);
+  hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, nullptr);
+
+  hb_vector_t<unsigned> face_indices;
+  face_indices.resize (len);
+  unsigned uncovered = hb_face_collection_index_lookup_buffer (index, buffer, face_indices.arrayZ);
+  unsigned count = 0;
+  for (unsigned i = 0; i < len; i++)
+  {
+    assert (face_indices[i] == expected_face (sets, info[i].codepoint));
+    count += face_indices[i] == HB_FACE_COLLECTION_INDEX_NO_FACE;
+  }
+  assert (uncovered == count && count);
+
+  hb_buffer_destroy (buffer);
+}
+
+static void
+check_rejected (hb_blob_t *blob)
+{
+  hb_face_collection_index_t *index = hb_face_collection_index_create_from_blob (blob);
+  assert (!hb_face_collection_index_get_face_count (index));
+  assert (hb_face_collection_index_lookup (index, 'A') == HB_FACE_COLLECTION_INDEX_NO_FACE);
+  hb_face_collection_index_destroy (index);
+}
+
+/* Copies @blob, applies @edit and expects the result to be rejected. */
+template <typename edit_t>
+static void
+check_corrupted (hb_blob_t *blob, edit_t edit)
+{
+  unsigned len;
+  const char *data = hb_blob_get_data (blob, &len);
+  char *copy = (char *) malloc (len);
+  hb_memcpy (copy, data, len);
+  edit (copy);
+  hb_blob_t *corrupted = hb_blob_create (copy, len, HB_MEMORY_MODE_WRITABLE, copy, free);
+  check_rejected (corrupted);
+  hb_blob_destroy (corrupted);
+}
+
+int
+main (int argc, char **argv)
+{
+  hb_vector_t<hb_set_t *> sets;
+  hb_face_collection_index_t *index = hb_face_collection_index_create ();
+
+  /* Overlapping faces, in priority order: Latin, Latin + Cyrillic, CJK,
+   * emoji. */
+  static const hb_codepoint_t face_ranges[][4] = {
+    {0x20, 0x7E, 0xA0, 0xFF},
+    {0x41, 0x5A, 0x400, 0x4FF},
+    {0x4E00, 0x9FFF, 0x3000, 0x303F},
+    {0x1F600, 0x1F64F, 0x20, 0x20},
+  };
+  for (const auto &r : face_ranges)
+  {
+    hb_set_t *s = hb_set_create ();
+    hb_set_add_range (s, r[0], r[1]);
+    hb_set_add_range (s, r[2], r[3]);
+    sets.push (s);
+    hb_face_t *face = create_face (s);
+    assert (hb_face_collection_index_add_face (index, face) == sets.length - 1);
+    hb_face_destroy (face);
+  }
+  /* Plain sets, enough to need more than one bitmap word, one reaching
+   * the top of the code space. */
+  for (unsigned j = 0; j < 40; j++)
+  {
+    hb_set_t *s = hb_set_create ();
+    hb_set_add_range (s, 0x20000 + j * 7, 0x20000 + j * 11 + 5);
+    if (j == 39)
+      hb_set_add_range (s, 0x10FF00, 0x10FFFF);
+    sets.push (s);
+    assert (hb_face_collection_index_add_unicodes (index, s) == sets.length - 1);
+  }
+  assert (!sets.in_error ());
+
+  /* Every range boundary and its neighbors, plus a sampled sweep. */
+  hb_set_t *probes = hb_set_create ();
+  for (hb_set_t *s : sets)
+  {
+    hb_codepoint_t first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+    while (hb_set_next_range (s, &first, &last))
+    {
+      hb_set_add_range (probes, first ? first - 1 : 0, first + 1);
+      hb_set_add_range (probes, last - 1, hb_min (last + 1, 0x10FFFFu));
+    }
+  }
+  for (hb_codepoint_t u = 0; u <= 0x10FFFF; u += 61)
+    hb_set_add (probes, u);
+  hb_set_add (probes, 0x10FFFF);
+
+  check_index (index, sets, probes);
+  check_buffer (index, sets);
+
+  /* Round trip through a copy of the serialized data. */
+  hb_blob_t *blob = hb_face_collection_index_serialize (index);
+  unsigned len;
+  const char *data = hb_blob_get_data (blob, &len);
+  assert (len > 20 && get32 (data) == HB_TAG ('H','B','F','I'));
+  char *copy = (char *) malloc (len);
+  hb_memcpy (copy, data, len);
+  hb_blob_t *copy_blob = hb_blob_create (copy, len, HB_MEMORY_MODE_READONLY, copy, free);
+  hb_face_collection_index_t *loaded = hb_face_collection_index_create_from_blob (copy_blob);
+  hb_blob_destroy (copy_blob);
+  assert (hb_face_collection_index_is_immutable (loaded));
+  check_index (loaded, sets, probes);
+  check_buffer (loaded, sets);
+  assert (hb_face_collection_index_add_face (loaded, hb_face_get_empty ()) == HB_FACE_COLLECTION_INDEX_NO_FACE);
+  assert (hb_face_collection_index_get_face_count (loaded) == sets.length);
+
+  /* Serializing a loaded index gives the same bytes. */
+  hb_blob_t *again = hb_face_collection_index_serialize (loaded);
+  unsigned again_len;
+  const char *again_data = hb_blob_get_data (again, &again_len);
+  assert (again_len == len && !memcmp (again_data, data, len));
+  hb_blob_destroy (again);
+
+  /* Damaged data: truncations, and header and range fields that lookups
+   * rely on. */
+  for (unsigned cut = 0; cut < len; cut += 3)
+  {
+    hb_blob_t *sub = hb_blob_create_sub_blob (blob, 0, cut);
+    check_rejected (sub);
+    hb_blob_destroy (sub);
+  }
+  check_corrupted (blob, [] (char *p) { p[0] = 'X'; });		/* magic */
+  check_corrupted (blob, [] (char *p) { p[5] = 2; });		/* version */
+  check_corrupted (blob, [] (char *p) { p[7] = 1; });		/* wordsPerBitmap */
+  check_corrupted (blob, [] (char *p) { set32 (p + 8, 100); });	/* faceCount */
+  check_corrupted (blob, [&] (char *p) { set32 (p + 12, len); });	/* bitmaps */
+  check_corrupted (blob, [] (char *p) { set32 (p + 16, 0x10000000); });	/* range count */
+  check_corrupted (blob, [] (char *p) { set32 (p + 20 + 16, 0); });	/* unsorted ranges */
+  check_corrupted (blob, [] (char *p) { set32 (p + 20 + 4, 0); });	/* last < first */
+  check_corrupted (blob, [] (char *p) { set32 (p + 20 + 8, 44); });	/* firstFace */
+  check_corrupted (blob, [] (char *p) { set32 (p + 20 + 12, 0xFFFF); });	/* bitmapIndex */
+
+  /* Empty and inert indices. */
+  hb_face_collection_index_t *empty = hb_face_collection_index_create ();
+  assert (hb_face_collection_index_lookup (empty, 'a') == HB_FACE_COLLECTION_INDEX_NO_FACE);
+  hb_blob_t *empty_blob = hb_face_collection_index_serialize (empty);
+  hb_face_collection_index_t *empty_loaded = hb_face_collection_index_create_from_blob (empty_blob);
+  assert (hb_face_collection_index_lookup (empty_loaded, 'a') == HB_FACE_COLLECTION_INDEX_NO_FACE);
+  hb_face_collection_index_make_immutable (empty);
+  assert (hb_face_collection_index_add_unicodes (empty, probes) == HB_FACE_COLLECTION_INDEX_NO_FACE);
+  assert (hb_face_collection_index_lookup (hb_face_collection_index_get_empty (), 'a') == HB_FACE_COLLECTION_INDEX_NO_FACE);
+  hb_face_collection_index_destroy (empty_loaded);
+  hb_blob_destroy (empty_blob);
+  hb_face_collection_index_destroy (empty);
+
+  hb_face_collection_index_destroy (loaded);
+  hb_face_collection_index_destroy (index);
+  hb_blob_destroy (blob);
+  hb_set_destroy (probes);
+  for (hb_set_t *s : sets)
+    hb_set_destroy (s);
+  return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+#include "hb-shape-plan.hh"
+
+static hb_feature_t
+global (hb_tag_t tag, uint32_t value)
+{
+  return {tag, value, HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END};
+}
+
+static hb_feature_t
+ranged (hb_tag_t tag, uint32_t value, unsigned start, unsigned end)
+{
+  return {tag, value, start, end};
+}
+
+static bool
+feature_equal (const hb_feature_t &a, const hb_feature_t &b)
+{
+  return a.tag == b.tag && a.value == b.value &&
+	 a.start == b.start && a.end == b.end;
+}
+
+static void
+check_features (const hb_feature_set_t *set,
+		const hb_feature_t *expected, unsigned count)
+{
+  hb_feature_t features[16];
+  unsigned num = ARRAY_LENGTH (features);
+  assert (hb_feature_set_get_features (set, 0, &num, features) == count);
+  assert (num == count);
+  for (unsigned i = 0; i < count; i++)
+    assert (feature_equal (features[i], expected[i]));
+
+  /* Paging. */
+  if (count > 1)
+  {
+    num = 1;
+    assert (hb_feature_set_get_features (set, 1, &num, features) == count);
+    assert (num == 1 && feature_equal (features[0], expected[1]));
+  }
+}
+
+static void
+test_canonicalize ()
+{
+  hb_tag_t liga = HB_TAG ('l','i','g','a');
+  hb_tag_t kern = HB_TAG ('k','e','r','n');
+
+  /* A global feature drops an earlier global one of the same tag, unless a
+   * ranged one of that tag sits in between. */
+  hb_feature_t in[] = {
+    global (liga, 0),
+    ranged (kern, 0, 2, 5),
+    global (liga, 1),
+    global (kern, 0),
+    global (kern, 1),
+  };
+  hb_feature_set_t *set = hb_feature_set_create (in, ARRAY_LENGTH (in));
+  hb_feature_t expected[] = {
+    ranged (kern, 0, 2, 5),
+    global (liga, 1),
+    global (kern, 1),
+  };
+  check_features (set, expected, ARRAY_LENGTH (expected));
+
+  /* Equivalent lists canonicalize to the same features and hash. */
+  hb_feature_set_t *set2 = hb_feature_set_create (expected, ARRAY_LENGTH (expected));
+  check_features (set2, expected, ARRAY_LENGTH (expected));
+  assert (set->hash == set2->hash);
+  hb_feature_set_destroy (set2);
+
+  /* Strings: empty and unparsable entries are skipped. */
+  hb_feature_set_t *set3 = hb_feature_set_create_from_string ("liga=0,,kern[2:5]=0,bogus[,liga,-kern,kern=1,", -1);
+  check_features (set3, expected, ARRAY_LENGTH (expected));
+  assert (set3->hash == set->hash);
+  hb_feature_set_destroy (set3);
+
+  /* Length-limited strings. */
+  hb_feature_set_t *set4 = hb_feature_set_create_from_string ("liga,kern", 4);
+  hb_feature_t liga_only[] = {global (liga, 1)};
+  check_features (set4, liga_only, 1);
+  hb_feature_set_destroy (set4);
+
+  hb_feature_set_t *empty = hb_feature_set_create_from_string ("", -1);
+  check_features (empty, nullptr, 0);
+  hb_feature_set_destroy (empty);
+  empty = hb_feature_set_create (nullptr, 0);
+  check_features (empty, nullptr, 0);
+  hb_feature_set_destroy (empty);
+
+  hb_feature_set_destroy (set);
+}
+
+static void
+test_plan_cache ()
+{
+  hb_face_t *face = hb_face_builder_create ();
+  hb_segment_properties_t props = HB_SEGMENT_PROPERTIES_DEFAULT;
+  props.direction = HB_DIRECTION_LTR;
+  props.script = HB_SCRIPT_LATIN;
+  props.language = hb_language_from_string ("en", -1);
+
+  hb_feature_t features[] = {
+    global (HB_TAG ('l','i','g','a'), 0),
+    ranged (HB_TAG ('s','m','c','p'), 1, 0, 3),
+  };
+  hb_feature_set_t *set = hb_feature_set_create (features, ARRAY_LENGTH (features));
+  hb_feature_set_t *same = hb_feature_set_create_from_string ("liga=0,smcp[0:3]", -1);
+
+  /* Feature set first... */
+  hb_shape_plan_t *p1 = _hb_shape_plan_create_cached (face, &props,
+						      set->features.arrayZ, set->features.length, set,
+						      nullptr, 0, nullptr);
+  /* ...then the same set, an equal set and the raw array all hit. */
+  hb_shape_plan_t *p2 = _hb_shape_plan_create_cached (face, &props,
+						      set->features.arrayZ, set->features.length, set,
+						      nullptr, 0, nullptr);
+  hb_shape_plan_t *p3 = _hb_shape_plan_create_cached (face, &props,
+						      same->features.arrayZ, same->features.length, same,
+						      nullptr, 0, nullptr);
+  hb_shape_plan_t *p4 = hb_shape_plan_create_cached (face, &props,
+						     features, ARRAY_LENGTH (features), nullptr);
+  assert (p1 == p2 && p1 == p3 && p1 == p4);
+
+  /* Different features miss. */
+  hb_shape_plan_t *p5 = hb_shape_plan_create_cached (face, &props, features, 1, nullptr);
+  assert (p5 != p1);
+
+  /* Raw array first, then a feature set. */
+  hb_feature_t other[] = {global (HB_TAG ('k','e','r','n'), 0)};
+  hb_shape_plan_t *p6 = hb_shape_plan_create_cached (face, &props, other, 1, nullptr);
+  hb_feature_set_t *other_set = hb_feature_set_create (other, 1);
+  hb_shape_plan_t *p7 = _hb_shape_plan_create_cached (face, &props,
+						      other_set->features.arrayZ, other_set->features.length,
+						      other_set, nullptr, 0, nullptr);
+  assert (p6 == p7);
+
+  hb_shape_plan_destroy (p1);
+  hb_shape_plan_destroy (p2);
+  hb_shape_plan_destroy (p3);
+  hb_shape_plan_destroy (p4);
+  hb_shape_plan_destroy (p5);
+  hb_shape_plan_destroy (p6);
+  hb_shape_plan_destroy (p7);
+  hb_feature_set_destroy (set);
+  hb_feature_set_destroy (same);
+  hb_feature_set_destroy (other_set);
+  hb_face_destroy (face);
+}
+
+static void
+test_shape ()
+{
+  hb_face_t *face = hb_face_builder_create ();
+  hb_font_t *font = hb_font_create (face);
+  hb_feature_set_t *set = hb_feature_set_create_from_string ("liga=0,kern[1:3]=0", -1);
+  hb_feature_t features[2];
+  unsigned num = 2;
+  hb_feature_set_get_features (set, 0, &num, features);
+
+  hb_buffer_t *a = hb_buffer_create ();
+  hb_buffer_t *b = hb_buffer_create ();
+  hb_buffer_add_utf8 (a, "office", -1, 0, -1);
+  hb_buffer_add_utf8 (b, "office", -1, 0, -1);
+  hb_buffer_guess_segment_properties (a);
+  hb_buffer_guess_segment_properties (b);
+  assert (hb_shape_with_feature_set (font, a, set, nullptr));
+  hb_shape (font, b, features, num);
+  assert (a->len == b->len);
+  for (unsigned i = 0; i < a->len; i++)
+    assert (a->info[i].codepoint == b->info[i].codepoint &&
+	    a->info[i].cluster == b->info[i].cluster &&
+	    a->pos[i].x_advance == b->pos[i].x_advance);
+
+  /* A null set shapes like no features. */
+  hb_buffer_clear_contents (a);
+  hb_buffer_add_utf8 (a, "office", -1, 0, -1);
+  hb_buffer_guess_segment_properties (a);
+  assert (hb_shape_with_feature_set (font, a, nullptr, nullptr));
+  assert (a->len == 6);
+
+  hb_buffer_destroy (a);
+  hb_buffer_destroy (b);
+  hb_feature_set_destroy (set);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static unsigned destroyed;
+static void destroy_cb (void *data) { destroyed++; }
+
+static void
+test_lifetime ()
+{
+  hb_user_data_key_t key;
+
+  hb_feature_set_t *set = hb_feature_set_create_from_string ("liga=0", -1);
+  assert (hb_feature_set_reference (set) == set);
+  assert (hb_feature_set_set_user_data (set, &key, &key, destroy_cb, true));
+  assert (hb_feature_set_get_user_data (set, &key) == &key);
+  hb_feature_set_destroy (set); /* Drops the extra reference. */
+  assert (!destroyed);
+
+  /* A cached plan keeps the set alive after the caller lets go. */
+  hb_face_t *face = hb_face_builder_create ();
+  hb_font_t *font = hb_font_create (face);
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_buffer_add_utf8 (buffer, "fi", -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_shape_with_feature_set (font, buffer, set, nullptr);
+  hb_feature_set_destroy (set);
+  assert (!destroyed);
+  hb_buffer_destroy (buffer);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+  assert (destroyed == 1);
+
+  /* The empty set is inert. */
+  hb_feature_set_t *empty = hb_feature_set_get_empty ();
+  assert (hb_feature_set_reference (empty) == empty);
+  assert (!hb_feature_set_set_user_data (empty, &key, &key, nullptr, true));
+  hb_feature_set_destroy (empty);
+  assert (!hb_feature_set_get_features (empty, 0, nullptr, nullptr));
+}
+
+int
+main (int argc, char **argv)
+{
+  test_canonicalize ();
+  test_plan_cache ();
+  test_shape ();
+  test_lifetime ();
+  return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+/* White-box: the clones are not visible through the API. */
+#include "hb-ft.cc"
+
+#include <pthread.h>
+
+/* Checks the lock-free advance and extents caches and the FT_Face clones
+ * of hb-ft against a plain hb-ft font over the same file.  Takes a font
+ * file as argument. */
+
+struct metrics_t
+{
+  hb_position_t h_advance;
+  hb_position_t v_advance;
+  hb_bool_t has_extents;
+  hb_glyph_extents_t extents;
+
+  bool operator == (const metrics_t &o) const
+  {
+    return h_advance == o.h_advance && v_advance == o.v_advance &&
+	   has_extents == o.has_extents &&
+	   (!has_extents ||
+	    (extents.x_bearing == o.extents.x_bearing &&
+	     extents.y_bearing == o.extents.y_bearing &&
+	     extents.width == o.extents.width &&
+	     extents.height == o.extents.height));
+  }
+};
+
+static metrics_t
+get_metrics (hb_font_t *font, hb_codepoint_t gid)
+{
+  metrics_t m = {};
+  m.h_advance = hb_font_get_glyph_h_advance (font, gid);
+  m.v_advance = hb_font_get_glyph_v_advance (font, gid);
+  m.has_extents = hb_font_get_glyph_extents (font, gid, &m.extents);
+  return m;
+}
+
+static void
+check_font (hb_font_t *font, hb_font_t *reference, unsigned num_glyphs)
+{
+  /* Twice: the second pass reads the caches. */
+  for (unsigned pass = 0; pass < 2; pass++)
+  {
+    for (unsigned gid = 0; gid < num_glyphs; gid++)
+      assert (get_metrics (font, gid) == get_metrics (reference, gid));
+
+    /* The batch call shares the advance cache. */
+    hb_codepoint_t gids[64];
+    hb_position_t advances[64], expected[64];
+    for (unsigned i = 0; i < ARRAY_LENGTH (gids); i++)
+      gids[i] = (i * 37) % num_glyphs;
+    hb_font_get_glyph_h_advances (font, ARRAY_LENGTH (gids), gids, sizeof (gids[0]), advances, sizeof (advances[0]));
+    hb_font_get_glyph_h_advances (reference, ARRAY_LENGTH (gids), gids, sizeof (gids[0]), expected, sizeof (expected[0]));
+    assert (!memcmp (advances, expected, sizeof (advances)));
+  }
+}
+
+struct thread_data_t
+{
+  hb_font_t *font;
+  const metrics_t *expected;
+  unsigned num_glyphs;
+};
+
+static void *
+thread_func (void *arg)
+{
+  const thread_data_t *data = (const thread_data_t *) arg;
+  for (unsigned round = 0; round < 4; round++)
+    for (unsigned gid = 0; gid < data->num_glyphs; gid++)
+    {
+      /* Walk in different orders so threads collide on cache slots. */
+      hb_codepoint_t g = round & 1 ? data->num_glyphs - 1 - gid : gid;
+      assert (get_metrics (data->font, g) == data->expected[g]);
+    }
+  return nullptr;
+}
+
+static void
+check_threads (hb_font_t *font, hb_font_t *reference, unsigned num_glyphs)
+{
+  hb_vector_t<metrics_t> expected;
+  assert (expected.resize (num_glyphs));
+  for (unsigned gid = 0; gid < num_glyphs; gid++)
+    expected[gid] = get_metrics (reference, gid);
+
+  thread_data_t data = {font, expected.arrayZ, num_glyphs};
+  pthread_t threads[8];
+  for (unsigned i = 0; i < ARRAY_LENGTH (threads); i++)
+    assert (!pthread_create (&threads[i], nullptr, thread_func, &data));
+  for (unsigned i = 0; i < ARRAY_LENGTH (threads); i++)
+    pthread_join (threads[i], nullptr);
+}
+
+static void
+set_scale (hb_font_t *font, hb_font_t *reference, int x_scale, int y_scale)
+{
+  /* Plain hb-ft fonts only see the change when told. */
+  hb_font_set_scale (font, x_scale, y_scale);
+  hb_ft_hb_font_changed (font);
+  hb_font_set_scale (reference, x_scale, y_scale);
+  hb_ft_hb_font_changed (reference);
+}
+
+static void
+test_clones (FT_Face ft_face, FT_Face ref_ft_face)
+{
+  hb_font_t *font = hb_ft_font_create_referenced (ft_face);
+  assert (ft_face->stream->read);
+  hb_font_t *reference = hb_ft_font_create_referenced (ref_ft_face);
+  unsigned num_glyphs = hb_face_get_glyph_count (hb_font_get_face (reference));
+  assert (num_glyphs);
+  set_scale (font, reference, 1000, 1000);
+
+  /* Without clones. */
+  check_font (font, reference, num_glyphs);
+
+  /* Clones share one copy of the font data. */
+  assert (hb_ft_font_set_face_clones (font, 3));
+  hb_ft_font_t *ft_font = (hb_ft_font_t *) font->user_data;
+  assert (ft_font->num_clones == 3);
+  for (unsigned i = 0; i < 3; i++)
+  {
+    assert (ft_font->clones[i].ft_face != ft_face);
+    assert (ft_font->clones[i].ft_face->generic.data == ft_font->clones[0].ft_face->generic.data);
+  }
+  check_font (font, reference, num_glyphs);
+
+  /* Clones follow font changes, and the caches are dropped. */
+  set_scale (font, reference, 2048, 1024);
+  check_font (font, reference, num_glyphs);
+  set_scale (font, reference, -1000, 1000); /* Transform. */
+  check_font (font, reference, num_glyphs);
+  set_scale (font, reference, 1000, 1000);
+  check_threads (font, reference, num_glyphs);
+
+  /* Every clone got used. */
+  for (unsigned i = 0; i < 3; i++)
+    assert (ft_font->clones[i].cached_serial == font->serial);
+
+  /* Removing them goes back to the main face. */
+  assert (hb_ft_font_set_face_clones (font, 0));
+  assert (!ft_font->num_clones);
+  set_scale (font, reference, 1500, 1500);
+  check_font (font, reference, num_glyphs);
+
+  hb_font_destroy (font);
+  hb_font_destroy (reference);
+}
+
+static void
+test_blob_face (const char *path, FT_Face ref_ft_face)
+{
+  /* hb-ft funcs on a face made from a blob: clones reference that blob. */
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_font_t *font = hb_font_create (face);
+  hb_ft_font_set_funcs (font);
+  hb_font_t *reference = hb_ft_font_create_referenced (ref_ft_face);
+  unsigned num_glyphs = hb_face_get_glyph_count (face);
+  set_scale (font, reference, 1000, 1000);
+
+  assert (hb_ft_font_set_face_clones (font, 2));
+  hb_ft_font_t *ft_font = (hb_ft_font_t *) font->user_data;
+  for (unsigned i = 0; i < 2; i++)
+    assert (ft_font->clones[i].ft_face->generic.data == blob);
+  check_font (font, reference, num_glyphs);
+  check_threads (font, reference, num_glyphs);
+
+  hb_font_destroy (font);
+  hb_font_destroy (reference);
+  hb_face_destroy (face);
+  hb_blob_destroy (blob);
+}
+
+/* Reads a few glyphs' metrics through @font; few enough that they are
+ * all still cached when check_font() gets to them. */
+static void
+touch_font (hb_font_t *font, unsigned num_glyphs)
+{
+  for (unsigned gid = 0; gid < hb_min (num_glyphs, 16u); gid++)
+    get_metrics (font, gid);
+}
+
+static void
+test_stale_reads (FT_Face ft_face, FT_Face ref_ft_face)
+{
+  /* Without clones, metrics read after changing the font but before
+   * hb_ft_hb_font_changed() come from the FT_Face as it was.  They must
+   * not be served once the FT_Face is brought up to date. */
+  hb_font_t *font = hb_ft_font_create_referenced (ft_face);
+  hb_font_t *reference = hb_ft_font_create_referenced (ref_ft_face);
+  unsigned num_glyphs = hb_face_get_glyph_count (hb_font_get_face (reference));
+  set_scale (font, reference, 1000, 1000);
+  check_font (font, reference, num_glyphs);
+
+  hb_font_set_scale (font, 2000, 2000);
+  touch_font (font, num_glyphs);
+  hb_ft_hb_font_changed (font);
+  hb_font_set_scale (reference, 2000, 2000);
+  hb_ft_hb_font_changed (reference);
+  check_font (font, reference, num_glyphs);
+
+  if (hb_ot_var_get_axis_count (hb_font_get_face (reference)))
+  {
+    hb_variation_t variation;
+    hb_ot_var_axis_info_t axis;
+    unsigned count = 1;
+    hb_ot_var_get_axis_infos (hb_font_get_face (reference), 0, &count, &axis);
+    variation.tag = axis.tag;
+    variation.value = axis.max_value;
+
+    hb_font_set_variations (font, &variation, 1);
+    touch_font (font, num_glyphs);
+    hb_ft_hb_font_changed (font);
+    hb_font_set_variations (reference, &variation, 1);
+    hb_ft_hb_font_changed (reference);
+    check_font (font, reference, num_glyphs);
+  }
+
+  hb_font_destroy (font);
+  hb_font_destroy (reference);
+}
+
+/* A FreeType stream that has to be read through, rather than mapped; hb-ft
+ * then builds a face that copies tables out of FreeType, and the font data
+ * for the clones has to be loaded as a whole. */
+static unsigned long
+stream_read (FT_Stream stream, unsigned long offset,
+	     unsigned char *buffer, unsigned long count)
+{
+  if (offset > stream->size)
+    return count ? 0 : 1;
+  count = hb_min (count, stream->size - offset);
+  memcpy (buffer, (const char *) stream->descriptor.pointer + offset, count);
+  return count;
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    fprintf (stderr, "usage: %s font-file\n", argv[0]);
+    return 0;
+  }
+
+  FT_Library library;
+  assert (!FT_Init_FreeType (&library));
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (argv[1]);
+  assert (blob);
+  FT_StreamRec stream = {};
+  stream.descriptor.pointer = (void *) hb_blob_get_data (blob, nullptr);
+  stream.size = hb_blob_get_length (blob);
+  stream.read = stream_read;
+  FT_Open_Args args = {};
+  args.flags = FT_OPEN_STREAM;
+  args.stream = &stream;
+
+  FT_Face ft_faces[3];
+  assert (!FT_Open_Face (library, &args, 0, &ft_faces[0]));
+  for (unsigned i = 1; i < ARRAY_LENGTH (ft_faces); i++)
+    assert (!FT_New_Face (library, argv[1], 0, &ft_faces[i]));
+  for (unsigned i = 0; i < ARRAY_LENGTH (ft_faces); i++)
+    assert (!FT_Set_Char_Size (ft_faces[i], 0, 1000, 0, 0));
+
+  test_clones (ft_faces[0], ft_faces[1]);
+  test_blob_face (argv[1], ft_faces[2]);
+  test_stale_reads (ft_faces[1], ft_faces[2]);
+
+  FT_Done_FreeType (library);
+  hb_blob_destroy (blob);
+  return 0;
+}
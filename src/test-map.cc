@@ -26,6 +26,8 @@
 #include "hb-map.hh"
 #include "hb-set.hh"
 #include <string>
+#include <chrono>
+#include <functional>
 
 int
 main (int argc, char **argv)
@@ -353,6 +355,138 @@ main (int argc, char **argv)
     assert (keys.is_equal (hb_set_t (m.keys ())));
     assert (values.is_equal (hb_set_t (m.values ())));
   }
+  /* Test dense map */
+  {
+    hb_map_t m;
+    for (unsigned i = 0; i < 100; i += 2)
+      m.set (i, i / 2);
+
+    hb_dense_map_t d;
+    d.init (&m);
+    assert (d.is_dense ());
+    assert (d.get_population () == 50);
+    assert (d[10] == 5);
+    assert (d.get (11) == HB_MAP_VALUE_INVALID);
+    assert (d.get (1000) == HB_MAP_VALUE_INVALID);
+    const hb_codepoint_t *v;
+    assert (d.has (98, &v) && *v == 49);
+    assert (!d.has (99));
+    assert (hb_set_t (d.keys ()).is_equal (hb_set_t (m.keys ())));
+  }
+  /* Test dense map falling back to sparse lookups */
+  {
+    hb_map_t m;
+    m.set (1, 10);
+    m.set (100000, 20);
+
+    hb_dense_map_t d;
+    d.init (&m);
+    assert (!d.is_dense ());
+    assert (d[1] == 10);
+    assert (d[100000] == 20);
+    assert (d[2] == HB_MAP_VALUE_INVALID);
+    assert (d.has (100000));
+    assert (!d.has (3));
+  }
+  /* Test deletion churn; chains must stay intact without tombstones. */
+  {
+    hb_map_t m;
+    hb_set_t present;
+    for (unsigned round = 0; round < 8; round++)
+    {
+      for (unsigned i = 0; i < 1000; i++)
+      {
+	unsigned k = (i * 7919 + round * 104729) % 4096;
+	if (i % 3)
+	{
+	  m.set (k, k + 1);
+	  present.add (k);
+	}
+	else
+	{
+	  m.del (k);
+	  present.del (k);
+	}
+      }
+      assert (m.get_population () == present.get_population ());
+      for (unsigned k = 0; k < 4096; k++)
+	assert (m.has (k) == present.has (k));
+    }
+    for (auto k : present)
+      assert (m[k] == k + 1);
+  }
+  /* Test keys that differ only in high bits. */
+  {
+    hb_map_t m;
+    for (unsigned i = 0; i < 64; i++)
+      m.set (i << 20, i);
+    assert (m.get_population () == 64);
+    for (unsigned i = 0; i < 64; i++)
+      assert (m[i << 20] == i);
+    for (unsigned i = 0; i < 64; i += 2)
+      m.del (i << 20);
+    for (unsigned i = 0; i < 64; i++)
+      assert (m.has (i << 20) == (i & 1));
+  }
+  /* Test overwriting replaces the key as well as the value. */
+  {
+    static const char a[] = "key", b[] = "key";
+    hb_hashmap_t<hb_bytes_t, unsigned> m;
+    m.set (hb_bytes_t (a, 3), 1);
+    m.set (hb_bytes_t (b, 3), 2);
+    assert (m.get_population () == 1);
+    for (auto k : m.keys ())
+      assert (k.arrayZ == b);
+    assert (m[hb_bytes_t (a, 3)] == 2);
+  }
+
+  /* Micro-benchmarks; run with --benchmark. */
+  if (argc > 1 && 0 == strcmp (argv[1], "--benchmark"))
+  {
+    const unsigned N = 1u << 20;
+    auto bench = [] (const char *name, unsigned n, const std::function<void ()> &f)
+    {
+      auto start = std::chrono::steady_clock::now ();
+      f ();
+      std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now () - start;
+      printf ("%-24s %8.2f ns/op\n", name, d.count () / n);
+    };
+
+    /* Even keys are inserted, odd keys are misses. */
+    hb_vector_t<unsigned> keys;
+    unsigned r = 1;
+    for (unsigned i = 0; i < 2 * N; i++)
+    {
+      r = r * 1103515245u + 12345u;
+      keys.push ((r & ~1u) | (i & 1));
+    }
+
+    hb_map_t m;
+    unsigned sink = 0;
+    bench ("insert", N, [&] () { for (unsigned i = 0; i < N; i++) m.set (keys[2 * i], i); });
+    bench ("lookup hit", N, [&] () { for (unsigned i = 0; i < N; i++) sink += m[keys[2 * i]]; });
+    bench ("lookup miss", N, [&] () { for (unsigned i = 0; i < N; i++) sink += m.has (keys[2 * i + 1]); });
+    bench ("sequential insert", N, [&] () { for (unsigned i = 0; i < N; i++) m.set (i * 4, i); });
+    bench ("sequential lookup", N, [&] () { for (unsigned i = 0; i < N; i++) sink += m[i * 4]; });
+    bench ("delete / insert churn", N, [&] ()
+    {
+      for (unsigned i = 0; i < N; i++)
+      {
+	m.del (keys[2 * i]);
+	m.set (keys[2 * i + 1], i);
+      }
+    });
+    bench ("lookup after churn", N, [&] () { for (unsigned i = 0; i < N; i++) sink += m[keys[2 * i + 1]]; });
+
+    hb_hashmap_t<hb_bytes_t, unsigned> s;
+    hb_vector_t<std::string> strings;
+    for (unsigned i = 0; i < N / 16; i++)
+      strings.push (std::to_string (i * 2654435761u));
+    bench ("string insert", N / 16, [&] () { for (unsigned i = 0; i < N / 16; i++) s.set (hb_bytes_t (strings[i].c_str (), strings[i].length ()), i); });
+    bench ("string lookup", N / 16, [&] () { for (unsigned i = 0; i < N / 16; i++) sink += s[hb_bytes_t (strings[i].c_str (), strings[i].length ())]; });
+
+    printf ("(%u)\n", sink & 1);
+  }
 
   return 0;
 }
@@ -0,0 +1,184 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+#include "hb-ot.h"
+
+#include <stdlib.h>
+
+/* GSUB with three SingleSubstFormat1 lookups mapping glyph 1+i to 11+i.
+ * Each lookup is 20 bytes: Lookup header, subtable, Coverage. */
+static void
+build_gsub (char *data, unsigned broken_lookup)
+{
+  static const char header[] = {
+    0,1, 0,0,		/* version 1.0 */
+    0,10, 0,12, 0,14,	/* ScriptList, FeatureList, LookupList */
+    0,0,		/* ScriptList: no scripts */
+    0,0,		/* FeatureList: no features */
+    0,3, 0,8, 0,28, 0,48,	/* LookupList: three lookups */
+  };
+  memcpy (data, header, sizeof (header));
+  for (unsigned i = 0; i < 3; i++)
+  {
+    char lookup[] = {
+      0,1, 0,0, 0,1, 0,8,	/* Lookup: type 1, no flags, one subtable */
+      0,1, 0,6, 0,10,		/* SingleSubstFormat1: coverage, delta */
+      0,1, 0,1, 0,(char) (1 + i),	/* CoverageFormat1: one glyph */
+    };
+    if (i == broken_lookup)
+      lookup[16] = lookup[17] = (char) 0xFF; /* glyphCount way past the end */
+    memcpy (data + sizeof (header) + 20 * i, lookup, sizeof (lookup));
+  }
+}
+
+static hb_face_t *
+create_face (unsigned broken_lookup)
+{
+  static char gsub[24 + 3 * 20];
+  static const char maxp[] = {0,0,0x50,0, 0,20};
+  build_gsub (gsub, broken_lookup);
+
+  hb_face_t *face = hb_face_builder_create ();
+  hb_blob_t *blob = hb_blob_create (gsub, sizeof (gsub), HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_OT_TAG_GSUB, blob);
+  hb_blob_destroy (blob);
+  blob = hb_blob_create (maxp, sizeof (maxp), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_TAG ('m','a','x','p'), blob);
+  hb_blob_destroy (blob);
+
+  /* Reload from the compiled blob, like a font read from disk. */
+  blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+/* GSUB with SHARED_LOOKUPS lookups whose single subtable is the same
+ * SingleSubstFormat1, covering glyphs 1 to SHARED_COVERAGE. */
+enum { SHARED_LOOKUPS = 100, SHARED_COVERAGE = 4000 };
+
+static hb_face_t *
+create_shared_face ()
+{
+  hb_vector_t<char> gsub;
+  auto push16 = [&] (unsigned x) { gsub.push (x >> 8); gsub.push (x & 0xFF); };
+
+  const unsigned lookups = 16 + 2 * SHARED_LOOKUPS;
+  const unsigned subtable = lookups + 8 * SHARED_LOOKUPS;
+  push16 (1); push16 (0);		/* version 1.0 */
+  push16 (10); push16 (12); push16 (14);	/* ScriptList, FeatureList, LookupList */
+  push16 (0);				/* ScriptList: no scripts */
+  push16 (0);				/* FeatureList: no features */
+  push16 (SHARED_LOOKUPS);
+  for (unsigned i = 0; i < SHARED_LOOKUPS; i++)
+    push16 (lookups + 8 * i - 14);
+  for (unsigned i = 0; i < SHARED_LOOKUPS; i++)
+  {
+    push16 (1); push16 (0); push16 (1);	/* Lookup: type 1, no flags, one subtable */
+    push16 (subtable - (lookups + 8 * i));
+  }
+  push16 (1); push16 (6); push16 (10);	/* SingleSubstFormat1: coverage, delta */
+  push16 (1); push16 (SHARED_COVERAGE);	/* CoverageFormat1 */
+  for (unsigned g = 1; g <= SHARED_COVERAGE; g++)
+    push16 (g);
+  assert (!gsub.in_error ());
+
+  hb_face_t *face = hb_face_builder_create ();
+  hb_blob_t *blob = hb_blob_create (gsub.arrayZ, gsub.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_OT_TAG_GSUB, blob);
+  hb_blob_destroy (blob);
+
+  blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static bool
+would_substitute (hb_face_t *face, unsigned lookup_index, hb_codepoint_t glyph)
+{
+  return hb_ot_layout_lookup_would_substitute (face, lookup_index, &glyph, 1, false);
+}
+
+int
+main (int argc, char **argv)
+{
+  /* Must be set before the first HarfBuzz call reads the options. */
+  setenv ("HB_OPTIONS", "lazy-layout-sanitize", 1);
+  assert (hb_options ().lazy_layout_sanitize);
+
+  /* Intact table: every lookup applies. */
+  {
+    hb_face_t *face = create_face ((unsigned) -1);
+    assert (hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB) == 3);
+    for (unsigned i = 0; i < 3; i++)
+    {
+      assert (would_substitute (face, i, 1 + i));
+      assert (!would_substitute (face, i, 5));
+    }
+    hb_face_destroy (face);
+  }
+
+  /* One corrupt lookup: it is treated as empty, the others still apply,
+   * whichever order they are fetched in. */
+  for (unsigned broken = 0; broken < 3; broken++)
+  {
+    hb_face_t *face = create_face (broken);
+    assert (hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB) == 3);
+    for (unsigned pass = 0; pass < 2; pass++) /* Second pass hits cached verdicts. */
+      for (unsigned j = 0; j < 3; j++)
+      {
+	unsigned i = (broken + j) % 3;
+	assert (would_substitute (face, i, 1 + i) == (i != broken));
+      }
+    hb_face_destroy (face);
+  }
+
+  /* The lookups share one budget: sanitizing the same large subtable for
+   * each of them uses it up after a few, and the rest are treated as
+   * empty, much like eager sanitizing would reject the whole table. */
+  {
+    hb_face_t *face = create_shared_face ();
+    assert (hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB) == SHARED_LOOKUPS);
+    unsigned sane = 0;
+    while (sane < SHARED_LOOKUPS && would_substitute (face, sane, SHARED_COVERAGE))
+      sane++;
+    assert (sane > 0 && sane < SHARED_LOOKUPS);
+    for (unsigned i = sane; i < SHARED_LOOKUPS; i++)
+      assert (!would_substitute (face, i, 1));
+    hb_face_destroy (face);
+  }
+
+  /* Out-of-range lookup index. */
+  {
+    hb_face_t *face = create_face (1);
+    assert (!would_substitute (face, 3, 1));
+    hb_face_destroy (face);
+  }
+
+  return 0;
+}
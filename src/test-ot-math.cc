@@ -0,0 +1,297 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-ot.h"
+#include "hb-font.hh"
+
+/* Checks the per-font MATH construction and kern cache against fonts
+ * that resolve everything from scratch, and
+ * hb_ot_math_get_glyph_construction() against the per-item calls. */
+
+static void
+push16 (hb_vector_t<char> &v, int x)
+{
+  v.push ((char) (x >> 8));
+  v.push ((char) x);
+}
+
+static void
+push16 (hb_vector_t<char> &v, std::initializer_list<int> xs)
+{
+  for (int x : xs)
+    push16 (v, x);
+}
+
+/* MathGlyphInfo with kerning for glyphs 5 and 7, and MathVariants with a
+ * vertical construction for glyph 5 (three variants and a three-part
+ * assembly) and a horizontal one for glyph 7 (two variants).  One kern
+ * value has a hinting device table, so results depend on ppem. */
+static hb_face_t *
+create_face ()
+{
+  hb_vector_t<char> kinfo;
+  /* MathKernInfo: coverage, two records of four corners. */
+  push16 (kinfo, {20, 2, 28,0,0,50, 0,28,28,0});
+  push16 (kinfo, {1, 2, 5, 7});				/* Coverage. */
+  push16 (kinfo, {2, 100,0, 300,0, 10,0, 20,0, 30,0});	/* MathKern A. */
+  push16 (kinfo, {0, -40,6});				/* MathKern B... */
+  push16 (kinfo, {10,12,1,0x7400});			/* ...and its device. */
+
+  hb_vector_t<char> variants;
+  /* MathVariants: minConnectorOverlap, coverages, constructions. */
+  push16 (variants, {20, 14, 20, 1, 1, 26, 78});
+  push16 (variants, {1, 1, 5});
+  push16 (variants, {1, 1, 7});
+  push16 (variants, {16, 3, 5,500, 8,800, 9,1200});	/* Vertical, glyph 5. */
+  push16 (variants, {15,0, 3, 10,0,50,300,0, 11,50,50,200,1, 12,50,0,300,0}); /* Assembly. */
+  push16 (variants, {0, 2, 7,400, 13,900});		/* Horizontal, glyph 7. */
+
+  hb_vector_t<char> math;
+  push16 (math, {1,0, 0, 10, (int) (10 + 8 + kinfo.length)});
+  push16 (math, {0,0,0,8});				/* MathGlyphInfo. */
+  for (char c : kinfo) math.push (c);
+  for (char c : variants) math.push (c);
+
+  hb_face_t *face = hb_face_builder_create ();
+  hb_blob_t *blob = hb_blob_create (math.arrayZ, math.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_TAG ('M','A','T','H'), blob);
+  hb_blob_destroy (blob);
+  blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static const hb_codepoint_t glyphs[] = {5, 7, 3};
+static const hb_direction_t directions[] = {HB_DIRECTION_LTR, HB_DIRECTION_TTB, HB_DIRECTION_INVALID};
+
+/* Everything the cached calls return, including partial fetches. */
+static void
+collect (hb_font_t *font, hb_vector_t<int> &out)
+{
+  out.resize (0);
+  for (hb_codepoint_t g : glyphs)
+  {
+    for (int k = -1; k < 5; k++)
+    {
+      hb_ot_math_kern_t kern = (hb_ot_math_kern_t) k;
+      for (int h : {-500, 0, 99, 100, 101, 299, 300, 301, 1000})
+	out.push (hb_ot_math_get_glyph_kerning (font, g, kern, h));
+      for (unsigned start : {0u, 1u, 5u})
+      {
+	hb_ot_math_kern_entry_t entries[8];
+	unsigned n = 2;
+	out.push (hb_ot_math_get_glyph_kernings (font, g, kern, start, &n, entries));
+	out.push (n);
+	for (unsigned i = 0; i < n; i++)
+	{
+	  out.push (entries[i].max_correction_height);
+	  out.push (entries[i].kern_value);
+	}
+      }
+      out.push (hb_ot_math_get_glyph_kernings (font, g, kern, 0, nullptr, nullptr));
+    }
+
+    for (hb_direction_t d : directions)
+    {
+      for (unsigned start : {0u, 1u, 9u})
+      {
+	hb_ot_math_glyph_variant_t v[8];
+	unsigned n = 2;
+	out.push (hb_ot_math_get_glyph_variants (font, g, d, start, &n, v));
+	out.push (n);
+	for (unsigned i = 0; i < n; i++)
+	{
+	  out.push (v[i].glyph);
+	  out.push (v[i].advance);
+	}
+
+	hb_ot_math_glyph_part_t p[8];
+	hb_position_t ic = -1;
+	n = 2;
+	out.push (hb_ot_math_get_glyph_assembly (font, g, d, start, &n, p, &ic));
+	out.push (n);
+	out.push (ic);
+	for (unsigned i = 0; i < n; i++)
+	{
+	  out.push (p[i].glyph);
+	  out.push (p[i].start_connector_length);
+	  out.push (p[i].end_connector_length);
+	  out.push (p[i].full_advance);
+	  out.push (p[i].flags);
+	}
+      }
+      hb_position_t ic = -1;
+      hb_ot_math_get_glyph_assembly (font, g, d, 0, nullptr, nullptr, &ic);
+      out.push (ic);
+      out.push (hb_ot_math_get_min_connector_overlap (font, d));
+    }
+  }
+  assert (!out.in_error ());
+}
+
+static void
+check_construction (hb_font_t *font)
+{
+  for (hb_codepoint_t g : glyphs)
+    for (hb_direction_t d : directions)
+    {
+      hb_ot_math_glyph_variant_t v[8], v2[8];
+      hb_ot_math_glyph_part_t p[8], p2[8];
+      unsigned total_variants = hb_ot_math_get_glyph_variants (font, g, d, 0, nullptr, nullptr);
+      hb_position_t ic2;
+      unsigned total_parts = hb_ot_math_get_glyph_assembly (font, g, d, 0, nullptr, nullptr, &ic2);
+      unsigned n = 8;
+      hb_ot_math_get_glyph_variants (font, g, d, 0, &n, v2);
+      n = 8;
+      hb_ot_math_get_glyph_assembly (font, g, d, 0, &n, p2, nullptr);
+
+      /* Every array size, including too small ones: counts are totals. */
+      for (unsigned size = 0; size <= 4; size++)
+      {
+	unsigned vn = size, pn = size;
+	hb_position_t ic = -1, overlap = -1;
+	hb_bool_t ret = hb_ot_math_get_glyph_construction (font, g, d, &vn, v, &pn, p, &ic, &overlap);
+	assert (ret == (total_variants || total_parts));
+	assert (vn == total_variants && pn == total_parts);
+	assert (ic == ic2);
+	assert (overlap == hb_ot_math_get_min_connector_overlap (font, d));
+	for (unsigned i = 0; i < hb_min (size, total_variants); i++)
+	  assert (v[i].glyph == v2[i].glyph && v[i].advance == v2[i].advance);
+	for (unsigned i = 0; i < hb_min (size, total_parts); i++)
+	  assert (!memcmp (&p[i], &p2[i], sizeof (p[i])));
+      }
+
+      /* Everything optional. */
+      assert (hb_ot_math_get_glyph_construction (font, g, d, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr) ==
+	      (total_variants || total_parts));
+    }
+}
+
+static void
+check_same (hb_font_t *font, hb_font_t *reference)
+{
+  hb_vector_t<int> a, b;
+  collect (font, a);
+  collect (reference, b);
+  assert (a.length == b.length && !memcmp (a.arrayZ, b.arrayZ, a.get_size ()));
+  /* Again, now from the cache on both. */
+  collect (font, b);
+  assert (a.length == b.length && !memcmp (a.arrayZ, b.arrayZ, a.get_size ()));
+  check_construction (font);
+}
+
+enum { STEP_COUNT = 5 };
+
+static void
+apply_step (hb_font_t *font, unsigned step)
+{
+  switch (step)
+  {
+  case 0: hb_font_set_scale (font, 2048, -1000); break;
+  case 1: hb_font_set_ppem (font, 11, 11); break;
+  case 2: hb_font_set_ppem (font, 12, 10); break;
+  case 3: hb_font_set_scale (font, 500, 500); break;
+  case 4: hb_font_set_face (font, hb_face_get_empty ()); break;
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  hb_face_t *face = create_face ();
+  assert (hb_ot_math_has_data (face));
+
+  /* Known values, at upem scale. */
+  {
+    hb_font_t *font = hb_font_create (face);
+    hb_font_set_scale (font, 1000, 1000);
+    assert (hb_ot_math_get_glyph_kerning (font, 5, HB_OT_MATH_KERN_TOP_RIGHT, 200) == 20);
+    assert (hb_ot_math_get_glyph_kerning (font, 5, HB_OT_MATH_KERN_TOP_RIGHT, 301) == 30);
+    assert (hb_ot_math_get_glyph_variants (font, 5, HB_DIRECTION_TTB, 0, nullptr, nullptr) == 3);
+    assert (hb_ot_math_get_glyph_assembly (font, 5, HB_DIRECTION_TTB, 0, nullptr, nullptr, nullptr) == 3);
+    assert (hb_ot_math_get_glyph_variants (font, 7, HB_DIRECTION_LTR, 0, nullptr, nullptr) == 2);
+    assert (hb_ot_math_get_min_connector_overlap (font, HB_DIRECTION_TTB) == 20);
+    hb_font_destroy (font);
+  }
+
+  /* One font taken through every change, against a new font set up the
+   * same way from scratch. */
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *reference = hb_font_create (face);
+  check_same (font, reference);
+  hb_font_destroy (reference);
+  for (unsigned step = 0; step < STEP_COUNT; step++)
+  {
+#ifndef HB_NO_OT_MATH_CACHE
+    assert (font->math_cache.get_relaxed ());
+#endif
+    apply_step (font, step);
+#ifndef HB_NO_OT_MATH_CACHE
+    assert (!font->math_cache.get_relaxed ());
+#endif
+
+    reference = hb_font_create (face);
+    for (unsigned i = 0; i <= step; i++)
+      apply_step (reference, i);
+    check_same (font, reference);
+
+    /* Sub-fonts have their own. */
+    hb_font_t *sub = hb_font_create_sub_font (font);
+    hb_font_t *ref_sub = hb_font_create_sub_font (reference);
+    check_same (sub, ref_sub);
+    hb_font_set_scale (sub, 333, 777);
+    hb_font_set_scale (ref_sub, 333, 777);
+    check_same (sub, ref_sub);
+    check_same (font, reference);
+    hb_font_destroy (sub);
+    hb_font_destroy (ref_sub);
+
+    hb_font_destroy (reference);
+  }
+  hb_font_destroy (font);
+
+  /* Asking for far more glyphs than the cache holds fills every bucket;
+   * glyphs that no longer fit are still resolved right. */
+  font = hb_font_create (face);
+  for (hb_codepoint_t g = 100; g < 4100; g++)
+  {
+    assert (!hb_ot_math_get_glyph_kerning (font, g, (hb_ot_math_kern_t) (g % 4), 0));
+    assert (!hb_ot_math_get_glyph_variants (font, g, g % 2 ? HB_DIRECTION_LTR : HB_DIRECTION_TTB,
+					    0, nullptr, nullptr));
+  }
+  reference = hb_font_create (face);
+  check_same (font, reference);
+  hb_font_destroy (reference);
+  hb_font_destroy (font);
+
+  /* The empty font. */
+  check_construction (hb_font_get_empty ());
+
+  hb_face_destroy (face);
+  return 0;
+}
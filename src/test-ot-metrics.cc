@@ -0,0 +1,277 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-ot.h"
+#include "hb-font.hh"
+
+/* Checks the per-font metrics snapshot against fonts that resolve the
+ * metrics from scratch, after every kind of font change. */
+
+static void
+push16 (hb_vector_t<char> &v, unsigned x)
+{
+  v.push ((char) (x >> 8));
+  v.push ((char) x);
+}
+
+static void
+push32 (hb_vector_t<char> &v, unsigned x)
+{
+  push16 (v, x >> 16);
+  push16 (v, x & 0xFFFF);
+}
+
+static void
+add_table (hb_face_t *face, hb_tag_t tag, const hb_vector_t<char> &data)
+{
+  hb_blob_t *blob = hb_blob_create (data.arrayZ, data.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+  hb_face_builder_add_table (face, tag, blob);
+  hb_blob_destroy (blob);
+}
+
+/* head, hhea, OS/2 and post; plus, if @variable, a wght axis and an MVAR
+ * moving hasc by +100, hdsc by -50 and xhgt by +30 at wght=900. */
+static hb_face_t *
+create_face (bool variable)
+{
+  hb_face_t *face = hb_face_builder_create ();
+  hb_vector_t<char> t;
+
+  push32 (t, 0x00010000); push32 (t, 0); push32 (t, 0); push32 (t, 0x5F0F3CF5);
+  push16 (t, 0); push16 (t, 1000);
+  for (unsigned i = 0; i < 16 + 8 + 4 * 2; i++) t.push (0);
+  push16 (t, 0); push16 (t, 8); push16 (t, 2); push16 (t, 0); push16 (t, 0);
+  add_table (face, HB_TAG ('h','e','a','d'), t);
+
+  t.resize (0);
+  push32 (t, 0x00010000); push16 (t, 800); push16 (t, -200); push16 (t, 90);
+  for (unsigned i = 0; i < 4; i++) push16 (t, 0);
+  push16 (t, 1); push16 (t, 0); push16 (t, 0); /* Caret rise, run, offset. */
+  for (unsigned i = 0; i < 5; i++) push16 (t, 0);
+  push16 (t, 0);
+  add_table (face, HB_TAG ('h','h','e','a'), t);
+
+  t.resize (0);
+  push16 (t, 2); push16 (t, 500); push16 (t, 400); push16 (t, 5); push16 (t, 0);
+  push16 (t, 650); push16 (t, 600); push16 (t, 0); push16 (t, 75);	/* Subscript. */
+  push16 (t, 650); push16 (t, 600); push16 (t, 0); push16 (t, 350);	/* Superscript. */
+  push16 (t, 50); push16 (t, 260);					/* Strikeout. */
+  while (t.length < 68) t.push (0);
+  push16 (t, 750); push16 (t, -250); push16 (t, 100);	/* Typo. */
+  push16 (t, 950); push16 (t, 280);			/* Win. */
+  push32 (t, 0); push32 (t, 0);
+  push16 (t, 500); push16 (t, 700);			/* x-height, cap height. */
+  push16 (t, 0); push16 (t, 32); push16 (t, 1);
+  add_table (face, HB_TAG ('O','S','/','2'), t);
+
+  t.resize (0);
+  push32 (t, 0x00030000); push32 (t, 0); push16 (t, -100); push16 (t, 50);
+  while (t.length < 32) t.push (0);
+  add_table (face, HB_TAG ('p','o','s','t'), t);
+
+  if (variable)
+  {
+    t.resize (0);
+    push16 (t, 1); push16 (t, 0); push16 (t, 16); push16 (t, 2);
+    push16 (t, 1); push16 (t, 20); push16 (t, 0); push16 (t, 8);
+    push32 (t, HB_TAG ('w','g','h','t'));
+    push32 (t, 100 << 16); push32 (t, 400 << 16); push32 (t, 900 << 16);
+    push16 (t, 0); push16 (t, 256);
+    add_table (face, HB_TAG ('f','v','a','r'), t);
+
+    t.resize (0);
+    push16 (t, 1); push16 (t, 0); push16 (t, 0); push16 (t, 8);
+    push16 (t, 3); push16 (t, 12 + 24);
+    push32 (t, HB_TAG ('h','a','s','c')); push16 (t, 0); push16 (t, 0);
+    push32 (t, HB_TAG ('h','d','s','c')); push16 (t, 0); push16 (t, 1);
+    push32 (t, HB_TAG ('x','h','g','t')); push16 (t, 0); push16 (t, 2);
+    /* ItemVariationStore: one region, wght 0..1..1. */
+    push16 (t, 1); push32 (t, 12); push16 (t, 1); push32 (t, 22);
+    push16 (t, 1); push16 (t, 1); push16 (t, 0); push16 (t, 16384); push16 (t, 16384);
+    push16 (t, 3); push16 (t, 1); push16 (t, 1); push16 (t, 0);
+    push16 (t, 100); push16 (t, -50); push16 (t, 30);
+    add_table (face, HB_TAG ('M','V','A','R'), t);
+  }
+
+  hb_blob_t *blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static const hb_tag_t tags[] = {
+  HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER,
+  HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER,
+  HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP,
+  HB_OT_METRICS_TAG_HORIZONTAL_CLIPPING_ASCENT,
+  HB_OT_METRICS_TAG_HORIZONTAL_CLIPPING_DESCENT,
+  HB_OT_METRICS_TAG_VERTICAL_ASCENDER,
+  HB_OT_METRICS_TAG_VERTICAL_DESCENDER,
+  HB_OT_METRICS_TAG_VERTICAL_LINE_GAP,
+  HB_OT_METRICS_TAG_HORIZONTAL_CARET_RISE,
+  HB_OT_METRICS_TAG_HORIZONTAL_CARET_RUN,
+  HB_OT_METRICS_TAG_HORIZONTAL_CARET_OFFSET,
+  HB_OT_METRICS_TAG_VERTICAL_CARET_RISE,
+  HB_OT_METRICS_TAG_VERTICAL_CARET_RUN,
+  HB_OT_METRICS_TAG_VERTICAL_CARET_OFFSET,
+  HB_OT_METRICS_TAG_X_HEIGHT,
+  HB_OT_METRICS_TAG_CAP_HEIGHT,
+  HB_OT_METRICS_TAG_SUBSCRIPT_EM_X_SIZE,
+  HB_OT_METRICS_TAG_SUBSCRIPT_EM_Y_SIZE,
+  HB_OT_METRICS_TAG_SUBSCRIPT_EM_X_OFFSET,
+  HB_OT_METRICS_TAG_SUBSCRIPT_EM_Y_OFFSET,
+  HB_OT_METRICS_TAG_SUPERSCRIPT_EM_X_SIZE,
+  HB_OT_METRICS_TAG_SUPERSCRIPT_EM_Y_SIZE,
+  HB_OT_METRICS_TAG_SUPERSCRIPT_EM_X_OFFSET,
+  HB_OT_METRICS_TAG_SUPERSCRIPT_EM_Y_OFFSET,
+  HB_OT_METRICS_TAG_STRIKEOUT_SIZE,
+  HB_OT_METRICS_TAG_STRIKEOUT_OFFSET,
+  HB_OT_METRICS_TAG_UNDERLINE_SIZE,
+  HB_OT_METRICS_TAG_UNDERLINE_OFFSET,
+  HB_TAG ('O','a','s','c'), HB_TAG ('H','a','s','c'),
+  HB_TAG ('O','d','s','c'), HB_TAG ('H','d','s','c'),
+  HB_TAG ('O','l','g','p'), HB_TAG ('H','l','g','p'),
+  HB_TAG ('z','z','z','z'),
+};
+
+static void
+check_same (hb_font_t *font, hb_font_t *reference)
+{
+  for (hb_tag_t tag : tags)
+  {
+    hb_position_t a = -12345, b = -12345;
+    assert (hb_ot_metrics_get_position (font, (hb_ot_metrics_tag_t) tag, &a) ==
+	    hb_ot_metrics_get_position (reference, (hb_ot_metrics_tag_t) tag, &b));
+    assert (a == b);
+    /* The output is optional. */
+    assert (hb_ot_metrics_get_position (font, (hb_ot_metrics_tag_t) tag, nullptr) ==
+	    hb_ot_metrics_get_position (reference, (hb_ot_metrics_tag_t) tag, nullptr));
+  }
+
+  hb_font_extents_t a, b;
+  hb_font_get_h_extents (font, &a);
+  hb_font_get_h_extents (reference, &b);
+  assert (a.ascender == b.ascender && a.descender == b.descender && a.line_gap == b.line_gap);
+  hb_font_get_v_extents (font, &a);
+  hb_font_get_v_extents (reference, &b);
+  assert (a.ascender == b.ascender && a.descender == b.descender && a.line_gap == b.line_gap);
+}
+
+static hb_position_t
+get (hb_font_t *font, hb_ot_metrics_tag_t tag)
+{
+  hb_position_t v = 0;
+  assert (hb_ot_metrics_get_position (font, tag, &v));
+  return v;
+}
+
+enum { STEP_COUNT = 8 };
+
+static void
+apply_step (hb_font_t *font, unsigned step, hb_face_t *other_face)
+{
+  hb_variation_t wght = {HB_TAG ('w','g','h','t'), 900};
+  int zero = 0;
+  switch (step)
+  {
+  case 0: hb_font_set_scale (font, 2048, -1000); break;
+  case 1: hb_font_set_synthetic_slant (font, .2f); break;
+  case 2: hb_font_set_variations (font, &wght, 1); break;
+  case 3: wght.value = 650; hb_font_set_variations (font, &wght, 1); break;
+  case 4: hb_font_set_var_coords_normalized (font, &zero, 1); break;
+  case 5: hb_font_set_synthetic_bold (font, .05f, .05f, false); break;
+  case 6: hb_font_set_scale (font, 1000, 1000); hb_font_set_variations (font, &wght, 1); break;
+  case 7: hb_font_set_face (font, other_face); break;
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  hb_face_t *face = create_face (true);
+  hb_face_t *plain = create_face (false);
+
+  /* MVAR is applied. */
+  {
+    hb_font_t *font = hb_font_create (face);
+    assert (get (font, HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER) == 800);
+    assert (get (font, HB_OT_METRICS_TAG_X_HEIGHT) == 500);
+    hb_variation_t wght = {HB_TAG ('w','g','h','t'), 900};
+    hb_font_set_variations (font, &wght, 1);
+    assert (get (font, HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER) == 900);
+    assert (get (font, HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER) == -250);
+    assert (get (font, HB_OT_METRICS_TAG_X_HEIGHT) == 530);
+    wght.value = 650;
+    hb_font_set_variations (font, &wght, 1);
+    assert (get (font, HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER) == 850);
+    hb_font_destroy (font);
+  }
+
+  /* One font taken through every change, against a new font set up the
+   * same way from scratch. */
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *reference = hb_font_create (face);
+  check_same (font, reference);
+  hb_font_destroy (reference);
+  for (unsigned step = 0; step < STEP_COUNT; step++)
+  {
+#ifndef HB_NO_OT_METRICS_CACHE
+    assert (font->metrics_snapshot.get_relaxed ());
+#endif
+    apply_step (font, step, plain);
+#ifndef HB_NO_OT_METRICS_CACHE
+    assert (!font->metrics_snapshot.get_relaxed ());
+#endif
+
+    reference = hb_font_create (face);
+    for (unsigned i = 0; i <= step; i++)
+      apply_step (reference, i, plain);
+    check_same (font, reference);
+    check_same (font, reference); /* From the snapshot both times. */
+
+    /* Sub-fonts have their own. */
+    hb_font_t *sub = hb_font_create_sub_font (font);
+    hb_font_t *ref_sub = hb_font_create_sub_font (reference);
+    check_same (sub, ref_sub);
+    hb_font_set_scale (sub, 333, 777);
+    hb_font_set_scale (ref_sub, 333, 777);
+    check_same (sub, ref_sub);
+    check_same (font, reference);
+    hb_font_destroy (sub);
+    hb_font_destroy (ref_sub);
+
+    hb_font_destroy (reference);
+  }
+  hb_font_destroy (font);
+
+  /* Nothing to find. */
+  assert (!hb_ot_metrics_get_position (hb_font_get_empty (), HB_OT_METRICS_TAG_X_HEIGHT, nullptr));
+
+  hb_face_destroy (face);
+  hb_face_destroy (plain);
+  return 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-ot.h"
+#include "hb-ot-face.hh"
+#include "hb-ot-name-table.hh"
+
+/* Checks the per-face cache of decoded names against converting the name
+ * records directly, for every entry, encoding and buffer size, and
+ * hb_ot_name_collect_utf8() against hb_ot_name_get_utf8(). */
+
+static void
+push16 (hb_vector_t<char> &v, unsigned x)
+{
+  v.push ((char) (x >> 8));
+  v.push ((char) x);
+}
+
+static void
+push32 (hb_vector_t<char> &v, unsigned x)
+{
+  push16 (v, x >> 16);
+  push16 (v, x & 0xFFFF);
+}
+
+struct record_t
+{
+  unsigned platform, encoding, language, name_id;
+  std::initializer_list<unsigned> units; /* UTF-16 code units, or bytes. */
+};
+
+static hb_blob_t *
+create_font (std::initializer_list<record_t> records)
+{
+  hb_face_t *face = hb_face_builder_create ();
+
+  if (records.size ())
+  {
+    hb_vector_t<char> t, strings;
+    push16 (t, 0);
+    push16 (t, records.size ());
+    push16 (t, 6 + 12 * records.size ());
+    for (const record_t &r : records)
+    {
+      bool wide = r.platform != 1;
+      unsigned offset = strings.length;
+      for (unsigned u : r.units)
+	if (wide)
+	  push16 (strings, u);
+	else
+	  strings.push ((char) u);
+      push16 (t, r.platform); push16 (t, r.encoding); push16 (t, r.language); push16 (t, r.name_id);
+      push16 (t, strings.length - offset); push16 (t, offset);
+    }
+    for (char c : strings)
+      t.push (c);
+
+    hb_blob_t *blob = hb_blob_create (t.arrayZ, t.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+    hb_face_builder_add_table (face, HB_TAG ('n','a','m','e'), blob);
+    hb_blob_destroy (blob);
+  }
+  static const char maxp[] = {0,0,0x50,0, 0,1};
+  hb_blob_t *blob = hb_blob_create (maxp, sizeof (maxp), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_TAG ('m','a','x','p'), blob);
+  hb_blob_destroy (blob);
+
+  blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  return blob;
+}
+
+/* A TrueType collection of @fonts; table offsets are moved to where each
+ * font lands in the file. */
+static hb_blob_t *
+create_collection (hb_blob_t **fonts, unsigned count)
+{
+  hb_vector_t<char> ttc;
+  push32 (ttc, HB_TAG ('t','t','c','f'));
+  push32 (ttc, 0x00010000);
+  push32 (ttc, count);
+  unsigned offset = 12 + 4 * count;
+  for (unsigned i = 0; i < count; i++)
+  {
+    push32 (ttc, offset);
+    offset += (hb_blob_get_length (fonts[i]) + 3) & ~3;
+  }
+  for (unsigned i = 0; i < count; i++)
+  {
+    unsigned base = ttc.length;
+    unsigned length;
+    const char *data = hb_blob_get_data (fonts[i], &length);
+    for (unsigned j = 0; j < length; j++)
+      ttc.push (data[j]);
+    while (ttc.length & 3)
+      ttc.push (0);
+
+    unsigned num_tables = ((uint8_t) data[4] << 8) | (uint8_t) data[5];
+    for (unsigned j = 0; j < num_tables; j++)
+    {
+      char *p = ttc.arrayZ + base + 12 + 16 * j + 8;
+      unsigned v = ((uint8_t) p[0] << 24 | (uint8_t) p[1] << 16 | (uint8_t) p[2] << 8 | (uint8_t) p[3]) + base;
+      p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+    }
+  }
+  assert (!ttc.in_error ());
+  return hb_blob_create (ttc.arrayZ, ttc.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+}
+
+template <typename utf_t>
+static unsigned
+get_name (hb_face_t *face, hb_ot_name_id_t name_id, hb_language_t language,
+	  unsigned *text_size, typename utf_t::codepoint_t *text);
+template <>
+unsigned
+get_name<hb_utf8_t> (hb_face_t *face, hb_ot_name_id_t name_id, hb_language_t language,
+		     unsigned *text_size, uint8_t *text)
+{ return hb_ot_name_get_utf8 (face, name_id, language, text_size, (char *) text); }
+template <>
+unsigned
+get_name<hb_utf16_t> (hb_face_t *face, hb_ot_name_id_t name_id, hb_language_t language,
+		      unsigned *text_size, uint16_t *text)
+{ return hb_ot_name_get_utf16 (face, name_id, language, text_size, text); }
+template <>
+unsigned
+get_name<hb_utf32_t> (hb_face_t *face, hb_ot_name_id_t name_id, hb_language_t language,
+		      unsigned *text_size, uint32_t *text)
+{ return hb_ot_name_get_utf32 (face, name_id, language, text_size, text); }
+
+/* Every buffer size, against the converting path. */
+template <typename utf_t>
+static void
+check_entry (hb_face_t *face, hb_ot_name_id_t name_id, hb_language_t language)
+{
+  typedef typename utf_t::codepoint_t unit_t;
+  const OT::name_accelerator_t &name = *face->table.name;
+  int entry = name.get_entry (name_id, language ? language : hb_language_from_string ("en", -1));
+  if (entry == -1)
+  {
+    unit_t text[4] = {1, 1, 1, 1};
+    unsigned size = 4;
+    assert (!get_name<utf_t> (face, name_id, language, &size, text));
+    assert (!size && !text[0]);
+    return;
+  }
+
+  unsigned length = name.convert_entry<utf_t> (entry, nullptr, nullptr);
+  assert (get_name<utf_t> (face, name_id, language, nullptr, nullptr) == length);
+
+  for (unsigned pass = 0; pass < 2; pass++) /* Filling the cache, then from it. */
+    for (unsigned buf_size = 0; buf_size <= length + 2; buf_size++)
+    {
+      unit_t expected[64], text[64];
+      assert (length + 2 < ARRAY_LENGTH (text));
+      for (unsigned i = 0; i < ARRAY_LENGTH (text); i++)
+	expected[i] = text[i] = (unit_t) 0x55;
+
+      unsigned expected_size = buf_size, size = buf_size;
+      assert (name.convert_entry<utf_t> (entry, &expected_size, expected) == length);
+      assert (get_name<utf_t> (face, name_id, language, &size, text) == length);
+      assert (size == expected_size);
+      assert (!memcmp (text, expected, sizeof (text)));
+    }
+}
+
+static void
+check_face (hb_face_t *face)
+{
+  unsigned count;
+  const hb_ot_name_entry_t *entries = hb_ot_name_list_names (face, &count);
+  for (unsigned i = 0; i < count; i++)
+  {
+    check_entry<hb_utf8_t> (face, entries[i].name_id, entries[i].language);
+    check_entry<hb_utf16_t> (face, entries[i].name_id, entries[i].language);
+    check_entry<hb_utf32_t> (face, entries[i].name_id, entries[i].language);
+  }
+
+  /* Language fallback, and missing names. */
+  const char *languages[] = {"en", "ja", "fr", nullptr};
+  for (const char *l : languages)
+    for (hb_ot_name_id_t name_id : {1u, 4u, 5u, 6u, 99u})
+    {
+      hb_language_t language = l ? hb_language_from_string (l, -1) : HB_LANGUAGE_INVALID;
+      check_entry<hb_utf8_t> (face, name_id, language);
+      check_entry<hb_utf16_t> (face, name_id, language);
+      check_entry<hb_utf32_t> (face, name_id, language);
+    }
+}
+
+struct collected_t
+{
+  unsigned face_index;
+  hb_ot_name_id_t name_id;
+  char text[64];
+};
+
+struct collector_t
+{
+  hb_vector_t<collected_t> names;
+  unsigned stop_after;
+};
+
+static hb_bool_t
+collect (unsigned face_index, hb_ot_name_id_t name_id,
+	 const char *text, unsigned text_size, void *user_data)
+{
+  collector_t *c = (collector_t *) user_data;
+  assert (strlen (text) == text_size && text_size < 64);
+  collected_t *n = c->names.push ();
+  n->face_index = face_index;
+  n->name_id = name_id;
+  strcpy (n->text, text);
+  return c->names.length < c->stop_after;
+}
+
+int
+main (int argc, char **argv)
+{
+  const unsigned en = 0x0409, ja = 0x0411;
+  hb_blob_t *fonts[3] = {
+    create_font ({
+      {1, 0, 0, 6, {'C','a','f',0x8E}},				/* Mac Roman. */
+      {3, 1, en, 1, {'F','a','m','i','l','y'}},
+      {3, 1, en, 4, {0xD83D, 0xDE00, 0x6F22, 0x5B57, 'x', 0xD840, 0xDC0B}}, /* Non-BMP and CJK. */
+      {3, 1, en, 5, {'a', 0xD800, 'b', 0xDC00}},		/* Broken surrogates. */
+      {3, 1, ja, 1, {0x65E5, 0x672C, 0x8A9E}},
+    }),
+    create_font ({
+      {3, 1, en, 1, {'O','t','h','e','r'}},
+      {3, 1, en, 6, {0x00E9, 0x00E8}},
+    }),
+    create_font ({}), /* No names. */
+  };
+
+  /* Each face on its own. */
+  for (hb_blob_t *font : fonts)
+  {
+    hb_face_t *face = hb_face_create (font, 0);
+    check_face (face);
+    hb_face_destroy (face);
+  }
+
+  /* Known values. */
+  {
+    hb_face_t *face = hb_face_create (fonts[0], 0);
+    char text[64];
+    unsigned size = sizeof (text);
+    assert (hb_ot_name_get_utf8 (face, 4, HB_LANGUAGE_INVALID, &size, text) == 15);
+    assert (!strcmp (text, "\xF0\x9F\x98\x80\xE6\xBC\xA2\xE5\xAD\x97x\xF0\xA0\x80\x8B"));
+    size = 7; /* The second CJK character does not fit whole. */
+    hb_ot_name_get_utf8 (face, 4, HB_LANGUAGE_INVALID, &size, text);
+    assert (size == 4 && !strcmp (text, "\xF0\x9F\x98\x80"));
+    uint16_t text16[8];
+    size = 2; /* Neither does the surrogate pair. */
+    hb_ot_name_get_utf16 (face, 4, HB_LANGUAGE_INVALID, &size, text16);
+    assert (size == 0 && !text16[0]);
+    hb_face_destroy (face);
+  }
+
+  /* A collection, listed in one go. */
+  hb_blob_t *collection = create_collection (fonts, 3);
+  const hb_ot_name_id_t name_ids[] = {1, 4, 99, 6};
+  collector_t c;
+  c.stop_after = (unsigned) -1;
+  assert (hb_ot_name_collect_utf8 (collection, name_ids, ARRAY_LENGTH (name_ids),
+				   HB_LANGUAGE_INVALID, collect, &c) == 3);
+  unsigned k = 0;
+  for (unsigned i = 0; i < 3; i++)
+  {
+    hb_face_t *face = hb_face_create (collection, i);
+    check_face (face);
+    for (hb_ot_name_id_t name_id : name_ids)
+    {
+      char text[64];
+      unsigned size = sizeof (text);
+      if (!hb_ot_name_get_utf8 (face, name_id, HB_LANGUAGE_INVALID, &size, text))
+	continue;
+      assert (k < c.names.length);
+      assert (c.names[k].face_index == i && c.names[k].name_id == name_id);
+      assert (!strcmp (c.names[k].text, text));
+      k++;
+    }
+    hb_face_destroy (face);
+  }
+  assert (k == c.names.length && k == 5);
+
+  /* Stopping early. */
+  collector_t c2;
+  c2.stop_after = 2;
+  assert (hb_ot_name_collect_utf8 (collection, name_ids, ARRAY_LENGTH (name_ids),
+				   HB_LANGUAGE_INVALID, collect, &c2) == 3);
+  assert (c2.names.length == 2);
+
+  /* A single font is one face; nothing is not a font. */
+  c.names.resize (0);
+  assert (hb_ot_name_collect_utf8 (fonts[1], name_ids, ARRAY_LENGTH (name_ids),
+				   hb_language_from_string ("en", -1), collect, &c) == 1);
+  assert (c.names.length == 2 && !strcmp (c.names[0].text, "Other"));
+  assert (!hb_ot_name_collect_utf8 (hb_blob_get_empty (), name_ids, ARRAY_LENGTH (name_ids),
+				    HB_LANGUAGE_INVALID, collect, &c));
+
+  hb_blob_destroy (collection);
+  for (hb_blob_t *font : fonts)
+    hb_blob_destroy (font);
+  return 0;
+}
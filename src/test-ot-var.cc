@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-ot.h"
+
+/* Two axes: wght 100..400..900 with an avar map, wdth 50..100..200. */
+static hb_face_t *
+create_face ()
+{
+  static const char fvar[] = {
+    0,1, 0,0, 0,16, 0,2, 0,2, 0,20, 0,0, 0,12,
+    'w','g','h','t', 0,100,0,0, 1,(char) 144,0,0, 3,(char) 132,0,0, 0,0, 1,0,
+    'w','d','t','h', 0,50,0,0, 0,100,0,0, 0,(char) 200,0,0, 0,0, 1,1,
+  };
+  static const char avar[] = {
+    0,1, 0,0, 0,0, 0,2,
+    0,5, (char) 0xC0,0, (char) 0xC0,0, (char) 0xE0,0, (char) 0xD0,0,
+	 0,0, 0,0, 0x20,0, 0x10,0, 0x40,0, 0x40,0,
+    0,3, (char) 0xC0,0, (char) 0xC0,0, 0,0, 0,0, 0x40,0, 0x40,0,
+  };
+
+  hb_face_t *face = hb_face_builder_create ();
+  hb_blob_t *blob = hb_blob_create (fvar, sizeof (fvar), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_TAG ('f','v','a','r'), blob);
+  hb_blob_destroy (blob);
+  blob = hb_blob_create (avar, sizeof (avar), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+  hb_face_builder_add_table (face, HB_TAG ('a','v','a','r'), blob);
+  hb_blob_destroy (blob);
+
+  blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+/* Through hb_ot_var_normalize_variations(), which has no cache. */
+static void
+normalize_uncached (hb_face_t *face, const float *design, int *normalized)
+{
+  hb_variation_t variations[] = {
+    {HB_TAG ('w','g','h','t'), design[0]},
+    {HB_TAG ('w','d','t','h'), design[1]},
+  };
+  hb_ot_var_normalize_variations (face, variations, 2, normalized, 2);
+}
+
+int
+main (int argc, char **argv)
+{
+  hb_face_t *face = create_face ();
+  assert (hb_ot_var_get_axis_count (face) == 2);
+
+  /* Known values: avar maps wght 0.5 to 0.25. */
+  {
+    float design[] = {650, 200};
+    int normalized[2];
+    hb_ot_var_normalize_coords (face, 2, design, normalized);
+    assert (normalized[0] == 0x1000 && normalized[1] == 0x4000);
+  }
+
+  /* Enough distinct instances to cycle the cache, each asked for three
+   * times, against the uncached path and the batch call. */
+  const unsigned count = 100;
+  float design[count * 2];
+  for (unsigned i = 0; i < count; i++)
+  {
+    design[2 * i] = 50 + i * 9.5f;	/* Including out of range. */
+    design[2 * i + 1] = 40 + (i % 7) * 30;
+  }
+  design[2 * 10] = design[2 * 9]; /* Repeated instances. */
+  design[2 * 10 + 1] = design[2 * 9 + 1];
+
+  int batch[count * 2];
+  hb_ot_var_normalize_coords_batch (face, 2, count, design, batch);
+
+  for (unsigned round = 0; round < 3; round++)
+    for (unsigned i = 0; i < count; i++)
+    {
+      /* Revisit recent instances so some lookups hit. */
+      unsigned k = round == 1 ? i / 2 : i;
+      int cached[2], uncached[2];
+      hb_ot_var_normalize_coords (face, 2, design + 2 * k, cached);
+      normalize_uncached (face, design + 2 * k, uncached);
+      assert (cached[0] == uncached[0] && cached[1] == uncached[1]);
+      assert (cached[0] == batch[2 * k] && cached[1] == batch[2 * k + 1]);
+    }
+
+  /* Instances of different lengths don't mix. */
+  {
+    float design3[] = {650, 200, 7};
+    int normalized[3];
+    hb_ot_var_normalize_coords (face, 3, design3, normalized);
+    assert (normalized[0] == 0x1000 && normalized[1] == 0x4000 && !normalized[2]);
+    hb_ot_var_normalize_coords (face, 1, design3, normalized);
+    assert (normalized[0] == 0x1000);
+    hb_ot_var_normalize_coords_batch (face, 3, 1, design3, normalized);
+    assert (normalized[0] == 0x1000 && normalized[1] == 0x4000 && !normalized[2]);
+  }
+
+  /* Nothing to do. */
+  hb_ot_var_normalize_coords (face, 0, nullptr, nullptr);
+  hb_ot_var_normalize_coords_batch (face, 0, 5, nullptr, nullptr);
+  hb_ot_var_normalize_coords_batch (face, 2, 0, nullptr, nullptr);
+
+  hb_face_destroy (face);
+
+  /* No fvar. */
+  {
+    hb_face_t *empty = hb_face_get_empty ();
+    float d[] = {1, 2};
+    int n[2] = {5, 5};
+    hb_ot_var_normalize_coords (empty, 2, d, n);
+    assert (!n[0] && !n[1]);
+    n[0] = n[1] = 5;
+    hb_ot_var_normalize_coords_batch (empty, 2, 1, d, n);
+    assert (!n[0] && !n[1]);
+  }
+
+  return 0;
+}
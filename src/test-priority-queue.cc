@@ -73,9 +73,140 @@ test_extract ()
   assert (queue.is_empty ());
 }
 
+static void
+test_indexed_decrease ()
+{
+  hb_indexed_priority_queue_t queue;
+  assert (queue.reset (8));
+  assert (queue.is_empty ());
+
+  queue.insert (50, 5);
+  queue.insert (30, 3);
+  queue.insert (70, 7);
+  assert (queue.contains (3) && !queue.contains (4));
+  assert (queue.minimum () == hb_pair (30, 3));
+
+  assert (queue.insert_or_decrease (10, 7));
+  assert (queue.minimum () == hb_pair (10, 7));
+  assert (!queue.insert_or_decrease (60, 5));
+  assert (queue.insert_or_decrease (40, 4));
+  assert (queue.get_population () == 4);
+
+  assert (queue.pop_minimum () == hb_pair (10, 7));
+  assert (!queue.contains (7));
+  assert (queue.pop_minimum () == hb_pair (30, 3));
+  assert (queue.pop_minimum () == hb_pair (40, 4));
+  assert (queue.pop_minimum () == hb_pair (50, 5));
+  assert (queue.is_empty ());
+
+  /* Popped values can be queued again. */
+  queue.insert (20, 7);
+  assert (queue.pop_minimum () == hb_pair (20, 7));
+}
+
+static void
+test_indexed_extract ()
+{
+  hb_indexed_priority_queue_t queue;
+  assert (queue.reset (1000));
+  for (unsigned i = 0; i < 1000; i++)
+    queue.insert ((i * 7919) % 1000, i);
+  for (unsigned i = 0; i < 1000; i++)
+    assert (queue.insert_or_decrease ((int64_t) ((i * 7919) % 1000) - 1000, i));
+
+  for (int i = 0; i < 1000; i++)
+  {
+    auto item = queue.pop_minimum ();
+    assert (item.first == i - 1000);
+    assert ((item.second * 7919) % 1000 == (unsigned) i);
+  }
+  assert (queue.is_empty ());
+}
+
+/* Shortest distances on a large random graph, computed with the indexed
+ * queue and with the lazy-deletion approach on hb_priority_queue_t. */
+static void
+test_indexed_large_graph ()
+{
+  const unsigned num_vertices = 20000;
+  const unsigned edges_per_vertex = 16;
+  hb_vector_t<hb_pair_t<unsigned, unsigned>> edges; /* (target, weight) */
+  uint32_t state = 1;
+  auto rand = [&] () { state = state * 1103515245 + 12345; return state >> 8; };
+  for (unsigned v = 0; v < num_vertices; v++)
+    for (unsigned e = 0; e < edges_per_vertex; e++)
+      edges.push (hb_pair (rand () % num_vertices, 1 + rand () % 1000));
+  assert (!edges.in_error ());
+
+  hb_vector_t<int64_t> lazy_distances;
+  lazy_distances.resize (num_vertices);
+  for (auto &d : lazy_distances) d = hb_int_max (int64_t);
+  hb_vector_t<bool> visited;
+  visited.resize (num_vertices);
+  unsigned lazy_max_population = 0;
+  {
+    hb_priority_queue_t queue;
+    lazy_distances[0] = 0;
+    queue.insert (0, 0);
+    while (queue)
+    {
+      unsigned v = queue.pop_minimum ().second;
+      if (visited[v]) continue;
+      visited[v] = true;
+      for (unsigned e = 0; e < edges_per_vertex; e++)
+      {
+	auto edge = edges[v * edges_per_vertex + e];
+	int64_t d = lazy_distances[v] + edge.second;
+	if (d < lazy_distances[edge.first])
+	{
+	  lazy_distances[edge.first] = d;
+	  queue.insert (d, edge.first);
+	  lazy_max_population = hb_max (lazy_max_population, queue.get_population ());
+	}
+      }
+    }
+  }
+
+  hb_vector_t<int64_t> distances;
+  distances.resize (num_vertices);
+  for (auto &d : distances) d = hb_int_max (int64_t);
+  unsigned max_population = 0;
+  {
+    hb_indexed_priority_queue_t queue;
+    assert (queue.reset (num_vertices));
+    distances[0] = 0;
+    queue.insert (0, 0);
+    while (queue)
+    {
+      auto item = queue.pop_minimum ();
+      unsigned v = item.second;
+      assert (item.first == distances[v]);
+      for (unsigned e = 0; e < edges_per_vertex; e++)
+      {
+	auto edge = edges[v * edges_per_vertex + e];
+	int64_t d = distances[v] + edge.second;
+	if (d < distances[edge.first])
+	{
+	  distances[edge.first] = d;
+	  queue.insert_or_decrease (d, edge.first);
+	  max_population = hb_max (max_population, queue.get_population ());
+	}
+      }
+    }
+    assert (!queue.in_error ());
+  }
+
+  assert (distances == lazy_distances);
+  assert (max_population <= num_vertices);
+  assert (max_population <= lazy_max_population);
+}
+
 int
 main (int argc, char **argv)
 {
   test_insert ();
   test_extract ();
+  test_indexed_decrease ();
+  test_indexed_extract ();
+  test_indexed_large_graph ();
 }
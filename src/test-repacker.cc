@@ -2094,12 +2094,129 @@ test_shared_node_with_virtual_links ()
 }
 
 
+#ifdef HB_RUNTIME_ALLOCATOR
+static int live_allocations = 0;
+
+static void *counting_malloc (size_t size, void *user_data)
+{
+  live_allocations++;
+  return malloc (size);
+}
+static void *counting_calloc (size_t nmemb, size_t size, void *user_data)
+{
+  live_allocations++;
+  return calloc (nmemb, size);
+}
+static void *counting_realloc (void *ptr, size_t size, void *user_data)
+{
+  if (!ptr) live_allocations++;
+  return realloc (ptr, size);
+}
+static void counting_free (void *ptr, void *user_data)
+{
+  if (ptr) live_allocations--;
+  free (ptr);
+}
+
+static void test_arena ()
+{
+  int live_before = live_allocations;
+  {
+    hb_arena_t arena;
+
+    void *a = arena.alloc (100);
+    void *b = arena.calloc (10, 10);
+    assert (a && b);
+    for (unsigned i = 0; i < 100; i++)
+      assert (!((char *) b)[i]);
+
+    /* Freed blocks get reused. */
+    arena.free (a);
+    void *c = arena.alloc (90);
+    assert (c == a);
+
+    /* Growing within the size class stays in place. */
+    hb_memset (c, 'x', 90);
+    assert (arena.realloc (c, 110) == c);
+    c = arena.realloc (c, 10000);
+    assert (((char *) c)[89] == 'x');
+
+    /* Large allocations get a chunk of their own, released on free. */
+    int live = live_allocations;
+    void *large = arena.alloc (1 << 20);
+    assert (large && live_allocations == live + 1);
+    hb_memset (large, 'y', 1 << 20);
+    large = arena.realloc (large, (1 << 20) + 1);
+    assert (((char *) large)[(1 << 20) - 1] == 'y');
+    arena.free (large);
+    assert (live_allocations == live);
+
+    arena.free (b);
+    arena.free (c);
+
+    /* Whatever is left goes with the arena. */
+    assert (arena.alloc (1000) && arena.alloc (100000));
+  }
+  assert (live_allocations == live_before);
+
+  /* Size classes bigger than the first chunks, mixed with small ones. */
+  {
+    hb_arena_t arena;
+
+    static const unsigned sizes[] = {40000, 100, 60000, 16000, 3000, 65000, 8};
+    void *ps[ARRAY_LENGTH_CONST (sizes)];
+    for (unsigned i = 0; i < ARRAY_LENGTH (sizes); i++)
+    {
+      ps[i] = arena.alloc (sizes[i]);
+      assert (ps[i]);
+      hb_memset (ps[i], 'a' + i, sizes[i]);
+    }
+    for (unsigned i = 0; i < ARRAY_LENGTH (sizes); i++)
+    {
+      for (unsigned j = 0; j < sizes[i]; j++)
+	assert (((char *) ps[i])[j] == (char) ('a' + i));
+      arena.free (ps[i]);
+    }
+  }
+  assert (live_allocations == live_before);
+
+  /* Only the installed allocator keeps allocations off the fast path. */
+  assert (_hb_allocator_hooks.get_relaxed () == 1);
+}
+
+static void test_resolve_overflows_in_arena ()
+{
+  size_t buffer_size = 160000;
+  void* buffer = malloc (buffer_size);
+  hb_serialize_context_t c (buffer, buffer_size);
+  populate_serializer_with_dedup_overflow (&c);
+
+  int live_before = live_allocations;
+  hb_blob_t* out = hb_resolve_overflows (c.object_graph (), HB_TAG_NONE);
+  assert (out);
+  assert (live_allocations == live_before + 2); /* The blob and its data. */
+  hb_bytes_t result = out->as_bytes ();
+  assert (result.length == (10000 + 2 * 2 + 60000 + 2 + 3 * 2));
+
+  hb_blob_destroy (out);
+  assert (live_allocations == live_before);
+  free (buffer);
+}
+#endif
+
+
 // TODO(garretrieger): update will_overflow tests to check the overflows array.
 // TODO(garretrieger): add tests for priority raising.
 
 int
 main (int argc, char **argv)
 {
+#ifdef HB_RUNTIME_ALLOCATOR
+  hb_allocator_t allocator = {counting_malloc, counting_calloc,
+			      counting_realloc, counting_free, nullptr};
+  assert (hb_allocator_set (&allocator));
+#endif
+
   test_serialize ();
   test_sort_shortest ();
   test_will_overflow_1 ();
@@ -2128,6 +2245,13 @@ main (int argc, char **argv)
   test_resolve_with_pair_pos_2_split_with_device_tables ();
   test_resolve_with_close_to_limit_pair_pos_2_split ();
   test_resolve_with_basic_mark_base_pos_1_split ();
+#ifdef HB_RUNTIME_ALLOCATOR
+  test_arena ();
+  test_resolve_overflows_in_arena ();
+
+  /* Too late to change it now. */
+  assert (!hb_allocator_set (nullptr));
+#endif
 
   // TODO(grieger): have run overflow tests compare graph equality not final packed binary.
   // TODO(grieger): split test where multiple subtables in one lookup are split to test link ordering.
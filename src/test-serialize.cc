@@ -48,5 +48,47 @@ main (int argc, char **argv)
   assert (bytes.length == 10);
   bytes.fini ();
 
+  /* Test object dedup. */
+  {
+    hb_serialize_context_t s (buf, sizeof (buf));
+    s.start_serialize<char> ();
+
+    s.push ();
+    *s.allocate_size<char> (1) = 'a';
+    unsigned leaf = s.pop_pack ();
+
+    unsigned parents[3];
+    for (unsigned i = 0; i < 3; i++)
+    {
+      s.push ();
+      auto *ofs = s.allocate_size<OT::HBUINT16> (2);
+      if (i == 2)
+      {
+	/* Links reverted away must not count towards the object's identity. */
+	auto snap = s.snapshot ();
+	s.add_link (ofs[0], leaf);
+	s.revert (snap);
+	ofs = s.allocate_size<OT::HBUINT16> (2);
+      }
+      else
+	s.add_link (*ofs, leaf);
+      parents[i] = s.pop_pack ();
+    }
+    assert (parents[0] == parents[1]);
+    assert (parents[0] != parents[2]);
+
+    s.push ();
+    s.allocate_size<OT::HBUINT16> (4);
+    assert (s.pop_pack () == parents[2]);
+
+    s.push ();
+    auto *ofs = s.allocate_size<OT::HBUINT16> (2);
+    s.add_link (*ofs, leaf);
+    assert (s.pop_pack (false) != parents[0]);
+
+    s.end_serialize ();
+    assert (s.successful ());
+  }
+
   return 0;
 }
@@ -161,5 +161,107 @@ main (int argc, char **argv)
     assert(s.has(2));
   }
 
+  /* Test population and page reductions. */
+  {
+    hb_set_t s, t;
+    s.add_range (0, 1023);
+    assert (s.get_population () == 1024);
+    s.del (700);
+    assert (s.get_population () == 1023);
+
+    unsigned count = 0, overlap = 0;
+    for (unsigned g = 3; g < 3000; g += 7)
+    {
+      t.add (g);
+      count++;
+      overlap += s.has (g);
+    }
+    assert (t.get_population () == count);
+
+    hb_set_t u = t;
+    u.union_ (s);
+    assert (u.get_population () == 1023 + count - overlap);
+    assert (t.is_subset (u));
+    assert (!u.is_subset (t));
+    assert (u.is_equal (u));
+
+    u.subtract (t);
+    assert (u.is_subset (s));
+    u.subtract (s);
+    assert (u.is_empty ());
+
+    /* Walk glyphs in order across pages. */
+    for (unsigned g = 0; g < 3000; g++)
+      assert (t.has (g) == (g >= 3 && (g - 3) % 7 == 0));
+  }
+
+  /* Test range and bit representations. */
+  {
+    hb_set_t s;
+    s.add_range (0x0600, 0x06FF);
+    s.add_range (0x0750, 0x077F);
+    s.add_range (0x0700, 0x074F);
+    s.add (0x08A0);
+    assert (!s.s.s.use_bits);
+    assert (s.get_population () == 0x180 + 1);
+    assert (s.has (0x0700) && !s.has (0x0780) && !s.has (0x05FF));
+
+    hb_codepoint_t first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+    assert (s.next_range (&first, &last) && first == 0x0600 && last == 0x077F);
+    assert (s.next_range (&first, &last) && first == 0x08A0 && last == 0x08A0);
+    assert (!s.next_range (&first, &last));
+
+    s.del_range (0x0650, 0x065F);
+    assert (s.get_population () == 0x180 + 1 - 16);
+    hb_codepoint_t g = 0x064F;
+    assert (s.next (&g) && g == 0x0660);
+    assert (s.previous (&g) && g == 0x064F);
+
+    /* Hashes and equality do not depend on the representation. */
+    hb_set_t t;
+    for (hb_codepoint_t c : s)
+      t.add (c);
+    assert (t.is_equal (s) && s.is_equal (t));
+    assert (t.hash () == s.hash ());
+
+    /* Fragmenting switches to bits... */
+    for (unsigned i = 0; i < 1000; i++)
+      t.add (0x10000 + 2 * i);
+    assert (t.s.s.use_bits);
+    assert (t.get_population () == s.get_population () + 1000);
+    assert (s.is_subset (t) && !t.is_subset (s));
+
+    /* ...and long runs switch back. */
+    t.add_range (0x10000, 0x20000);
+    assert (!t.s.s.use_bits);
+    assert (t.get_population () == s.get_population () + 0x10001);
+
+    t.subtract (s);
+    first = last = HB_SET_VALUE_INVALID;
+    assert (t.next_range (&first, &last) && first == 0x10000 && last == 0x20000);
+    assert (!t.next_range (&first, &last));
+
+    t.intersect (s);
+    assert (t.is_empty ());
+  }
+
+  /* Test next_range / previous_range across pages. */
+  {
+    hb_set_t s;
+    for (unsigned i = 0; i < 2000; i++)
+      s.add (3 * i);
+    s.add_range (1000, 5000);
+    s.del (1999);
+    assert (s.s.s.use_bits);
+
+    hb_codepoint_t first = 998, last = 998;
+    assert (s.next_range (&first, &last) && first == 999 && last == 1998);
+    assert (s.next_range (&first, &last) && first == 2000 && last == 5001);
+    assert (s.next_range (&first, &last) && first == 5004 && last == 5004);
+    assert (s.previous_range (&first, &last) && first == 2000 && last == 5001);
+    assert (s.previous_range (&first, &last) && first == 999 && last == 1998);
+    assert (s.previous_range (&first, &last) && first == 996 && last == 996);
+  }
+
   return 0;
 }
@@ -0,0 +1,382 @@
+/*
+ * Copyright © 2026  The HarfBuzz Project Authors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-buffer.hh"
+
+#include <chrono>
+
+/* Checks the runs hb_shape_itemized() splits text into, and that each run
+ * shapes exactly like hb_shape() on that run with the rest of the text as
+ * context. */
+
+static void
+push16 (hb_vector_t<char> &v, unsigned x)
+{
+  v.push ((char) (x >> 8));
+  v.push ((char) x);
+}
+
+static void
+push32 (hb_vector_t<char> &v, unsigned x)
+{
+  push16 (v, x >> 16);
+  push16 (v, x & 0xFFFF);
+}
+
+/* A font whose format 12 cmap covers the ranges given as pairs. */
+static hb_font_t *
+create_font (std::initializer_list<hb_codepoint_t> ranges)
+{
+  hb_vector_t<char> t;
+  unsigned num_groups = ranges.size () / 2;
+  push16 (t, 0); push16 (t, 1);
+  push16 (t, 3); push16 (t, 10); push32 (t, 12);
+  push16 (t, 12); push16 (t, 0); push32 (t, 16 + 12 * num_groups); push32 (t, 0); push32 (t, num_groups);
+  for (auto it = ranges.begin (); it != ranges.end (); it += 2)
+  {
+    push32 (t, it[0]); push32 (t, it[1]); push32 (t, it[0] & 0x7FFF);
+  }
+  assert (!t.in_error ());
+
+  hb_face_t *builder = hb_face_builder_create ();
+  hb_blob_t *blob = hb_blob_create (t.arrayZ, t.length, HB_MEMORY_MODE_DUPLICATE, nullptr, nullptr);
+  hb_face_builder_add_table (builder, HB_TAG ('c','m','a','p'), blob);
+  hb_blob_destroy (blob);
+  static const char maxp[] = {0,0,0x50,0, (char) 0xFF,(char) 0xFF};
+  blob = hb_blob_create (maxp, sizeof (maxp), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+  hb_face_builder_add_table (builder, HB_TAG ('m','a','x','p'), blob);
+  hb_blob_destroy (blob);
+
+  blob = hb_face_reference_blob (builder);
+  hb_face_destroy (builder);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  return font;
+}
+
+static hb_font_t *fonts[3];
+
+static void
+create_fonts ()
+{
+  /* Basic Latin. */
+  fonts[0] = create_font ({0x20, 0x7E});
+  /* Punctuation, Latin Extended-A, combining marks, Cyrillic, ZWJ. */
+  fonts[1] = create_font ({0x20, 0x2F, 0x100, 0x17F, 0x300, 0x36F, 0x400, 0x4FF, 0x200D, 0x200D});
+  /* Space and Hebrew letters. */
+  fonts[2] = create_font ({0x20, 0x20, 0x5D0, 0x5EA});
+}
+
+struct expected_run_t
+{
+  unsigned font_index;
+  hb_script_t script;
+  hb_direction_t direction;
+  unsigned text_start, text_end;
+};
+
+static hb_vector_t<hb_shape_run_t> runs;
+
+static void
+collect_run (const hb_shape_run_t *run, void *user_data)
+{
+  runs.push (*run);
+}
+
+/* Clusters are spaced out to check that they are kept, not renumbered. */
+static hb_buffer_t *
+create_buffer (std::initializer_list<hb_codepoint_t> text,
+	       hb_direction_t direction, hb_script_t script,
+	       unsigned start = 0, unsigned length = (unsigned) -1)
+{
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_vector_t<hb_codepoint_t> u;
+  for (hb_codepoint_t c : text)
+    u.push (c);
+  hb_buffer_add_utf32 (buffer, u.arrayZ, u.length, start, length);
+  unsigned count;
+  hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, &count);
+  for (unsigned i = 0; i < count; i++)
+    info[i].cluster *= 10;
+  hb_buffer_set_direction (buffer, direction);
+  hb_buffer_set_script (buffer, script);
+  hb_buffer_set_language (buffer, hb_language_from_string ("en", -1));
+  return buffer;
+}
+
+static void
+check (std::initializer_list<hb_codepoint_t> text,
+       hb_direction_t direction, hb_script_t script,
+       std::initializer_list<expected_run_t> expected)
+{
+  hb_buffer_t *buffer = create_buffer (text, direction, script);
+  runs.resize (0);
+  assert (hb_shape_itemized (fonts, ARRAY_LENGTH (fonts), buffer, nullptr, nullptr, collect_run, nullptr));
+  assert (hb_buffer_get_content_type (buffer) == HB_BUFFER_CONTENT_TYPE_GLYPHS);
+  assert (runs.length == expected.size ());
+  assert (hb_buffer_get_direction (buffer) == direction);
+  assert (hb_buffer_get_script (buffer) == script);
+
+  unsigned count;
+  hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, &count);
+  hb_glyph_position_t *pos = hb_buffer_get_glyph_positions (buffer, nullptr);
+  unsigned glyph_end = 0;
+  for (unsigned i = 0; i < runs.length; i++)
+  {
+    const hb_shape_run_t &run = runs[i];
+    const expected_run_t &want = expected.begin ()[i];
+    assert (run.font_index == want.font_index);
+    assert (run.script == want.script);
+    assert (run.direction == want.direction);
+    assert (run.text_start == want.text_start && run.text_end == want.text_end);
+
+    /* Runs come in output order, back to back. */
+    assert (run.glyph_start == glyph_end);
+    glyph_end = run.glyph_end;
+
+    hb_buffer_t *ref = create_buffer (text, run.direction, run.script,
+				      run.text_start, run.text_end - run.text_start);
+    hb_shape (fonts[run.font_index], ref, nullptr, 0);
+    unsigned ref_count;
+    hb_glyph_info_t *ref_info = hb_buffer_get_glyph_infos (ref, &ref_count);
+    hb_glyph_position_t *ref_pos = hb_buffer_get_glyph_positions (ref, nullptr);
+    assert (ref_count == run.glyph_end - run.glyph_start);
+    for (unsigned j = 0; j < ref_count; j++)
+    {
+      const hb_glyph_info_t &g = info[run.glyph_start + j];
+      assert (g.codepoint == ref_info[j].codepoint);
+      assert (g.cluster == ref_info[j].cluster);
+      assert (g.cluster % 10 == 0 &&
+	      g.cluster / 10 >= run.text_start && g.cluster / 10 < run.text_end);
+      assert (!memcmp (&pos[run.glyph_start + j], &ref_pos[j], sizeof (ref_pos[j])));
+    }
+    hb_buffer_destroy (ref);
+  }
+  assert (glyph_end == count);
+
+  hb_buffer_destroy (buffer);
+}
+
+static void
+test_runs ()
+{
+  const hb_direction_t INVALID = HB_DIRECTION_INVALID;
+  const hb_direction_t LTR = HB_DIRECTION_LTR, RTL = HB_DIRECTION_RTL;
+  const hb_script_t DETECT = HB_SCRIPT_INVALID;
+  const hb_script_t LATN = HB_SCRIPT_LATIN, CYRL = HB_SCRIPT_CYRILLIC;
+  const hb_script_t HEBR = HB_SCRIPT_HEBREW, HANI = HB_SCRIPT_HAN;
+
+  /* One run, shaped in place. */
+  check ({'a', 'b', ' ', 'c'}, INVALID, DETECT, {{0, LATN, LTR, 0, 4}});
+
+  /* Font changes within a script. */
+  check ({'a', 'b', 0x101, 'c'}, INVALID, DETECT,
+	 {{0, LATN, LTR, 0, 2}, {1, LATN, LTR, 2, 3}, {0, LATN, LTR, 3, 4}});
+
+  /* Script changes within a font; the space stays with the text before. */
+  check ({0x101, 0x102, ' ', 0x430, 0x431}, INVALID, DETECT,
+	 {{1, LATN, LTR, 0, 3}, {1, CYRL, LTR, 3, 5}});
+
+  /* Marks and joiners stay with their base, even in a font lacking them. */
+  check ({'a', 'e', 0x301, 0x200D, 'c', 0x430, 0x301}, INVALID, DETECT,
+	 {{0, LATN, LTR, 0, 5}, {1, CYRL, LTR, 5, 7}});
+
+  /* Script-neutral text at the start takes the script that follows. */
+  check ({'(', '1', ')', 0x5D0, 0x5D1}, INVALID, DETECT,
+	 {{0, HEBR, RTL, 0, 3}, {2, HEBR, RTL, 3, 5}});
+
+  /* Uncovered characters stay in the current font. */
+  check ({0x4E00, 'a', 0x4E01}, INVALID, DETECT,
+	 {{0, HANI, LTR, 0, 1}, {0, LATN, LTR, 1, 2}, {0, HANI, LTR, 2, 3}});
+
+  /* Each run gets its own direction in logical order... */
+  check ({'a', 'b', ' ', 0x5D0, 0x5D1}, INVALID, DETECT,
+	 {{0, LATN, LTR, 0, 3}, {2, HEBR, RTL, 3, 5}});
+  /* ...while a backward buffer direction applies to all, in reverse. */
+  check ({'a', 'b', ' ', 0x5D0, 0x5D1}, RTL, DETECT,
+	 {{2, HEBR, RTL, 3, 5}, {0, LATN, RTL, 0, 3}});
+  check ({'a', 0x430, 0x5D0}, RTL, DETECT,
+	 {{2, HEBR, RTL, 2, 3}, {1, CYRL, RTL, 1, 2}, {0, LATN, RTL, 0, 1}});
+
+  /* A buffer script only leaves font changes. */
+  check ({0x101, 0x430, 'a'}, INVALID, LATN,
+	 {{1, LATN, LTR, 0, 2}, {0, LATN, LTR, 2, 3}});
+}
+
+static void
+test_failure ()
+{
+  static const char *bogus[] = {"bogus", nullptr};
+  std::initializer_list<hb_codepoint_t> texts[] = {
+    {'a', 'b'},
+    {'a', 0x430, 0x5D0},
+  };
+  for (auto text : texts)
+  {
+    hb_buffer_t *buffer = create_buffer (text, HB_DIRECTION_INVALID, HB_SCRIPT_INVALID);
+    runs.resize (0);
+    assert (!hb_shape_itemized (fonts, ARRAY_LENGTH (fonts), buffer, nullptr, bogus, collect_run, nullptr));
+    assert (!runs.length);
+
+    /* The input is left as it was. */
+    assert (hb_buffer_get_content_type (buffer) == HB_BUFFER_CONTENT_TYPE_UNICODE);
+    assert (hb_buffer_get_script (buffer) == HB_SCRIPT_INVALID);
+    assert (hb_buffer_get_direction (buffer) == HB_DIRECTION_INVALID);
+    unsigned count;
+    hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, &count);
+    assert (count == text.size ());
+    for (unsigned i = 0; i < count; i++)
+      assert (info[i].codepoint == text.begin ()[i] && info[i].cluster == 10 * i);
+    hb_buffer_destroy (buffer);
+  }
+
+  /* Failing after some runs were appended, which set the properties the
+   * buffer had unset: the last run does not fit. */
+  {
+    hb_codepoint_t text[100] = {'a', 0x430};
+    for (unsigned i = 2; i < ARRAY_LENGTH (text); i++)
+      text[i] = 0x5D0;
+    hb_buffer_t *buffer = hb_buffer_create ();
+    hb_buffer_add_utf32 (buffer, text, ARRAY_LENGTH (text), 0, -1);
+    buffer->max_len = 50;
+    runs.resize (0);
+    assert (!hb_shape_itemized (fonts, ARRAY_LENGTH (fonts), buffer, nullptr, nullptr, collect_run, nullptr));
+    assert (runs.length == 2);
+    assert (hb_buffer_get_content_type (buffer) == HB_BUFFER_CONTENT_TYPE_UNICODE);
+    assert (hb_buffer_get_length (buffer) == ARRAY_LENGTH (text));
+    assert (hb_buffer_get_script (buffer) == HB_SCRIPT_INVALID);
+    assert (hb_buffer_get_direction (buffer) == HB_DIRECTION_INVALID);
+    hb_buffer_destroy (buffer);
+  }
+
+  /* No fonts, or no text. */
+  hb_buffer_t *buffer = hb_buffer_create ();
+  assert (hb_shape_itemized (fonts, ARRAY_LENGTH (fonts), buffer, nullptr, nullptr, nullptr, nullptr));
+  hb_buffer_add_utf8 (buffer, "a", -1, 0, -1);
+  assert (!hb_shape_itemized (fonts, 0, buffer, nullptr, nullptr, nullptr, nullptr));
+  hb_buffer_destroy (buffer);
+}
+
+/* Itemized shaping of short mixed-script messages, against splitting by
+ * font and script by hand and shaping every run in a buffer of its own. */
+static void
+benchmark ()
+{
+  static const char *messages[] = {
+    "hey! are we still on for tonight?",
+    "\xD0\xB4\xD0\xB0, \xD0\xBA\xD0\xBE\xD0\xBD\xD0\xB5\xD1\x87\xD0\xBD\xD0\xBE",
+    "ok see you at 8",
+    "\xD7\xA9\xD7\x9C\xD7\x95\xD7\x9D! \xD7\x9E\xD7\x94 \xD7\xA0\xD7\xA9\xD7\x9E\xD7\xA2?",
+    "na\xC3\xAFve caf\xC3\xA9 \xC4\x81\xC4\x93\xC4\xAB",
+    "brb",
+  };
+  const unsigned iterations = 20000;
+  hb_unicode_funcs_t *unicode = hb_unicode_funcs_get_default ();
+  hb_buffer_t *buffer = hb_buffer_create ();
+  unsigned chars = 0;
+
+  auto start = std::chrono::steady_clock::now ();
+  for (unsigned i = 0; i < iterations; i++)
+    for (const char *message : messages)
+    {
+      hb_buffer_clear_contents (buffer);
+      hb_buffer_add_utf8 (buffer, message, -1, 0, -1);
+      chars += hb_buffer_get_length (buffer);
+      hb_shape_itemized (fonts, ARRAY_LENGTH (fonts), buffer, nullptr, nullptr, nullptr, nullptr);
+    }
+  std::chrono::duration<double, std::nano> itemized = std::chrono::steady_clock::now () - start;
+
+  start = std::chrono::steady_clock::now ();
+  hb_vector_t<hb_codepoint_t> text;
+  hb_vector_t<unsigned> font_indices;
+  hb_vector_t<hb_script_t> scripts;
+  for (unsigned i = 0; i < iterations; i++)
+    for (const char *message : messages)
+    {
+      hb_buffer_clear_contents (buffer);
+      hb_buffer_add_utf8 (buffer, message, -1, 0, -1);
+      unsigned count;
+      hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, &count);
+      text.resize (count);
+      font_indices.resize (count);
+      scripts.resize (count);
+      for (unsigned j = 0; j < count; j++)
+      {
+	text[j] = info[j].codepoint;
+	scripts[j] = hb_unicode_script (unicode, text[j]);
+	font_indices[j] = 0;
+	for (unsigned f = 0; f < ARRAY_LENGTH (fonts); f++)
+	{
+	  hb_codepoint_t glyph;
+	  if (hb_font_get_nominal_glyph (fonts[f], text[j], &glyph))
+	  {
+	    font_indices[j] = f;
+	    break;
+	  }
+	}
+      }
+
+      hb_buffer_t *out = hb_buffer_create ();
+      for (unsigned j = 0; j < count;)
+      {
+	unsigned end = j + 1;
+	while (end < count && font_indices[end] == font_indices[j] &&
+	       (scripts[end] == scripts[j] || scripts[end] == HB_SCRIPT_COMMON))
+	  end++;
+	hb_buffer_t *run = hb_buffer_create ();
+	hb_buffer_add_utf32 (run, text.arrayZ, count, j, end - j);
+	hb_buffer_guess_segment_properties (run);
+	hb_shape (fonts[font_indices[j]], run, nullptr, 0);
+	hb_buffer_append (out, run, 0, (unsigned) -1);
+	hb_buffer_destroy (run);
+	j = end;
+      }
+      hb_buffer_destroy (out);
+    }
+  std::chrono::duration<double, std::nano> by_hand = std::chrono::steady_clock::now () - start;
+
+  printf ("%-24s %8.2f ns/char\n", "hb_shape_itemized", itemized.count () / chars);
+  printf ("%-24s %8.2f ns/char\n", "run buffers by hand", by_hand.count () / chars);
+  hb_buffer_destroy (buffer);
+}
+
+int
+main (int argc, char **argv)
+{
+  create_fonts ();
+
+  test_runs ();
+  test_failure ();
+
+  if (argc > 1 && 0 == strcmp (argv[1], "--benchmark"))
+    benchmark ();
+
+  for (hb_font_t *font : fonts)
+    hb_font_destroy (font);
+  return 0;
+}
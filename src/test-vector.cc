@@ -187,5 +187,60 @@ main (int argc, char **argv)
     v.push (m);
   }
 
+  /* Test small vectors, staying inline and spilling to the heap. */
+  {
+    hb_small_vector_t<int, 4> v {1, 2, 3};
+    hb_small_vector_t<int, 4> v2 {v};
+    v.push (4);
+    assert (v.length == 4);
+    assert (v2.length == 3);
+    v << 5 << 6;
+    assert (v.length == 6);
+    for (unsigned i = 0; i < v.length; i++)
+      assert (v[i] == (int) i + 1);
+
+    hb_swap (v, v2);
+    assert (v.length == 3);
+    assert (v2.length == 6);
+    assert (v2[5] == 6);
+
+    hb_small_vector_t<int, 4> v3 {std::move (v2)};
+    assert (v2.length == 0);
+    assert (v3.length == 6);
+    v3.shrink (2);
+    assert (v3.length == 2);
+    assert (v3[1] == 2);
+    v3 = std::move (v);
+    assert (v.length == 0);
+    assert (v3.length == 3);
+    assert (v3[2] == 3);
+    assert (v3.pop () == 3);
+
+    hb_set_t s {18, 12};
+    hb_small_vector_t<int, 1, true> S (s);
+    assert (S.length == 2);
+    assert (S[0] == 12 && S[1] == 18);
+  }
+
+  {
+    hb_small_vector_t<std::string, 2> v;
+    std::string s;
+    for (unsigned i = 1; i < 20; i++)
+    {
+      s += "x";
+      v.push (s);
+    }
+    hb_small_vector_t<std::string, 2> v2;
+    v2 = v;
+    v2.remove_ordered (5);
+    v2.remove_unordered (5);
+    assert (v2.length == 17);
+    v2.shrink (1);
+    assert (v2[0] == "x");
+    hb_swap (v, v2);
+    assert (v.length == 1);
+    assert (v2.length == 19);
+  }
+
   return 0;
 }